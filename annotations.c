@@ -0,0 +1,710 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rum.h"
+
+#define ANNOTATIONS_MAGIC 0x414d5552 // "RUMA"
+#define ANNOTATIONS_VERSION 1
+#define ANNOTATIONS_SEED 0x414e4e4f
+#define ANNOTATIONS_DEPTH 32 // nested annotations and arrays past this are taken to be malformed
+
+static const char runtime_visible[] = "RuntimeVisibleAnnotations";
+
+// whether the Utf8 entry at `index` is the RuntimeVisibleAnnotations attribute name
+static int is_runtime_visible(const struct rum_pool_t *pool, unsigned short index)
+{
+    unsigned short length;
+    const uint8_t *name = rum_pool_utf8(pool, index, &length);
+    return name != NULL && length == sizeof(runtime_visible) - 1 && memcmp(name, runtime_visible, length) == 0;
+}
+
+static int skip_annotation(struct cursor_t *cursor, int depth);
+
+// steps over an element_value, the constants are only pool indices
+static int skip_element(struct cursor_t *cursor, int depth)
+{
+    switch (read_u1(cursor))
+    {
+    case 'B':
+    case 'C':
+    case 'D':
+    case 'F':
+    case 'I':
+    case 'J':
+    case 'S':
+    case 'Z':
+    case 's':
+    case 'c':
+        read_u2(cursor);
+        return RUM_OK;
+    case 'e':
+        read_u4(cursor); // type and constant name
+        return RUM_OK;
+    case '@':
+        return depth == 0 ? RUM_ERR_TAG : skip_annotation(cursor, depth - 1);
+    case '[':
+    {
+        unsigned short count = read_u2(cursor);
+        for (unsigned short i = 0; i < count && !cursor->overflow; i++)
+        {
+            int error = depth == 0 ? RUM_ERR_TAG : skip_element(cursor, depth - 1);
+            if (error != RUM_OK)
+            {
+                return error;
+            }
+        }
+        return RUM_OK;
+    }
+    default:
+        return cursor->overflow ? RUM_ERR_TRUNCATED : RUM_ERR_TAG;
+    }
+}
+
+// steps over the element-value pairs of an annotation whose type has been read already
+static int skip_pairs(struct cursor_t *cursor, int depth)
+{
+    unsigned short pairs = read_u2(cursor);
+    for (unsigned short i = 0; i < pairs && !cursor->overflow; i++)
+    {
+        read_u2(cursor); // element name
+        int error = skip_element(cursor, depth);
+        if (error != RUM_OK)
+        {
+            return error;
+        }
+    }
+    return RUM_OK;
+}
+
+static int skip_annotation(struct cursor_t *cursor, int depth)
+{
+    read_u2(cursor);
+    return skip_pairs(cursor, depth);
+}
+
+int rum_annotation_skip(struct cursor_t *cursor)
+{
+    return skip_annotation(cursor, ANNOTATIONS_DEPTH);
+}
+
+struct scan_t
+{
+    const struct rum_pool_t *pool;
+    int (*found)(void *user, const struct rum_annotation_t *annotation);
+    void *user;
+};
+
+// reports the type of every annotation in the attribute, the values are stepped over
+static int scan_annotations(struct scan_t *scan, const uint8_t *bytes, uint32_t length, struct rum_annotation_t *annotation)
+{
+    struct cursor_t cursor = {
+        .data = bytes,
+        .length = length,
+        .offset = 0,
+        .overflow = 0};
+
+    unsigned short count = read_u2(&cursor);
+    for (unsigned short i = 0; i < count && !cursor.overflow; i++)
+    {
+        annotation->type.bytes = rum_pool_utf8(scan->pool, read_u2(&cursor), &annotation->type.length);
+        if (annotation->type.bytes == NULL)
+        {
+            return cursor.overflow ? RUM_ERR_TRUNCATED : RUM_ERR_TAG;
+        }
+        if (scan->found(scan->user, annotation) != 0)
+        {
+            return RUM_STOPPED;
+        }
+        int error = skip_pairs(&cursor, ANNOTATIONS_DEPTH);
+        if (error != RUM_OK)
+        {
+            return error;
+        }
+    }
+    return cursor.overflow ? RUM_ERR_TRUNCATED : RUM_OK;
+}
+
+// walks an attribute table, only RuntimeVisibleAnnotations is looked into, Code and everything else
+// is stepped over by its length
+static int scan_attributes(struct scan_t *scan, struct cursor_t *cursor, int target, unsigned short name, unsigned short descriptor)
+{
+    unsigned short count = read_u2(cursor);
+    for (unsigned short i = 0; i < count; i++)
+    {
+        unsigned short attribute = read_u2(cursor);
+        uint32_t length = read_u4(cursor);
+        const uint8_t *bytes = read_bytes(cursor, length);
+        if (cursor->overflow)
+        {
+            return RUM_ERR_TRUNCATED;
+        }
+        if (!is_runtime_visible(scan->pool, attribute))
+        {
+            continue;
+        }
+
+        // members are named only once one of them turns out to be annotated
+        struct rum_annotation_t annotation = {.target = target};
+        if (target != RUM_ANNOTATED_CLASS)
+        {
+            annotation.name.bytes = rum_pool_utf8(scan->pool, name, &annotation.name.length);
+            annotation.descriptor.bytes = rum_pool_utf8(scan->pool, descriptor, &annotation.descriptor.length);
+            if (annotation.name.bytes == NULL || annotation.descriptor.bytes == NULL)
+            {
+                return RUM_ERR_TAG;
+            }
+        }
+        int error = scan_annotations(scan, bytes, length, &annotation);
+        if (error != RUM_OK)
+        {
+            return error;
+        }
+    }
+    return cursor->overflow ? RUM_ERR_TRUNCATED : RUM_OK;
+}
+
+static int scan_members(struct scan_t *scan, struct cursor_t *cursor, int target)
+{
+    unsigned short count = read_u2(cursor);
+    for (unsigned short i = 0; i < count && !cursor->overflow; i++)
+    {
+        read_u2(cursor); // access flags
+        unsigned short name = read_u2(cursor);
+        unsigned short descriptor = read_u2(cursor);
+        int error = scan_attributes(scan, cursor, target, name, descriptor);
+        if (error != RUM_OK)
+        {
+            return error;
+        }
+    }
+    return cursor->overflow ? RUM_ERR_TRUNCATED : RUM_OK;
+}
+
+int rum_annotations_scan(const struct rum_pool_t *pool, int (*found)(void *user, const struct rum_annotation_t *annotation), void *user)
+{
+    // without the attribute name in the pool nothing in the class can be annotated, which is the
+    // answer for most classes
+    int named = 0;
+    for (unsigned short i = rum_pool_next(pool, CONSTANT_Utf8, 1); i != 0 && !named; i = rum_pool_next(pool, CONSTANT_Utf8, (unsigned short)(i + 1)))
+    {
+        named = is_runtime_visible(pool, i);
+    }
+    if (!named)
+    {
+        return RUM_OK;
+    }
+
+    struct cursor_t cursor = {
+        .data = pool->data,
+        .length = pool->length,
+        .offset = pool->end,
+        .overflow = 0};
+    struct scan_t scan = {pool, found, user};
+    read_bytes(&cursor, 6); // access flags, this and super
+    read_bytes(&cursor, (size_t)read_u2(&cursor) * 2);
+    if (cursor.overflow)
+    {
+        return RUM_ERR_TRUNCATED;
+    }
+    int error = scan_members(&scan, &cursor, RUM_ANNOTATED_FIELD);
+    if (error == RUM_OK)
+    {
+        error = scan_members(&scan, &cursor, RUM_ANNOTATED_METHOD);
+    }
+    return error == RUM_OK ? scan_attributes(&scan, &cursor, RUM_ANNOTATED_CLASS, 0, 0) : error;
+}
+
+// the file is this header, the slots, the types, their targets and then the strings
+struct annotations_header_t
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t type_count;
+    uint32_t slot_count;
+    uint32_t target_count;
+    uint32_t reserved;
+    uint64_t strings_size;
+};
+
+struct annotations_type_t
+{
+    uint64_t hash;
+    uint32_t name; // internal form, "javax/inject/Singleton"
+    uint32_t length;
+    uint32_t first; // targets[first] to targets[first + count - 1]
+    uint32_t count;
+};
+
+// a member's name and descriptor are one string, split at `name_length`
+struct annotations_target_t
+{
+    uint32_t class;
+    uint32_t member;
+    uint16_t class_length;
+    uint16_t name_length;
+    uint16_t descriptor_length;
+    uint16_t target; // RUM_ANNOTATED_*
+};
+
+// an annotation as a worker found it, names are ids in the worker's own table
+struct found_t
+{
+    uint32_t type;
+    uint32_t class;
+    uint32_t member;
+    uint16_t name_length;
+    uint16_t target;
+    uint32_t entry;    // classpath entry, which keeps the index in classpath order
+    uint32_t sequence; // and the class file's order within it
+};
+
+struct annotations_worker_t
+{
+    struct rum_pool_t pool;
+    struct rum_loader_t loader;
+    struct rum_names_t names;
+    struct found_t *found;
+    size_t found_count;
+    size_t found_capacity;
+    uint32_t class; // of the class being scanned, interned with its first kept annotation
+    const char *class_name;
+    size_t class_length;
+    uint32_t entry;
+    uint32_t sequence;
+    char *member; // name and descriptor of an annotated member, put together to be interned
+    int error;
+};
+
+struct annotations_build_t
+{
+    const struct rum_classpath_t *classpath;
+    const struct rum_names_t *query; // NULL to keep every type
+    struct annotations_worker_t *workers;
+};
+
+struct scan_job_t
+{
+    struct annotations_build_t *build;
+    struct annotations_worker_t *worker;
+};
+
+// "Lcom/example/Entity;" as "com/example/Entity", anything malformed is kept as it is
+static void type_name(const struct rum_name_t *type, const char **name, size_t *length)
+{
+    *name = (const char *)type->bytes;
+    *length = type->length;
+    if (*length >= 3 && type->bytes[0] == 'L' && type->bytes[*length - 1] == ';')
+    {
+        *name += 1;
+        *length -= 2;
+    }
+}
+
+static int keep_annotation(void *user, const struct rum_annotation_t *annotation)
+{
+    struct scan_job_t *job = user;
+    struct annotations_worker_t *worker = job->worker;
+    const char *name;
+    size_t length;
+    type_name(&annotation->type, &name, &length);
+    if (job->build->query != NULL && rum_names_find(job->build->query, name, length) == RUM_HIERARCHY_NONE)
+    {
+        return 0;
+    }
+    if (worker->found_count == worker->found_capacity)
+    {
+        size_t capacity = worker->found_capacity == 0 ? 1024 : worker->found_capacity * 2;
+        struct found_t *found = realloc(worker->found, sizeof(struct found_t) * capacity);
+        if (found == NULL)
+        {
+            worker->error = RUM_ERR_NOMEM;
+            return 1;
+        }
+        worker->found = found;
+        worker->found_capacity = capacity;
+    }
+
+    if (worker->class == RUM_HIERARCHY_NONE &&
+        (worker->class = rum_names_add(&worker->names, worker->class_name, worker->class_length)) == RUM_HIERARCHY_NONE)
+    {
+        worker->error = RUM_ERR_NOMEM;
+        return 1;
+    }
+
+    struct found_t *found = &worker->found[worker->found_count];
+    found->type = rum_names_add(&worker->names, name, length);
+    found->class = worker->class;
+    found->member = RUM_HIERARCHY_NONE;
+    found->name_length = annotation->name.length;
+    found->target = (uint16_t)annotation->target;
+    found->entry = worker->entry;
+    found->sequence = worker->sequence++;
+    if (annotation->target != RUM_ANNOTATED_CLASS)
+    {
+        // the descriptor goes right after the name, both are at most 65535 bytes
+        if (worker->member == NULL && (worker->member = malloc(2 * 65535)) == NULL)
+        {
+            worker->error = RUM_ERR_NOMEM;
+            return 1;
+        }
+        memcpy(worker->member, annotation->name.bytes, annotation->name.length);
+        memcpy(worker->member + annotation->name.length, annotation->descriptor.bytes, annotation->descriptor.length);
+        found->member = rum_names_add(&worker->names, worker->member, (size_t)annotation->name.length + annotation->descriptor.length);
+        if (found->member == RUM_HIERARCHY_NONE)
+        {
+            found->type = RUM_HIERARCHY_NONE;
+        }
+    }
+    if (found->type == RUM_HIERARCHY_NONE)
+    {
+        worker->error = RUM_ERR_NOMEM;
+        return 1;
+    }
+    worker->found_count++;
+    return 0;
+}
+
+// only the pool is decoded, and only classes naming RuntimeVisibleAnnotations go past it.
+// Classes that can't be read are left out, as with the other indices
+static void annotations_job(void *user, size_t index, int id)
+{
+    struct annotations_build_t *build = user;
+    struct annotations_worker_t *worker = &build->workers[id];
+    const uint8_t *data;
+    size_t length;
+    struct rum_pool_t *pool = &worker->pool;
+    if (worker->error != RUM_OK || rum_classpath_load(build->classpath, index, &worker->loader, &data, &length) != RUM_OK ||
+        rum_pool_parse(pool, data, length) != RUM_OK || pool->end + 4 > length)
+    {
+        return;
+    }
+    unsigned short this_class = (unsigned short)(data[pool->end + 2] << 8 | data[pool->end + 3]);
+    unsigned short this_length;
+    const uint8_t *this_name = this_class == 0 || this_class >= pool->count || pool->tags[this_class] != CONSTANT_Class
+                                   ? NULL
+                                   : rum_pool_utf8(pool, (unsigned short)pool->values[this_class], &this_length);
+    if (this_name == NULL)
+    {
+        return;
+    }
+    // most classes keep no annotation at all, so their name is only interned once one does
+    worker->class = RUM_HIERARCHY_NONE;
+    worker->class_name = (const char *)this_name;
+    worker->class_length = this_length;
+    worker->entry = (uint32_t)index;
+    worker->sequence = 0;
+
+    // a class that turns out to be malformed past what was kept keeps none of it
+    size_t kept = worker->found_count;
+    struct scan_job_t job = {build, worker};
+    int error = rum_annotations_scan(pool, keep_annotation, &job);
+    if (error != RUM_OK && worker->error == RUM_OK)
+    {
+        worker->found_count = kept;
+    }
+}
+
+static int compare_found(const void *a, const void *b)
+{
+    const struct found_t *x = a, *y = b;
+    if (x->entry != y->entry)
+    {
+        return x->entry < y->entry ? -1 : 1;
+    }
+    return (x->sequence > y->sequence) - (x->sequence < y->sequence);
+}
+
+struct annotations_output_t
+{
+    const struct annotations_header_t *header;
+    const uint32_t *slots;
+    const struct annotations_type_t *types;
+    const struct annotations_target_t *targets;
+    const char *strings;
+};
+
+static int write_annotations(void *user, FILE *file)
+{
+    const struct annotations_output_t *output = user;
+    const struct annotations_header_t *header = output->header;
+    int written = fwrite(header, sizeof(*header), 1, file) == 1 &&
+                  fwrite(output->slots, sizeof(uint32_t), header->slot_count, file) == header->slot_count &&
+                  fwrite(output->types, sizeof(struct annotations_type_t), header->type_count, file) == header->type_count &&
+                  fwrite(output->targets, sizeof(struct annotations_target_t), header->target_count, file) == header->target_count &&
+                  (header->strings_size == 0 || fwrite(output->strings, 1, header->strings_size, file) == header->strings_size);
+    return written ? RUM_OK : RUM_ERR_IO;
+}
+
+// merges the workers' names, groups the annotations by type and writes the index
+static int merge(struct annotations_build_t *build, int threads, const char *path, size_t *type_count, size_t *target_count)
+{
+    struct rum_names_t merged = {0};
+    uint32_t **maps = calloc((size_t)threads, sizeof(uint32_t *));
+    int error = maps == NULL ? RUM_ERR_NOMEM : RUM_OK;
+    size_t found_count = 0;
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        const struct rum_names_t *local = &build->workers[w].names;
+        found_count += build->workers[w].found_count;
+        maps[w] = malloc(sizeof(uint32_t) * ((size_t)local->count + 1));
+        error = maps[w] == NULL ? RUM_ERR_NOMEM : RUM_OK;
+        for (uint32_t n = 0; error == RUM_OK && n < local->count; n++)
+        {
+            maps[w][n] = rum_names_add(&merged, rum_names_get(local, n), local->offsets[n + 1] - local->offsets[n] - 1);
+            error = maps[w][n] == RUM_HIERARCHY_NONE ? RUM_ERR_NOMEM : RUM_OK;
+        }
+    }
+
+    // types get dense ids of their own in order of first appearance, then a counting sort by them
+    uint32_t *type_ids = error == RUM_OK ? malloc(sizeof(uint32_t) * ((size_t)merged.count + 1)) : NULL;
+    struct found_t *sorted = error == RUM_OK ? malloc(sizeof(struct found_t) * (found_count + 1)) : NULL;
+    struct annotations_type_t *types = error == RUM_OK ? calloc((size_t)merged.count + 1, sizeof(struct annotations_type_t)) : NULL;
+    if (error == RUM_OK && (type_ids == NULL || sorted == NULL || types == NULL || found_count >= UINT32_MAX))
+    {
+        error = RUM_ERR_NOMEM;
+    }
+    uint32_t types_count = 0;
+    for (uint32_t n = 0; error == RUM_OK && n < merged.count; n++)
+    {
+        type_ids[n] = RUM_HIERARCHY_NONE;
+    }
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        for (size_t f = 0; f < build->workers[w].found_count; f++)
+        {
+            uint32_t name = maps[w][build->workers[w].found[f].type];
+            if (type_ids[name] == RUM_HIERARCHY_NONE)
+            {
+                type_ids[name] = types_count;
+                types[types_count].name = merged.offsets[name];
+                types[types_count].length = merged.offsets[name + 1] - merged.offsets[name] - 1;
+                types_count++;
+            }
+            types[type_ids[name]].count++;
+        }
+    }
+    for (uint32_t t = 0, first = 0; error == RUM_OK && t < types_count; first += types[t++].count)
+    {
+        types[t].first = first;
+    }
+    uint32_t *next = error == RUM_OK ? calloc((size_t)types_count + 1, sizeof(uint32_t)) : NULL;
+    if (error == RUM_OK && next == NULL)
+    {
+        error = RUM_ERR_NOMEM;
+    }
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        for (size_t f = 0; f < build->workers[w].found_count; f++)
+        {
+            struct found_t found = build->workers[w].found[f];
+            uint32_t type = type_ids[maps[w][found.type]];
+            found.class = maps[w][found.class];
+            found.member = found.member == RUM_HIERARCHY_NONE ? RUM_HIERARCHY_NONE : maps[w][found.member];
+            sorted[types[type].first + next[type]++] = found;
+        }
+    }
+
+    // workers take classes in any order, the targets of a type are put back in classpath order
+    struct annotations_target_t *targets = error == RUM_OK ? malloc(sizeof(struct annotations_target_t) * (found_count + 1)) : NULL;
+    uint32_t slot_count = 1;
+    while (error == RUM_OK && slot_count < types_count * 2 + 2)
+    {
+        slot_count *= 2;
+    }
+    uint32_t *slots = error == RUM_OK ? calloc(slot_count, sizeof(uint32_t)) : NULL;
+    if (error == RUM_OK && (targets == NULL || slots == NULL))
+    {
+        error = RUM_ERR_NOMEM;
+    }
+    for (uint32_t t = 0; error == RUM_OK && t < types_count; t++)
+    {
+        struct annotations_type_t *type = &types[t];
+        qsort(sorted + type->first, type->count, sizeof(struct found_t), compare_found);
+        for (uint32_t f = type->first; f < type->first + type->count; f++)
+        {
+            struct annotations_target_t *target = &targets[f];
+            uint32_t member = sorted[f].member;
+            target->class = merged.offsets[sorted[f].class];
+            target->class_length = (uint16_t)(merged.offsets[sorted[f].class + 1] - target->class - 1);
+            target->member = member == RUM_HIERARCHY_NONE ? 0 : merged.offsets[member];
+            target->name_length = member == RUM_HIERARCHY_NONE ? 0 : sorted[f].name_length;
+            target->descriptor_length = member == RUM_HIERARCHY_NONE ? 0 : (uint16_t)(merged.offsets[member + 1] - target->member - 1 - target->name_length);
+            target->target = sorted[f].target;
+        }
+        type->hash = rum_hash_bytes((const uint8_t *)merged.strings + type->name, type->length, ANNOTATIONS_SEED);
+        uint32_t slot = (uint32_t)type->hash & (slot_count - 1);
+        while (slots[slot] != 0)
+        {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+        slots[slot] = t + 1;
+    }
+
+    if (error == RUM_OK)
+    {
+        struct annotations_header_t header = {
+            .magic = ANNOTATIONS_MAGIC,
+            .version = ANNOTATIONS_VERSION,
+            .type_count = types_count,
+            .slot_count = slot_count,
+            .target_count = (uint32_t)found_count,
+            .strings_size = merged.strings_size};
+        struct annotations_output_t output = {&header, slots, types, targets, merged.strings};
+        error = rum_write_atomic(path, write_annotations, &output);
+        *type_count = types_count;
+        *target_count = found_count;
+    }
+    for (int w = 0; maps != NULL && w < threads; w++)
+    {
+        free(maps[w]);
+    }
+    free(maps);
+    free(type_ids);
+    free(sorted);
+    free(types);
+    free(next);
+    free(targets);
+    free(slots);
+    rum_names_free(&merged);
+    return error;
+}
+
+int rum_annotations_build(const struct rum_classpath_t *classpath, int threads, const char *const *types, size_t types_count, const char *path, size_t *type_count, size_t *target_count)
+{
+    *type_count = 0;
+    *target_count = 0;
+    struct rum_names_t query = {0};
+    struct annotations_build_t build = {
+        .classpath = classpath,
+        .query = types_count > 0 ? &query : NULL,
+        .workers = calloc((size_t)threads, sizeof(struct annotations_worker_t))};
+    int error = build.workers == NULL ? RUM_ERR_NOMEM : RUM_OK;
+    for (size_t i = 0; error == RUM_OK && i < types_count; i++)
+    {
+        error = rum_names_add(&query, types[i], strlen(types[i])) == RUM_HIERARCHY_NONE ? RUM_ERR_NOMEM : RUM_OK;
+    }
+    if (error == RUM_OK)
+    {
+        error = rum_parallel_for(classpath->count, threads, annotations_job, &build);
+    }
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        error = build.workers[w].error;
+    }
+    if (error == RUM_OK)
+    {
+        error = merge(&build, threads, path, type_count, target_count);
+    }
+
+    for (int w = 0; build.workers != NULL && w < threads; w++)
+    {
+        rum_pool_release(&build.workers[w].pool);
+        rum_loader_release(&build.workers[w].loader);
+        rum_names_free(&build.workers[w].names);
+        free(build.workers[w].found);
+        free(build.workers[w].member);
+    }
+    free(build.workers);
+    rum_names_free(&query);
+    return error;
+}
+
+int rum_annotations_open(struct rum_annotations_t *annotations, const char *path)
+{
+    memset(annotations, 0, sizeof(struct rum_annotations_t));
+    int error = rum_map_file(path, &annotations->data, &annotations->length);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+
+    struct annotations_header_t header;
+    uint64_t size = 0;
+    if (annotations->length >= sizeof(header))
+    {
+        memcpy(&header, annotations->data, sizeof(header));
+        size = sizeof(header) + (uint64_t)header.slot_count * sizeof(uint32_t) + (uint64_t)header.type_count * sizeof(struct annotations_type_t) +
+               (uint64_t)header.target_count * sizeof(struct annotations_target_t);
+    }
+    if (annotations->length < sizeof(header) || header.magic != ANNOTATIONS_MAGIC || header.version != ANNOTATIONS_VERSION ||
+        header.slot_count == 0 || (header.slot_count & (header.slot_count - 1)) != 0 || header.type_count >= header.slot_count ||
+        size > annotations->length || header.strings_size != annotations->length - size)
+    {
+        rum_annotations_close(annotations);
+        return RUM_ERR_ARCHIVE;
+    }
+    annotations->type_count = header.type_count;
+    annotations->target_count = header.target_count;
+    annotations->slot_count = header.slot_count;
+    annotations->slots = annotations->data + sizeof(header);
+    annotations->types = annotations->slots + (size_t)header.slot_count * sizeof(uint32_t);
+    annotations->targets = annotations->types + (size_t)header.type_count * sizeof(struct annotations_type_t);
+    annotations->strings = (const char *)annotations->targets + (size_t)header.target_count * sizeof(struct annotations_target_t);
+    annotations->strings_size = header.strings_size;
+    return RUM_OK;
+}
+
+void rum_annotations_close(struct rum_annotations_t *annotations)
+{
+    if (annotations->data != NULL)
+    {
+        rum_unmap_file(annotations->data, annotations->length);
+    }
+    memset(annotations, 0, sizeof(struct rum_annotations_t));
+}
+
+size_t rum_annotations_find(const struct rum_annotations_t *annotations, const char *type, size_t length, int (*found)(void *user, const struct rum_annotated_t *annotated), void *user)
+{
+    uint64_t hash = rum_hash_bytes((const uint8_t *)type, length, ANNOTATIONS_SEED);
+    uint32_t mask = annotations->slot_count - 1;
+    for (uint32_t slot = (uint32_t)hash & mask, probes = 0; probes < annotations->slot_count; slot = (slot + 1) & mask, probes++)
+    {
+        uint32_t index;
+        memcpy(&index, annotations->slots + (size_t)slot * sizeof(uint32_t), sizeof(index));
+        if (index == 0 || index > annotations->type_count)
+        {
+            return 0;
+        }
+        struct annotations_type_t record;
+        memcpy(&record, annotations->types + (size_t)(index - 1) * sizeof(record), sizeof(record));
+        if (record.hash != hash || record.length != length || (uint64_t)record.name + record.length > annotations->strings_size ||
+            memcmp(annotations->strings + record.name, type, length) != 0)
+        {
+            continue;
+        }
+
+        size_t reported = 0;
+        for (uint64_t t = record.first; t < (uint64_t)record.first + record.count && t < annotations->target_count; t++)
+        {
+            struct annotations_target_t target;
+            memcpy(&target, annotations->targets + (size_t)t * sizeof(target), sizeof(target));
+            if ((uint64_t)target.class + target.class_length > annotations->strings_size ||
+                (uint64_t)target.member + target.name_length + target.descriptor_length > annotations->strings_size)
+            {
+                break;
+            }
+            struct rum_annotated_t annotated = {
+                .target = target.target,
+                .class = annotations->strings + target.class,
+                .class_length = target.class_length,
+                .name = annotations->strings + target.member,
+                .name_length = target.name_length,
+                .descriptor = annotations->strings + target.member + target.name_length,
+                .descriptor_length = target.descriptor_length};
+            reported++;
+            if (found(user, &annotated) != 0)
+            {
+                break;
+            }
+        }
+        return reported;
+    }
+    return 0;
+}
@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "rum.h"
+
+int rum_cpu_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count < 1 ? 1 : (int)count;
+}
+
+int rum_ends_with(const char *str, const char *suffix)
+{
+    size_t length = strlen(str), suffix_length = strlen(suffix);
+    return length >= suffix_length && strcmp(str + length - suffix_length, suffix) == 0;
+}
+
+static int paths_push(struct rum_paths_t *paths, const char *path)
+{
+    if (paths->count == paths->capacity)
+    {
+        size_t capacity = paths->capacity == 0 ? 64 : paths->capacity * 2;
+        char **grown = realloc(paths->paths, sizeof(char *) * capacity);
+        if (grown == NULL)
+        {
+            return RUM_ERR_NOMEM;
+        }
+        paths->paths = grown;
+        paths->capacity = capacity;
+    }
+    paths->paths[paths->count] = strdup(path);
+    if (paths->paths[paths->count] == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    paths->count++;
+    return RUM_OK;
+}
+
+static int compare_names(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// directory entries are visited in sorted order so the same tree always yields the same list
+static int collect_directory(struct rum_paths_t *paths, const char *directory)
+{
+    DIR *dir = opendir(directory);
+    if (dir == NULL)
+    {
+        return RUM_ERR_IO;
+    }
+
+    struct rum_paths_t names = {0};
+    int error = RUM_OK;
+    struct dirent *entry;
+    while (error == RUM_OK && (entry = readdir(dir)) != NULL)
+    {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+        {
+            error = paths_push(&names, entry->d_name);
+        }
+    }
+    closedir(dir);
+    if (names.count > 0)
+    {
+        qsort(names.paths, names.count, sizeof(char *), compare_names);
+    }
+
+    for (size_t i = 0; error == RUM_OK && i < names.count; i++)
+    {
+        size_t size = strlen(directory) + strlen(names.paths[i]) + 2;
+        char *path = malloc(size);
+        if (path == NULL)
+        {
+            error = RUM_ERR_NOMEM;
+            break;
+        }
+        snprintf(path, size, "%s/%s", directory, names.paths[i]);
+
+        struct stat st;
+        if (stat(path, &st) == 0 && S_ISDIR(st.st_mode))
+        {
+            error = collect_directory(paths, path);
+        }
+        else if (rum_ends_with(path, ".class") || rum_ends_with(path, ".jar"))
+        {
+            error = paths_push(paths, path);
+        }
+        free(path);
+    }
+    rum_paths_free(&names);
+    return error;
+}
+
+int rum_collect_paths(struct rum_paths_t *paths, char **inputs, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        struct stat st;
+        int error = stat(inputs[i], &st) == 0 && S_ISDIR(st.st_mode)
+                        ? collect_directory(paths, inputs[i])
+                        : paths_push(paths, inputs[i]); // named files are taken as they are
+        if (error != RUM_OK)
+        {
+            return error;
+        }
+    }
+    return RUM_OK;
+}
+
+void rum_paths_free(struct rum_paths_t *paths)
+{
+    for (size_t i = 0; i < paths->count; i++)
+    {
+        free(paths->paths[i]);
+    }
+    free(paths->paths);
+    memset(paths, 0, sizeof(struct rum_paths_t));
+}
+
+// range of job indices owned by one worker, the owner takes from `head` and thieves from `tail`
+struct deque_t
+{
+    pthread_mutex_t lock;
+    size_t head;
+    size_t tail;
+};
+
+struct pool_t
+{
+    struct deque_t *deques;
+    int threads;
+    void (*job)(void *user, size_t index, int worker);
+    void *user;
+};
+
+struct worker_t
+{
+    struct pool_t *pool;
+    int id;
+};
+
+static int deque_pop(struct deque_t *deque, size_t *index)
+{
+    pthread_mutex_lock(&deque->lock);
+    int found = deque->head < deque->tail;
+    if (found)
+    {
+        *index = deque->head++;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+// moves the back half of a victim's range into the thief's own deque
+static int deque_steal(struct pool_t *pool, int thief)
+{
+    for (int i = 1; i < pool->threads; i++)
+    {
+        struct deque_t *victim = &pool->deques[(thief + i) % pool->threads];
+        pthread_mutex_lock(&victim->lock);
+        size_t remaining = victim->tail - victim->head;
+        if (remaining == 0)
+        {
+            pthread_mutex_unlock(&victim->lock);
+            continue;
+        }
+        size_t taken = (remaining + 1) / 2;
+        size_t start = victim->tail - taken;
+        victim->tail = start;
+        pthread_mutex_unlock(&victim->lock);
+
+        struct deque_t *own = &pool->deques[thief];
+        pthread_mutex_lock(&own->lock);
+        own->head = start;
+        own->tail = start + taken;
+        pthread_mutex_unlock(&own->lock);
+        return 1;
+    }
+    return 0;
+}
+
+static void *worker_main(void *arg)
+{
+    struct worker_t *worker = arg;
+    struct pool_t *pool = worker->pool;
+    for (;;)
+    {
+        size_t index;
+        if (deque_pop(&pool->deques[worker->id], &index))
+        {
+            pool->job(pool->user, index, worker->id);
+        }
+        else if (!deque_steal(pool, worker->id))
+        {
+            // nothing left anywhere, jobs never add more work
+            return NULL;
+        }
+    }
+}
+
+int rum_parallel_for(size_t count, int threads, void (*job)(void *user, size_t index, int worker), void *user)
+{
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+    if ((size_t)threads > count)
+    {
+        threads = count == 0 ? 1 : (int)count;
+    }
+
+    struct pool_t pool = {
+        .deques = calloc((size_t)threads, sizeof(struct deque_t)),
+        .threads = threads,
+        .job = job,
+        .user = user};
+    pthread_t *handles = calloc((size_t)threads, sizeof(pthread_t));
+    struct worker_t *workers = calloc((size_t)threads, sizeof(struct worker_t));
+    if (pool.deques == NULL || handles == NULL || workers == NULL)
+    {
+        free(pool.deques);
+        free(handles);
+        free(workers);
+        return RUM_ERR_NOMEM;
+    }
+
+    // each worker starts on a contiguous slice, so output mostly completes in order
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_mutex_init(&pool.deques[i].lock, NULL);
+        pool.deques[i].head = count * (size_t)i / (size_t)threads;
+        pool.deques[i].tail = count * (size_t)(i + 1) / (size_t)threads;
+        workers[i].pool = &pool;
+        workers[i].id = i;
+    }
+
+    int started = 1;
+    for (int i = 1; i < threads; i++, started++)
+    {
+        if (pthread_create(&handles[i], NULL, worker_main, &workers[i]) != 0)
+        {
+            break;
+        }
+    }
+    // the calling thread is worker 0, anything a missing thread owned gets stolen
+    worker_main(&workers[0]);
+    for (int i = 1; i < started; i++)
+    {
+        pthread_join(handles[i], NULL);
+    }
+
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_mutex_destroy(&pool.deques[i].lock);
+    }
+    free(pool.deques);
+    free(handles);
+    free(workers);
+    return RUM_OK;
+}
+
+int rum_ordered_init(struct rum_ordered_t *ordered, size_t count, FILE *out)
+{
+    memset(ordered, 0, sizeof(struct rum_ordered_t));
+    ordered->slots = calloc(count == 0 ? 1 : count, sizeof(struct rum_ordered_slot_t));
+    if (ordered->slots == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    ordered->count = count;
+    ordered->out = out;
+    pthread_mutex_init(&ordered->lock, NULL);
+    return RUM_OK;
+}
+
+// hands over the output of job `index` and writes every finished job that is next in line
+void rum_ordered_submit(struct rum_ordered_t *ordered, size_t index, char *text, size_t length)
+{
+    pthread_mutex_lock(&ordered->lock);
+    ordered->slots[index].text = text;
+    ordered->slots[index].length = length;
+    ordered->slots[index].done = 1;
+    while (ordered->next < ordered->count && ordered->slots[ordered->next].done)
+    {
+        struct rum_ordered_slot_t *slot = &ordered->slots[ordered->next];
+        if (slot->text != NULL)
+        {
+            fwrite(slot->text, 1, slot->length, ordered->out);
+            free(slot->text);
+            slot->text = NULL;
+        }
+        ordered->next++;
+    }
+    pthread_mutex_unlock(&ordered->lock);
+}
+
+void rum_ordered_free(struct rum_ordered_t *ordered)
+{
+    for (size_t i = 0; i < ordered->count; i++)
+    {
+        free(ordered->slots[i].text);
+    }
+    free(ordered->slots);
+    pthread_mutex_destroy(&ordered->lock);
+}
@@ -0,0 +1,610 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "rum.h"
+
+#define BENCH_PHASES 7
+
+// a class file being generated, big-endian like the format
+struct buffer_t
+{
+    uint8_t *data;
+    size_t length;
+    size_t capacity;
+    int failed;
+};
+
+struct profile_t
+{
+    char name[64];
+    uint8_t *data;
+    size_t length;
+    int mapped;
+    int code; // whether the code and cfg phases have any methods to work on
+    double mb_per_s[BENCH_PHASES]; // the whole file's size times classes/s, even for phases that skip most of it
+    double classes_per_s[BENCH_PHASES];
+};
+
+static const char *phases[BENCH_PHASES] = {"parse", "visit", "print", "pool", "summary", "code", "cfg"};
+
+static void put_bytes(struct buffer_t *buffer, const void *bytes, size_t length)
+{
+    if (buffer->length + length > buffer->capacity)
+    {
+        size_t capacity = buffer->capacity == 0 ? 65536 : buffer->capacity;
+        while (capacity < buffer->length + length)
+        {
+            capacity *= 2;
+        }
+        uint8_t *grown = realloc(buffer->data, capacity);
+        if (grown == NULL)
+        {
+            buffer->failed = 1;
+            return;
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->length, bytes, length);
+    buffer->length += length;
+}
+
+static void put_u1(struct buffer_t *buffer, uint8_t value)
+{
+    put_bytes(buffer, &value, 1);
+}
+
+static void put_u2(struct buffer_t *buffer, uint16_t value)
+{
+    uint8_t bytes[2] = {value >> 8, value & 0xff};
+    put_bytes(buffer, bytes, 2);
+}
+
+static void put_u4(struct buffer_t *buffer, uint32_t value)
+{
+    uint8_t bytes[4] = {value >> 24, (value >> 16) & 0xff, (value >> 8) & 0xff, value & 0xff};
+    put_bytes(buffer, bytes, 4);
+}
+
+static void put_utf8(struct buffer_t *buffer, const char *text)
+{
+    put_u1(buffer, CONSTANT_Utf8);
+    put_u2(buffer, (uint16_t)strlen(text));
+    put_bytes(buffer, text, strlen(text));
+}
+
+// entries 1 to 6 of every generated pool, the rest is up to the profile
+#define POOL_THIS 2
+#define POOL_SUPER 4
+#define POOL_CODE 5
+#define POOL_DESCRIPTOR 6
+#define POOL_HEADER 7 // first free index
+
+static void put_header(struct buffer_t *buffer, uint16_t constant_pool_count)
+{
+    put_u4(buffer, 0xcafebabe);
+    put_u2(buffer, 0);
+    put_u2(buffer, 61);
+    put_u2(buffer, constant_pool_count);
+    put_utf8(buffer, "bench/Generated");
+    put_u1(buffer, CONSTANT_Class);
+    put_u2(buffer, 1);
+    put_utf8(buffer, "java/lang/Object");
+    put_u1(buffer, CONSTANT_Class);
+    put_u2(buffer, 3);
+    put_utf8(buffer, "Code");
+    put_utf8(buffer, "()V");
+}
+
+static void put_class_info(struct buffer_t *buffer)
+{
+    put_u2(buffer, ACC_PUBLIC | ACC_SUPER);
+    put_u2(buffer, POOL_THIS);
+    put_u2(buffer, POOL_SUPER);
+    put_u2(buffer, 0); // interfaces
+    put_u2(buffer, 0); // fields
+}
+
+// a Code attribute of `code_length` valid bytecode: a counting loop body, padded with nops, then return
+static void put_code(struct buffer_t *buffer, uint32_t code_length)
+{
+    static const uint8_t body[] = {0x03, 0x3c, 0x84, 0x01, 0x01}; // iconst_0, istore_1, iinc 1 1
+    put_u2(buffer, POOL_CODE);
+    put_u4(buffer, 2 + 2 + 4 + code_length + 2 + 2);
+    put_u2(buffer, 1);
+    put_u2(buffer, 2);
+    put_u4(buffer, code_length);
+    uint32_t written = 0;
+    for (; written + sizeof(body) < code_length; written += sizeof(body))
+    {
+        put_bytes(buffer, body, sizeof(body));
+    }
+    for (; written + 1 < code_length; written++)
+    {
+        put_u1(buffer, 0x00);
+    }
+    put_u1(buffer, 0xb1);
+    put_u2(buffer, 0); // exception table
+    put_u2(buffer, 0); // attributes
+}
+
+// `methods` methods named m0, m1, ... each with `code_length` bytes of code
+static void put_methods(struct buffer_t *buffer, uint16_t first_name, uint16_t methods, uint32_t code_length)
+{
+    put_u2(buffer, methods);
+    for (uint16_t i = 0; i < methods; i++)
+    {
+        put_u2(buffer, METHOD_INFO_ACC_PUBLIC | METHOD_INFO_ACC_STATIC);
+        put_u2(buffer, first_name + i);
+        put_u2(buffer, POOL_DESCRIPTOR);
+        put_u2(buffer, 1);
+        put_code(buffer, code_length);
+    }
+    put_u2(buffer, 0); // class attributes
+}
+
+static void put_method_names(struct buffer_t *buffer, uint16_t methods)
+{
+    char name[16];
+    for (uint16_t i = 0; i < methods; i++)
+    {
+        snprintf(name, sizeof(name), "m%u", i);
+        put_utf8(buffer, name);
+    }
+}
+
+// the largest pool there can be, cycling through the single-slot constant kinds
+static void generate_constant_pool(struct buffer_t *buffer)
+{
+    put_header(buffer, 65535);
+    char text[32];
+    for (uint32_t i = POOL_HEADER; i < 65535; i++)
+    {
+        switch (i % 6)
+        {
+        case 0:
+            snprintf(text, sizeof(text), "name%u", i);
+            put_utf8(buffer, text);
+            break;
+        case 1:
+            put_u1(buffer, CONSTANT_Class);
+            put_u2(buffer, 1);
+            break;
+        case 2:
+            put_u1(buffer, CONSTANT_NameAndType);
+            put_u2(buffer, 1);
+            put_u2(buffer, POOL_DESCRIPTOR);
+            break;
+        case 3:
+            put_u1(buffer, CONSTANT_Methodref);
+            put_u2(buffer, POOL_THIS);
+            put_u2(buffer, (uint16_t)(i - 1));
+            break;
+        case 4:
+            put_u1(buffer, CONSTANT_Integer);
+            put_u4(buffer, i);
+            break;
+        default:
+            put_u1(buffer, CONSTANT_String);
+            put_u2(buffer, 1);
+            break;
+        }
+    }
+    put_class_info(buffer);
+    put_methods(buffer, 1, 0, 0);
+}
+
+// a pool that is nothing but Long and Double constants, each taking two slots
+static void generate_long_double(struct buffer_t *buffer)
+{
+    put_header(buffer, 65535);
+    for (uint32_t i = POOL_HEADER; i + 1 < 65535; i += 2)
+    {
+        put_u1(buffer, i % 4 == 1 ? CONSTANT_Long : CONSTANT_Double);
+        put_u4(buffer, i);
+        put_u4(buffer, ~i);
+    }
+    put_class_info(buffer);
+    put_methods(buffer, 1, 0, 0);
+}
+
+// long strings, most of them ASCII and the rest with two-byte, three-byte, NUL and surrogate pair characters
+static void generate_strings(struct buffer_t *buffer)
+{
+    static const char *wide[] = {"\xc3\xa9", "\xe4\xb8\xad", "\xc0\x80", "\xed\xa0\xbd\xed\xb8\x80"};
+    uint16_t strings = 4000;
+    char text[2048];
+    put_header(buffer, POOL_HEADER + strings);
+    for (uint16_t i = 0; i < strings; i++)
+    {
+        size_t length = 0;
+        while (length + 16 < sizeof(text))
+        {
+            const char *piece = i % 4 == 0 && length % 64 == 0 ? wide[(length / 64) % 4] : "abcdefghijklmnop";
+            memcpy(text + length, piece, strlen(piece));
+            length += strlen(piece);
+        }
+        put_u1(buffer, CONSTANT_Utf8);
+        put_u2(buffer, (uint16_t)length);
+        put_bytes(buffer, text, length);
+    }
+    put_class_info(buffer);
+    put_methods(buffer, 1, 0, 0);
+}
+
+static void generate_methods(struct buffer_t *buffer)
+{
+    uint16_t methods = 8000;
+    put_header(buffer, POOL_HEADER + methods);
+    put_method_names(buffer, methods);
+    put_class_info(buffer);
+    put_methods(buffer, POOL_HEADER, methods, 64);
+}
+
+// code_length is capped at 65535 by the JVM, so big classes are many big methods
+static void generate_huge_code(struct buffer_t *buffer)
+{
+    uint16_t methods = 256;
+    put_header(buffer, POOL_HEADER + methods);
+    put_method_names(buffer, methods);
+    put_class_info(buffer);
+    put_methods(buffer, POOL_HEADER, methods, 65535);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// decodes the Code attribute of every method and walks its instructions, or builds its
+// control-flow graph when there is a `cfg` to build it in
+static int decode_methods(const struct class_t *class, struct rum_cfg_t *cfg, volatile uint32_t *checksum)
+{
+    for (unsigned short m = 0; m < class->methods_count; m++)
+    {
+        const struct method_info_t *method = &class->methods[m];
+        const struct attribute_info_t *attribute = rum_find_attribute(class, method->attributes, method->attributes_count, "Code");
+        struct rum_code_t code;
+        if (attribute == NULL)
+        {
+            continue;
+        }
+        int error = rum_code_decode(class->data, attribute, &code);
+        if (error != RUM_OK)
+        {
+            return error;
+        }
+        if (cfg != NULL)
+        {
+            error = rum_cfg_build(cfg, &code);
+            *checksum += cfg->block_count + cfg->loop_count;
+            if (error != RUM_OK)
+            {
+                return error;
+            }
+            continue;
+        }
+        struct rum_insn_iter_t iter;
+        struct rum_insn_t insn;
+        rum_insn_begin(&iter, &code);
+        while (rum_insn_next(&iter, &insn))
+        {
+            *checksum += insn.opcode;
+        }
+        if (iter.error != RUM_OK)
+        {
+            return iter.error;
+        }
+    }
+    return RUM_OK;
+}
+
+// runs one phase over and over for at least `seconds`, returns the iterations per second
+static double run_phase(int phase, struct profile_t *profile, struct class_t *class, struct rum_pool_t *pool, struct rum_cfg_t *cfg, FILE *sink,
+                        double seconds)
+{
+    struct rum_visitor_t visitor = {0};
+    struct rum_summary_t summary;
+    size_t iterations = 0;
+    volatile uint32_t checksum = 0; // keeps the scan from being optimized out
+    double start = now(), elapsed;
+    do
+    {
+        int error = RUM_OK;
+        if (phase == 0 || phase == 2)
+        {
+            error = rum_class_parse_buffer(class, profile->data, profile->length);
+        }
+        if (phase == 1)
+        {
+            error = rum_visit_buffer(profile->data, profile->length, &visitor);
+        }
+        if (phase == 3)
+        {
+            // the structure-of-arrays pool, and a tag-filtered scan over it
+            error = rum_pool_parse(pool, profile->data, profile->length);
+            for (unsigned short i = 1; error == RUM_OK && (i = rum_pool_next(pool, CONSTANT_Methodref, i)) != 0; i++)
+            {
+                checksum += pool->values[i];
+            }
+        }
+        if (phase == 4)
+        {
+            error = rum_summarize(profile->data, profile->length, &summary);
+        }
+        if (phase == 5)
+        {
+            // every instruction of every method, on the class the parse phase left behind
+            error = decode_methods(class, NULL, &checksum);
+        }
+        if (phase == 6)
+        {
+            error = decode_methods(class, cfg, &checksum);
+        }
+        if (error == RUM_OK && phase == 2)
+        {
+            error = rum_pretty_print(sink, class);
+        }
+        if (error != RUM_OK)
+        {
+            fprintf(stderr, "[-] couldn't parse '%s' : %s\n", profile->name, rum_strerror(error));
+            return 0;
+        }
+        iterations++;
+        elapsed = now() - start;
+    } while (elapsed < seconds || iterations < 3);
+
+    // printing includes its parse, take the parse time back out
+    double rate = (double)iterations / elapsed;
+    if (phase == 2 && profile->classes_per_s[0] > 0)
+    {
+        double print = 1 / rate - 1 / profile->classes_per_s[0];
+        rate = print > 0 ? 1 / print : rate;
+    }
+    return rate;
+}
+
+static int write_profile(const char *directory, const struct profile_t *profile)
+{
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s.class", directory, profile->name);
+    FILE *file = fopen(path, "wb");
+    if (file == NULL || fwrite(profile->data, 1, profile->length, file) != profile->length)
+    {
+        fprintf(stderr, "[-] couldn't write '%s'\n", path);
+        if (file != NULL)
+        {
+            fclose(file);
+        }
+        return RUM_ERR_IO;
+    }
+    fclose(file);
+    return RUM_OK;
+}
+
+// "profile phase file_mb_per_s classes_per_s" per line, 0 when the baseline has no such entry
+static double baseline_rate(const char *path, const char *profile, const char *phase)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return 0;
+    }
+    char line[256], name[64], kind[16];
+    double mb_per_s, classes_per_s, found = 0;
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (line[0] != '#' && sscanf(line, "%63s %15s %lf %lf", name, kind, &mb_per_s, &classes_per_s) == 4 &&
+            strcmp(name, profile) == 0 && strcmp(kind, phase) == 0)
+        {
+            found = classes_per_s;
+        }
+    }
+    fclose(file);
+    return found;
+}
+
+static void usage(const char *program)
+{
+    printf("usage : %s [--seconds s] [--baseline file] [--save file] [--tolerance percent] [--write directory] [class file]...\n", program);
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = 0.5, tolerance = 25;
+    const char *baseline = NULL, *save = NULL, *directory = NULL;
+    int first = 1;
+    for (; first < argc && argv[first][0] == '-'; first += 2)
+    {
+        if (first + 1 >= argc)
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        if (strcmp(argv[first], "--seconds") == 0)
+        {
+            seconds = atof(argv[first + 1]);
+        }
+        else if (strcmp(argv[first], "--baseline") == 0)
+        {
+            baseline = argv[first + 1];
+        }
+        else if (strcmp(argv[first], "--save") == 0)
+        {
+            save = argv[first + 1];
+        }
+        else if (strcmp(argv[first], "--tolerance") == 0)
+        {
+            tolerance = atof(argv[first + 1]);
+        }
+        else if (strcmp(argv[first], "--write") == 0)
+        {
+            directory = argv[first + 1];
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // numbers are only compared against a baseline taken on this machine, and asked for by name
+    FILE *compared = baseline == NULL ? NULL : fopen(baseline, "r");
+    if (baseline != NULL && compared == NULL)
+    {
+        fprintf(stderr, "[-] couldn't read baseline '%s'\n", baseline);
+        return EXIT_FAILURE;
+    }
+    if (compared != NULL)
+    {
+        fclose(compared);
+    }
+
+    static const struct
+    {
+        const char *name;
+        void (*generate)(struct buffer_t *buffer);
+        int code;
+    } generators[] = {
+        {"constant_pool", generate_constant_pool, 0},
+        {"long_double", generate_long_double, 0},
+        {"methods", generate_methods, 1},
+        {"huge_code", generate_huge_code, 1},
+        {"strings", generate_strings, 0},
+    };
+    size_t generated = sizeof(generators) / sizeof(generators[0]);
+    size_t count = generated + (size_t)(argc - first);
+    struct profile_t *profiles = calloc(count, sizeof(struct profile_t));
+    if (profiles == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // synthetic stress classes first, then any real class files named on the command line
+    for (size_t i = 0; i < count; i++)
+    {
+        struct profile_t *profile = &profiles[i];
+        if (i < generated)
+        {
+            struct buffer_t buffer = {0};
+            generators[i].generate(&buffer);
+            if (buffer.failed)
+            {
+                fprintf(stderr, "[-] couldn't generate '%s' : %s\n", generators[i].name, rum_strerror(RUM_ERR_NOMEM));
+                return EXIT_FAILURE;
+            }
+            snprintf(profile->name, sizeof(profile->name), "%s", generators[i].name);
+            profile->data = buffer.data;
+            profile->length = buffer.length;
+            profile->code = generators[i].code;
+            continue;
+        }
+        const char *path = argv[first + (int)(i - generated)];
+        const char *base = strrchr(path, '/');
+        snprintf(profile->name, sizeof(profile->name), "%s", base == NULL ? path : base + 1);
+        int error = rum_map_file(path, (const uint8_t **)&profile->data, &profile->length);
+        if (error != RUM_OK)
+        {
+            fprintf(stderr, "[-] couldn't read '%s' : %s\n", path, rum_strerror(error));
+            return EXIT_FAILURE;
+        }
+        profile->mapped = 1;
+        profile->code = 1;
+    }
+
+    struct class_t *class = rum_class_new();
+    struct rum_pool_t pool = {0};
+    struct rum_cfg_t cfg = {0};
+    FILE *sink = fopen("/dev/null", "w");
+    FILE *saved = save == NULL ? NULL : fopen(save, "w");
+    if (class == NULL || sink == NULL || (save != NULL && saved == NULL))
+    {
+        fprintf(stderr, "[-] couldn't set up the benchmark\n");
+        return EXIT_FAILURE;
+    }
+    if (saved != NULL)
+    {
+        fprintf(saved, "# profile phase file_mb_per_s classes_per_s\n");
+    }
+
+    int regressions = 0;
+    printf("%-16s %-7s %10s %12s %12s %10s\n", "profile", "phase", "size", "file MB/s", "classes/s", "baseline");
+    for (size_t i = 0; i < count; i++)
+    {
+        struct profile_t *profile = &profiles[i];
+        if (directory != NULL && i < generated && write_profile(directory, profile) != RUM_OK)
+        {
+            return EXIT_FAILURE;
+        }
+        for (int phase = 0; phase < BENCH_PHASES; phase++)
+        {
+            // a class without methods would only time the loop over them
+            if (phase >= 5 && !profile->code)
+            {
+                continue;
+            }
+            double rate = run_phase(phase, profile, class, &pool, &cfg, sink, seconds);
+            if (rate == 0)
+            {
+                return EXIT_FAILURE;
+            }
+            profile->classes_per_s[phase] = rate;
+            profile->mb_per_s[phase] = rate * (double)profile->length / 1e6;
+
+            // throughput is compared in classes/s, so the same profile can be compared across sizes
+            char compared[32] = "-";
+            double previous = baseline == NULL ? 0 : baseline_rate(baseline, profile->name, phases[phase]);
+            if (previous > 0)
+            {
+                double change = (rate / previous - 1) * 100;
+                int regressed = change < -tolerance;
+                regressions += regressed;
+                snprintf(compared, sizeof(compared), "%+.1f%%%s", change, regressed ? " !" : "");
+            }
+            printf("%-16s %-7s %9.2fM %12.1f %12.1f %10s\n", profile->name, phases[phase], (double)profile->length / 1e6,
+                   profile->mb_per_s[phase], profile->classes_per_s[phase], compared);
+            if (saved != NULL)
+            {
+                fprintf(saved, "%s %s %.1f %.1f\n", profile->name, phases[phase], profile->mb_per_s[phase], profile->classes_per_s[phase]);
+            }
+        }
+    }
+
+    if (saved != NULL)
+    {
+        fclose(saved);
+    }
+    fclose(sink);
+    rum_class_free(class);
+    rum_pool_release(&pool);
+    rum_cfg_free(&cfg);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (profiles[i].mapped)
+        {
+            rum_unmap_file(profiles[i].data, profiles[i].length);
+        }
+        else
+        {
+            free(profiles[i].data);
+        }
+    }
+    free(profiles);
+
+    if (regressions > 0)
+    {
+        printf("[-] %d phase(s) more than %.0f%% slower than %s\n", regressions, tolerance, baseline);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "rum.h"
+
+#define IMAGE_MAGIC 0x434d5552 // "RUMC"
+#define IMAGE_VERSION 1
+// images hold the parser's structs as they are, so they only load into a build with the same layout
+#define IMAGE_LAYOUT ((uint32_t)(sizeof(struct cp_info_t) << 16 | sizeof(struct field_info_t) << 8 | sizeof(struct attribute_info_t)))
+
+// an image is this header, the class's tables and then the class file itself
+struct image_header_t
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t layout;
+    uint32_t reserved;
+    uint64_t hash;   // of the class file
+    uint64_t length; // of the class file
+    uint64_t tables; // size of the tables
+    uint32_t class_magic;
+    unsigned short minor;
+    unsigned short major;
+    unsigned short constant_pool_count;
+    unsigned short access_flags;
+    unsigned short this_class;
+    unsigned short super_class;
+    unsigned short interfaces_count;
+    unsigned short fields_count;
+    unsigned short methods_count;
+    unsigned short attribute_count;
+};
+
+// where each array sits in the tables, the same as the parser lays them out in the arena
+struct layout_t
+{
+    size_t constant_pool;
+    size_t interfaces;
+    size_t fields;
+    size_t methods;
+    size_t attributes; // the class's own, member attributes follow
+    size_t member_attributes;
+    size_t size;
+};
+
+static size_t align(size_t size)
+{
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+static void layout_tables(struct layout_t *layout, const struct image_header_t *header, size_t member_attributes_size)
+{
+    size_t pool = header->constant_pool_count == 0 ? 0 : header->constant_pool_count - 1u;
+    layout->constant_pool = 0;
+    layout->interfaces = align(sizeof(struct cp_info_t) * pool);
+    layout->fields = layout->interfaces + align(sizeof(unsigned short) * header->interfaces_count);
+    layout->methods = layout->fields + align(sizeof(struct field_info_t) * header->fields_count);
+    layout->attributes = layout->methods + align(sizeof(struct method_info_t) * header->methods_count);
+    layout->member_attributes = layout->attributes + align(sizeof(struct attribute_info_t) * header->attribute_count);
+    layout->size = layout->member_attributes + member_attributes_size;
+}
+
+// multiply-xorshift over 8 byte words, to recognise a class file that was moved or touched but not changed
+uint64_t rum_hash_bytes(const uint8_t *data, size_t length, uint64_t hash)
+{
+    hash ^= length * 0x9e3779b97f4a7c15ull;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+        hash ^= hash >> 32;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data + i, length - i);
+    hash = (hash ^ tail) * 0xc4ceb9fe1a85ec53ull;
+    return hash ^ (hash >> 29);
+}
+
+int rum_cache_open(struct rum_cache_t *cache, const char *directory)
+{
+    memset(cache, 0, sizeof(struct rum_cache_t));
+    if (mkdir(directory, 0777) != 0 && errno != EEXIST)
+    {
+        return RUM_ERR_IO;
+    }
+    cache->directory = strdup(directory);
+    return cache->directory == NULL ? RUM_ERR_NOMEM : RUM_OK;
+}
+
+void rum_cache_close(struct rum_cache_t *cache)
+{
+    free(cache->directory);
+    memset(cache, 0, sizeof(struct rum_cache_t));
+}
+
+static int attributes_fit(const struct attribute_info_t *attributes, size_t count, size_t length)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (attributes[i].offset > length || attributes[i].attribute_length > length - attributes[i].offset)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// points a member's attributes back into the tables, from the offset they were stored as
+static int relocate_members(uint8_t *tables, const struct layout_t *layout, struct field_info_t *members, size_t count, size_t length)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        uintptr_t offset = (uintptr_t)members[i].attributes;
+        size_t size = sizeof(struct attribute_info_t) * members[i].attributes_count;
+        if (offset < layout->member_attributes || offset > layout->size || size > layout->size - offset || offset % ARENA_ALIGN != 0)
+        {
+            return 0;
+        }
+        members[i].attributes = (struct attribute_info_t *)(tables + offset);
+        if (!attributes_fit(members[i].attributes, members[i].attributes_count, length))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int rum_class_load_image(struct class_t *class, const char *path, uint64_t hash)
+{
+    const uint8_t *image;
+    size_t image_length;
+    int error = rum_map_file(path, &image, &image_length);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+
+    struct image_header_t header;
+    struct layout_t layout = {0};
+    if (image_length >= sizeof(header))
+    {
+        memcpy(&header, image, sizeof(header));
+        layout_tables(&layout, &header, 0);
+    }
+    if (image_length < sizeof(header) || header.magic != IMAGE_MAGIC || header.version != IMAGE_VERSION ||
+        header.layout != IMAGE_LAYOUT || (hash != 0 && header.hash != hash) || header.tables < layout.size ||
+        header.tables > image_length - sizeof(header) || header.length != image_length - sizeof(header) - header.tables)
+    {
+        rum_unmap_file(image, image_length);
+        return RUM_ERR_CACHE;
+    }
+    layout_tables(&layout, &header, header.tables - layout.member_attributes);
+
+    // the tables are copied into the arena in one go, only the pointers in them are patched up
+    rum_class_clear(class);
+    uint8_t *tables = NULL;
+    if (arena_reserve(&class->arena, align(header.tables)) == RUM_OK)
+    {
+        tables = arena_alloc(&class->arena, header.tables == 0 ? 1 : header.tables);
+    }
+    if (tables == NULL)
+    {
+        rum_unmap_file(image, image_length);
+        return RUM_ERR_NOMEM;
+    }
+    memcpy(tables, image + sizeof(header), header.tables);
+
+    class->magic = header.class_magic;
+    class->minor = header.minor;
+    class->major = header.major;
+    class->constant_pool_count = header.constant_pool_count;
+    class->access_flags = header.access_flags;
+    class->this_class = header.this_class;
+    class->super_class = header.super_class;
+    class->interfaces_count = header.interfaces_count;
+    class->fields_count = header.fields_count;
+    class->methods_count = header.methods_count;
+    class->attribute_count = header.attribute_count;
+    class->constant_pool = (struct cp_info_t *)(tables + layout.constant_pool);
+    class->interfaces = (unsigned short *)(tables + layout.interfaces);
+    class->fields = (struct field_info_t *)(tables + layout.fields);
+    class->methods = (struct method_info_t *)(tables + layout.methods);
+    class->attributes = (struct attribute_info_t *)(tables + layout.attributes);
+    class->data = image + sizeof(header) + header.tables;
+    class->length = header.length;
+    class->image = image;
+    class->image_length = image_length;
+
+    int valid = attributes_fit(class->attributes, class->attribute_count, class->length) &&
+                relocate_members(tables, &layout, class->fields, class->fields_count, class->length) &&
+                relocate_members(tables, &layout, (struct field_info_t *)class->methods, class->methods_count, class->length);
+    for (size_t i = 0; valid && i + 1 < class->constant_pool_count; i++)
+    {
+        struct constant_utf8_t *utf8 = &class->constant_pool[i].constant_utf8;
+        if (class->constant_pool[i].tag == CONSTANT_Utf8)
+        {
+            uintptr_t offset = (uintptr_t)utf8->bytes;
+            valid = offset <= class->length && utf8->length <= class->length - offset;
+            utf8->bytes = valid ? class->data + offset : NULL;
+        }
+    }
+    if (!valid)
+    {
+        rum_class_clear(class);
+        return RUM_ERR_CACHE;
+    }
+    return RUM_OK;
+}
+
+// the tables with every pointer turned into an offset: into the class file for Utf8 bytes, into
+// the tables for attribute arrays
+static uint8_t *build_tables(const struct class_t *class, struct image_header_t *header)
+{
+    size_t member_attributes = 0;
+    for (size_t i = 0; i < class->fields_count; i++)
+    {
+        member_attributes += align(sizeof(struct attribute_info_t) * class->fields[i].attributes_count);
+    }
+    for (size_t i = 0; i < class->methods_count; i++)
+    {
+        member_attributes += align(sizeof(struct attribute_info_t) * class->methods[i].attributes_count);
+    }
+    struct layout_t layout;
+    layout_tables(&layout, header, member_attributes);
+    uint8_t *tables = calloc(1, layout.size == 0 ? 1 : layout.size);
+    if (tables == NULL)
+    {
+        return NULL;
+    }
+    header->tables = layout.size;
+
+    struct cp_info_t *pool = (struct cp_info_t *)(tables + layout.constant_pool);
+    memcpy(pool, class->constant_pool, sizeof(struct cp_info_t) * (class->constant_pool_count - 1u));
+    for (size_t i = 0; i + 1 < class->constant_pool_count; i++)
+    {
+        if (pool[i].tag == CONSTANT_Utf8)
+        {
+            pool[i].constant_utf8.bytes = (const uint8_t *)(uintptr_t)(pool[i].constant_utf8.bytes - class->data);
+        }
+    }
+    memcpy(tables + layout.interfaces, class->interfaces, sizeof(unsigned short) * class->interfaces_count);
+    memcpy(tables + layout.attributes, class->attributes, sizeof(struct attribute_info_t) * class->attribute_count);
+
+    size_t next = layout.member_attributes;
+    struct field_info_t *fields = (struct field_info_t *)(tables + layout.fields);
+    memcpy(fields, class->fields, sizeof(struct field_info_t) * class->fields_count);
+    struct method_info_t *methods = (struct method_info_t *)(tables + layout.methods);
+    memcpy(methods, class->methods, sizeof(struct method_info_t) * class->methods_count);
+    for (size_t i = 0; i < (size_t)class->fields_count + class->methods_count; i++)
+    {
+        // fields and methods share a layout
+        struct field_info_t *member = i < class->fields_count ? &fields[i] : (struct field_info_t *)&methods[i - class->fields_count];
+        memcpy(tables + next, member->attributes, sizeof(struct attribute_info_t) * member->attributes_count);
+        member->attributes = (struct attribute_info_t *)(uintptr_t)next;
+        next += align(sizeof(struct attribute_info_t) * member->attributes_count);
+    }
+    return tables;
+}
+
+struct image_output_t
+{
+    const struct image_header_t *header;
+    const uint8_t *tables;
+    const struct class_t *class;
+};
+
+static int put_image(void *user, FILE *file)
+{
+    const struct image_output_t *output = user;
+    int written = fwrite(output->header, sizeof(*output->header), 1, file) == 1 &&
+                  fwrite(output->tables, 1, output->header->tables, file) == output->header->tables &&
+                  fwrite(output->class->data, 1, output->class->length, file) == output->class->length;
+    return written ? RUM_OK : RUM_ERR_IO;
+}
+
+// written to a temporary file first and renamed into place, so readers never see half an image
+static int write_image(const char *path, const struct class_t *class, uint64_t hash)
+{
+    struct image_header_t header = {
+        .magic = IMAGE_MAGIC,
+        .version = IMAGE_VERSION,
+        .layout = IMAGE_LAYOUT,
+        .hash = hash,
+        .length = class->length,
+        .class_magic = class->magic,
+        .minor = class->minor,
+        .major = class->major,
+        .constant_pool_count = class->constant_pool_count,
+        .access_flags = class->access_flags,
+        .this_class = class->this_class,
+        .super_class = class->super_class,
+        .interfaces_count = class->interfaces_count,
+        .fields_count = class->fields_count,
+        .methods_count = class->methods_count,
+        .attribute_count = class->attribute_count};
+    uint8_t *tables = build_tables(class, &header);
+    if (tables == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+
+    struct image_output_t output = {&header, tables, class};
+    int error = rum_write_atomic(path, put_image, &output);
+    free(tables);
+    return error;
+}
+
+int rum_cache_load(const struct rum_cache_t *cache, const struct rum_classpath_t *classpath, size_t index, struct rum_loader_t *loader, struct class_t *class, int *hit)
+{
+    *hit = 0;
+
+    // the identity key trusts that a file with the same name, size and mtime hasn't changed
+    char name[4096], identity[4096], content[4096];
+    struct stat st;
+    const struct rum_source_t *source = &classpath->sources[classpath->entries[index].source];
+    int length = rum_classpath_name(classpath, index, name, sizeof(name));
+    int known = length > 0 && (size_t)length < sizeof(name) && stat(source->path, &st) == 0;
+    if (known)
+    {
+        uint64_t stamp[5] = {(uint64_t)st.st_dev, (uint64_t)st.st_ino, (uint64_t)st.st_size, (uint64_t)st.st_mtim.tv_sec, (uint64_t)st.st_mtim.tv_nsec};
+        uint64_t key = rum_hash_bytes((const uint8_t *)stamp, sizeof(stamp), rum_hash_bytes((const uint8_t *)name, (size_t)length, 0));
+        snprintf(identity, sizeof(identity), "%s/i-%016llx", cache->directory, (unsigned long long)key);
+        if (rum_class_load_image(class, identity, 0) == RUM_OK)
+        {
+            *hit = RUM_CACHE_IDENTITY;
+            return RUM_OK;
+        }
+    }
+
+    // otherwise the bytes are read after all, and an image of the same content is as good
+    const uint8_t *data;
+    size_t data_length;
+    int error = rum_classpath_load(classpath, index, loader, &data, &data_length);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+    uint64_t hash = rum_hash_bytes(data, data_length, 1);
+    hash += hash == 0; // 0 means unchecked
+    snprintf(content, sizeof(content), "%s/c-%016llx", cache->directory, (unsigned long long)hash);
+    if (rum_class_load_image(class, content, hash) == RUM_OK && class->length == data_length && memcmp(class->data, data, data_length) == 0)
+    {
+        *hit = RUM_CACHE_CONTENT;
+    }
+    else if ((error = rum_class_parse_buffer(class, data, data_length)) != RUM_OK)
+    {
+        return error;
+    }
+    else if (write_image(content, class, hash) != RUM_OK)
+    {
+        // a cache that can't be written to only makes the next run slower
+        return RUM_OK;
+    }
+    if (known)
+    {
+        unlink(identity);
+        link(content, identity);
+    }
+    return RUM_OK;
+}
@@ -0,0 +1,676 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "rum.h"
+
+// what a pc is to the block splitter
+#define MARK_INSN 1   // an instruction starts here
+#define MARK_LEADER 2 // a block starts here, only valid on an instruction
+
+static int resize(void **array, size_t size)
+{
+    void *resized = realloc(*array, size);
+    if (resized == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    *array = resized;
+    return RUM_OK;
+}
+
+// room for `count` pcs and one past the last
+static int reserve_pcs(struct rum_cfg_t *cfg, size_t count)
+{
+    if (count + 1 <= cfg->pc_capacity)
+    {
+        return RUM_OK;
+    }
+    if (resize((void **)&cfg->marks, count + 1) != RUM_OK || resize((void **)&cfg->pc_blocks, sizeof(uint32_t) * (count + 1)) != RUM_OK)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    cfg->pc_capacity = count + 1;
+    return RUM_OK;
+}
+
+// room for `count` blocks, and a last offset for the rows
+static int reserve_blocks(struct rum_cfg_t *cfg, size_t count)
+{
+    if (count + 1 <= cfg->block_capacity)
+    {
+        return RUM_OK;
+    }
+    size_t capacity = cfg->block_capacity * 2 < count + 1 ? count + 1 : cfg->block_capacity * 2;
+    uint32_t **arrays[] = {&cfg->starts, &cfg->succ_offsets, &cfg->pred_offsets, &cfg->idom, &cfg->loop_of, &cfg->order, &cfg->rpo,
+                           &cfg->pre, &cfg->last, &cfg->next, &cfg->child_offsets, &cfg->children, &cfg->seen};
+    for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); i++)
+    {
+        if (resize((void **)arrays[i], sizeof(uint32_t) * capacity) != RUM_OK)
+        {
+            return RUM_ERR_NOMEM;
+        }
+    }
+    cfg->block_capacity = capacity;
+    return RUM_OK;
+}
+
+static int reserve_edges(struct rum_cfg_t *cfg, size_t count)
+{
+    if (count <= cfg->edge_capacity)
+    {
+        return RUM_OK;
+    }
+    size_t capacity = cfg->edge_capacity * 2 < count ? (count < 64 ? 64 : count) : cfg->edge_capacity * 2;
+    uint32_t **arrays[] = {&cfg->edge_from, &cfg->edge_to, &cfg->succs, &cfg->preds, &cfg->stack};
+    for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); i++)
+    {
+        if (resize((void **)arrays[i], sizeof(uint32_t) * capacity) != RUM_OK)
+        {
+            return RUM_ERR_NOMEM;
+        }
+    }
+    if (resize((void **)&cfg->edge_kinds, capacity) != RUM_OK || resize((void **)&cfg->edge_flags, capacity) != RUM_OK)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    cfg->edge_capacity = capacity;
+    return RUM_OK;
+}
+
+static int reserve_loops(struct rum_cfg_t *cfg, size_t count)
+{
+    if (count <= cfg->loop_capacity)
+    {
+        return RUM_OK;
+    }
+    size_t capacity = cfg->loop_capacity * 2 < count ? (count < 16 ? 16 : count) : cfg->loop_capacity * 2;
+    if (resize((void **)&cfg->loops, sizeof(struct rum_loop_t) * capacity) != RUM_OK)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    cfg->loop_capacity = capacity;
+    return RUM_OK;
+}
+
+// a leader at `target`, which has to turn out to be an instruction
+static int mark_target(struct rum_cfg_t *cfg, int64_t target, uint32_t length)
+{
+    if (target < 0 || target >= length)
+    {
+        return RUM_ERR_CODE;
+    }
+    cfg->marks[target] |= MARK_LEADER;
+    return RUM_OK;
+}
+
+static int add_edge(struct rum_cfg_t *cfg, uint32_t from, int64_t to_pc, uint8_t kind)
+{
+    if (reserve_edges(cfg, (size_t)cfg->edge_count + 1) != RUM_OK)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    cfg->edge_from[cfg->edge_count] = from;
+    cfg->edge_to[cfg->edge_count] = cfg->pc_blocks[to_pc];
+    cfg->edge_kinds[cfg->edge_count] = kind;
+    cfg->edge_count++;
+    return RUM_OK;
+}
+
+// every pc some instruction starts at, and the leaders: the entry, branch and switch targets, what
+// follows a block ending instruction, handlers and the bounds of the ranges they cover
+static int find_leaders(struct rum_cfg_t *cfg, const struct rum_code_t *code)
+{
+    uint32_t length = code->code_length;
+    memset(cfg->marks, 0, length + 1);
+    cfg->marks[0] = MARK_LEADER;
+
+    struct rum_insn_iter_t iter;
+    struct rum_insn_t insn;
+    rum_insn_begin(&iter, code);
+    while (rum_insn_next(&iter, &insn))
+    {
+        cfg->marks[insn.pc] |= MARK_INSN;
+        int error = RUM_OK;
+        if (insn.flags & RUM_INSN_BRANCH)
+        {
+            error = mark_target(cfg, rum_insn_target(&insn), length);
+        }
+        else if (insn.flags & RUM_INSN_SWITCH)
+        {
+            struct rum_switch_t table;
+            rum_insn_switch(&insn, &table);
+            error = mark_target(cfg, table.default_target, length);
+            for (uint32_t i = 0; error == RUM_OK && i < table.count; i++)
+            {
+                int32_t match;
+                error = mark_target(cfg, rum_switch_case(&table, i, &match), length);
+            }
+        }
+        if (error != RUM_OK)
+        {
+            return error;
+        }
+        if (insn.flags & (RUM_INSN_BRANCH | RUM_INSN_SWITCH | RUM_INSN_NO_FALLTHROUGH))
+        {
+            cfg->marks[insn.pc + insn.length] |= MARK_LEADER;
+        }
+    }
+    if (iter.error != RUM_OK)
+    {
+        return iter.error;
+    }
+
+    for (unsigned short i = 0; i < code->exception_table_length; i++)
+    {
+        struct rum_exception_t exception;
+        rum_code_exception(code, i, &exception);
+        if (exception.start_pc >= exception.end_pc || exception.end_pc > length || mark_target(cfg, exception.handler_pc, length) != RUM_OK ||
+            (exception.end_pc < length && !(cfg->marks[exception.end_pc] & MARK_INSN)))
+        {
+            return RUM_ERR_CODE;
+        }
+        cfg->marks[exception.start_pc] |= MARK_LEADER;
+        cfg->marks[exception.end_pc] |= MARK_LEADER;
+    }
+
+    // a leader inside an instruction is a target the code can't jump to
+    cfg->block_count = 0;
+    for (uint32_t pc = 0; pc < length; pc++)
+    {
+        if (!(cfg->marks[pc] & MARK_LEADER))
+        {
+            continue;
+        }
+        if (!(cfg->marks[pc] & MARK_INSN))
+        {
+            return RUM_ERR_CODE;
+        }
+        if (reserve_blocks(cfg, (size_t)cfg->block_count + 1) != RUM_OK)
+        {
+            return RUM_ERR_NOMEM;
+        }
+        cfg->pc_blocks[pc] = cfg->block_count;
+        cfg->starts[cfg->block_count++] = pc;
+    }
+    cfg->starts[cfg->block_count] = length;
+    return RUM_OK;
+}
+
+// the edges out of the last instruction of every block, then one from every block a handler
+// covers to the handler
+static int collect_edges(struct rum_cfg_t *cfg, const struct rum_code_t *code)
+{
+    uint32_t length = code->code_length;
+    uint32_t block = 0;
+    struct rum_insn_iter_t iter;
+    struct rum_insn_t insn;
+    int error = RUM_OK;
+    cfg->edge_count = 0;
+    rum_insn_begin(&iter, code);
+    while (error == RUM_OK && rum_insn_next(&iter, &insn))
+    {
+        uint32_t next = insn.pc + insn.length;
+        if (cfg->marks[insn.pc] & MARK_LEADER)
+        {
+            block = cfg->pc_blocks[insn.pc];
+        }
+        if (next < length && !(cfg->marks[next] & MARK_LEADER))
+        {
+            continue;
+        }
+        if (insn.flags & RUM_INSN_BRANCH)
+        {
+            error = add_edge(cfg, block, rum_insn_target(&insn), 0);
+        }
+        else if (insn.flags & RUM_INSN_SWITCH)
+        {
+            struct rum_switch_t table;
+            rum_insn_switch(&insn, &table);
+            error = add_edge(cfg, block, table.default_target, 0);
+            for (uint32_t i = 0; error == RUM_OK && i < table.count; i++)
+            {
+                int32_t match;
+                error = add_edge(cfg, block, rum_switch_case(&table, i, &match), 0);
+            }
+        }
+        // falling off the end of the code is left for the verifier to reject
+        if (error == RUM_OK && !(insn.flags & RUM_INSN_NO_FALLTHROUGH) && next < length)
+        {
+            error = add_edge(cfg, block, next, 0);
+        }
+    }
+
+    for (unsigned short i = 0; error == RUM_OK && i < code->exception_table_length; i++)
+    {
+        struct rum_exception_t exception;
+        rum_code_exception(code, i, &exception);
+        for (uint32_t b = cfg->pc_blocks[exception.start_pc]; error == RUM_OK && cfg->starts[b] < exception.end_pc; b++)
+        {
+            error = add_edge(cfg, b, exception.handler_pc, RUM_EDGE_EXCEPTION);
+        }
+    }
+    return error;
+}
+
+// the collected edges as rows of successors without duplicates, a normal edge winning over an
+// exception edge to the same block, and the rows of predecessors
+static void build_rows(struct rum_cfg_t *cfg)
+{
+    uint32_t n = cfg->block_count;
+    memset(cfg->succ_offsets, 0, sizeof(uint32_t) * (n + 1));
+    for (uint32_t e = 0; e < cfg->edge_count; e++)
+    {
+        cfg->succ_offsets[cfg->edge_from[e] + 1]++;
+    }
+    for (uint32_t b = 0; b < n; b++)
+    {
+        cfg->succ_offsets[b + 1] += cfg->succ_offsets[b];
+        cfg->next[b] = cfg->succ_offsets[b];
+        cfg->seen[b] = RUM_CFG_NONE;
+    }
+    for (uint32_t e = 0; e < cfg->edge_count; e++)
+    {
+        uint32_t slot = cfg->next[cfg->edge_from[e]]++;
+        cfg->succs[slot] = cfg->edge_to[e];
+        cfg->edge_flags[slot] = cfg->edge_kinds[e];
+    }
+
+    uint32_t kept = 0;
+    for (uint32_t b = 0; b < n; b++)
+    {
+        uint32_t begin = cfg->succ_offsets[b], end = cfg->succ_offsets[b + 1];
+        cfg->succ_offsets[b] = kept;
+        for (uint32_t e = begin; e < end; e++)
+        {
+            if (cfg->seen[cfg->succs[e]] != b)
+            {
+                cfg->seen[cfg->succs[e]] = b;
+                cfg->succs[kept] = cfg->succs[e];
+                cfg->edge_flags[kept++] = cfg->edge_flags[e];
+            }
+        }
+    }
+    cfg->succ_offsets[n] = kept;
+    cfg->edge_count = kept;
+
+    memset(cfg->pred_offsets, 0, sizeof(uint32_t) * (n + 1));
+    for (uint32_t e = 0; e < kept; e++)
+    {
+        cfg->pred_offsets[cfg->succs[e] + 1]++;
+    }
+    for (uint32_t b = 0; b < n; b++)
+    {
+        cfg->pred_offsets[b + 1] += cfg->pred_offsets[b];
+        cfg->next[b] = cfg->pred_offsets[b];
+    }
+    for (uint32_t b = 0; b < n; b++)
+    {
+        for (uint32_t e = cfg->succ_offsets[b]; e < cfg->succ_offsets[b + 1]; e++)
+        {
+            cfg->preds[cfg->next[cfg->succs[e]]++] = b;
+        }
+    }
+}
+
+// reverse postorder of the blocks reachable from the entry into `order`, with each block's
+// position in `rpo`, RUM_CFG_NONE for unreachable ones
+static void number_blocks(struct rum_cfg_t *cfg)
+{
+    uint32_t n = cfg->block_count;
+    for (uint32_t b = 0; b < n; b++)
+    {
+        cfg->rpo[b] = RUM_CFG_NONE;
+        cfg->next[b] = cfg->succ_offsets[b];
+    }
+    // `stack` has room for every edge, and a block is pushed once through an edge at most
+    uint32_t top = 0, postorder = 0;
+    cfg->stack[top++] = 0;
+    cfg->rpo[0] = 0;
+    while (top > 0)
+    {
+        uint32_t b = cfg->stack[top - 1];
+        if (cfg->next[b] < cfg->succ_offsets[b + 1])
+        {
+            uint32_t s = cfg->succs[cfg->next[b]++];
+            if (cfg->rpo[s] == RUM_CFG_NONE)
+            {
+                cfg->rpo[s] = 0;
+                cfg->stack[top++] = s;
+            }
+            continue;
+        }
+        top--;
+        cfg->order[postorder++] = b;
+    }
+    cfg->reachable = postorder;
+    for (uint32_t i = 0; i < postorder / 2; i++)
+    {
+        uint32_t swap = cfg->order[i];
+        cfg->order[i] = cfg->order[postorder - 1 - i];
+        cfg->order[postorder - 1 - i] = swap;
+    }
+    for (uint32_t i = 0; i < postorder; i++)
+    {
+        cfg->rpo[cfg->order[i]] = i;
+    }
+}
+
+// Cooper, Harvey and Kennedy's iteration over reverse postorder, which settles in a couple of
+// passes on the graphs compilers produce
+static void find_dominators(struct rum_cfg_t *cfg)
+{
+    uint32_t *idom = cfg->idom, *rpo = cfg->rpo;
+    for (uint32_t b = 0; b < cfg->block_count; b++)
+    {
+        idom[b] = RUM_CFG_NONE;
+    }
+    idom[0] = 0;
+    for (int changed = 1; changed;)
+    {
+        changed = 0;
+        for (uint32_t i = 1; i < cfg->reachable; i++)
+        {
+            uint32_t b = cfg->order[i], dominator = RUM_CFG_NONE;
+            for (uint32_t e = cfg->pred_offsets[b]; e < cfg->pred_offsets[b + 1]; e++)
+            {
+                uint32_t p = cfg->preds[e];
+                if (idom[p] == RUM_CFG_NONE)
+                {
+                    continue;
+                }
+                if (dominator == RUM_CFG_NONE)
+                {
+                    dominator = p;
+                    continue;
+                }
+                uint32_t x = p;
+                while (x != dominator)
+                {
+                    while (rpo[x] > rpo[dominator])
+                    {
+                        x = idom[x];
+                    }
+                    while (rpo[dominator] > rpo[x])
+                    {
+                        dominator = idom[dominator];
+                    }
+                }
+            }
+            if (idom[b] != dominator)
+            {
+                idom[b] = dominator;
+                changed = 1;
+            }
+        }
+    }
+    idom[0] = RUM_CFG_NONE;
+
+    // preorder intervals of the dominator tree answer `rum_cfg_dominates` in constant time, and its
+    // postorder in `order` lists inner loop headers before the headers dominating them
+    uint32_t n = cfg->block_count;
+    memset(cfg->child_offsets, 0, sizeof(uint32_t) * (n + 1));
+    for (uint32_t i = 1; i < cfg->reachable; i++)
+    {
+        cfg->child_offsets[idom[cfg->order[i]] + 1]++;
+    }
+    for (uint32_t b = 0; b < n; b++)
+    {
+        cfg->child_offsets[b + 1] += cfg->child_offsets[b];
+        cfg->next[b] = cfg->child_offsets[b];
+        cfg->pre[b] = RUM_CFG_NONE;
+    }
+    for (uint32_t i = 1; i < cfg->reachable; i++)
+    {
+        uint32_t b = cfg->order[i];
+        cfg->children[cfg->next[idom[b]]++] = b;
+    }
+    for (uint32_t b = 0; b < n; b++)
+    {
+        cfg->next[b] = cfg->child_offsets[b];
+    }
+    uint32_t top = 0, counter = 0, postorder = 0;
+    cfg->stack[top++] = 0;
+    cfg->pre[0] = counter++;
+    while (top > 0)
+    {
+        uint32_t b = cfg->stack[top - 1];
+        if (cfg->next[b] < cfg->child_offsets[b + 1])
+        {
+            uint32_t child = cfg->children[cfg->next[b]++];
+            cfg->pre[child] = counter++;
+            cfg->stack[top++] = child;
+            continue;
+        }
+        top--;
+        cfg->last[b] = counter - 1;
+        cfg->order[postorder++] = b;
+    }
+}
+
+// natural loops, one per header that some block it dominates jumps back to. Headers are visited
+// inner first and every block is claimed by the innermost loop reaching it, so a loop found inside
+// the body of another is linked to it as a child and its body isn't walked twice. Cycles entered
+// other than through a dominating header (irreducible flow) aren't loops here
+static int find_loops(struct rum_cfg_t *cfg)
+{
+    for (uint32_t b = 0; b < cfg->block_count; b++)
+    {
+        cfg->loop_of[b] = RUM_CFG_NONE;
+    }
+    cfg->loop_count = 0;
+    for (uint32_t i = 0; i < cfg->reachable; i++)
+    {
+        uint32_t header = cfg->order[i], top = 0, back_edges = 0;
+        for (uint32_t e = cfg->pred_offsets[header]; e < cfg->pred_offsets[header + 1]; e++)
+        {
+            uint32_t p = cfg->preds[e];
+            if (rum_cfg_dominates(cfg, header, p))
+            {
+                cfg->stack[top++] = p;
+                back_edges++;
+            }
+        }
+        if (back_edges == 0)
+        {
+            continue;
+        }
+        if (reserve_loops(cfg, (size_t)cfg->loop_count + 1) != RUM_OK)
+        {
+            return RUM_ERR_NOMEM;
+        }
+        uint32_t loop = cfg->loop_count++;
+        cfg->loops[loop] = (struct rum_loop_t){.header = header, .parent = RUM_CFG_NONE, .back_edges = back_edges};
+        cfg->loop_of[header] = loop;
+
+        // every block reaching a back edge without going through the header
+        while (top > 0)
+        {
+            uint32_t b = cfg->stack[--top];
+            if (cfg->loop_of[b] == RUM_CFG_NONE)
+            {
+                cfg->loop_of[b] = loop;
+            }
+            else
+            {
+                uint32_t inner = cfg->loop_of[b];
+                while (cfg->loops[inner].parent != RUM_CFG_NONE)
+                {
+                    inner = cfg->loops[inner].parent;
+                }
+                if (inner == loop)
+                {
+                    continue;
+                }
+                cfg->loops[inner].parent = loop;
+                b = cfg->loops[inner].header;
+            }
+            // each block's predecessors are pushed once, so `stack` can't hold more than every edge
+            for (uint32_t e = cfg->pred_offsets[b]; e < cfg->pred_offsets[b + 1]; e++)
+            {
+                if (cfg->rpo[cfg->preds[e]] != RUM_CFG_NONE)
+                {
+                    cfg->stack[top++] = cfg->preds[e];
+                }
+            }
+        }
+    }
+
+    // parents are found after their children, so they come later
+    for (uint32_t l = cfg->loop_count; l-- > 0;)
+    {
+        struct rum_loop_t *loop = &cfg->loops[l];
+        loop->depth = loop->parent == RUM_CFG_NONE ? 1 : cfg->loops[loop->parent].depth + 1;
+    }
+    for (uint32_t b = 0; b < cfg->block_count; b++)
+    {
+        for (uint32_t l = cfg->loop_of[b]; l != RUM_CFG_NONE; l = cfg->loops[l].parent)
+        {
+            cfg->loops[l].blocks++;
+            cfg->loops[l].bytes += cfg->starts[b + 1] - cfg->starts[b];
+        }
+    }
+
+    // back edges are the ones into a header from inside its loop
+    for (uint32_t b = 0; b < cfg->block_count; b++)
+    {
+        for (uint32_t e = cfg->succ_offsets[b]; e < cfg->succ_offsets[b + 1]; e++)
+        {
+            if (rum_cfg_dominates(cfg, cfg->succs[e], b))
+            {
+                cfg->edge_flags[e] |= RUM_EDGE_BACK;
+            }
+        }
+    }
+    return RUM_OK;
+}
+
+int rum_cfg_build(struct rum_cfg_t *cfg, const struct rum_code_t *code)
+{
+    cfg->block_count = 0;
+    cfg->edge_count = 0;
+    cfg->reachable = 0;
+    cfg->loop_count = 0;
+    if (code->code_length == 0)
+    {
+        return RUM_ERR_CODE;
+    }
+    int error = reserve_pcs(cfg, code->code_length);
+    if (error == RUM_OK)
+    {
+        error = find_leaders(cfg, code);
+    }
+    if (error == RUM_OK)
+    {
+        error = collect_edges(cfg, code);
+    }
+    if (error == RUM_OK)
+    {
+        error = reserve_edges(cfg, (size_t)cfg->block_count + cfg->edge_count);
+    }
+    if (error != RUM_OK)
+    {
+        cfg->block_count = 0;
+        cfg->edge_count = 0;
+        return error;
+    }
+    build_rows(cfg);
+    number_blocks(cfg);
+    find_dominators(cfg);
+    error = find_loops(cfg);
+    if (error != RUM_OK)
+    {
+        cfg->block_count = 0;
+        cfg->edge_count = 0;
+        cfg->loop_count = 0;
+    }
+    return error;
+}
+
+void rum_cfg_free(struct rum_cfg_t *cfg)
+{
+    void *arrays[] = {cfg->starts, cfg->succ_offsets, cfg->succs, cfg->edge_flags, cfg->pred_offsets, cfg->preds, cfg->idom, cfg->loop_of,
+                      cfg->loops, cfg->marks, cfg->pc_blocks, cfg->order, cfg->rpo, cfg->pre, cfg->last, cfg->next, cfg->child_offsets,
+                      cfg->children, cfg->seen, cfg->stack, cfg->edge_from, cfg->edge_to, cfg->edge_kinds};
+    for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); i++)
+    {
+        free(arrays[i]);
+    }
+    memset(cfg, 0, sizeof(*cfg));
+}
+
+int rum_cfg_dominates(const struct rum_cfg_t *cfg, uint32_t a, uint32_t b)
+{
+    return a < cfg->block_count && b < cfg->block_count && cfg->pre[a] != RUM_CFG_NONE && cfg->pre[b] != RUM_CFG_NONE &&
+           cfg->pre[a] <= cfg->pre[b] && cfg->pre[b] <= cfg->last[a];
+}
+
+uint32_t rum_cfg_block(const struct rum_cfg_t *cfg, uint32_t pc)
+{
+    if (cfg->block_count == 0 || pc >= cfg->starts[cfg->block_count])
+    {
+        return RUM_CFG_NONE;
+    }
+    uint32_t low = 0, high = cfg->block_count; // the block is the last one starting at or before pc
+    while (high - low > 1)
+    {
+        uint32_t middle = low + (high - low) / 2;
+        if (cfg->starts[middle] <= pc)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+uint32_t rum_cfg_max_depth(const struct rum_cfg_t *cfg)
+{
+    uint32_t depth = 0;
+    for (uint32_t l = 0; l < cfg->loop_count; l++)
+    {
+        depth = cfg->loops[l].depth > depth ? cfg->loops[l].depth : depth;
+    }
+    return depth;
+}
+
+// one box per block labelled with its pc range, loop headers in bold, exception edges dashed and
+// back edges in red. Unreachable blocks are dotted
+int rum_cfg_write_dot(const struct rum_cfg_t *cfg, FILE *out, const char *name, size_t length)
+{
+    fprintf(out, "digraph \"");
+    for (size_t i = 0; i < length; i++)
+    {
+        fprintf(out, "%s%c", name[i] == '"' || name[i] == '\\' ? "\\" : "", name[i]);
+    }
+    fprintf(out, "\" {\n\tnode [shape=box];\n");
+    for (uint32_t b = 0; b < cfg->block_count; b++)
+    {
+        uint32_t loop = cfg->loop_of[b];
+        int header = loop != RUM_CFG_NONE && cfg->loops[loop].header == b;
+        fprintf(out, "\tb%u [label=\"B%u [%u, %u)", b, b, cfg->starts[b], cfg->starts[b + 1]);
+        if (header)
+        {
+            fprintf(out, "\\nloop %u depth %u", loop, cfg->loops[loop].depth);
+        }
+        int unreachable = cfg->rpo[b] == RUM_CFG_NONE;
+        fprintf(out, "\"%s];\n", header && unreachable ? " style=\"bold,dotted\"" : header ? " style=bold" : unreachable ? " style=dotted" : "");
+    }
+    for (uint32_t b = 0; b < cfg->block_count; b++)
+    {
+        for (uint32_t e = cfg->succ_offsets[b]; e < cfg->succ_offsets[b + 1]; e++)
+        {
+            fprintf(out, "\tb%u -> b%u%s%s;\n", b, cfg->succs[e], cfg->edge_flags[e] & RUM_EDGE_EXCEPTION ? " [style=dashed]" : "",
+                    cfg->edge_flags[e] & RUM_EDGE_BACK ? " [color=red]" : "");
+        }
+    }
+    return fprintf(out, "}\n") < 0 ? RUM_ERR_IO : RUM_OK;
+}
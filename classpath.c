@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rum.h"
+
+static int entries_push(struct rum_classpath_t *classpath, uint32_t source, uint32_t entry)
+{
+    if (classpath->count == classpath->capacity)
+    {
+        size_t capacity = classpath->capacity == 0 ? 256 : classpath->capacity * 2;
+        struct rum_entry_t *grown = realloc(classpath->entries, sizeof(struct rum_entry_t) * capacity);
+        if (grown == NULL)
+        {
+            return RUM_ERR_NOMEM;
+        }
+        classpath->entries = grown;
+        classpath->capacity = capacity;
+    }
+    classpath->entries[classpath->count].source = source;
+    classpath->entries[classpath->count].entry = entry;
+    classpath->count++;
+    return RUM_OK;
+}
+
+static int is_jimage(const char *path)
+{
+    return strcmp(path, "modules") == 0 || rum_ends_with(path, "/modules") || rum_ends_with(path, ".jimage");
+}
+
+static int open_source(struct rum_source_t *source)
+{
+    if (is_jimage(source->path))
+    {
+        source->kind = RUM_SOURCE_JIMAGE;
+        return rum_jimage_open(&source->jimage, source->path);
+    }
+    if (rum_ends_with(source->path, ".jar") || rum_ends_with(source->path, ".zip"))
+    {
+        source->kind = RUM_SOURCE_ZIP;
+        return rum_zip_open(&source->zip, source->path);
+    }
+    source->kind = RUM_SOURCE_FILE;
+    return RUM_OK;
+}
+
+// "container!/member" picks one class out of an archive or image
+static int find_member(const struct rum_source_t *source, const char *member, uint32_t *entry)
+{
+    if (source->kind == RUM_SOURCE_JIMAGE)
+    {
+        // image names start with the slash of "!/"
+        return rum_jimage_find(&source->jimage, member - 1, entry);
+    }
+    size_t length = strlen(member);
+    for (size_t k = 0; source->kind == RUM_SOURCE_ZIP && k < source->zip.count; k++)
+    {
+        const struct rum_zip_entry_t *candidate = &source->zip.entries[k];
+        if (candidate->name_length == length && memcmp(candidate->name, member, length) == 0)
+        {
+            *entry = (uint32_t)k;
+            return RUM_OK;
+        }
+    }
+    return RUM_ERR_IO;
+}
+
+int rum_classpath_open(struct rum_classpath_t *classpath, char **inputs, int count)
+{
+    memset(classpath, 0, sizeof(struct rum_classpath_t));
+    int error = rum_collect_paths(&classpath->paths, inputs, count);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+    classpath->sources = calloc(classpath->paths.count + 1, sizeof(struct rum_source_t));
+    if (classpath->sources == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+
+    for (size_t i = 0; error == RUM_OK && i < classpath->paths.count; i++)
+    {
+        struct rum_source_t *source = &classpath->sources[i];
+        source->path = classpath->paths.paths[i];
+
+        // the path is cut at the "!", the member name stays behind it in the same allocation
+        char *member = strstr(classpath->paths.paths[i], "!/");
+        if (member != NULL)
+        {
+            *member = '\0';
+            member += 2;
+        }
+
+        // an archive that can't be opened still gets one entry, which reports the error when loaded
+        source->error = open_source(source);
+        if (source->error != RUM_OK)
+        {
+            error = entries_push(classpath, (uint32_t)i, UINT32_MAX);
+            continue;
+        }
+        if (member != NULL && source->kind != RUM_SOURCE_FILE)
+        {
+            uint32_t entry = UINT32_MAX;
+            source->error = find_member(source, member, &entry);
+            error = entries_push(classpath, (uint32_t)i, entry);
+            continue;
+        }
+
+        if (source->kind == RUM_SOURCE_FILE)
+        {
+            error = entries_push(classpath, (uint32_t)i, 0);
+        }
+        for (size_t k = 0; error == RUM_OK && source->kind == RUM_SOURCE_ZIP && k < source->zip.count; k++)
+        {
+            if (rum_zip_entry_is(&source->zip.entries[k], ".class"))
+            {
+                error = entries_push(classpath, (uint32_t)i, (uint32_t)k);
+            }
+        }
+        // the offsets table is in hash order, names don't come out sorted
+        for (uint32_t k = 0; error == RUM_OK && source->kind == RUM_SOURCE_JIMAGE && k < source->jimage.table_length; k++)
+        {
+            struct rum_jimage_location_t location;
+            if (rum_jimage_location(&source->jimage, k, &location) == RUM_OK && rum_jimage_is_class(&source->jimage, &location))
+            {
+                error = entries_push(classpath, (uint32_t)i, k);
+            }
+        }
+    }
+    return error;
+}
+
+void rum_classpath_close(struct rum_classpath_t *classpath)
+{
+    for (size_t i = 0; classpath->sources != NULL && i < classpath->paths.count; i++)
+    {
+        // a missing member leaves the container open
+        if (classpath->sources[i].kind == RUM_SOURCE_ZIP)
+        {
+            rum_zip_close(&classpath->sources[i].zip);
+        }
+        else if (classpath->sources[i].kind == RUM_SOURCE_JIMAGE)
+        {
+            rum_jimage_close(&classpath->sources[i].jimage);
+        }
+    }
+    free(classpath->sources);
+    free(classpath->entries);
+    rum_paths_free(&classpath->paths);
+    memset(classpath, 0, sizeof(struct rum_classpath_t));
+}
+
+// "path" for class files, "archive!/entry" for archive members, "modules!/module/name.class" for images
+int rum_classpath_name(const struct rum_classpath_t *classpath, size_t index, char *buffer, size_t size)
+{
+    const struct rum_entry_t *entry = &classpath->entries[index];
+    const struct rum_source_t *source = &classpath->sources[entry->source];
+    if (source->kind == RUM_SOURCE_FILE || entry->entry == UINT32_MAX)
+    {
+        return snprintf(buffer, size, "%s", source->path);
+    }
+    if (source->kind == RUM_SOURCE_JIMAGE)
+    {
+        struct rum_jimage_location_t location;
+        rum_jimage_location(&source->jimage, entry->entry, &location);
+        int length = snprintf(buffer, size, "%s!", source->path);
+        return length < 0 || (size_t)length >= size ? length : length + rum_jimage_name(&source->jimage, &location, buffer + length, size - (size_t)length);
+    }
+    const struct rum_zip_entry_t *member = &source->zip.entries[entry->entry];
+    return snprintf(buffer, size, "%s!/%.*s", source->path, (int)member->name_length, member->name);
+}
+
+void rum_loader_init(struct rum_loader_t *loader)
+{
+    memset(loader, 0, sizeof(struct rum_loader_t));
+}
+
+// drops whatever the last `rum_classpath_load` handed out
+static void loader_unmap(struct rum_loader_t *loader)
+{
+    if (loader->mapped != NULL)
+    {
+        rum_unmap_file(loader->mapped, loader->mapped_length);
+        loader->mapped = NULL;
+    }
+}
+
+void rum_loader_release(struct rum_loader_t *loader)
+{
+    loader_unmap(loader);
+    rum_inflater_free(loader->inflater);
+    loader->inflater = NULL;
+}
+
+int rum_classpath_load(const struct rum_classpath_t *classpath, size_t index, struct rum_loader_t *loader, const uint8_t **data, size_t *length)
+{
+    loader_unmap(loader);
+
+    const struct rum_entry_t *entry = &classpath->entries[index];
+    const struct rum_source_t *source = &classpath->sources[entry->source];
+    if (source->kind == RUM_SOURCE_FILE)
+    {
+        int error = rum_map_file(source->path, data, length);
+        if (error == RUM_OK)
+        {
+            loader->mapped = *data;
+            loader->mapped_length = *length;
+        }
+        return error;
+    }
+    if (source->error != RUM_OK)
+    {
+        return source->error;
+    }
+    if (loader->inflater == NULL && (loader->inflater = rum_inflater_new()) == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    if (source->kind == RUM_SOURCE_JIMAGE)
+    {
+        struct rum_jimage_location_t location;
+        int error = rum_jimage_location(&source->jimage, entry->entry, &location);
+        return error != RUM_OK ? error : rum_jimage_read(&source->jimage, &location, loader->inflater, data, length);
+    }
+    return rum_zip_read(&source->zip, entry->entry, loader->inflater, data, length);
+}
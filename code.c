@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+
+#include "rum.h"
+
+// length of every instruction with its operands, 0 for the variable length ones (tableswitch,
+// lookupswitch and wide) and for opcodes that can't appear in a class file
+static const uint8_t lengths[256] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    2, 3, 2, 3, 3, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 2, 0, 0, 1, 1, 1, 1,
+    1, 1, 3, 3, 3, 3, 3, 3, 3, 5, 5, 3, 2, 3, 1, 1,
+    3, 3, 1, 1, 0, 4, 3, 3, 5, 5, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+// RUM_INSN_* of every opcode, 0 for those that need nothing beyond their length
+static const uint8_t flags[256] = {
+    [OP_ldc] = RUM_INSN_POOL,
+    [OP_ldc_w] = RUM_INSN_POOL,
+    [OP_ldc2_w] = RUM_INSN_POOL,
+    [OP_iload] = RUM_INSN_LOCAL,
+    [OP_lload] = RUM_INSN_LOCAL,
+    [OP_fload] = RUM_INSN_LOCAL,
+    [OP_dload] = RUM_INSN_LOCAL,
+    [OP_aload] = RUM_INSN_LOCAL,
+    [OP_istore] = RUM_INSN_LOCAL,
+    [OP_lstore] = RUM_INSN_LOCAL,
+    [OP_fstore] = RUM_INSN_LOCAL,
+    [OP_dstore] = RUM_INSN_LOCAL,
+    [OP_astore] = RUM_INSN_LOCAL,
+    [OP_iinc] = RUM_INSN_LOCAL,
+    [OP_ifeq] = RUM_INSN_BRANCH,
+    [OP_ifne] = RUM_INSN_BRANCH,
+    [OP_iflt] = RUM_INSN_BRANCH,
+    [OP_ifge] = RUM_INSN_BRANCH,
+    [OP_ifgt] = RUM_INSN_BRANCH,
+    [OP_ifle] = RUM_INSN_BRANCH,
+    [OP_if_icmpeq] = RUM_INSN_BRANCH,
+    [OP_if_icmpne] = RUM_INSN_BRANCH,
+    [OP_if_icmplt] = RUM_INSN_BRANCH,
+    [OP_if_icmpge] = RUM_INSN_BRANCH,
+    [OP_if_icmpgt] = RUM_INSN_BRANCH,
+    [OP_if_icmple] = RUM_INSN_BRANCH,
+    [OP_if_acmpeq] = RUM_INSN_BRANCH,
+    [OP_if_acmpne] = RUM_INSN_BRANCH,
+    [OP_goto] = RUM_INSN_BRANCH | RUM_INSN_NO_FALLTHROUGH,
+    [OP_jsr] = RUM_INSN_BRANCH | RUM_INSN_SUBROUTINE,
+    [OP_ret] = RUM_INSN_NO_FALLTHROUGH | RUM_INSN_SUBROUTINE | RUM_INSN_LOCAL,
+    [OP_tableswitch] = RUM_INSN_SWITCH | RUM_INSN_NO_FALLTHROUGH,
+    [OP_lookupswitch] = RUM_INSN_SWITCH | RUM_INSN_NO_FALLTHROUGH,
+    [OP_ireturn] = RUM_INSN_NO_FALLTHROUGH | RUM_INSN_RETURN,
+    [OP_lreturn] = RUM_INSN_NO_FALLTHROUGH | RUM_INSN_RETURN,
+    [OP_freturn] = RUM_INSN_NO_FALLTHROUGH | RUM_INSN_RETURN,
+    [OP_dreturn] = RUM_INSN_NO_FALLTHROUGH | RUM_INSN_RETURN,
+    [OP_areturn] = RUM_INSN_NO_FALLTHROUGH | RUM_INSN_RETURN,
+    [OP_return] = RUM_INSN_NO_FALLTHROUGH | RUM_INSN_RETURN,
+    [OP_getstatic] = RUM_INSN_POOL,
+    [OP_putstatic] = RUM_INSN_POOL,
+    [OP_getfield] = RUM_INSN_POOL,
+    [OP_putfield] = RUM_INSN_POOL,
+    [OP_invokevirtual] = RUM_INSN_INVOKE | RUM_INSN_POOL,
+    [OP_invokespecial] = RUM_INSN_INVOKE | RUM_INSN_POOL,
+    [OP_invokestatic] = RUM_INSN_INVOKE | RUM_INSN_POOL,
+    [OP_invokeinterface] = RUM_INSN_INVOKE | RUM_INSN_POOL,
+    [OP_invokedynamic] = RUM_INSN_INVOKE | RUM_INSN_POOL,
+    [OP_new] = RUM_INSN_POOL,
+    [OP_anewarray] = RUM_INSN_POOL,
+    [OP_athrow] = RUM_INSN_NO_FALLTHROUGH,
+    [OP_checkcast] = RUM_INSN_POOL,
+    [OP_instanceof] = RUM_INSN_POOL,
+    [OP_multianewarray] = RUM_INSN_POOL,
+    [OP_ifnull] = RUM_INSN_BRANCH,
+    [OP_ifnonnull] = RUM_INSN_BRANCH,
+    [OP_goto_w] = RUM_INSN_BRANCH | RUM_INSN_NO_FALLTHROUGH,
+    [OP_jsr_w] = RUM_INSN_BRANCH | RUM_INSN_SUBROUTINE,
+};
+
+static const char *const names[256] = {
+    "nop", "aconst_null", "iconst_m1", "iconst_0", "iconst_1", "iconst_2", "iconst_3", "iconst_4",
+    "iconst_5", "lconst_0", "lconst_1", "fconst_0", "fconst_1", "fconst_2", "dconst_0", "dconst_1",
+    "bipush", "sipush", "ldc", "ldc_w", "ldc2_w", "iload", "lload", "fload",
+    "dload", "aload", "iload_0", "iload_1", "iload_2", "iload_3", "lload_0", "lload_1",
+    "lload_2", "lload_3", "fload_0", "fload_1", "fload_2", "fload_3", "dload_0", "dload_1",
+    "dload_2", "dload_3", "aload_0", "aload_1", "aload_2", "aload_3", "iaload", "laload",
+    "faload", "daload", "aaload", "baload", "caload", "saload", "istore", "lstore",
+    "fstore", "dstore", "astore", "istore_0", "istore_1", "istore_2", "istore_3", "lstore_0",
+    "lstore_1", "lstore_2", "lstore_3", "fstore_0", "fstore_1", "fstore_2", "fstore_3", "dstore_0",
+    "dstore_1", "dstore_2", "dstore_3", "astore_0", "astore_1", "astore_2", "astore_3", "iastore",
+    "lastore", "fastore", "dastore", "aastore", "bastore", "castore", "sastore", "pop",
+    "pop2", "dup", "dup_x1", "dup_x2", "dup2", "dup2_x1", "dup2_x2", "swap",
+    "iadd", "ladd", "fadd", "dadd", "isub", "lsub", "fsub", "dsub",
+    "imul", "lmul", "fmul", "dmul", "idiv", "ldiv", "fdiv", "ddiv",
+    "irem", "lrem", "frem", "drem", "ineg", "lneg", "fneg", "dneg",
+    "ishl", "lshl", "ishr", "lshr", "iushr", "lushr", "iand", "land",
+    "ior", "lor", "ixor", "lxor", "iinc", "i2l", "i2f", "i2d",
+    "l2i", "l2f", "l2d", "f2i", "f2l", "f2d", "d2i", "d2l",
+    "d2f", "i2b", "i2c", "i2s", "lcmp", "fcmpl", "fcmpg", "dcmpl",
+    "dcmpg", "ifeq", "ifne", "iflt", "ifge", "ifgt", "ifle", "if_icmpeq",
+    "if_icmpne", "if_icmplt", "if_icmpge", "if_icmpgt", "if_icmple", "if_acmpeq", "if_acmpne", "goto",
+    "jsr", "ret", "tableswitch", "lookupswitch", "ireturn", "lreturn", "freturn", "dreturn",
+    "areturn", "return", "getstatic", "putstatic", "getfield", "putfield", "invokevirtual", "invokespecial",
+    "invokestatic", "invokeinterface", "invokedynamic", "new", "newarray", "anewarray", "arraylength", "athrow",
+    "checkcast", "instanceof", "monitorenter", "monitorexit", "wide", "multianewarray", "ifnull", "ifnonnull",
+    "goto_w", "jsr_w",
+};
+
+static uint32_t get_u4(const uint8_t *bytes)
+{
+    return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+}
+
+const char *rum_opcode_name(uint8_t opcode)
+{
+    return names[opcode] != NULL ? names[opcode] : "<invalid>";
+}
+
+int rum_code_decode(const uint8_t *data, const struct attribute_info_t *attribute, struct rum_code_t *code)
+{
+    struct cursor_t cursor = {
+        .data = data + attribute->offset,
+        .length = attribute->attribute_length,
+        .offset = 0,
+        .overflow = 0};
+
+    memset(code, 0, sizeof(struct rum_code_t));
+    code->max_stack = read_u2(&cursor);
+    code->max_locals = read_u2(&cursor);
+    code->code_length = read_u4(&cursor);
+    code->code = read_bytes(&cursor, code->code_length);
+    code->exception_table_length = read_u2(&cursor);
+    code->exception_table = read_bytes(&cursor, (size_t)code->exception_table_length * 8);
+    code->attributes_count = read_u2(&cursor);
+    code->attributes_offset = attribute->offset + (uint32_t)cursor.offset;
+
+    // the nested attributes have to fill the rest of the body exactly, like they do in the class
+    for (unsigned short i = 0; i < code->attributes_count && !cursor.overflow; i++)
+    {
+        read_u2(&cursor);
+        read_bytes(&cursor, read_u4(&cursor));
+    }
+    if (cursor.overflow || cursor.offset != cursor.length)
+    {
+        return RUM_ERR_TRUNCATED;
+    }
+    return code->code_length == 0 || code->code_length > 65535 ? RUM_ERR_CODE : RUM_OK;
+}
+
+void rum_code_exception(const struct rum_code_t *code, unsigned short index, struct rum_exception_t *exception)
+{
+    const uint8_t *entry = code->exception_table + (size_t)index * 8;
+    exception->start_pc = (unsigned short)(entry[0] << 8 | entry[1]);
+    exception->end_pc = (unsigned short)(entry[2] << 8 | entry[3]);
+    exception->handler_pc = (unsigned short)(entry[4] << 8 | entry[5]);
+    exception->catch_type = (unsigned short)(entry[6] << 8 | entry[7]);
+}
+
+void rum_code_attribute(const uint8_t *data, const struct rum_code_t *code, uint32_t *offset, struct attribute_info_t *attribute)
+{
+    // `rum_code_decode` checked that every nested attribute is within the body
+    if (*offset == 0)
+    {
+        *offset = code->attributes_offset;
+    }
+    const uint8_t *header = data + *offset;
+    attribute->attribute_name_index = (unsigned short)(header[0] << 8 | header[1]);
+    attribute->attribute_length = get_u4(header + 2);
+    attribute->offset = *offset + 6;
+    *offset = attribute->offset + attribute->attribute_length;
+}
+
+void rum_insn_begin(struct rum_insn_iter_t *iter, const struct rum_code_t *code)
+{
+    iter->code = code->code;
+    iter->length = code->code_length;
+    iter->pc = 0;
+    iter->error = RUM_OK;
+}
+
+int rum_insn_next(struct rum_insn_iter_t *iter, struct rum_insn_t *insn)
+{
+    if (iter->pc >= iter->length || iter->error != RUM_OK)
+    {
+        return 0;
+    }
+    uint32_t pc = iter->pc;
+    uint8_t opcode = iter->code[pc];
+    uint32_t length = lengths[opcode];
+    insn->pc = pc;
+    insn->opcode = opcode;
+    insn->wide = 0;
+    insn->flags = flags[opcode];
+    insn->operands = iter->code + pc + 1;
+
+    if (opcode == OP_wide)
+    {
+        // the modified instruction takes the place of the prefix, with 16-bit operands
+        uint8_t modified = pc + 1 < iter->length ? iter->code[pc + 1] : OP_nop;
+        if (modified == OP_iinc)
+        {
+            length = 6;
+        }
+        else if ((modified >= OP_iload && modified <= OP_aload) || (modified >= OP_istore && modified <= OP_astore) || modified == OP_ret)
+        {
+            length = 4;
+        }
+        insn->opcode = modified;
+        insn->wide = 1;
+        insn->flags = flags[modified];
+        insn->operands = iter->code + pc + 2;
+    }
+    else if (opcode == OP_tableswitch || opcode == OP_lookupswitch)
+    {
+        // the operands start at the next multiple of four from the start of the code, after the
+        // default and either the bounds or the number of pairs
+        uint32_t operands = (pc + 4) & ~3u;
+        uint32_t header = opcode == OP_tableswitch ? 12 : 8;
+        insn->operands = iter->code + operands;
+        if (operands + header <= iter->length)
+        {
+            const uint8_t *table = insn->operands;
+            int64_t cases = opcode == OP_tableswitch ? (int64_t)(int32_t)get_u4(table + 8) - (int32_t)get_u4(table + 4) + 1
+                                                     : (int64_t)(int32_t)get_u4(table + 4);
+            int64_t size = (int64_t)(operands - pc) + header + cases * (opcode == OP_tableswitch ? 4 : 8);
+            length = cases < 0 || size > (int64_t)(iter->length - pc) ? 0 : (uint32_t)size;
+        }
+    }
+    if (length == 0 || length > iter->length - pc)
+    {
+        iter->error = RUM_ERR_CODE;
+        return 0;
+    }
+    insn->length = length;
+    iter->pc = pc + length;
+    return 1;
+}
+
+uint16_t rum_insn_u2(const struct rum_insn_t *insn)
+{
+    return (uint16_t)(insn->operands[0] << 8 | insn->operands[1]);
+}
+
+int64_t rum_insn_target(const struct rum_insn_t *insn)
+{
+    if (insn->opcode == OP_goto_w || insn->opcode == OP_jsr_w)
+    {
+        return (int64_t)insn->pc + (int32_t)get_u4(insn->operands);
+    }
+    return (int64_t)insn->pc + (int16_t)rum_insn_u2(insn);
+}
+
+void rum_insn_switch(const struct rum_insn_t *insn, struct rum_switch_t *table)
+{
+    const uint8_t *operands = insn->operands;
+    table->pc = insn->pc;
+    table->lookup = insn->opcode == OP_lookupswitch;
+    table->default_target = (int64_t)insn->pc + (int32_t)get_u4(operands);
+    if (table->lookup)
+    {
+        table->low = 0;
+        table->count = get_u4(operands + 4);
+        table->cases = operands + 8;
+    }
+    else
+    {
+        table->low = (int32_t)get_u4(operands + 4);
+        table->count = (uint32_t)((int64_t)(int32_t)get_u4(operands + 8) - table->low + 1);
+        table->cases = operands + 12;
+    }
+}
+
+int64_t rum_switch_case(const struct rum_switch_t *table, uint32_t index, int32_t *match)
+{
+    if (table->lookup)
+    {
+        *match = (int32_t)get_u4(table->cases + (size_t)index * 8);
+        return (int64_t)table->pc + (int32_t)get_u4(table->cases + (size_t)index * 8 + 4);
+    }
+    *match = (int32_t)((int64_t)table->low + index);
+    return (int64_t)table->pc + (int32_t)get_u4(table->cases + (size_t)index * 4);
+}
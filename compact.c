@@ -0,0 +1,834 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "rum.h"
+
+#define COMPACT_DEPTH 32 // nested annotations and arrays past this are taken to be malformed
+
+// what an attribute holds, as far as pool indices go
+enum
+{
+    HOLDS_NOTHING,
+    HOLDS_INDEX,      // one u2
+    HOLDS_LIST,       // u2 count, u2 indices
+    HOLDS_CODE,
+    HOLDS_STACK_MAP,
+    HOLDS_INNER_CLASSES,
+    HOLDS_ENCLOSING_METHOD,
+    HOLDS_LOCALS,
+    HOLDS_ANNOTATIONS,
+    HOLDS_PARAMETER_ANNOTATIONS,
+    HOLDS_TYPE_ANNOTATIONS,
+    HOLDS_ELEMENT,
+    HOLDS_BOOTSTRAP_METHODS,
+    HOLDS_METHOD_PARAMETERS,
+    HOLDS_RECORD,
+    HOLDS_UNKNOWN, // may hold indices nobody can find, the pool is left alone
+};
+
+#define KNOWN(name, holds) {name, sizeof(name) - 1, holds}
+
+static const struct
+{
+    const char *name;
+    unsigned short length;
+    int holds;
+} known[] = {
+    KNOWN("Code", HOLDS_CODE),
+    KNOWN("ConstantValue", HOLDS_INDEX),
+    KNOWN("StackMapTable", HOLDS_STACK_MAP),
+    KNOWN("Exceptions", HOLDS_LIST),
+    KNOWN("InnerClasses", HOLDS_INNER_CLASSES),
+    KNOWN("EnclosingMethod", HOLDS_ENCLOSING_METHOD),
+    KNOWN("Synthetic", HOLDS_NOTHING),
+    KNOWN("Signature", HOLDS_INDEX),
+    KNOWN("SourceFile", HOLDS_INDEX),
+    KNOWN("SourceDebugExtension", HOLDS_NOTHING),
+    KNOWN("LineNumberTable", HOLDS_NOTHING),
+    KNOWN("LocalVariableTable", HOLDS_LOCALS),
+    KNOWN("LocalVariableTypeTable", HOLDS_LOCALS),
+    KNOWN("Deprecated", HOLDS_NOTHING),
+    KNOWN("RuntimeVisibleAnnotations", HOLDS_ANNOTATIONS),
+    KNOWN("RuntimeInvisibleAnnotations", HOLDS_ANNOTATIONS),
+    KNOWN("RuntimeVisibleParameterAnnotations", HOLDS_PARAMETER_ANNOTATIONS),
+    KNOWN("RuntimeInvisibleParameterAnnotations", HOLDS_PARAMETER_ANNOTATIONS),
+    KNOWN("RuntimeVisibleTypeAnnotations", HOLDS_TYPE_ANNOTATIONS),
+    KNOWN("RuntimeInvisibleTypeAnnotations", HOLDS_TYPE_ANNOTATIONS),
+    KNOWN("AnnotationDefault", HOLDS_ELEMENT),
+    KNOWN("BootstrapMethods", HOLDS_BOOTSTRAP_METHODS),
+    KNOWN("MethodParameters", HOLDS_METHOD_PARAMETERS),
+    KNOWN("NestHost", HOLDS_INDEX),
+    KNOWN("NestMembers", HOLDS_LIST),
+    KNOWN("PermittedSubclasses", HOLDS_LIST),
+    KNOWN("Record", HOLDS_RECORD),
+};
+
+// the pool entries the attributes of a class refer to, either marked live or renumbered in place
+struct walk_t
+{
+    const struct class_t *class;
+    int flags;                  // RUM_WRITE_*, attributes the writer drops aren't walked
+    const uint8_t *data;        // the bytes walked
+    uint8_t *out;               // the same bytes, renumbered through `map`, NULL when marking
+    const unsigned short *map;
+    uint8_t *live;
+    unsigned short *stack;      // live entries whose own references haven't been followed yet
+    size_t depth;
+};
+
+static int holds(const struct class_t *class, unsigned short index)
+{
+    if (index == 0 || index >= class->constant_pool_count || class->constant_pool[index - 1].tag != CONSTANT_Utf8)
+    {
+        return HOLDS_UNKNOWN;
+    }
+    const struct constant_utf8_t *name = &class->constant_pool[index - 1].constant_utf8;
+    for (size_t i = 0; i < sizeof(known) / sizeof(known[0]); i++)
+    {
+        if (known[i].length == name->length && memcmp(known[i].name, name->bytes, name->length) == 0)
+        {
+            return known[i].holds;
+        }
+    }
+    return HOLDS_UNKNOWN;
+}
+
+static void mark(struct walk_t *walk, unsigned short index)
+{
+    if (!walk->live[index])
+    {
+        walk->live[index] = 1;
+        walk->stack[walk->depth++] = index;
+    }
+}
+
+// the reference at `at`, one byte wide for ldc and two otherwise. 0 means none where it is allowed
+static int reference(struct walk_t *walk, const uint8_t *at, int width)
+{
+    unsigned short index = width == 1 ? at[0] : (unsigned short)((at[0] << 8) | at[1]);
+    if (index == 0)
+    {
+        return RUM_OK;
+    }
+    if (index >= walk->class->constant_pool_count || walk->class->constant_pool[index - 1].tag == 0)
+    {
+        return RUM_ERR_TAG;
+    }
+    if (walk->out == NULL)
+    {
+        mark(walk, index);
+        return RUM_OK;
+    }
+    uint8_t *to = walk->out + (at - walk->data);
+    unsigned short renumbered = walk->map[index];
+    if (width == 1)
+    {
+        to[0] = (uint8_t)renumbered; // entries only move down, so an ldc index still fits
+    }
+    else
+    {
+        to[0] = renumbered >> 8;
+        to[1] = renumbered & 0xff;
+    }
+    return RUM_OK;
+}
+
+// the u2 at the cursor is a reference
+static int read_reference(struct walk_t *walk, struct cursor_t *cursor)
+{
+    size_t offset = cursor->offset;
+    read_u2(cursor);
+    return cursor->overflow ? RUM_ERR_TRUNCATED : reference(walk, cursor->data + offset, 2);
+}
+
+static int walk_annotation(struct walk_t *walk, struct cursor_t *cursor, int depth);
+
+static int walk_element(struct walk_t *walk, struct cursor_t *cursor, int depth)
+{
+    int error;
+    switch (read_u1(cursor))
+    {
+    case 'B':
+    case 'C':
+    case 'D':
+    case 'F':
+    case 'I':
+    case 'J':
+    case 'S':
+    case 'Z':
+    case 's':
+    case 'c':
+        return read_reference(walk, cursor);
+    case 'e':
+        error = read_reference(walk, cursor); // type and constant name
+        return error != RUM_OK ? error : read_reference(walk, cursor);
+    case '@':
+        return depth == 0 ? RUM_ERR_TAG : walk_annotation(walk, cursor, depth - 1);
+    case '[':
+    {
+        unsigned short count = read_u2(cursor);
+        for (unsigned short i = 0; i < count && !cursor->overflow; i++)
+        {
+            error = depth == 0 ? RUM_ERR_TAG : walk_element(walk, cursor, depth - 1);
+            if (error != RUM_OK)
+            {
+                return error;
+            }
+        }
+        return cursor->overflow ? RUM_ERR_TRUNCATED : RUM_OK;
+    }
+    default:
+        return cursor->overflow ? RUM_ERR_TRUNCATED : RUM_ERR_TAG;
+    }
+}
+
+static int walk_annotation(struct walk_t *walk, struct cursor_t *cursor, int depth)
+{
+    int error = read_reference(walk, cursor);
+    unsigned short pairs = read_u2(cursor);
+    for (unsigned short i = 0; error == RUM_OK && i < pairs && !cursor->overflow; i++)
+    {
+        error = read_reference(walk, cursor); // element name
+        if (error == RUM_OK)
+        {
+            error = walk_element(walk, cursor, depth);
+        }
+    }
+    return error == RUM_OK && cursor->overflow ? RUM_ERR_TRUNCATED : error;
+}
+
+static int walk_annotations(struct walk_t *walk, struct cursor_t *cursor)
+{
+    int error = RUM_OK;
+    unsigned short count = read_u2(cursor);
+    for (unsigned short i = 0; error == RUM_OK && i < count && !cursor->overflow; i++)
+    {
+        error = walk_annotation(walk, cursor, COMPACT_DEPTH);
+    }
+    return error;
+}
+
+// steps over the target_info and type_path in front of a type annotation
+static int skip_type_target(struct cursor_t *cursor)
+{
+    uint8_t target = read_u1(cursor);
+    switch (target)
+    {
+    case 0x00: // type parameter
+    case 0x01:
+    case 0x16: // formal parameter
+        read_u1(cursor);
+        break;
+    case 0x10: // supertype
+    case 0x11: // type parameter bound
+    case 0x12:
+    case 0x17: // throws
+    case 0x42: // catch
+    case 0x43: // instanceof, new and method references
+    case 0x44:
+    case 0x45:
+    case 0x46:
+        read_u2(cursor);
+        break;
+    case 0x13: // field, return and receiver types
+    case 0x14:
+    case 0x15:
+        break;
+    case 0x40: // local variables, a table of start_pc, length and index
+    case 0x41:
+        read_bytes(cursor, (size_t)read_u2(cursor) * 6);
+        break;
+    case 0x47: // casts and type arguments
+    case 0x48:
+    case 0x49:
+    case 0x4a:
+    case 0x4b:
+        read_u2(cursor);
+        read_u1(cursor);
+        break;
+    default:
+        return cursor->overflow ? RUM_ERR_TRUNCATED : RUM_ERR_TAG;
+    }
+    read_bytes(cursor, (size_t)read_u1(cursor) * 2); // type_path
+    return cursor->overflow ? RUM_ERR_TRUNCATED : RUM_OK;
+}
+
+static int walk_verification_types(struct walk_t *walk, struct cursor_t *cursor, unsigned short count)
+{
+    for (unsigned short i = 0; i < count && !cursor->overflow; i++)
+    {
+        uint8_t tag = read_u1(cursor);
+        if (tag == 7) // Object_variable_info
+        {
+            int error = read_reference(walk, cursor);
+            if (error != RUM_OK)
+            {
+                return error;
+            }
+        }
+        else if (tag == 8) // Uninitialized_variable_info, an offset into the code
+        {
+            read_u2(cursor);
+        }
+        else if (tag > 8)
+        {
+            return cursor->overflow ? RUM_ERR_TRUNCATED : RUM_ERR_TAG;
+        }
+    }
+    return cursor->overflow ? RUM_ERR_TRUNCATED : RUM_OK;
+}
+
+static int walk_stack_map(struct walk_t *walk, struct cursor_t *cursor)
+{
+    int error = RUM_OK;
+    unsigned short frames = read_u2(cursor);
+    for (unsigned short i = 0; error == RUM_OK && i < frames && !cursor->overflow; i++)
+    {
+        uint8_t type = read_u1(cursor);
+        if (type < 64) // same_frame
+        {
+            continue;
+        }
+        if (type < 128) // same_locals_1_stack_item_frame
+        {
+            error = walk_verification_types(walk, cursor, 1);
+        }
+        else if (type < 247)
+        {
+            error = RUM_ERR_TAG;
+        }
+        else if (type == 247) // same_locals_1_stack_item_frame_extended
+        {
+            read_u2(cursor);
+            error = walk_verification_types(walk, cursor, 1);
+        }
+        else if (type < 252) // chop_frame and same_frame_extended
+        {
+            read_u2(cursor);
+        }
+        else if (type < 255) // append_frame
+        {
+            read_u2(cursor);
+            error = walk_verification_types(walk, cursor, type - 251);
+        }
+        else // full_frame, locals then stack
+        {
+            read_u2(cursor);
+            error = walk_verification_types(walk, cursor, read_u2(cursor));
+            if (error == RUM_OK)
+            {
+                error = walk_verification_types(walk, cursor, read_u2(cursor));
+            }
+        }
+    }
+    return error == RUM_OK && cursor->overflow ? RUM_ERR_TRUNCATED : error;
+}
+
+static int walk_attribute(struct walk_t *walk, const uint8_t *header, size_t available, int droppable);
+
+// the instructions, the catch types and the nested attributes of a Code attribute
+static int walk_code(struct walk_t *walk, const uint8_t *header)
+{
+    struct attribute_info_t attribute = {
+        .attribute_name_index = (unsigned short)((header[0] << 8) | header[1]),
+        .attribute_length = (uint32_t)header[2] << 24 | (uint32_t)header[3] << 16 | (uint32_t)header[4] << 8 | header[5],
+        .offset = (uint32_t)(header + 6 - walk->data)};
+    struct rum_code_t code;
+    int error = rum_code_decode(walk->data, &attribute, &code);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+
+    struct rum_insn_iter_t iter;
+    struct rum_insn_t insn;
+    rum_insn_begin(&iter, &code);
+    while (error == RUM_OK && rum_insn_next(&iter, &insn))
+    {
+        if (insn.flags & RUM_INSN_POOL)
+        {
+            error = reference(walk, insn.operands, insn.opcode == OP_ldc ? 1 : 2);
+        }
+    }
+    if (error == RUM_OK && iter.error != RUM_OK)
+    {
+        error = iter.error;
+    }
+    for (unsigned short i = 0; error == RUM_OK && i < code.exception_table_length; i++)
+    {
+        error = reference(walk, code.exception_table + (size_t)i * 8 + 6, 2); // catch_type
+    }
+    uint32_t offset = 0;
+    for (unsigned short i = 0; error == RUM_OK && i < code.attributes_count; i++)
+    {
+        struct attribute_info_t nested;
+        rum_code_attribute(walk->data, &code, &offset, &nested);
+        error = walk_attribute(walk, walk->data + nested.offset - 6, 6 + (size_t)nested.attribute_length, 1);
+    }
+    return error;
+}
+
+static int walk_body(struct walk_t *walk, int kind, struct cursor_t *cursor)
+{
+    int error = RUM_OK;
+    unsigned short count;
+    switch (kind)
+    {
+    case HOLDS_NOTHING:
+        return RUM_OK;
+    case HOLDS_INDEX:
+        return read_reference(walk, cursor);
+    case HOLDS_LIST:
+        count = read_u2(cursor);
+        for (unsigned short i = 0; error == RUM_OK && i < count; i++)
+        {
+            error = read_reference(walk, cursor);
+        }
+        return error;
+    case HOLDS_STACK_MAP:
+        return walk_stack_map(walk, cursor);
+    case HOLDS_INNER_CLASSES:
+        count = read_u2(cursor);
+        for (unsigned short i = 0; error == RUM_OK && i < count; i++)
+        {
+            // inner, outer and simple name, any of the last two may be 0
+            for (int j = 0; error == RUM_OK && j < 3; j++)
+            {
+                error = read_reference(walk, cursor);
+            }
+            read_u2(cursor);
+        }
+        return error == RUM_OK && cursor->overflow ? RUM_ERR_TRUNCATED : error;
+    case HOLDS_ENCLOSING_METHOD:
+        error = read_reference(walk, cursor);
+        return error != RUM_OK ? error : read_reference(walk, cursor);
+    case HOLDS_LOCALS:
+        count = read_u2(cursor);
+        for (unsigned short i = 0; error == RUM_OK && i < count; i++)
+        {
+            read_u4(cursor); // start_pc and length
+            error = read_reference(walk, cursor);
+            if (error == RUM_OK)
+            {
+                error = read_reference(walk, cursor);
+            }
+            read_u2(cursor);
+        }
+        return error == RUM_OK && cursor->overflow ? RUM_ERR_TRUNCATED : error;
+    case HOLDS_ANNOTATIONS:
+        return walk_annotations(walk, cursor);
+    case HOLDS_PARAMETER_ANNOTATIONS:
+        count = read_u1(cursor);
+        for (unsigned short i = 0; error == RUM_OK && i < count && !cursor->overflow; i++)
+        {
+            error = walk_annotations(walk, cursor);
+        }
+        return error == RUM_OK && cursor->overflow ? RUM_ERR_TRUNCATED : error;
+    case HOLDS_TYPE_ANNOTATIONS:
+        count = read_u2(cursor);
+        for (unsigned short i = 0; error == RUM_OK && i < count && !cursor->overflow; i++)
+        {
+            error = skip_type_target(cursor);
+            if (error == RUM_OK)
+            {
+                error = walk_annotation(walk, cursor, COMPACT_DEPTH);
+            }
+        }
+        return error == RUM_OK && cursor->overflow ? RUM_ERR_TRUNCATED : error;
+    case HOLDS_ELEMENT:
+        return walk_element(walk, cursor, COMPACT_DEPTH);
+    case HOLDS_BOOTSTRAP_METHODS:
+        count = read_u2(cursor);
+        for (unsigned short i = 0; error == RUM_OK && i < count && !cursor->overflow; i++)
+        {
+            error = read_reference(walk, cursor);
+            unsigned short arguments = read_u2(cursor);
+            for (unsigned short j = 0; error == RUM_OK && j < arguments; j++)
+            {
+                error = read_reference(walk, cursor);
+            }
+        }
+        return error == RUM_OK && cursor->overflow ? RUM_ERR_TRUNCATED : error;
+    case HOLDS_METHOD_PARAMETERS:
+        count = read_u1(cursor);
+        for (unsigned short i = 0; error == RUM_OK && i < count; i++)
+        {
+            error = read_reference(walk, cursor); // 0 for a parameter without a name
+            read_u2(cursor);
+        }
+        return error == RUM_OK && cursor->overflow ? RUM_ERR_TRUNCATED : error;
+    case HOLDS_RECORD:
+        count = read_u2(cursor);
+        for (unsigned short i = 0; error == RUM_OK && i < count && !cursor->overflow; i++)
+        {
+            error = read_reference(walk, cursor); // name and descriptor
+            if (error == RUM_OK)
+            {
+                error = read_reference(walk, cursor);
+            }
+            unsigned short attributes = read_u2(cursor);
+            for (unsigned short j = 0; error == RUM_OK && j < attributes && !cursor->overflow; j++)
+            {
+                size_t at = cursor->offset;
+                read_u2(cursor);
+                read_bytes(cursor, read_u4(cursor));
+                error = cursor->overflow ? RUM_ERR_TRUNCATED : walk_attribute(walk, cursor->data + at, cursor->offset - at, 0);
+            }
+        }
+        return error == RUM_OK && cursor->overflow ? RUM_ERR_TRUNCATED : error;
+    default:
+        return RUM_STOPPED;
+    }
+}
+
+// an attribute, header included, in `available` bytes. RUM_STOPPED when nothing is known of it.
+// `droppable` where the writer drops what the flags ask for, record components are copied whole
+static int walk_attribute(struct walk_t *walk, const uint8_t *header, size_t available, int droppable)
+{
+    if (available < 6)
+    {
+        return RUM_ERR_TRUNCATED;
+    }
+    unsigned short name = (unsigned short)((header[0] << 8) | header[1]);
+    uint32_t length = (uint32_t)header[2] << 24 | (uint32_t)header[3] << 16 | (uint32_t)header[4] << 8 | header[5];
+    if (length > available - 6)
+    {
+        return RUM_ERR_TRUNCATED;
+    }
+    // the kind is taken from the old name before it is renumbered
+    int kind = holds(walk->class, name);
+    if (kind == HOLDS_UNKNOWN)
+    {
+        return RUM_STOPPED;
+    }
+    if (droppable && walk->out == NULL && rum_write_drops(walk->class, walk->flags, name))
+    {
+        return RUM_OK; // won't be written
+    }
+    int error = reference(walk, header, 2);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+    if (kind == HOLDS_CODE)
+    {
+        return walk_code(walk, header);
+    }
+    struct cursor_t cursor = {
+        .data = header + 6,
+        .length = length,
+        .offset = 0,
+        .overflow = 0};
+    error = walk_body(walk, kind, &cursor);
+    return error == RUM_OK && cursor.overflow ? RUM_ERR_TRUNCATED : error;
+}
+
+static int walk_attributes(struct walk_t *walk, const struct attribute_info_t *attributes, unsigned short count)
+{
+    int error = RUM_OK;
+    for (unsigned short i = 0; error == RUM_OK && i < count; i++)
+    {
+        const struct attribute_info_t *attribute = &attributes[i];
+        error = walk_attribute(walk, walk->data + attribute->offset - 6, 6 + (size_t)attribute->attribute_length, 1);
+    }
+    return error;
+}
+
+int rum_pool_remap(const struct class_t *class, const unsigned short *map, uint8_t *attribute, size_t length)
+{
+    struct walk_t walk = {
+        .class = class,
+        .data = attribute,
+        .out = attribute,
+        .map = map};
+    return walk_attribute(&walk, attribute, length, 0);
+}
+
+// the references an entry makes to other entries, at most two
+static int references(const struct cp_info_t *constant, unsigned short *to)
+{
+    switch (constant->tag)
+    {
+    case CONSTANT_Class:
+        to[0] = constant->constant_class.name_index;
+        return 1;
+    case CONSTANT_String:
+        to[0] = constant->constant_string.string_index;
+        return 1;
+    case CONSTANT_MethodType:
+        to[0] = constant->constant_method_type.descriptor_index;
+        return 1;
+    case CONSTANT_NameAndType:
+        to[0] = constant->constant_name_and_type_info.name_index;
+        to[1] = constant->constant_name_and_type_info.descriptor_index;
+        return 2;
+    case CONSTANT_Fieldref:
+    case CONSTANT_Methodref:
+    case CONSTANT_InterfaceMethodref:
+        to[0] = constant->constant_methodref.class_index;
+        to[1] = constant->constant_methodref.name_and_type_index;
+        return 2;
+    case CONSTANT_MethodHandle:
+        to[0] = constant->constant_method_handle.reference_index;
+        return 1;
+    case CONSTANT_InvokeDynamic:
+        to[0] = constant->constant_invoke_dynamic.name_and_type_index; // the bootstrap method isn't in the pool
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+// entries are merged bottom up, so the ones an entry refers to have been merged by the time it is
+static int level(uint8_t tag)
+{
+    switch (tag)
+    {
+    case CONSTANT_Class:
+    case CONSTANT_String:
+    case CONSTANT_MethodType:
+    case CONSTANT_NameAndType:
+        return 1;
+    case CONSTANT_Fieldref:
+    case CONSTANT_Methodref:
+    case CONSTANT_InterfaceMethodref:
+        return 2;
+    case CONSTANT_MethodHandle:
+        return 3;
+    case CONSTANT_InvokeDynamic:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+#define LEVELS 5
+
+static uint32_t hash_constant(const struct cp_info_t *constant, const unsigned short *canonical)
+{
+    uint32_t hash = 2166136261u ^ constant->tag;
+    unsigned short to[2];
+    int count = references(constant, to);
+    for (int i = 0; i < count; i++)
+    {
+        hash = (hash ^ canonical[to[i]]) * 16777619u;
+    }
+    switch (constant->tag)
+    {
+    case CONSTANT_Utf8:
+        for (unsigned short i = 0; i < constant->constant_utf8.length; i++)
+        {
+            hash = (hash ^ constant->constant_utf8.bytes[i]) * 16777619u;
+        }
+        break;
+    case CONSTANT_Integer:
+    case CONSTANT_Float:
+        hash = (hash ^ constant->constant_integer.bytes) * 16777619u;
+        break;
+    case CONSTANT_Long:
+    case CONSTANT_Double:
+        hash = (hash ^ constant->constant_long.high_bytes) * 16777619u;
+        hash = (hash ^ constant->constant_long.low_bytes) * 16777619u;
+        break;
+    case CONSTANT_MethodHandle:
+        hash = (hash ^ constant->constant_method_handle.reference_kind) * 16777619u;
+        break;
+    case CONSTANT_InvokeDynamic:
+        hash = (hash ^ constant->constant_invoke_dynamic.bootstrap_method_attr_index) * 16777619u;
+        break;
+    }
+    return hash;
+}
+
+static int same_constant(const struct cp_info_t *a, const struct cp_info_t *b, const unsigned short *canonical)
+{
+    if (a->tag != b->tag)
+    {
+        return 0;
+    }
+    unsigned short from[2], to[2];
+    int count = references(a, from);
+    references(b, to);
+    for (int i = 0; i < count; i++)
+    {
+        if (canonical[from[i]] != canonical[to[i]])
+        {
+            return 0;
+        }
+    }
+    switch (a->tag)
+    {
+    case CONSTANT_Utf8:
+        return a->constant_utf8.length == b->constant_utf8.length &&
+               memcmp(a->constant_utf8.bytes, b->constant_utf8.bytes, a->constant_utf8.length) == 0;
+    case CONSTANT_Integer:
+    case CONSTANT_Float:
+        return a->constant_integer.bytes == b->constant_integer.bytes; // bit for bit, so NaNs stay apart
+    case CONSTANT_Long:
+    case CONSTANT_Double:
+        return a->constant_long.high_bytes == b->constant_long.high_bytes && a->constant_long.low_bytes == b->constant_long.low_bytes;
+    case CONSTANT_MethodHandle:
+        return a->constant_method_handle.reference_kind == b->constant_method_handle.reference_kind;
+    case CONSTANT_InvokeDynamic:
+        return a->constant_invoke_dynamic.bootstrap_method_attr_index == b->constant_invoke_dynamic.bootstrap_method_attr_index;
+    default:
+        return 1;
+    }
+}
+
+// marks what the class refers to from outside the pool, then everything those entries refer to
+static int mark_live(struct walk_t *walk)
+{
+    const struct class_t *class = walk->class;
+    int error = RUM_OK;
+    unsigned short roots[2] = {class->this_class, class->super_class};
+    for (int i = 0; i < 2; i++)
+    {
+        uint8_t bytes[2] = {roots[i] >> 8, roots[i] & 0xff};
+        error = error == RUM_OK ? reference(walk, bytes, 2) : error;
+    }
+    for (unsigned short i = 0; error == RUM_OK && i < class->interfaces_count; i++)
+    {
+        uint8_t bytes[2] = {class->interfaces[i] >> 8, class->interfaces[i] & 0xff};
+        error = reference(walk, bytes, 2);
+    }
+    for (unsigned short i = 0; error == RUM_OK && i < class->fields_count; i++)
+    {
+        const struct field_info_t *field = &class->fields[i];
+        uint8_t bytes[4] = {field->name_index >> 8, field->name_index & 0xff, field->descriptor_index >> 8, field->descriptor_index & 0xff};
+        error = reference(walk, bytes, 2);
+        error = error == RUM_OK ? reference(walk, bytes + 2, 2) : error;
+        error = error == RUM_OK ? walk_attributes(walk, field->attributes, field->attributes_count) : error;
+    }
+    for (unsigned short i = 0; error == RUM_OK && i < class->methods_count; i++)
+    {
+        const struct method_info_t *method = &class->methods[i];
+        uint8_t bytes[4] = {method->name_index >> 8, method->name_index & 0xff, method->descriptor_index >> 8, method->descriptor_index & 0xff};
+        error = reference(walk, bytes, 2);
+        error = error == RUM_OK ? reference(walk, bytes + 2, 2) : error;
+        error = error == RUM_OK ? walk_attributes(walk, method->attributes, method->attributes_count) : error;
+    }
+    if (error == RUM_OK)
+    {
+        error = walk_attributes(walk, class->attributes, class->attribute_count);
+    }
+
+    while (error == RUM_OK && walk->depth > 0)
+    {
+        const struct cp_info_t *constant = &class->constant_pool[walk->stack[--walk->depth] - 1];
+        unsigned short to[2];
+        int count = references(constant, to);
+        for (int i = 0; error == RUM_OK && i < count; i++)
+        {
+            uint8_t bytes[2] = {to[i] >> 8, to[i] & 0xff};
+            error = to[i] == 0 ? RUM_ERR_TAG : reference(walk, bytes, 2);
+        }
+    }
+    return error;
+}
+
+int rum_pool_compact(const struct class_t *class, int flags, unsigned short *map, unsigned short *count)
+{
+    unsigned short slots = class->constant_pool_count;
+    size_t table_size = 16;
+    while (table_size < (size_t)slots * 2)
+    {
+        table_size *= 2;
+    }
+    // live flags, a stack of them, the canonical entry of each and the hash table of canonical entries
+    uint8_t *block = malloc((size_t)slots + (size_t)slots * sizeof(unsigned short) * 2 + table_size * sizeof(unsigned short));
+    if (block == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    unsigned short *stack = (unsigned short *)block;
+    unsigned short *canonical = stack + slots;
+    unsigned short *table = canonical + slots;
+    uint8_t *live = (uint8_t *)(table + table_size);
+    memset(live, 0, slots);
+    memset(table, 0, table_size * sizeof(unsigned short));
+
+    struct walk_t walk = {
+        .class = class,
+        .flags = flags,
+        .data = class->data,
+        .live = live,
+        .stack = stack};
+    int error = mark_live(&walk);
+    if (error != RUM_OK)
+    {
+        free(block);
+        return error;
+    }
+
+    for (unsigned short i = 0; i < slots; i++)
+    {
+        canonical[i] = i;
+    }
+    // live entries bucketed by level, in index order within each, into the stack marking emptied
+    size_t starts[LEVELS + 1] = {0};
+    for (unsigned short i = 1; i < slots; i++)
+    {
+        starts[level(class->constant_pool[i - 1].tag) + 1] += live[i];
+    }
+    for (int pass = 0; pass < LEVELS; pass++)
+    {
+        starts[pass + 1] += starts[pass];
+    }
+    size_t total = starts[LEVELS];
+    for (unsigned short i = 1; i < slots; i++)
+    {
+        if (live[i])
+        {
+            stack[starts[level(class->constant_pool[i - 1].tag)]++] = i;
+        }
+    }
+
+    // the first of equal entries stands for all of them, which keeps every index moving down
+    for (size_t k = 0; k < total; k++)
+    {
+        unsigned short i = stack[k];
+        const struct cp_info_t *constant = &class->constant_pool[i - 1];
+        size_t slot = hash_constant(constant, canonical) & (table_size - 1);
+        while (table[slot] != 0 && !same_constant(&class->constant_pool[table[slot] - 1], constant, canonical))
+        {
+            slot = (slot + 1) & (table_size - 1);
+        }
+        if (table[slot] == 0)
+        {
+            table[slot] = i;
+        }
+        canonical[i] = table[slot];
+    }
+
+    // entries keep their order, so each one ends up at or below where it was and ldc keeps fitting
+    unsigned short next = 1;
+    map[0] = 0;
+    for (unsigned short i = 1; i < slots; i++)
+    {
+        if (!live[i])
+        {
+            map[i] = 0;
+            continue;
+        }
+        if (canonical[i] == i)
+        {
+            uint8_t tag = class->constant_pool[i - 1].tag;
+            map[i] = next;
+            next += tag == CONSTANT_Long || tag == CONSTANT_Double ? 2 : 1;
+        }
+        else
+        {
+            map[i] = map[canonical[i]];
+        }
+    }
+    *count = next;
+    free(block);
+    return RUM_OK;
+}
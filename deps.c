@@ -0,0 +1,591 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "rum.h"
+
+#define DEPS_MAGIC 0x444d5552 // "RUMD"
+#define DEPS_VERSION 1
+#define NAMES_SEED 0x4e414d45
+
+void rum_names_free(struct rum_names_t *names)
+{
+    free(names->slots);
+    free(names->offsets);
+    free(names->hashes);
+    free(names->strings);
+    memset(names, 0, sizeof(struct rum_names_t));
+}
+
+// doubles the slots once they are half full, rehashing by the stored hashes
+static int names_grow(struct rum_names_t *names)
+{
+    uint32_t slot_count = names->slot_count == 0 ? 256 : names->slot_count * 2;
+    uint32_t *slots = malloc(sizeof(uint32_t) * slot_count);
+    uint32_t *offsets = realloc(names->offsets, sizeof(uint32_t) * (slot_count / 2 + 1));
+    names->offsets = offsets != NULL ? offsets : names->offsets;
+    uint64_t *hashes = realloc(names->hashes, sizeof(uint64_t) * (slot_count / 2));
+    names->hashes = hashes != NULL ? hashes : names->hashes;
+    if (slots == NULL || offsets == NULL || hashes == NULL)
+    {
+        free(slots);
+        return RUM_ERR_NOMEM;
+    }
+    offsets[0] = 0;
+    memset(slots, 0xff, sizeof(uint32_t) * slot_count);
+    for (uint32_t i = 0; i < names->count; i++)
+    {
+        uint32_t slot = (uint32_t)hashes[i] & (slot_count - 1);
+        while (slots[slot] != RUM_HIERARCHY_NONE)
+        {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+        slots[slot] = i;
+    }
+    free(names->slots);
+    names->slots = slots;
+    names->slot_count = slot_count;
+    names->capacity = slot_count / 2;
+    return RUM_OK;
+}
+
+uint32_t rum_names_find(const struct rum_names_t *names, const char *name, size_t length)
+{
+    if (names->slot_count == 0)
+    {
+        return RUM_HIERARCHY_NONE;
+    }
+    uint64_t hash = rum_hash_bytes((const uint8_t *)name, length, NAMES_SEED);
+    uint32_t mask = names->slot_count - 1;
+    for (uint32_t slot = (uint32_t)hash & mask;; slot = (slot + 1) & mask)
+    {
+        uint32_t id = names->slots[slot];
+        if (id == RUM_HIERARCHY_NONE)
+        {
+            return RUM_HIERARCHY_NONE;
+        }
+        const char *found = names->strings + names->offsets[id];
+        if (names->hashes[id] == hash && names->offsets[id + 1] - names->offsets[id] == length + 1 && memcmp(found, name, length) == 0)
+        {
+            return id;
+        }
+    }
+}
+
+uint32_t rum_names_add(struct rum_names_t *names, const char *name, size_t length)
+{
+    uint32_t id = rum_names_find(names, name, length);
+    if (id != RUM_HIERARCHY_NONE)
+    {
+        return id;
+    }
+    if ((names->count == names->capacity && names_grow(names) != RUM_OK) || names->strings_size + length + 1 >= UINT32_MAX)
+    {
+        return RUM_HIERARCHY_NONE;
+    }
+    if (names->strings_size + length + 1 > names->strings_capacity)
+    {
+        size_t capacity = (names->strings_capacity + length + 1) * 2;
+        char *strings = realloc(names->strings, capacity);
+        if (strings == NULL)
+        {
+            return RUM_HIERARCHY_NONE;
+        }
+        names->strings = strings;
+        names->strings_capacity = capacity;
+    }
+    uint64_t hash = rum_hash_bytes((const uint8_t *)name, length, NAMES_SEED);
+    uint32_t mask = names->slot_count - 1;
+    uint32_t slot = (uint32_t)hash & mask;
+    while (names->slots[slot] != RUM_HIERARCHY_NONE)
+    {
+        slot = (slot + 1) & mask;
+    }
+    id = names->count++;
+    names->slots[slot] = id;
+    names->hashes[id] = hash;
+    memcpy(names->strings + names->strings_size, name, length);
+    names->strings[names->strings_size + length] = '\0';
+    names->strings_size += length + 1;
+    // offsets[count] is always where the next name goes, so lengths are a subtraction
+    names->offsets[id + 1] = (uint32_t)names->strings_size;
+    return id;
+}
+
+const char *rum_names_get(const struct rum_names_t *names, uint32_t id)
+{
+    return names->strings + names->offsets[id];
+}
+
+struct deps_worker_t
+{
+    struct class_t *class;
+    struct rum_loader_t loader;
+    struct rum_names_t names;
+    uint32_t *found; // the current class's dependencies, before they are made unique
+    size_t found_count;
+    size_t found_capacity;
+    uint32_t *edges; // pairs of local ids, from and to
+    size_t edge_count;
+    size_t edge_capacity;
+    uint32_t *defined; // local ids of the classes this worker read
+    size_t defined_count;
+    size_t defined_capacity;
+    int error;
+};
+
+struct deps_build_t
+{
+    const struct rum_classpath_t *classpath;
+    struct deps_worker_t *workers;
+};
+
+static void add_type(struct deps_worker_t *worker, const uint8_t *name, size_t length)
+{
+    uint32_t id = rum_names_add(&worker->names, (const char *)name, length);
+    uint32_t *found = id == RUM_HIERARCHY_NONE ? NULL : array_grow(worker->found, &worker->found_capacity, worker->found_count + 1, sizeof(uint32_t));
+    if (found == NULL)
+    {
+        worker->error = RUM_ERR_NOMEM;
+        return;
+    }
+    worker->found = found;
+    worker->found[worker->found_count++] = id;
+}
+
+// every class a field or method descriptor names, "L...;" wherever a type can start
+static void add_descriptor(struct deps_worker_t *worker, const uint8_t *descriptor, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        if (descriptor[i] != 'L')
+        {
+            continue; // primitives, '[', '(' and ')'
+        }
+        const uint8_t *end = memchr(descriptor + i, ';', length - i);
+        if (end == NULL)
+        {
+            return;
+        }
+        add_type(worker, descriptor + i + 1, (size_t)(end - descriptor) - i - 1);
+        i = (size_t)(end - descriptor);
+    }
+}
+
+static void add_utf8_descriptor(struct deps_worker_t *worker, const struct class_t *class, unsigned short index)
+{
+    const struct constant_utf8_t *utf8 = rum_constant_utf8(class, index);
+    if (utf8 != NULL)
+    {
+        add_descriptor(worker, utf8->bytes, utf8->length);
+    }
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Class entries, the descriptors of member references, method types and the class's own members
+static void deps_job(void *user, size_t index, int id)
+{
+    struct deps_build_t *build = user;
+    struct deps_worker_t *worker = &build->workers[id];
+    struct class_t *class = worker->class;
+    const uint8_t *data;
+    size_t length;
+    if (worker->error != RUM_OK || rum_classpath_load(build->classpath, index, &worker->loader, &data, &length) != RUM_OK ||
+        rum_class_parse_buffer(class, data, length) != RUM_OK)
+    {
+        return;
+    }
+    const struct constant_utf8_t *this_name = rum_constant_class_name(class, class->this_class);
+    if (this_name == NULL)
+    {
+        return;
+    }
+    uint32_t self = rum_names_add(&worker->names, (const char *)this_name->bytes, this_name->length);
+    uint32_t *defined = self == RUM_HIERARCHY_NONE ? NULL : array_grow(worker->defined, &worker->defined_capacity, worker->defined_count + 1, sizeof(uint32_t));
+    if (defined == NULL)
+    {
+        worker->error = RUM_ERR_NOMEM;
+        return;
+    }
+    worker->defined = defined;
+    worker->defined[worker->defined_count++] = self;
+
+    worker->found_count = 0;
+    for (unsigned short i = 0; i + 1 < class->constant_pool_count; i++)
+    {
+        const struct cp_info_t *constant = &class->constant_pool[i];
+        if (constant->tag == CONSTANT_Class)
+        {
+            // array classes are named by their descriptor
+            const struct constant_utf8_t *name = rum_constant_utf8(class, constant->constant_class.name_index);
+            if (name != NULL && name->length > 0 && name->bytes[0] == '[')
+            {
+                add_descriptor(worker, name->bytes, name->length);
+            }
+            else if (name != NULL)
+            {
+                add_type(worker, name->bytes, name->length);
+            }
+        }
+        else if (constant->tag == CONSTANT_NameAndType)
+        {
+            add_utf8_descriptor(worker, class, constant->constant_name_and_type_info.descriptor_index);
+        }
+        else if (constant->tag == CONSTANT_MethodType)
+        {
+            add_utf8_descriptor(worker, class, constant->constant_method_type.descriptor_index);
+        }
+    }
+    for (unsigned short i = 0; i < class->fields_count; i++)
+    {
+        add_utf8_descriptor(worker, class, class->fields[i].descriptor_index);
+    }
+    for (unsigned short i = 0; i < class->methods_count; i++)
+    {
+        add_utf8_descriptor(worker, class, class->methods[i].descriptor_index);
+    }
+
+    qsort(worker->found, worker->found_count, sizeof(uint32_t), compare_u32);
+    for (size_t i = 0; worker->error == RUM_OK && i < worker->found_count; i++)
+    {
+        if (worker->found[i] == self || (i > 0 && worker->found[i] == worker->found[i - 1]))
+        {
+            continue;
+        }
+        uint32_t *edges = array_grow(worker->edges, &worker->edge_capacity, worker->edge_count * 2 + 2, sizeof(uint32_t));
+        if (edges == NULL)
+        {
+            worker->error = RUM_ERR_NOMEM;
+            return;
+        }
+        worker->edges = edges;
+        worker->edges[worker->edge_count * 2] = self;
+        worker->edges[worker->edge_count * 2 + 1] = worker->found[i];
+        worker->edge_count++;
+    }
+}
+
+// merges the workers' names and edges into compressed rows, each row sorted and unique
+static int merge(struct rum_deps_t *deps, struct deps_build_t *build, int threads)
+{
+    uint32_t **maps = calloc((size_t)threads, sizeof(uint32_t *));
+    int error = maps == NULL ? RUM_ERR_NOMEM : RUM_OK;
+    size_t edges = 0;
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        const struct deps_worker_t *worker = &build->workers[w];
+        maps[w] = malloc(sizeof(uint32_t) * ((size_t)worker->names.count + 1));
+        error = maps[w] == NULL ? RUM_ERR_NOMEM : RUM_OK;
+        for (uint32_t n = 0; error == RUM_OK && n < worker->names.count; n++)
+        {
+            const char *name = rum_names_get(&worker->names, n);
+            maps[w][n] = rum_names_add(&deps->names, name, worker->names.offsets[n + 1] - worker->names.offsets[n] - 1);
+            error = maps[w][n] == RUM_HIERARCHY_NONE ? RUM_ERR_NOMEM : RUM_OK;
+        }
+        edges += worker->edge_count;
+    }
+    uint32_t count = deps->names.count;
+    deps->count = count;
+    deps->flags = calloc((size_t)count + 1, sizeof(uint8_t));
+    deps->offsets = calloc((size_t)count + 2, sizeof(uint32_t));
+    deps->targets = malloc(sizeof(uint32_t) * (edges + 1));
+    if (error == RUM_OK && (deps->flags == NULL || deps->offsets == NULL || deps->targets == NULL || edges >= UINT32_MAX))
+    {
+        error = RUM_ERR_NOMEM;
+    }
+
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        const struct deps_worker_t *worker = &build->workers[w];
+        for (size_t d = 0; d < worker->defined_count; d++)
+        {
+            deps->flags[maps[w][worker->defined[d]]] |= RUM_TYPE_DEFINED;
+        }
+        for (size_t e = 0; e < worker->edge_count; e++)
+        {
+            deps->offsets[maps[w][worker->edges[2 * e]] + 1]++;
+        }
+    }
+    for (uint32_t n = 0; error == RUM_OK && n < count; n++)
+    {
+        deps->offsets[n + 1] += deps->offsets[n];
+    }
+    // filled through offsets[n], which ends up where row n ends
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        const struct deps_worker_t *worker = &build->workers[w];
+        for (size_t e = 0; e < worker->edge_count; e++)
+        {
+            uint32_t from = maps[w][worker->edges[2 * e]];
+            deps->targets[deps->offsets[from]++] = maps[w][worker->edges[2 * e + 1]];
+        }
+    }
+    // every row is at offsets[n - 1] to offsets[n] now, shifted back into place while deduplicating
+    uint32_t written = 0, begin = 0;
+    for (uint32_t n = 0; error == RUM_OK && n < count; n++)
+    {
+        uint32_t end = deps->offsets[n];
+        qsort(deps->targets + begin, end - begin, sizeof(uint32_t), compare_u32);
+        deps->offsets[n] = written;
+        for (uint32_t e = begin; e < end; e++)
+        {
+            // a class defined twice in the classpath comes with its edges twice
+            if (e == begin || deps->targets[e] != deps->targets[e - 1])
+            {
+                deps->targets[written++] = deps->targets[e];
+            }
+        }
+        begin = end;
+    }
+    if (error == RUM_OK)
+    {
+        deps->offsets[count] = written;
+        deps->edge_count = written;
+    }
+    for (int w = 0; maps != NULL && w < threads; w++)
+    {
+        free(maps[w]);
+    }
+    free(maps);
+    return error;
+}
+
+int rum_deps_build(struct rum_deps_t *deps, const struct rum_classpath_t *classpath, int threads)
+{
+    memset(deps, 0, sizeof(struct rum_deps_t));
+    struct deps_build_t build = {
+        .classpath = classpath,
+        .workers = calloc((size_t)threads, sizeof(struct deps_worker_t))};
+    int error = build.workers == NULL ? RUM_ERR_NOMEM : RUM_OK;
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        build.workers[w].class = rum_class_new();
+        error = build.workers[w].class == NULL ? RUM_ERR_NOMEM : RUM_OK;
+    }
+    if (error == RUM_OK)
+    {
+        error = rum_parallel_for(classpath->count, threads, deps_job, &build);
+    }
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        error = build.workers[w].error;
+    }
+    if (error == RUM_OK)
+    {
+        error = merge(deps, &build, threads);
+    }
+
+    for (int w = 0; build.workers != NULL && w < threads; w++)
+    {
+        struct deps_worker_t *worker = &build.workers[w];
+        rum_class_free(worker->class);
+        rum_loader_release(&worker->loader);
+        rum_names_free(&worker->names);
+        free(worker->found);
+        free(worker->edges);
+        free(worker->defined);
+    }
+    free(build.workers);
+    if (error != RUM_OK)
+    {
+        rum_deps_free(deps);
+    }
+    return error;
+}
+
+void rum_deps_free(struct rum_deps_t *deps)
+{
+    rum_names_free(&deps->names);
+    free(deps->flags);
+    free(deps->offsets);
+    free(deps->targets);
+    memset(deps, 0, sizeof(struct rum_deps_t));
+}
+
+// Tarjan's algorithm without recursion. Components come out after everything they depend on, so a
+// component's layer is one more than the highest of the components it has edges into
+int rum_deps_components(const struct rum_deps_t *deps, uint32_t *components, uint32_t *layers, uint32_t *component_count)
+{
+    uint32_t count = deps->count;
+    uint32_t *lowlink = malloc(sizeof(uint32_t) * ((size_t)count + 1));
+    uint32_t *order = malloc(sizeof(uint32_t) * ((size_t)count + 1));
+    uint32_t *stack = malloc(sizeof(uint32_t) * ((size_t)count + 1));
+    uint32_t *calls = malloc(sizeof(uint32_t) * 2 * ((size_t)count + 1)); // node and next edge of every frame
+    if (lowlink == NULL || order == NULL || stack == NULL || calls == NULL)
+    {
+        free(lowlink);
+        free(order);
+        free(stack);
+        free(calls);
+        return RUM_ERR_NOMEM;
+    }
+    for (uint32_t n = 0; n < count; n++)
+    {
+        order[n] = RUM_HIERARCHY_NONE;
+        components[n] = RUM_HIERARCHY_NONE;
+    }
+
+    uint32_t next = 0, depth = 0, frames = 0;
+    *component_count = 0;
+    for (uint32_t root = 0; root < count; root++)
+    {
+        if (order[root] != RUM_HIERARCHY_NONE)
+        {
+            continue;
+        }
+        order[root] = lowlink[root] = next++;
+        stack[depth++] = root;
+        calls[0] = root;
+        calls[1] = deps->offsets[root];
+        frames = 1;
+        while (frames > 0)
+        {
+            uint32_t node = calls[2 * (frames - 1)];
+            uint32_t *edge = &calls[2 * (frames - 1) + 1];
+            if (*edge < deps->offsets[node + 1])
+            {
+                uint32_t target = deps->targets[(*edge)++];
+                if (order[target] == RUM_HIERARCHY_NONE)
+                {
+                    order[target] = lowlink[target] = next++;
+                    stack[depth++] = target;
+                    calls[2 * frames] = target;
+                    calls[2 * frames + 1] = deps->offsets[target];
+                    frames++;
+                }
+                else if (components[target] == RUM_HIERARCHY_NONE && order[target] < lowlink[node])
+                {
+                    lowlink[node] = order[target]; // still on the stack
+                }
+                continue;
+            }
+
+            frames--;
+            if (frames > 0)
+            {
+                uint32_t parent = calls[2 * (frames - 1)];
+                lowlink[parent] = lowlink[node] < lowlink[parent] ? lowlink[node] : lowlink[parent];
+            }
+            if (lowlink[node] != order[node])
+            {
+                continue;
+            }
+            // `node` roots a component, everything above it on the stack belongs to it
+            uint32_t component = (*component_count)++;
+            uint32_t layer = 0;
+            uint32_t bottom = depth;
+            do
+            {
+                components[stack[--bottom]] = component;
+            } while (stack[bottom] != node);
+            for (uint32_t i = bottom; i < depth; i++)
+            {
+                for (uint32_t e = deps->offsets[stack[i]]; e < deps->offsets[stack[i] + 1]; e++)
+                {
+                    uint32_t target = components[deps->targets[e]];
+                    if (target != component && layers[target] + 1 > layer)
+                    {
+                        layer = layers[target] + 1;
+                    }
+                }
+            }
+            // layers are indexed by component while the walk runs, and moved to the nodes at the end
+            layers[component] = layer;
+            depth = bottom;
+        }
+    }
+    for (uint32_t n = 0; n < *component_count; n++)
+    {
+        order[n] = layers[n];
+    }
+    for (uint32_t n = 0; n < count; n++)
+    {
+        layers[n] = order[components[n]];
+    }
+    free(lowlink);
+    free(order);
+    free(stack);
+    free(calls);
+    return RUM_OK;
+}
+
+// a name as a quoted DOT id or CSV field, which both escape a quote by what comes before it
+static void write_quoted(FILE *out, const char *name, char escape)
+{
+    fputc('"', out);
+    for (; *name != '\0'; name++)
+    {
+        if (*name == '"' || (escape == '\\' && *name == '\\'))
+        {
+            fputc(escape, out);
+        }
+        fputc(*name, out);
+    }
+    fputc('"', out);
+}
+
+static int write_text(const struct rum_deps_t *deps, FILE *out, int format)
+{
+    char escape = format == RUM_DEPS_DOT ? '\\' : '"';
+    fprintf(out, format == RUM_DEPS_DOT ? "digraph dependencies {\n" : "from,to\n");
+    for (uint32_t n = 0; format == RUM_DEPS_DOT && n < deps->count; n++)
+    {
+        // classes that aren't in the classpath are drawn dashed
+        if (!(deps->flags[n] & RUM_TYPE_DEFINED))
+        {
+            fprintf(out, "    ");
+            write_quoted(out, rum_names_get(&deps->names, n), escape);
+            fprintf(out, " [style=dashed];\n");
+        }
+    }
+    for (uint32_t n = 0; n < deps->count; n++)
+    {
+        for (uint32_t e = deps->offsets[n]; e < deps->offsets[n + 1]; e++)
+        {
+            fprintf(out, format == RUM_DEPS_DOT ? "    " : "");
+            write_quoted(out, rum_names_get(&deps->names, n), escape);
+            fprintf(out, format == RUM_DEPS_DOT ? " -> " : ",");
+            write_quoted(out, rum_names_get(&deps->names, deps->targets[e]), escape);
+            fprintf(out, format == RUM_DEPS_DOT ? ";\n" : "\n");
+        }
+    }
+    fprintf(out, format == RUM_DEPS_DOT ? "}\n" : "");
+    return ferror(out) ? RUM_ERR_IO : RUM_OK;
+}
+
+int rum_deps_write(const struct rum_deps_t *deps, FILE *out, int format)
+{
+    if (format != RUM_DEPS_BINARY)
+    {
+        return write_text(deps, out, format);
+    }
+    // the header, the row offsets, the targets, the name offsets, a byte of flags per node and the names
+    struct
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t count;
+        uint32_t edge_count;
+        uint64_t names_size;
+    } header = {DEPS_MAGIC, DEPS_VERSION, deps->count, deps->edge_count, deps->names.strings_size};
+    // an empty classpath interns no names, so there's no offsets array to write its one offset from
+    static const uint32_t no_names = 0;
+    const uint32_t *name_offsets = deps->count == 0 ? &no_names : deps->names.offsets;
+    int written = fwrite(&header, sizeof(header), 1, out) == 1 &&
+                  fwrite(deps->offsets, sizeof(uint32_t), (size_t)deps->count + 1, out) == (size_t)deps->count + 1 &&
+                  fwrite(deps->targets, sizeof(uint32_t), deps->edge_count, out) == deps->edge_count &&
+                  fwrite(name_offsets, sizeof(uint32_t), (size_t)deps->count + 1, out) == (size_t)deps->count + 1 &&
+                  fwrite(deps->flags, 1, deps->count, out) == deps->count &&
+                  fwrite(deps->names.strings, 1, deps->names.strings_size, out) == deps->names.strings_size;
+    return written ? RUM_OK : RUM_ERR_IO;
+}
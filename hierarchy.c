@@ -0,0 +1,489 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "rum.h"
+
+#define HIERARCHY_SEED 0x48494552
+
+// what every worker found for its classes: access flags, the number of names, then this, super
+// and the interfaces as a u16 length followed by the bytes
+struct collect_t
+{
+    const struct rum_classpath_t *classpath;
+    struct rum_loader_t *loaders;
+    uint8_t **found; // per entry, NULL when it couldn't be summarized
+};
+
+static void collect_job(void *user, size_t index, int worker)
+{
+    struct collect_t *collect = user;
+    const uint8_t *data;
+    size_t length;
+    struct rum_summary_t summary;
+    if (rum_classpath_load(collect->classpath, index, &collect->loaders[worker], &data, &length) != RUM_OK ||
+        rum_summarize(data, length, &summary) != RUM_OK)
+    {
+        return;
+    }
+    size_t count = 2 + (summary.interfaces_count < RUM_SUMMARY_INTERFACES ? summary.interfaces_count : RUM_SUMMARY_INTERFACES);
+    const struct rum_name_t *names[RUM_SUMMARY_INTERFACES + 2] = {&summary.this_class, &summary.super_class};
+    size_t size = 4;
+    for (size_t i = 0; i < count; i++)
+    {
+        names[i] = i < 2 ? names[i] : &summary.interfaces[i - 2];
+        size += 2 + (size_t)names[i]->length;
+    }
+    uint8_t *record = malloc(size);
+    if (record == NULL)
+    {
+        return;
+    }
+    memcpy(record, &summary.access_flags, 2);
+    memcpy(record + 2, &(unsigned short){(unsigned short)count}, 2);
+    size = 4;
+    for (size_t i = 0; i < count; i++)
+    {
+        memcpy(record + size, &names[i]->length, 2);
+        if (names[i]->length != 0)
+        {
+            memcpy(record + size + 2, names[i]->bytes, names[i]->length); // a missing super class has no bytes at all
+        }
+        size += 2 + (size_t)names[i]->length;
+    }
+    collect->found[index] = record;
+}
+
+static const char *node_name(const struct rum_hierarchy_t *hierarchy, uint32_t node)
+{
+    return hierarchy->names + hierarchy->name_offsets[node];
+}
+
+uint32_t rum_hierarchy_find(const struct rum_hierarchy_t *hierarchy, const char *name, size_t length)
+{
+    uint64_t hash = rum_hash_bytes((const uint8_t *)name, length, HIERARCHY_SEED);
+    uint32_t mask = hierarchy->slot_count - 1;
+    for (uint32_t slot = (uint32_t)hash & mask;; slot = (slot + 1) & mask)
+    {
+        uint32_t node = hierarchy->slots[slot];
+        if (node == RUM_HIERARCHY_NONE)
+        {
+            return RUM_HIERARCHY_NONE;
+        }
+        const char *found = node_name(hierarchy, node);
+        if (strncmp(found, name, length) == 0 && found[length] == '\0')
+        {
+            return node;
+        }
+    }
+}
+
+const char *rum_hierarchy_name(const struct rum_hierarchy_t *hierarchy, uint32_t node)
+{
+    return node_name(hierarchy, node);
+}
+
+// the node called `name`, added if it isn't there yet
+static uint32_t intern(struct rum_hierarchy_t *hierarchy, size_t *names_capacity, const char *name, size_t length)
+{
+    uint32_t node = rum_hierarchy_find(hierarchy, name, length);
+    if (node != RUM_HIERARCHY_NONE)
+    {
+        return node;
+    }
+    if (hierarchy->names_size + length + 1 > *names_capacity)
+    {
+        size_t capacity = (*names_capacity + length + 1) * 2;
+        char *names = realloc(hierarchy->names, capacity);
+        if (names == NULL)
+        {
+            return RUM_HIERARCHY_NONE;
+        }
+        hierarchy->names = names;
+        *names_capacity = capacity;
+    }
+    node = hierarchy->count++;
+    hierarchy->name_offsets[node] = (uint32_t)hierarchy->names_size;
+    memcpy(hierarchy->names + hierarchy->names_size, name, length);
+    hierarchy->names[hierarchy->names_size + length] = '\0';
+    hierarchy->names_size += length + 1;
+
+    uint64_t hash = rum_hash_bytes((const uint8_t *)name, length, HIERARCHY_SEED);
+    uint32_t mask = hierarchy->slot_count - 1;
+    uint32_t slot = (uint32_t)hash & mask;
+    while (hierarchy->slots[slot] != RUM_HIERARCHY_NONE)
+    {
+        slot = (slot + 1) & mask;
+    }
+    hierarchy->slots[slot] = node;
+    return node;
+}
+
+// counting sort of the edges into compressed rows, `from` of every edge being the row
+static int build_rows(uint32_t count, const uint32_t *from, const uint32_t *to, size_t edges, uint32_t **offsets, uint32_t **targets)
+{
+    *offsets = calloc((size_t)count + 1, sizeof(uint32_t));
+    *targets = malloc(sizeof(uint32_t) * (edges + 1));
+    if (*offsets == NULL || *targets == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    for (size_t i = 0; i < edges; i++)
+    {
+        (*offsets)[from[i]]++;
+    }
+    // each row's end, then filled back to front so every row ends up at its start with the edges in
+    // the order they were found
+    for (uint32_t i = 1; i < count; i++)
+    {
+        (*offsets)[i] += (*offsets)[i - 1];
+    }
+    (*offsets)[count] = (uint32_t)edges;
+    for (size_t i = edges; i-- > 0;)
+    {
+        (*targets)[--(*offsets)[from[i]]] = to[i];
+    }
+    return RUM_OK;
+}
+
+// preorder numbers over the superclass forest, every subclass of a class is numbered inside its
+// interval. The stack holds nodes and how far through their subtypes the walk got
+static int number_classes(struct rum_hierarchy_t *hierarchy)
+{
+    uint32_t count = hierarchy->count;
+    hierarchy->first = malloc(sizeof(uint32_t) * ((size_t)count + 1));
+    hierarchy->last = malloc(sizeof(uint32_t) * ((size_t)count + 1));
+    hierarchy->order = malloc(sizeof(uint32_t) * ((size_t)count + 1));
+    uint32_t *stack = malloc(sizeof(uint32_t) * 2 * ((size_t)count + 1));
+    if (hierarchy->first == NULL || hierarchy->last == NULL || hierarchy->order == NULL || stack == NULL)
+    {
+        free(stack);
+        return RUM_ERR_NOMEM;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        hierarchy->first[i] = RUM_HIERARCHY_NONE;
+    }
+
+    uint32_t next = 0;
+    // roots first, then whatever a superclass cycle kept out of reach, cut where it was found
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (uint32_t root = 0; root < count; root++)
+        {
+            if (hierarchy->first[root] != RUM_HIERARCHY_NONE || (pass == 0 && hierarchy->superclass[root] != RUM_HIERARCHY_NONE))
+            {
+                continue;
+            }
+            hierarchy->first[root] = next;
+            hierarchy->order[next++] = root;
+            stack[0] = root;
+            stack[1] = hierarchy->sub_offsets[root];
+            size_t depth = 1;
+            while (depth > 0)
+            {
+                uint32_t node = stack[2 * (depth - 1)];
+                uint32_t *edge = &stack[2 * (depth - 1) + 1];
+                if (*edge == hierarchy->sub_offsets[node + 1])
+                {
+                    hierarchy->last[node] = next - 1;
+                    depth--;
+                    continue;
+                }
+                uint32_t sub = hierarchy->subs[(*edge)++];
+                if (hierarchy->superclass[sub] != node || hierarchy->first[sub] != RUM_HIERARCHY_NONE)
+                {
+                    continue;
+                }
+                hierarchy->first[sub] = next;
+                hierarchy->order[next++] = sub;
+                stack[2 * depth] = sub;
+                stack[2 * depth + 1] = hierarchy->sub_offsets[sub];
+                depth++;
+            }
+        }
+    }
+    free(stack);
+    return RUM_OK;
+}
+
+int rum_hierarchy_build(struct rum_hierarchy_t *hierarchy, const struct rum_classpath_t *classpath, int threads)
+{
+    memset(hierarchy, 0, sizeof(struct rum_hierarchy_t));
+    size_t count = classpath->count;
+    struct collect_t collect = {
+        .classpath = classpath,
+        .loaders = calloc((size_t)threads, sizeof(struct rum_loader_t)),
+        .found = calloc(count + 1, sizeof(uint8_t *))};
+    int error = collect.loaders == NULL || collect.found == NULL ? RUM_ERR_NOMEM : RUM_OK;
+    if (error == RUM_OK)
+    {
+        error = rum_parallel_for(count, threads, collect_job, &collect);
+    }
+
+    // every class and every name they mention is a node, at most this many of them
+    size_t nodes = 0;
+    for (size_t i = 0; error == RUM_OK && i < count; i++)
+    {
+        uint16_t names = 0;
+        if (collect.found[i] != NULL)
+        {
+            memcpy(&names, collect.found[i] + 2, 2);
+        }
+        nodes += names;
+    }
+    if (error == RUM_OK && nodes >= UINT32_MAX / 4)
+    {
+        error = RUM_ERR_NOMEM;
+    }
+    hierarchy->slot_count = 2;
+    while (hierarchy->slot_count < nodes * 2)
+    {
+        hierarchy->slot_count *= 2;
+    }
+    size_t names_capacity = 0;
+    uint32_t *from = malloc(sizeof(uint32_t) * 2 * (nodes + 1));
+    uint32_t *to = malloc(sizeof(uint32_t) * 2 * (nodes + 1));
+    hierarchy->slots = malloc(sizeof(uint32_t) * hierarchy->slot_count);
+    hierarchy->name_offsets = malloc(sizeof(uint32_t) * (nodes + 1));
+    hierarchy->flags = calloc(nodes + 1, sizeof(uint8_t));
+    hierarchy->access_flags = calloc(nodes + 1, sizeof(unsigned short));
+    hierarchy->superclass = malloc(sizeof(uint32_t) * (nodes + 1));
+    if (error == RUM_OK && (from == NULL || to == NULL || hierarchy->slots == NULL || hierarchy->name_offsets == NULL ||
+                            hierarchy->flags == NULL || hierarchy->access_flags == NULL || hierarchy->superclass == NULL))
+    {
+        error = RUM_ERR_NOMEM;
+    }
+    if (error == RUM_OK)
+    {
+        memset(hierarchy->slots, 0xff, sizeof(uint32_t) * hierarchy->slot_count);
+        memset(hierarchy->superclass, 0xff, sizeof(uint32_t) * (nodes + 1));
+    }
+
+    // in classpath order, so the first definition of a name is the one that counts as on the JVM
+    size_t edges = 0;
+    for (size_t i = 0; error == RUM_OK && i < count; i++)
+    {
+        const uint8_t *record = collect.found[i];
+        if (record == NULL)
+        {
+            continue;
+        }
+        uint16_t access_flags, names, length;
+        memcpy(&access_flags, record, 2);
+        memcpy(&names, record + 2, 2);
+        memcpy(&length, record + 4, 2);
+        uint32_t node = intern(hierarchy, &names_capacity, (const char *)record + 6, length);
+        if (node == RUM_HIERARCHY_NONE)
+        {
+            error = RUM_ERR_NOMEM;
+            break;
+        }
+        if (hierarchy->flags[node] & RUM_TYPE_DEFINED)
+        {
+            continue;
+        }
+        hierarchy->flags[node] = RUM_TYPE_DEFINED | (access_flags & ACC_INTERFACE ? RUM_TYPE_INTERFACE : 0);
+        hierarchy->access_flags[node] = access_flags;
+
+        size_t offset = 6 + (size_t)length;
+        for (uint16_t n = 1; n < names; n++)
+        {
+            memcpy(&length, record + offset, 2);
+            const char *name = (const char *)record + offset + 2;
+            offset += 2 + (size_t)length;
+            if (n == 1 && length == 0)
+            {
+                continue; // java/lang/Object
+            }
+            uint32_t super = intern(hierarchy, &names_capacity, name, length);
+            if (super == RUM_HIERARCHY_NONE)
+            {
+                error = RUM_ERR_NOMEM;
+                break;
+            }
+            // a type only ever named can't say what it is, how it's used is the best guess
+            if (!(hierarchy->flags[super] & RUM_TYPE_DEFINED) && n > 1)
+            {
+                hierarchy->flags[super] |= RUM_TYPE_INTERFACE;
+            }
+            if (n == 1)
+            {
+                hierarchy->superclass[node] = super;
+            }
+            from[edges] = node;
+            to[edges++] = super;
+        }
+    }
+
+    // types that are only named still extend java/lang/Object, as every class file but its own says
+    uint32_t object = error == RUM_OK && hierarchy->count > 0 ? intern(hierarchy, &names_capacity, "java/lang/Object", 16) : RUM_HIERARCHY_NONE;
+    for (uint32_t node = 0; object != RUM_HIERARCHY_NONE && node < hierarchy->count; node++)
+    {
+        if (!(hierarchy->flags[node] & RUM_TYPE_DEFINED) && node != object)
+        {
+            hierarchy->superclass[node] = object;
+            from[edges] = node;
+            to[edges++] = object;
+        }
+    }
+    if (error == RUM_OK)
+    {
+        error = build_rows(hierarchy->count, from, to, edges, &hierarchy->super_offsets, &hierarchy->supers);
+    }
+    if (error == RUM_OK)
+    {
+        error = build_rows(hierarchy->count, to, from, edges, &hierarchy->sub_offsets, &hierarchy->subs);
+    }
+    if (error == RUM_OK)
+    {
+        error = number_classes(hierarchy);
+    }
+    for (size_t i = 0; collect.found != NULL && i < count; i++)
+    {
+        free(collect.found[i]);
+    }
+    for (int i = 0; collect.loaders != NULL && i < threads; i++)
+    {
+        rum_loader_release(&collect.loaders[i]);
+    }
+    free(collect.loaders);
+    free(collect.found);
+    free(from);
+    free(to);
+    if (error != RUM_OK)
+    {
+        rum_hierarchy_free(hierarchy);
+    }
+    return error;
+}
+
+void rum_hierarchy_free(struct rum_hierarchy_t *hierarchy)
+{
+    free(hierarchy->names);
+    free(hierarchy->name_offsets);
+    free(hierarchy->flags);
+    free(hierarchy->access_flags);
+    free(hierarchy->superclass);
+    free(hierarchy->super_offsets);
+    free(hierarchy->supers);
+    free(hierarchy->sub_offsets);
+    free(hierarchy->subs);
+    free(hierarchy->first);
+    free(hierarchy->last);
+    free(hierarchy->order);
+    free(hierarchy->slots);
+    memset(hierarchy, 0, sizeof(struct rum_hierarchy_t));
+}
+
+int rum_walk_init(struct rum_walk_t *walk, uint32_t count)
+{
+    walk->marks = calloc((size_t)count + 1, sizeof(uint32_t));
+    walk->found = malloc(sizeof(uint32_t) * ((size_t)count + 1));
+    walk->count = count;
+    walk->generation = 0;
+    walk->found_count = 0;
+    return walk->marks == NULL || walk->found == NULL ? RUM_ERR_NOMEM : RUM_OK;
+}
+
+void rum_walk_free(struct rum_walk_t *walk)
+{
+    free(walk->marks);
+    free(walk->found);
+    memset(walk, 0, sizeof(struct rum_walk_t));
+}
+
+// every node is unmarked again without touching the marks
+void rum_walk_begin(struct rum_walk_t *walk)
+{
+    walk->found_count = 0;
+    if (++walk->generation == 0)
+    {
+        memset(walk->marks, 0, sizeof(uint32_t) * ((size_t)walk->count + 1));
+        walk->generation = 1;
+    }
+}
+
+void rum_walk_add(struct rum_walk_t *walk, uint32_t node)
+{
+    if (walk->marks[node] != walk->generation)
+    {
+        walk->marks[node] = walk->generation;
+        walk->found[walk->found_count++] = node;
+    }
+}
+
+int rum_hierarchy_is_subtype(const struct rum_hierarchy_t *hierarchy, struct rum_walk_t *walk, uint32_t node, uint32_t super)
+{
+    if (node == super)
+    {
+        return 1;
+    }
+    // classes only inherit from classes through superclass links, which the intervals cover
+    if (!(hierarchy->flags[super] & RUM_TYPE_INTERFACE))
+    {
+        return hierarchy->first[super] <= hierarchy->first[node] && hierarchy->first[node] <= hierarchy->last[super];
+    }
+    rum_walk_begin(walk);
+    rum_walk_add(walk, node);
+    for (size_t i = 0; i < walk->found_count; i++)
+    {
+        uint32_t current = walk->found[i];
+        for (uint32_t edge = hierarchy->super_offsets[current]; edge < hierarchy->super_offsets[current + 1]; edge++)
+        {
+            if (hierarchy->supers[edge] == super)
+            {
+                return 1;
+            }
+            rum_walk_add(walk, hierarchy->supers[edge]);
+        }
+    }
+    return 0;
+}
+
+size_t rum_hierarchy_supertypes(const struct rum_hierarchy_t *hierarchy, struct rum_walk_t *walk, uint32_t node)
+{
+    rum_walk_begin(walk);
+    rum_walk_add(walk, node);
+    for (size_t i = 0; i < walk->found_count; i++)
+    {
+        uint32_t current = walk->found[i];
+        for (uint32_t edge = hierarchy->super_offsets[current]; edge < hierarchy->super_offsets[current + 1]; edge++)
+        {
+            rum_walk_add(walk, hierarchy->supers[edge]);
+        }
+    }
+    // the node itself isn't one of its supertypes
+    memmove(walk->found, walk->found + 1, sizeof(uint32_t) * --walk->found_count);
+    return walk->found_count;
+}
+
+size_t rum_hierarchy_subtypes(const struct rum_hierarchy_t *hierarchy, struct rum_walk_t *walk, uint32_t node)
+{
+    rum_walk_begin(walk);
+    rum_walk_add(walk, node);
+    for (size_t i = 0; i < walk->found_count; i++)
+    {
+        uint32_t current = walk->found[i];
+        if (!(hierarchy->flags[current] & RUM_TYPE_INTERFACE))
+        {
+            // a class's subtypes are its interval
+            for (uint32_t n = hierarchy->first[current] + 1; n <= hierarchy->last[current]; n++)
+            {
+                rum_walk_add(walk, hierarchy->order[n]);
+            }
+            continue;
+        }
+        for (uint32_t edge = hierarchy->sub_offsets[current]; edge < hierarchy->sub_offsets[current + 1]; edge++)
+        {
+            rum_walk_add(walk, hierarchy->subs[edge]);
+        }
+    }
+    memmove(walk->found, walk->found + 1, sizeof(uint32_t) * --walk->found_count);
+    return walk->found_count;
+}
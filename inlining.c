@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "rum.h"
+
+// whether the Utf8 entry at `index` is the Code attribute name
+static int is_code(const struct rum_pool_t *pool, unsigned short index)
+{
+    unsigned short length;
+    const uint8_t *name = rum_pool_utf8(pool, index, &length);
+    return name != NULL && length == 4 && memcmp(name, "Code", 4) == 0;
+}
+
+// steps over an attribute table, reporting the code_length of a Code attribute in `method` when there is one
+static int scan_attributes(const struct rum_pool_t *pool, struct cursor_t *cursor, struct rum_method_size_t *method,
+                           int (*found)(void *user, const struct rum_method_size_t *method), void *user)
+{
+    unsigned short count = read_u2(cursor);
+    for (unsigned short i = 0; i < count; i++)
+    {
+        unsigned short name = read_u2(cursor);
+        uint32_t length = read_u4(cursor);
+        const uint8_t *bytes = read_bytes(cursor, length);
+        if (cursor->overflow)
+        {
+            return RUM_ERR_TRUNCATED;
+        }
+        if (method == NULL || !is_code(pool, name))
+        {
+            continue;
+        }
+        if (length < 8)
+        {
+            return RUM_ERR_TRUNCATED;
+        }
+        // max_stack and max_locals, then code_length
+        method->code_length = (uint32_t)bytes[4] << 24 | (uint32_t)bytes[5] << 16 | (uint32_t)bytes[6] << 8 | bytes[7];
+        if (found(user, method) != 0)
+        {
+            return RUM_STOPPED;
+        }
+    }
+    return RUM_OK;
+}
+
+int rum_method_sizes(const struct rum_pool_t *pool, int (*found)(void *user, const struct rum_method_size_t *method), void *user)
+{
+    struct cursor_t cursor = {
+        .data = pool->data,
+        .length = pool->length,
+        .offset = pool->end,
+        .overflow = 0};
+    read_bytes(&cursor, 6); // access flags, this and super
+    read_bytes(&cursor, (size_t)read_u2(&cursor) * 2);
+
+    unsigned short fields = read_u2(&cursor);
+    for (unsigned short i = 0; i < fields && !cursor.overflow; i++)
+    {
+        read_bytes(&cursor, 6);
+        int error = scan_attributes(pool, &cursor, NULL, found, user);
+        if (error != RUM_OK)
+        {
+            return error;
+        }
+    }
+
+    unsigned short methods = read_u2(&cursor);
+    for (unsigned short i = 0; i < methods && !cursor.overflow; i++)
+    {
+        struct rum_method_size_t method = {.access_flags = read_u2(&cursor)};
+        unsigned short name = read_u2(&cursor);
+        unsigned short descriptor = read_u2(&cursor);
+        method.name.bytes = rum_pool_utf8(pool, name, &method.name.length);
+        method.descriptor.bytes = rum_pool_utf8(pool, descriptor, &method.descriptor.length);
+        if (!cursor.overflow && (method.name.bytes == NULL || method.descriptor.bytes == NULL))
+        {
+            return RUM_ERR_TAG;
+        }
+        int error = scan_attributes(pool, &cursor, &method, found, user);
+        if (error != RUM_OK)
+        {
+            return error;
+        }
+    }
+    return cursor.overflow ? RUM_ERR_TRUNCATED : RUM_OK;
+}
+
+// a method over at least one limit, as a worker found it. Names are offsets into the worker's strings
+struct flagged_t
+{
+    uint32_t class;
+    uint32_t member; // the name, followed by the descriptor
+    uint16_t class_length;
+    uint16_t name_length;
+    uint16_t descriptor_length;
+    uint16_t flags;
+    uint32_t code_length;
+    uint32_t entry;    // classpath entry, which breaks ties in classpath order
+    uint32_t sequence; // and then in the class file's order
+};
+
+struct inlining_worker_t
+{
+    struct rum_pool_t pool;
+    struct rum_loader_t loader;
+    struct flagged_t *flagged;
+    size_t flagged_count;
+    size_t flagged_capacity;
+    char *strings;
+    size_t strings_size;
+    size_t strings_capacity;
+    uint64_t methods; // with code, flagged or not
+    const uint8_t *class_name; // of the class being scanned, copied once one of its methods is flagged
+    unsigned short class_length;
+    uint32_t class; // RUM_CFG_NONE until then
+    uint32_t entry;
+    uint32_t sequence;
+    int error;
+};
+
+struct inlining_build_t
+{
+    const struct rum_classpath_t *classpath;
+    const struct rum_inline_limits_t *limits;
+    struct inlining_worker_t *workers;
+};
+
+struct size_job_t
+{
+    const struct rum_inline_limits_t *limits;
+    struct inlining_worker_t *worker;
+};
+
+// copies `length` bytes to the end of the worker's strings, returns their offset or RUM_CFG_NONE
+static uint32_t add_string(struct inlining_worker_t *worker, const uint8_t *bytes, size_t length)
+{
+    if (worker->strings_size + length > worker->strings_capacity)
+    {
+        size_t capacity = worker->strings_capacity == 0 ? 65536 : worker->strings_capacity * 2;
+        capacity = capacity < worker->strings_size + length ? worker->strings_size + length : capacity;
+        char *strings = capacity >= UINT32_MAX ? NULL : realloc(worker->strings, capacity);
+        if (strings == NULL)
+        {
+            return RUM_CFG_NONE;
+        }
+        worker->strings = strings;
+        worker->strings_capacity = capacity;
+    }
+    uint32_t offset = (uint32_t)worker->strings_size;
+    memcpy(worker->strings + offset, bytes, length);
+    worker->strings_size += length;
+    return offset;
+}
+
+static int keep_size(void *user, const struct rum_method_size_t *method)
+{
+    struct size_job_t *job = user;
+    struct inlining_worker_t *worker = job->worker;
+    worker->methods++;
+    uint16_t flags = (method->code_length > job->limits->max_inline ? RUM_SIZE_OVER_MAX_INLINE : 0) |
+                     (method->code_length > job->limits->freq_inline ? RUM_SIZE_OVER_FREQ_INLINE : 0) |
+                     (method->code_length > job->limits->huge_method ? RUM_SIZE_HUGE : 0);
+    if (flags == 0)
+    {
+        return 0;
+    }
+    if (worker->flagged_count == worker->flagged_capacity)
+    {
+        size_t capacity = worker->flagged_capacity == 0 ? 1024 : worker->flagged_capacity * 2;
+        struct flagged_t *flagged = realloc(worker->flagged, sizeof(struct flagged_t) * capacity);
+        if (flagged == NULL)
+        {
+            worker->error = RUM_ERR_NOMEM;
+            return 1;
+        }
+        worker->flagged = flagged;
+        worker->flagged_capacity = capacity;
+    }
+    if (worker->class == RUM_CFG_NONE)
+    {
+        worker->class = add_string(worker, worker->class_name, worker->class_length);
+    }
+    uint32_t member = add_string(worker, method->name.bytes, method->name.length);
+    if (worker->class == RUM_CFG_NONE || member == RUM_CFG_NONE || add_string(worker, method->descriptor.bytes, method->descriptor.length) == RUM_CFG_NONE)
+    {
+        worker->error = RUM_ERR_NOMEM;
+        return 1;
+    }
+    worker->flagged[worker->flagged_count++] = (struct flagged_t){
+        .class = worker->class,
+        .member = member,
+        .class_length = worker->class_length,
+        .name_length = method->name.length,
+        .descriptor_length = method->descriptor.length,
+        .flags = flags,
+        .code_length = method->code_length,
+        .entry = worker->entry,
+        .sequence = worker->sequence++};
+    return 0;
+}
+
+// only the pool and the member tables are read, Code attributes are looked at for their length alone.
+// Classes that can't be read are left out, as with the indices
+static void inlining_job(void *user, size_t index, int id)
+{
+    struct inlining_build_t *build = user;
+    struct inlining_worker_t *worker = &build->workers[id];
+    const uint8_t *data;
+    size_t length;
+    struct rum_pool_t *pool = &worker->pool;
+    if (worker->error != RUM_OK || rum_classpath_load(build->classpath, index, &worker->loader, &data, &length) != RUM_OK ||
+        rum_pool_parse(pool, data, length) != RUM_OK || pool->end + 4 > length)
+    {
+        return;
+    }
+    unsigned short this_class = (unsigned short)(data[pool->end + 2] << 8 | data[pool->end + 3]);
+    worker->class_name = this_class == 0 || this_class >= pool->count || pool->tags[this_class] != CONSTANT_Class
+                             ? NULL
+                             : rum_pool_utf8(pool, (unsigned short)pool->values[this_class], &worker->class_length);
+    if (worker->class_name == NULL)
+    {
+        return;
+    }
+    worker->class = RUM_CFG_NONE;
+    worker->entry = (uint32_t)index;
+    worker->sequence = 0;
+
+    // a class that turns out to be malformed past what was kept keeps none of it
+    size_t kept = worker->flagged_count, strings = worker->strings_size;
+    uint64_t methods = worker->methods;
+    struct size_job_t job = {build->limits, worker};
+    if (rum_method_sizes(pool, keep_size, &job) != RUM_OK && worker->error == RUM_OK)
+    {
+        worker->flagged_count = kept;
+        worker->strings_size = strings;
+        worker->methods = methods;
+    }
+}
+
+static int compare_flagged(const void *a, const void *b)
+{
+    const struct flagged_t *x = a, *y = b;
+    if (x->code_length != y->code_length)
+    {
+        return x->code_length > y->code_length ? -1 : 1;
+    }
+    if (x->entry != y->entry)
+    {
+        return x->entry < y->entry ? -1 : 1;
+    }
+    return (x->sequence > y->sequence) - (x->sequence < y->sequence);
+}
+
+// the workers' strings one after the other, and every flagged method ranked largest first
+static int merge(struct rum_inlining_t *inlining, struct inlining_build_t *build, int threads)
+{
+    size_t strings_size = 0, flagged_count = 0;
+    for (int w = 0; w < threads; w++)
+    {
+        strings_size += build->workers[w].strings_size;
+        flagged_count += build->workers[w].flagged_count;
+        inlining->method_count += build->workers[w].methods;
+    }
+    struct flagged_t *flagged = malloc(sizeof(struct flagged_t) * (flagged_count + 1));
+    inlining->strings = malloc(strings_size + 1);
+    inlining->methods = malloc(sizeof(struct rum_inlined_t) * (flagged_count + 1));
+    if (flagged == NULL || inlining->strings == NULL || inlining->methods == NULL || strings_size >= UINT32_MAX)
+    {
+        free(flagged);
+        return RUM_ERR_NOMEM;
+    }
+    size_t base = 0, count = 0;
+    for (int w = 0; w < threads; w++)
+    {
+        const struct inlining_worker_t *worker = &build->workers[w];
+        if (worker->strings_size > 0)
+        {
+            memcpy(inlining->strings + base, worker->strings, worker->strings_size);
+        }
+        for (size_t f = 0; f < worker->flagged_count; f++)
+        {
+            flagged[count] = worker->flagged[f];
+            flagged[count].class += (uint32_t)base;
+            flagged[count].member += (uint32_t)base;
+            count++;
+        }
+        base += worker->strings_size;
+    }
+    qsort(flagged, count, sizeof(struct flagged_t), compare_flagged);
+
+    for (size_t f = 0; f < count; f++)
+    {
+        const struct flagged_t *from = &flagged[f];
+        struct rum_inlined_t *method = &inlining->methods[f];
+        method->class = inlining->strings + from->class;
+        method->class_length = from->class_length;
+        method->name = inlining->strings + from->member;
+        method->name_length = from->name_length;
+        method->descriptor = method->name + from->name_length;
+        method->descriptor_length = from->descriptor_length;
+        method->code_length = from->code_length;
+        method->flags = from->flags;
+        inlining->over_max_inline += (from->flags & RUM_SIZE_OVER_MAX_INLINE) != 0;
+        inlining->over_freq_inline += (from->flags & RUM_SIZE_OVER_FREQ_INLINE) != 0;
+        inlining->huge += (from->flags & RUM_SIZE_HUGE) != 0;
+    }
+    inlining->count = count;
+    free(flagged);
+    return RUM_OK;
+}
+
+int rum_inlining_build(struct rum_inlining_t *inlining, const struct rum_classpath_t *classpath, int threads, const struct rum_inline_limits_t *limits)
+{
+    memset(inlining, 0, sizeof(*inlining));
+    inlining->limits = *limits;
+    struct inlining_build_t build = {classpath, limits, calloc((size_t)threads, sizeof(struct inlining_worker_t))};
+    if (build.workers == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    int error = rum_parallel_for(classpath->count, threads, inlining_job, &build);
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        error = build.workers[w].error;
+    }
+    if (error == RUM_OK)
+    {
+        error = merge(inlining, &build, threads);
+    }
+    for (int w = 0; w < threads; w++)
+    {
+        rum_pool_release(&build.workers[w].pool);
+        rum_loader_release(&build.workers[w].loader);
+        free(build.workers[w].flagged);
+        free(build.workers[w].strings);
+    }
+    free(build.workers);
+    if (error != RUM_OK)
+    {
+        rum_inlining_free(inlining);
+    }
+    return error;
+}
+
+void rum_inlining_free(struct rum_inlining_t *inlining)
+{
+    free(inlining->methods);
+    free(inlining->strings);
+    memset(inlining, 0, sizeof(*inlining));
+}
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "rum.h"
+
+#define JIMAGE_MAGIC 0xcafedada
+#define JIMAGE_HEADER_SIZE 28
+#define JIMAGE_HASH_MULTIPLIER 0x01000193
+#define JIMAGE_COMPRESSED_MAGIC 0xcafefafa
+#define JIMAGE_COMPRESSED_HEADER_SIZE 29
+
+// location attribute kinds
+#define ATTRIBUTE_END 0
+#define ATTRIBUTE_MODULE 1
+#define ATTRIBUTE_PARENT 2
+#define ATTRIBUTE_BASE 3
+#define ATTRIBUTE_EXTENSION 4
+#define ATTRIBUTE_OFFSET 5
+#define ATTRIBUTE_COMPRESSED 6
+#define ATTRIBUTE_UNCOMPRESSED 7
+#define ATTRIBUTE_COUNT 8
+
+// jimage files are written in the byte order of the platform that built them
+static uint32_t image_u4(const struct rum_jimage_t *image, const uint8_t *p)
+{
+    return image->big_endian ? ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3]
+                             : (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t image_u8(const struct rum_jimage_t *image, const uint8_t *p)
+{
+    uint64_t first = image_u4(image, p), second = image_u4(image, p + 4);
+    return image->big_endian ? (first << 32) | second : (second << 32) | first;
+}
+
+// the FNV-style hash the jimage perfect hash table is built with
+static uint32_t image_hash(const char *name, size_t length, uint32_t seed)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        seed = (seed * JIMAGE_HASH_MULTIPLIER) ^ (uint8_t)name[i];
+    }
+    return seed & 0x7fffffff;
+}
+
+int rum_jimage_open_buffer(struct rum_jimage_t *image, const uint8_t *data, size_t length)
+{
+    memset(image, 0, sizeof(struct rum_jimage_t));
+    image->data = data;
+    image->length = length;
+    if (length < JIMAGE_HEADER_SIZE)
+    {
+        return RUM_ERR_ARCHIVE;
+    }
+    if (image_u4(image, data) != JIMAGE_MAGIC)
+    {
+        image->big_endian = 1;
+        if (image_u4(image, data) != JIMAGE_MAGIC)
+        {
+            return RUM_ERR_ARCHIVE;
+        }
+    }
+    image->version = image_u4(image, data + 4);
+    image->flags = image_u4(image, data + 8);
+    image->resource_count = image_u4(image, data + 12);
+    image->table_length = image_u4(image, data + 16);
+    image->locations_size = image_u4(image, data + 20);
+    image->strings_size = image_u4(image, data + 24);
+    if (image->version >> 16 != 1)
+    {
+        return RUM_ERR_ARCHIVE;
+    }
+
+    // header, redirect table, offsets table, locations and strings make up the index
+    uint64_t index_size = JIMAGE_HEADER_SIZE + (uint64_t)image->table_length * 8 + image->locations_size + image->strings_size;
+    if (index_size > length)
+    {
+        return RUM_ERR_ARCHIVE;
+    }
+    image->redirect = data + JIMAGE_HEADER_SIZE;
+    image->offsets = image->redirect + (size_t)image->table_length * 4;
+    image->locations = image->offsets + (size_t)image->table_length * 4;
+    image->strings = image->locations + image->locations_size;
+    image->index_size = (size_t)index_size;
+    return RUM_OK;
+}
+
+int rum_jimage_open(struct rum_jimage_t *image, const char *path)
+{
+    const uint8_t *data;
+    size_t length;
+    int error = rum_map_file(path, &data, &length);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+    error = rum_jimage_open_buffer(image, data, length);
+    if (error != RUM_OK)
+    {
+        rum_unmap_file(data, length);
+        memset(image, 0, sizeof(struct rum_jimage_t));
+        return error;
+    }
+    image->mapped = 1;
+    return RUM_OK;
+}
+
+void rum_jimage_close(struct rum_jimage_t *image)
+{
+    if (image->mapped)
+    {
+        rum_unmap_file(image->data, image->length);
+    }
+    memset(image, 0, sizeof(struct rum_jimage_t));
+}
+
+// returns the NUL-terminated string at `offset` of the strings table, "" when it runs off the end
+static const char *image_string(const struct rum_jimage_t *image, uint64_t offset)
+{
+    if (offset >= image->strings_size || memchr(image->strings + offset, '\0', image->strings_size - (size_t)offset) == NULL)
+    {
+        return "";
+    }
+    return (const char *)image->strings + offset;
+}
+
+// locations are a run of (kind << 3 | length - 1) bytes, each followed by a big-endian value
+int rum_jimage_location(const struct rum_jimage_t *image, uint32_t index, struct rum_jimage_location_t *location)
+{
+    memset(location, 0, sizeof(struct rum_jimage_location_t));
+    if (index >= image->table_length)
+    {
+        return RUM_ERR_ARCHIVE;
+    }
+    uint32_t offset = image_u4(image, image->offsets + (size_t)index * 4);
+    if (offset >= image->locations_size)
+    {
+        return RUM_ERR_ARCHIVE;
+    }
+
+    uint64_t attributes[ATTRIBUTE_COUNT] = {0};
+    const uint8_t *p = image->locations + offset, *end = image->locations + image->locations_size;
+    while (p < end)
+    {
+        uint8_t header = *p++;
+        if (header >> 3 == ATTRIBUTE_END)
+        {
+            break;
+        }
+        int kind = header >> 3, length = (header & 0x7) + 1;
+        if (kind >= ATTRIBUTE_COUNT || end - p < length)
+        {
+            return RUM_ERR_ARCHIVE;
+        }
+        uint64_t value = 0;
+        for (int i = 0; i < length; i++)
+        {
+            value = (value << 8) | *p++;
+        }
+        attributes[kind] = value;
+    }
+
+    location->module = attributes[ATTRIBUTE_MODULE];
+    location->parent = attributes[ATTRIBUTE_PARENT];
+    location->base = attributes[ATTRIBUTE_BASE];
+    location->extension = attributes[ATTRIBUTE_EXTENSION];
+    location->offset = attributes[ATTRIBUTE_OFFSET];
+    location->compressed = attributes[ATTRIBUTE_COMPRESSED];
+    location->uncompressed = attributes[ATTRIBUTE_UNCOMPRESSED];
+    return RUM_OK;
+}
+
+// "/module/parent/base.extension", parts that are empty are left out along with their separator
+int rum_jimage_name(const struct rum_jimage_t *image, const struct rum_jimage_location_t *location, char *buffer, size_t size)
+{
+    const char *module = image_string(image, location->module);
+    const char *parent = image_string(image, location->parent);
+    const char *extension = image_string(image, location->extension);
+    return snprintf(buffer, size, "%s%s%s%s%s%s%s%s", *module ? "/" : "", module, *module ? "/" : "",
+                    parent, *parent ? "/" : "", image_string(image, location->base), *extension ? "." : "", extension);
+}
+
+int rum_jimage_is_class(const struct rum_jimage_t *image, const struct rum_jimage_location_t *location)
+{
+    return strcmp(image_string(image, location->extension), "class") == 0 && *image_string(image, location->module) != '\0';
+}
+
+int rum_jimage_find(const struct rum_jimage_t *image, const char *name, uint32_t *index)
+{
+    if (image->table_length == 0)
+    {
+        return RUM_ERR_ARCHIVE;
+    }
+    size_t length = strlen(name);
+    uint32_t slot = image_hash(name, length, JIMAGE_HASH_MULTIPLIER) % image->table_length;
+    int32_t redirect = (int32_t)image_u4(image, image->redirect + (size_t)slot * 4);
+    if (redirect < 0)
+    {
+        // buckets holding a single name point straight at its location
+        slot = (uint32_t)(-(int64_t)redirect - 1);
+    }
+    else if (redirect > 0)
+    {
+        // otherwise the redirect is the seed that spreads the bucket over free slots
+        slot = image_hash(name, length, (uint32_t)redirect) % image->table_length;
+    }
+    else
+    {
+        return RUM_ERR_IO;
+    }
+
+    // the table is only perfect for names that are in it, so the location has to be checked
+    struct rum_jimage_location_t location;
+    char found[4096];
+    if (rum_jimage_location(image, slot, &location) != RUM_OK || rum_jimage_name(image, &location, found, sizeof(found)) < 0)
+    {
+        return RUM_ERR_IO;
+    }
+    if (strcmp(found, name) != 0)
+    {
+        return RUM_ERR_IO;
+    }
+    *index = slot;
+    return RUM_OK;
+}
+
+int rum_jimage_read(const struct rum_jimage_t *image, const struct rum_jimage_location_t *location, struct rum_inflater_t *inflater, const uint8_t **data, size_t *length)
+{
+    uint64_t stored = location->compressed != 0 ? location->compressed : location->uncompressed;
+    if (location->offset > image->length - image->index_size || stored > image->length - image->index_size - location->offset)
+    {
+        return RUM_ERR_ARCHIVE;
+    }
+    const uint8_t *content = image->data + image->index_size + location->offset;
+    size_t content_length = (size_t)stored;
+    if (location->compressed == 0)
+    {
+        // uncompressed resources are used in place
+        *data = content;
+        *length = content_length;
+        return RUM_OK;
+    }
+
+    // compressed resources are a stack of (header, payload) layers, each undone in turn
+    while (content_length >= JIMAGE_COMPRESSED_HEADER_SIZE && image_u4(image, content) == JIMAGE_COMPRESSED_MAGIC)
+    {
+        uint64_t compressed_size = image_u8(image, content + 4);
+        uint64_t uncompressed_size = image_u8(image, content + 12);
+        const char *decompressor = image_string(image, image_u4(image, content + 20));
+        if (compressed_size > content_length - JIMAGE_COMPRESSED_HEADER_SIZE || uncompressed_size > UINT32_MAX)
+        {
+            return RUM_ERR_ARCHIVE;
+        }
+        // only the zip plugin is supported, string sharing (compact-cp) is reported as unsupported
+        if (strcmp(decompressor, "zip") != 0)
+        {
+            return RUM_ERR_ARCHIVE;
+        }
+
+        // the zip plugin writes zlib streams, rather than the raw deflate found in jars
+        int error = rum_inflate(inflater, content + JIMAGE_COMPRESSED_HEADER_SIZE, (size_t)compressed_size, (size_t)uncompressed_size, 0, &content);
+        if (error != RUM_OK)
+        {
+            return error;
+        }
+        content_length = (size_t)uncompressed_size;
+    }
+    *data = content;
+    *length = content_length;
+    return RUM_OK;
+}
@@ -4,983 +4,1155 @@
  * SPDX-License-Identifier: MIT
  */
 
-#include <assert.h>
-#include <inttypes.h>
-#include <stdint.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// cp_info_tag values
-#define CONSTANT_Class 7
-#define CONSTANT_Fieldref 9
-#define CONSTANT_Methodref 10
-#define CONSTANT_InterfaceMethodref 11
-#define CONSTANT_String 8
-#define CONSTANT_Integer 3
-#define CONSTANT_Float 4
-#define CONSTANT_Long 5
-#define CONSTANT_Double 6
-#define CONSTANT_NameAndType 12
-#define CONSTANT_Utf8 1
-#define CONSTANT_MethodHandle 15
-#define CONSTANT_MethodType 16
-#define CONSTANT_InvokeDynamic 18
-
-// method_info access_flags mask table
-#define METHOD_INFO_ACC_PUBLIC 0x0001
-#define METHOD_INFO_ACC_PRIVATE 0x0002
-#define METHOD_INFO_ACC_PROTECTED 0x0004
-#define METHOD_INFO_ACC_STATIC 0x0008
-#define METHOD_INFO_ACC_FINAL 0x0010
-#define METHOD_INFO_ACC_SYNCHRONIZED 0x0020
-#define METHOD_INFO_ACC_BRIDGE 0x0040
-#define METHOD_INFO_ACC_VARARGS 0x0080
-#define METHOD_INFO_ACC_NATIVE 0x0100
-#define METHOD_INFO_ACC_ABSTRACT 0x0400
-#define METHOD_INFO_ACC_STRICT 0x0800
-#define METHOD_INFO_ACC_SYNTHETIC 0x1000
-
-// class file access_flags mask table
-#define ACC_PUBLIC 0x0001
-#define ACC_FINAL 0x0010
-#define ACC_SUPER 0x0020
-#define ACC_INTERFACE 0x0200
-#define ACC_ABSTRACT 0x0400
-#define ACC_SYNTHETIC 0x1000
-#define ACC_ANNOTATION 0x2000
-#define ACC_ENUM 0x4000
-
-// field_info access_flags mask table
-#define FIELD_INFO_ACC_PUBLIC 0x0001
-#define FIELD_INFO_ACC_PRIVATE 0x0002
-#define FIELD_INFO_ACC_PROTECTED 0x0004
-#define FIELD_INFO_ACC_STATIC 0x0008
-#define FIELD_INFO_ACC_FINAL 0x0010
-#define FIELD_INFO_ACC_VOLATILE 0x0040
-#define FIELD_INFO_ACC_TRANSIENT 0x0080
-#define FIELD_INFO_ACC_SYNTHETIC 0x1000
-#define FIELD_INFO_ACC_ENUM 0x4000
-
-// helpful macros
-#define READ_U2(var) fread(var, sizeof(unsigned short), 1, file)
-#define SWAP(var) var = le_to_be(var) // swap the endian-ness of an unsigned short
-#define ALLOC(type, count) (type *)malloc(sizeof(type) * (count))
-#define PRINT_FLAG(str, flag) sprintf(str, "%s%s" flag, str, strlen(str) == 0 ? "" : ", ");
-
-struct constant_methodref_t
-{
-    unsigned short class_index;
-    unsigned short name_and_type_index;
-};
+#include "rum.h"
 
-struct constant_utf8_t
+struct batch_t
 {
-    unsigned short length;
-    uint8_t *bytes;
+    struct rum_classpath_t classpath;
+    struct class_t **classes;        // one handle per worker, reused for every class it parses
+    struct rum_loader_t *loaders;    // one per worker
+    struct rum_summary_t *summaries; // one per worker, in place of `classes` with --summary
+    int summary;
+    struct rum_cache_t *cache;       // NULL without --cache
+    size_t *hits;                    // classes each worker loaded from the cache
+    size_t *jobs;                    // classpath entry of every job in the current phase
+    int *errors;
+    struct rum_ordered_t ordered;
 };
 
-struct constant_class_t
+// "path : Name extends Super implements A, B" on one line
+void print_summary(FILE *out, const char *name, const struct rum_summary_t *summary)
 {
-    unsigned short name_index;
-};
+    fprintf(out, "%s : %.*s", name, summary->this_class.length, summary->this_class.bytes);
+    if (summary->super_class.bytes != NULL)
+    {
+        fprintf(out, " extends %.*s", summary->super_class.length, summary->super_class.bytes);
+    }
+    for (unsigned short i = 0; i < summary->interfaces_count && i < RUM_SUMMARY_INTERFACES; i++)
+    {
+        fprintf(out, "%s%.*s", i == 0 ? " implements " : ", ", summary->interfaces[i].length, summary->interfaces[i].bytes);
+    }
+    fprintf(out, "%s\n", summary->interfaces_count > RUM_SUMMARY_INTERFACES ? ", ..." : "");
+}
 
-struct constant_name_and_type_info_t
+// renders the class `worker` just parsed, or the reason it couldn't be parsed
+void print_result(struct batch_t *batch, size_t index, int worker, int error)
 {
-    unsigned short name_index;
-    unsigned short descriptor_index;
-};
+    char name[4096];
+    rum_classpath_name(&batch->classpath, index, name, sizeof(name));
+    char *text = NULL;
+    size_t length = 0;
+    FILE *out = open_memstream(&text, &length);
+    if (out == NULL)
+    {
+        batch->errors[index] = RUM_ERR_NOMEM;
+        rum_ordered_submit(&batch->ordered, index, NULL, 0);
+        return;
+    }
 
-struct constant_fieldref_t
-{
-    unsigned short class_index;
-    unsigned short name_and_type_index;
-};
+    if (error == RUM_OK && batch->summary)
+    {
+        print_summary(out, name, &batch->summaries[worker]);
+    }
+    else if (error == RUM_OK)
+    {
+        if (batch->classpath.count > 1)
+        {
+            fprintf(out, "==> %s <==\n", name);
+        }
+        if ((error = rum_pretty_print(out, batch->classes[worker])) != RUM_OK)
+        {
+            fprintf(out, "\n[-] couldn't print file '%s' : %s\n", name, rum_strerror(error));
+        }
+    }
+    else
+    {
+        fprintf(out, "[-] couldn't parse file '%s' : %s\n", name, rum_strerror(error));
+    }
+    batch->errors[index] = error;
+    fclose(out);
+    rum_ordered_submit(&batch->ordered, index, text, length);
+}
 
-struct constant_string_t
+int parse(struct batch_t *batch, int worker, const uint8_t *data, size_t length)
 {
-    unsigned short string_index;
-};
+    return batch->summary ? rum_summarize(data, length, &batch->summaries[worker])
+                          : rum_class_parse_buffer(batch->classes[worker], data, length);
+}
 
-struct constant_interface_methodref_t
+void print_job(void *user, size_t job, int worker)
 {
-    unsigned short class_index;
-    unsigned short name_and_type_index;
-};
+    struct batch_t *batch = user;
+    size_t index = batch->jobs[job];
+    if (batch->cache != NULL && !batch->summary)
+    {
+        int hit;
+        int error = rum_cache_load(batch->cache, &batch->classpath, index, &batch->loaders[worker], batch->classes[worker], &hit);
+        batch->hits[worker] += hit != 0;
+        print_result(batch, index, worker, error);
+        return;
+    }
 
-struct constant_invoke_dynamic_t
-{
-    unsigned short bootstrap_method_attr_index;
-    unsigned short name_and_type_index;
-};
+    const uint8_t *data;
+    size_t length;
+    int error = rum_classpath_load(&batch->classpath, index, &batch->loaders[worker], &data, &length);
+    if (error == RUM_OK)
+    {
+        error = parse(batch, worker, data, length);
+    }
+    print_result(batch, index, worker, error);
+}
 
-struct constant_method_handle_t
+void print_buffer_job(void *user, size_t job, int worker, const uint8_t *data, size_t length, int error)
 {
-    uint8_t reference_kind;
-    unsigned short reference_index;
-};
+    struct batch_t *batch = user;
+    if (error == RUM_OK)
+    {
+        error = parse(batch, worker, data, length);
+    }
+    print_result(batch, batch->jobs[job], worker, error);
+}
 
-struct constant_float_t
+// reads the plain class files through the pipeline and then parses the archive members, which are
+// already mapped, on the worker pool
+int run_pipeline(struct batch_t *batch, int threads, int flags)
 {
-    uint32_t bytes;
-};
+    struct rum_paths_t files = {0};
+    files.paths = malloc(sizeof(char *) * (batch->classpath.count + 1));
+    if (files.paths == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    size_t members = 0;
+    for (size_t i = 0; i < batch->classpath.count; i++)
+    {
+        const struct rum_source_t *source = &batch->classpath.sources[batch->classpath.entries[i].source];
+        if (source->kind == RUM_SOURCE_FILE)
+        {
+            batch->jobs[files.count] = i;
+            files.paths[files.count++] = (char *)source->path;
+        }
+    }
+    int error = rum_pipeline(&files, threads, flags, print_buffer_job, batch);
+    free(files.paths);
 
-struct constant_integer_t
-{
-    uint32_t bytes;
-};
+    for (size_t i = 0; i < batch->classpath.count; i++)
+    {
+        if (batch->classpath.sources[batch->classpath.entries[i].source].kind != RUM_SOURCE_FILE)
+        {
+            batch->jobs[members++] = i;
+        }
+    }
+    return error != RUM_OK ? error : rum_parallel_for(members, threads, print_job, batch);
+}
 
-struct constant_double_t
+// answers every name on the command line, or one per line on stdin when there are none
+int lookup(const char *path, char **names, int count)
 {
-    uint32_t high_bytes;
-    uint32_t low_bytes;
-};
+    struct rum_symbols_t symbols;
+    int error = rum_symbols_open(&symbols, path);
+    if (error != RUM_OK)
+    {
+        printf("[-] couldn't open index '%s' : %s\n", path, rum_strerror(error));
+        return EXIT_FAILURE;
+    }
 
-struct constant_long_t
-{
-    uint32_t high_bytes;
-    uint32_t low_bytes;
-};
+    int status = EXIT_SUCCESS;
+    char *line = NULL;
+    size_t capacity = 0;
+    for (int i = 0;; i++)
+    {
+        char *name = i < count ? names[i] : NULL;
+        ssize_t length;
+        if (count == 0 && (length = getline(&line, &capacity, stdin)) > 0)
+        {
+            name = line;
+            name[length - (line[length - 1] == '\n')] = '\0';
+        }
+        if (name == NULL)
+        {
+            break;
+        }
+        // "java.lang.Object" works as well as the internal "java/lang/Object"
+        for (char *c = name; *c != '\0'; c++)
+        {
+            *c = *c == '.' ? '/' : *c;
+        }
 
-struct constant_method_type_t
-{
-    unsigned short descriptor_index;
-};
+        struct rum_symbol_t symbol;
+        if (rum_symbols_find(&symbols, name, strlen(name), &symbol) == RUM_OK)
+        {
+            printf("%s : %.*s %llu %llu\n", name, (int)symbol.entry_length, symbol.entry,
+                   (unsigned long long)symbol.offset, (unsigned long long)symbol.length);
+        }
+        else
+        {
+            printf("[-] couldn't find class '%s'\n", name);
+            status = EXIT_FAILURE;
+        }
+    }
+    free(line);
+    rum_symbols_close(&symbols);
+    return status;
+}
 
-struct cp_info_t
+// "Type : Class", "Type : Class.field:descriptor" or "Type : Class.method(descriptor)"
+int print_annotated(void *user, const struct rum_annotated_t *annotated)
 {
-    uint8_t tag;
-    union
-    {
-        struct constant_methodref_t constant_methodref;
-        struct constant_utf8_t constant_utf8;
-        struct constant_class_t constant_class;
-        struct constant_name_and_type_info_t constant_name_and_type_info;
-        struct constant_fieldref_t constant_fieldref;
-        struct constant_string_t constant_string;
-        struct constant_interface_methodref_t constant_interface_methodref;
-        struct constant_invoke_dynamic_t constant_invoke_dynamic;
-        struct constant_method_handle_t constant_method_handle;
-        struct constant_float_t constant_float;
-        struct constant_integer_t constant_integer;
-        struct constant_double_t constant_double;
-        struct constant_long_t constant_long;
-        struct constant_method_type_t constant_method_type;
-    };
-};
+    const char *type = user;
+    printf("%s : %.*s", type, (int)annotated->class_length, annotated->class);
+    if (annotated->target != RUM_ANNOTATED_CLASS)
+    {
+        printf(".%.*s%s%.*s", (int)annotated->name_length, annotated->name, annotated->target == RUM_ANNOTATED_FIELD ? ":" : "",
+               (int)annotated->descriptor_length, annotated->descriptor);
+    }
+    printf("\n");
+    return 0;
+}
 
-struct attribute_info_t
+// answers every annotation type on the command line, or one per line on stdin when there are none
+int find_annotated(const char *path, char **types, int count)
 {
-    unsigned short attribute_name_index;
-    uint32_t attribute_length;
-    uint8_t *info; // `attribute_length` number of elements
-};
+    struct rum_annotations_t annotations;
+    int error = rum_annotations_open(&annotations, path);
+    if (error != RUM_OK)
+    {
+        printf("[-] couldn't open annotation index '%s' : %s\n", path, rum_strerror(error));
+        return EXIT_FAILURE;
+    }
+
+    int status = EXIT_SUCCESS;
+    char *line = NULL;
+    size_t capacity = 0;
+    for (int i = 0;; i++)
+    {
+        char *type = i < count ? types[i] : NULL;
+        ssize_t length;
+        if (count == 0 && (length = getline(&line, &capacity, stdin)) > 0)
+        {
+            type = line;
+            type[length - (line[length - 1] == '\n')] = '\0';
+        }
+        if (type == NULL)
+        {
+            break;
+        }
+        for (char *c = type; *c != '\0'; c++)
+        {
+            *c = *c == '.' ? '/' : *c;
+        }
+        if (rum_annotations_find(&annotations, type, strlen(type), print_annotated, type) == 0)
+        {
+            printf("[-] couldn't find anything annotated with '%s'\n", type);
+            status = EXIT_FAILURE;
+        }
+    }
+    free(line);
+    rum_annotations_close(&annotations);
+    return status;
+}
 
-struct field_info_t
+struct references_t
 {
-    unsigned short access_flags;
-    unsigned short name_index;
-    unsigned short descriptor_index;
-    unsigned short attributes_count;
-    struct attribute_info_t *attributes; // `attributes_count` number of elements
+    const struct rum_xref_t *xref;
+    const char *descriptor; // only print members with this descriptor, unless NULL
+    uint32_t *classes;
+    size_t printed;
 };
 
-struct method_info_t
+// "owner.name(descriptor) : A, B" for methods, "owner.name:descriptor : A, B" for fields
+int print_references(void *user, const struct rum_member_ref_t *member)
 {
-    unsigned short access_flags;
-    unsigned short name_index;
-    unsigned short descriptor_index;
-    unsigned short attributes_count;
-    struct attribute_info_t *attributes; // `attributes_count` number of elements
-};
+    struct references_t *references = user;
+    if (references->descriptor != NULL && (strlen(references->descriptor) != member->descriptor_length ||
+                                           memcmp(references->descriptor, member->descriptor, member->descriptor_length) != 0))
+    {
+        return 0;
+    }
+    uint32_t *classes = realloc(references->classes, sizeof(uint32_t) * (member->count + 1u));
+    if (classes == NULL)
+    {
+        return 1;
+    }
+    references->classes = classes;
+    size_t count = rum_xref_classes(member, classes);
+    printf("%.*s.%.*s%s%.*s :", (int)member->owner_length, member->owner, (int)member->name_length, member->name,
+           member->kinds & RUM_XREF_FIELD ? ":" : "", (int)member->descriptor_length, member->descriptor);
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t length;
+        const char *name = rum_xref_class(references->xref, classes[i], &length);
+        printf("%s %.*s", i == 0 ? "" : ",", (int)length, name == NULL ? "?" : name);
+    }
+    printf("\n");
+    references->printed++;
+    return 0;
+}
 
-struct class_t
+// answers "owner.name", optionally followed by a descriptor, for every member on the command line
+// or one per line on stdin when there are none
+int find_references(const char *path, char **members, int count)
 {
-    uint32_t magic;
-    unsigned short minor;
-    unsigned short major;
-    unsigned short constant_pool_count;
-    struct cp_info_t *constant_pool; // `constant_pool_count` -1 number of elements
-    unsigned short access_flags;
-    unsigned short this_class;
-    unsigned short super_class;
-    unsigned short interfaces_count;
-    unsigned short *interfaces; // `interface_count` number of elements
-    unsigned short fields_count;
-    struct field_info_t *fields; // `fields_count` number of elements
-    unsigned short methods_count;
-    struct method_info_t *methods; // `methods_count` number of elements
-    unsigned short attribute_count;
-    struct attribute_info_t *attributes; // `attribute_count` number of elements
-};
+    struct rum_xref_t xref;
+    int error = rum_xref_open(&xref, path);
+    if (error != RUM_OK)
+    {
+        printf("[-] couldn't open cross-reference index '%s' : %s\n", path, rum_strerror(error));
+        return EXIT_FAILURE;
+    }
 
-struct class_t class; // the main class struct
+    int status = EXIT_SUCCESS;
+    char *line = NULL;
+    size_t capacity = 0;
+    struct references_t references = {.xref = &xref};
+    for (int i = 0;; i++)
+    {
+        char *query = i < count ? members[i] : NULL;
+        ssize_t length;
+        if (count == 0 && (length = getline(&line, &capacity, stdin)) > 0)
+        {
+            query = line;
+            query[length - (line[length - 1] == '\n')] = '\0';
+        }
+        if (query == NULL)
+        {
+            break;
+        }
 
-unsigned short le_to_be(unsigned short bytes)
-{
-    unsigned short result = ((bytes & 0xFF) << 8) | ((bytes & 0xFF00) >> 8);
-    return result;
+        // the descriptor starts at '(' for methods and after ':' for fields, the name after the last dot before it
+        char *descriptor = strpbrk(query, "(:");
+        size_t end = descriptor == NULL ? strlen(query) : (size_t)(descriptor - query);
+        char *dot = NULL;
+        for (size_t c = 0; c < end; c++)
+        {
+            dot = query[c] == '.' ? query + c : dot;
+        }
+        if (dot == NULL)
+        {
+            printf("[-] '%s' isn't owner.member\n", query);
+            status = EXIT_FAILURE;
+            continue;
+        }
+        for (char *c = query; c < dot; c++)
+        {
+            *c = *c == '.' ? '/' : *c;
+        }
+        references.descriptor = descriptor == NULL ? NULL : descriptor + (*descriptor == ':');
+        references.printed = 0;
+        rum_xref_find(&xref, query, (size_t)(dot - query), dot + 1, end - (size_t)(dot - query) - 1, print_references, &references);
+        if (references.printed == 0)
+        {
+            printf("[-] couldn't find references to '%s'\n", query);
+            status = EXIT_FAILURE;
+        }
+    }
+    free(references.classes);
+    free(line);
+    rum_xref_close(&xref);
+    return status;
 }
 
-const char *get_tag_name(uint8_t tag)
+// the node `name` (either form) names, reporting it when there is none
+uint32_t find_type(const struct rum_hierarchy_t *hierarchy, char *name)
 {
-    switch (tag)
-    {
-    case CONSTANT_Class:
-        return "CONSTANT_Class";
-    case CONSTANT_Fieldref:
-        return "CONSTANT_Fieldref";
-    case CONSTANT_Methodref:
-        return "CONSTANT_Methodref";
-    case CONSTANT_InterfaceMethodref:
-        return "CONSTANT_InterfaceMethodref";
-    case CONSTANT_String:
-        return "CONSTANT_String";
-    case CONSTANT_Integer:
-        return "CONSTANT_Integer";
-    case CONSTANT_Float:
-        return "CONSTANT_Float";
-    case CONSTANT_Long:
-        return "CONSTANT_Long";
-    case CONSTANT_Double:
-        return "CONSTANT_Double";
-    case CONSTANT_NameAndType:
-        return "CONSTANT_NameAndType";
-    case CONSTANT_Utf8:
-        return "CONSTANT_Utf8";
-    case CONSTANT_MethodHandle:
-        return "CONSTANT_MethodHandle";
-    case CONSTANT_MethodType:
-        return "CONSTANT_MethodType";
-    case CONSTANT_InvokeDynamic:
-        return "CONSTANT_InvokeDynamic";
-    default:
-        return "<unknown tag>";
+    for (char *c = name; *c != '\0'; c++)
+    {
+        *c = *c == '.' ? '/' : *c;
+    }
+    uint32_t node = rum_hierarchy_find(hierarchy, name, strlen(name));
+    if (node == RUM_HIERARCHY_NONE)
+    {
+        printf("[-] couldn't find class '%s'\n", name);
     }
+    return node;
 }
 
-char *get_access_flags(unsigned short flag)
+// answers "subtypes X", "supertypes X", "implementors X" and "is-subtype X Y", one per line on stdin
+int query_hierarchy(const struct rum_classpath_t *classpath, int threads)
 {
-    char *ret = malloc(sizeof(char) * 256);
-    if (flag & ACC_PUBLIC)
-    {
-        PRINT_FLAG(ret, "ACC_PUBLIC");
-    }
-    if (flag & ACC_FINAL)
+    struct rum_hierarchy_t hierarchy;
+    struct rum_walk_t walk = {0};
+    int error = rum_hierarchy_build(&hierarchy, classpath, threads);
+    if (error != RUM_OK || (error = rum_walk_init(&walk, hierarchy.count)) != RUM_OK)
     {
-        PRINT_FLAG(ret, "ACC_FINAL");
+        printf("[-] couldn't build the class hierarchy : %s\n", rum_strerror(error));
+        rum_walk_free(&walk);
+        rum_hierarchy_free(&hierarchy);
+        return EXIT_FAILURE;
     }
-    if (flag & ACC_SUPER)
+
+    int status = EXIT_SUCCESS;
+    char *line = NULL;
+    size_t capacity = 0;
+    while (getline(&line, &capacity, stdin) > 0)
     {
-        PRINT_FLAG(ret, "ACC_SUPER");
+        char *query = strtok(line, " \t\n");
+        char *name = strtok(NULL, " \t\n");
+        char *other = strtok(NULL, " \t\n");
+        if (query == NULL)
+        {
+            continue;
+        }
+        int implementors = strcmp(query, "implementors") == 0;
+        int subtypes = implementors || strcmp(query, "subtypes") == 0;
+        int supertypes = strcmp(query, "supertypes") == 0;
+        int is_subtype = strcmp(query, "is-subtype") == 0;
+        if ((!subtypes && !supertypes && !is_subtype) || name == NULL || is_subtype != (other != NULL))
+        {
+            printf("[-] unknown query '%s'\n", query);
+            status = EXIT_FAILURE;
+            continue;
+        }
+        uint32_t node = find_type(&hierarchy, name);
+        uint32_t super = is_subtype ? find_type(&hierarchy, other) : 0;
+        if (node == RUM_HIERARCHY_NONE || super == RUM_HIERARCHY_NONE)
+        {
+            status = EXIT_FAILURE;
+        }
+        else if (is_subtype)
+        {
+            printf("%s %s %s : %s\n", query, name, other, rum_hierarchy_is_subtype(&hierarchy, &walk, node, super) ? "true" : "false");
+        }
+        else
+        {
+            size_t found = supertypes ? rum_hierarchy_supertypes(&hierarchy, &walk, node) : rum_hierarchy_subtypes(&hierarchy, &walk, node);
+            printf("%s %s :", query, name);
+            for (size_t i = 0, printed = 0; i < found; i++)
+            {
+                // implementors are the classes among the subtypes
+                if (!implementors || !(hierarchy.flags[walk.found[i]] & RUM_TYPE_INTERFACE))
+                {
+                    printf("%s %s", printed++ == 0 ? "" : ",", rum_hierarchy_name(&hierarchy, walk.found[i]));
+                }
+            }
+            printf("\n");
+        }
     }
-    if (flag & ACC_INTERFACE)
+    free(line);
+    rum_walk_free(&walk);
+    rum_hierarchy_free(&hierarchy);
+    return status;
+}
+
+// "label group : A, B" for every group, nodes bucketed by `groups` first so this is linear. Groups
+// with a `sizes` below 2 are left out
+int print_groups(const struct rum_deps_t *deps, const char *label, const uint32_t *groups, uint32_t group_count, const uint32_t *sizes)
+{
+    uint32_t *starts = calloc((size_t)group_count + 1, sizeof(uint32_t));
+    uint32_t *nodes = malloc(sizeof(uint32_t) * ((size_t)deps->count + 1));
+    if (starts == NULL || nodes == NULL)
     {
-        PRINT_FLAG(ret, "ACC_INTERFACE");
+        free(starts);
+        free(nodes);
+        return RUM_ERR_NOMEM;
     }
-    if (flag & ACC_ABSTRACT)
+    for (uint32_t n = 0; n < deps->count; n++)
     {
-        PRINT_FLAG(ret, "ACC_ABSTRACT");
+        starts[groups[n] + 1]++;
     }
-    if (flag & ACC_SYNTHETIC)
+    for (uint32_t g = 0; g < group_count; g++)
     {
-        PRINT_FLAG(ret, "ACC_SYNTHETIC");
+        starts[g + 1] += starts[g];
     }
-    if (flag & ACC_ANNOTATION)
+    for (uint32_t n = 0; n < deps->count; n++)
     {
-        PRINT_FLAG(ret, "ACC_ANNOTATION");
+        nodes[starts[groups[n]]++] = n;
     }
-    if (flag & ACC_ENUM)
+    // starts[g] is where group g ends now
+    for (uint32_t g = 0, begin = 0; g < group_count; begin = starts[g++])
     {
-        PRINT_FLAG(ret, "ACC_ENUM");
+        if (sizes != NULL && sizes[g] < 2)
+        {
+            continue;
+        }
+        printf("%s %u :", label, g);
+        for (uint32_t i = begin; i < starts[g]; i++)
+        {
+            printf("%s %s", i == begin ? "" : ",", rum_names_get(&deps->names, nodes[i]));
+        }
+        printf("\n");
     }
-    return strlen(ret) == 0 ? "<unknown flag>" : ret;
+    free(starts);
+    free(nodes);
+    return RUM_OK;
 }
 
-char *get_field_info_access_flags(unsigned short flag)
+// cyclic components and the layers classes can be loaded in, dependencies first
+int print_layers(const struct rum_deps_t *deps)
 {
-    char *ret = malloc(sizeof(char) * 256);
-
-    if (flag & FIELD_INFO_ACC_PUBLIC)
+    uint32_t *components = malloc(sizeof(uint32_t) * ((size_t)deps->count + 1));
+    uint32_t *layers = malloc(sizeof(uint32_t) * ((size_t)deps->count + 1));
+    uint32_t *sizes = calloc((size_t)deps->count + 1, sizeof(uint32_t));
+    uint32_t component_count = 0, layer_count = 0, cyclic = 0, defined = 0;
+    int error = components == NULL || layers == NULL || sizes == NULL ? RUM_ERR_NOMEM : rum_deps_components(deps, components, layers, &component_count);
+    for (uint32_t n = 0; error == RUM_OK && n < deps->count; n++)
     {
-        PRINT_FLAG(ret, "ACC_PUBLIC");
+        cyclic += ++sizes[components[n]] == 2;
+        defined += deps->flags[n] & RUM_TYPE_DEFINED;
+        layer_count = layers[n] + 1 > layer_count ? layers[n] + 1 : layer_count;
     }
-    if (flag & FIELD_INFO_ACC_PRIVATE)
+    if (error == RUM_OK)
     {
-        PRINT_FLAG(ret, "ACC_PRIVATE");
+        printf("%u types (%u in the classpath), %u dependencies, %u components, %u cyclic, %u layers\n", deps->count, defined,
+               deps->edge_count, component_count, cyclic, layer_count);
     }
-    if (flag & FIELD_INFO_ACC_PROTECTED)
-    {
-        PRINT_FLAG(ret, "ACC_PROTECTED");
-    }
-    if (flag & FIELD_INFO_ACC_STATIC)
+
+    // each cycle on a line, then each layer
+    if (error == RUM_OK)
     {
-        PRINT_FLAG(ret, "ACC_STATIC");
+        error = print_groups(deps, "cycle", components, component_count, sizes);
     }
-    if (flag & FIELD_INFO_ACC_FINAL)
+    if (error == RUM_OK)
     {
-        PRINT_FLAG(ret, "ACC_FINAL");
+        error = print_groups(deps, "layer", layers, layer_count, NULL);
     }
-    if (flag & FIELD_INFO_ACC_VOLATILE)
+    free(components);
+    free(layers);
+    free(sizes);
+    return error;
+}
+
+// the dependency graph of the classpath as "dot", "csv", "binary" or the "layers" summary
+int print_dependencies(const struct rum_classpath_t *classpath, int threads, const char *format)
+{
+    static const char *formats[] = {"dot", "csv", "binary", "layers"};
+    int kind = 0;
+    while (kind < 4 && strcmp(format, formats[kind]) != 0)
     {
-        PRINT_FLAG(ret, "ACC_VOLATILE");
+        kind++;
     }
-    if (flag & FIELD_INFO_ACC_TRANSIENT)
+    if (kind == 4)
     {
-        PRINT_FLAG(ret, "ACC_TRANSIENT");
+        printf("[-] unknown dependency format '%s'\n", format);
+        return EXIT_FAILURE;
     }
-    if (flag & FIELD_INFO_ACC_SYNTHETIC)
+
+    struct rum_deps_t deps;
+    int error = rum_deps_build(&deps, classpath, threads);
+    if (error == RUM_OK)
     {
-        PRINT_FLAG(ret, "ACC_SYNTHETIC");
+        error = kind == 3 ? print_layers(&deps) : rum_deps_write(&deps, stdout, kind);
     }
-    if (flag & FIELD_INFO_ACC_ENUM)
+    if (error != RUM_OK)
     {
-        PRINT_FLAG(ret, "ACC_ENUM");
+        printf("[-] couldn't build the dependency graph : %s\n", rum_strerror(error));
     }
-    return strlen(ret) == 0 ? "<unknown flag>" : ret;
+    rum_deps_free(&deps);
+    return error == RUM_OK ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
-char *get_method_info_access_flags(unsigned short flag)
+struct cfgs_t
 {
-    char *ret = malloc(sizeof(char) * 256);
+    const struct rum_classpath_t *classpath;
+    int dot;
+    struct class_t **classes;     // one per worker
+    struct rum_loader_t *loaders; // one per worker
+    struct rum_cfg_t *cfgs;       // one per worker, grown to the largest method it has seen
+    int *errors;
+    struct rum_ordered_t ordered;
+};
 
-    if (flag & METHOD_INFO_ACC_PUBLIC)
+// a CONSTANT_Utf8 as "%.*s" arguments, empty when `index` doesn't name one
+const char *pool_utf8(const struct class_t *class, unsigned short index, int *length)
+{
+    if (index == 0 || index >= class->constant_pool_count || class->constant_pool[index - 1].tag != CONSTANT_Utf8)
     {
-        PRINT_FLAG(ret, "ACC_PUBLIC");
+        *length = 0;
+        return "";
     }
-    if (flag & METHOD_INFO_ACC_PRIVATE)
+    *length = class->constant_pool[index - 1].constant_utf8.length;
+    return (const char *)class->constant_pool[index - 1].constant_utf8.bytes;
+}
+
+// "Class.method(descriptor) : 7 blocks, 2 loops, depth 2" and a line per loop for the methods with
+// loops, or a digraph per method
+void cfg_job(void *user, size_t index, int worker)
+{
+    struct cfgs_t *cfgs = user;
+    struct class_t *class = cfgs->classes[worker];
+    struct rum_cfg_t *cfg = &cfgs->cfgs[worker];
+    char file[4096];
+    rum_classpath_name(cfgs->classpath, index, file, sizeof(file));
+    char *text = NULL;
+    size_t size = 0;
+    FILE *out = open_memstream(&text, &size);
+    if (out == NULL)
     {
-        PRINT_FLAG(ret, "ACC_PRIVATE");
+        cfgs->errors[index] = RUM_ERR_NOMEM;
+        rum_ordered_submit(&cfgs->ordered, index, NULL, 0);
+        return;
     }
-    if (flag & METHOD_INFO_ACC_PROTECTED)
+
+    const uint8_t *data;
+    size_t length;
+    int error = rum_classpath_load(cfgs->classpath, index, &cfgs->loaders[worker], &data, &length);
+    if (error == RUM_OK)
     {
-        PRINT_FLAG(ret, "ACC_PROTECTED");
+        error = rum_class_parse_buffer(class, data, length);
     }
-    if (flag & METHOD_INFO_ACC_STATIC)
+    if (error != RUM_OK)
     {
-        PRINT_FLAG(ret, "ACC_STATIC");
+        fprintf(out, "[-] couldn't parse file '%s' : %s\n", file, rum_strerror(error));
     }
-    if (flag & METHOD_INFO_ACC_FINAL)
+    int owner_length = 0;
+    const char *owner = "";
+    if (error == RUM_OK && class->this_class != 0 && class->this_class < class->constant_pool_count &&
+        class->constant_pool[class->this_class - 1].tag == CONSTANT_Class)
     {
-        PRINT_FLAG(ret, "ACC_FINAL");
+        owner = pool_utf8(class, class->constant_pool[class->this_class - 1].constant_class.name_index, &owner_length);
     }
-    if (flag & METHOD_INFO_ACC_SYNCHRONIZED)
+    for (unsigned short m = 0; error == RUM_OK && m < class->methods_count; m++)
     {
-        PRINT_FLAG(ret, "ACC_SYNCHRONIZED");
+        const struct method_info_t *method = &class->methods[m];
+        const struct attribute_info_t *attribute = rum_find_attribute(class, method->attributes, method->attributes_count, "Code");
+        if (attribute == NULL)
+        {
+            continue; // abstract and native
+        }
+        int name_length, descriptor_length;
+        const char *name = pool_utf8(class, method->name_index, &name_length);
+        const char *descriptor = pool_utf8(class, method->descriptor_index, &descriptor_length);
+        char title[4096];
+        int title_length = snprintf(title, sizeof(title), "%.*s.%.*s%.*s", owner_length, owner, name_length, name, descriptor_length, descriptor);
+        title_length = title_length < (int)sizeof(title) ? title_length : (int)sizeof(title) - 1;
+
+        struct rum_code_t code;
+        int built = rum_code_decode(class->data, attribute, &code);
+        if (built == RUM_OK)
+        {
+            built = rum_cfg_build(cfg, &code);
+        }
+        if (built != RUM_OK)
+        {
+            fprintf(out, "[-] couldn't build the control-flow graph of %s : %s\n", title, rum_strerror(built));
+            error = built == RUM_ERR_NOMEM ? built : error;
+            cfgs->errors[index] = built;
+        }
+        else if (cfgs->dot)
+        {
+            rum_cfg_write_dot(cfg, out, title, (size_t)title_length);
+        }
+        else if (cfg->loop_count > 0)
+        {
+            fprintf(out, "%s : %u blocks, %u loops, depth %u\n", title, cfg->block_count, cfg->loop_count, rum_cfg_max_depth(cfg));
+            for (uint32_t l = 0; l < cfg->loop_count; l++)
+            {
+                const struct rum_loop_t *loop = &cfg->loops[l];
+                fprintf(out, "\tloop %u : header pc %u, depth %u, %u blocks, %u bytes, %u back edges", l, cfg->starts[loop->header],
+                        loop->depth, loop->blocks, loop->bytes, loop->back_edges);
+                if (loop->parent != RUM_CFG_NONE)
+                {
+                    fprintf(out, ", in loop %u", loop->parent);
+                }
+                fprintf(out, "\n");
+            }
+        }
     }
-    if (flag & METHOD_INFO_ACC_BRIDGE)
+    if (error != RUM_OK)
     {
-        PRINT_FLAG(ret, "ACC_BRIDGE");
+        cfgs->errors[index] = error;
     }
-    if (flag & METHOD_INFO_ACC_VARARGS)
+    fclose(out);
+    rum_ordered_submit(&cfgs->ordered, index, text, size);
+}
+
+// the control-flow graph of every method in the classpath as "dot", or the "loops" of each method
+int print_cfgs(const struct rum_classpath_t *classpath, int threads, const char *format)
+{
+    if (strcmp(format, "dot") != 0 && strcmp(format, "loops") != 0)
     {
-        PRINT_FLAG(ret, "ACC_VARARGS");
+        printf("[-] unknown control-flow graph format '%s'\n", format);
+        return EXIT_FAILURE;
     }
-    if (flag & METHOD_INFO_ACC_NATIVE)
+    size_t count = classpath->count;
+    struct cfgs_t cfgs = {.classpath = classpath, .dot = strcmp(format, "dot") == 0};
+    cfgs.classes = calloc((size_t)threads, sizeof(struct class_t *));
+    cfgs.loaders = calloc((size_t)threads, sizeof(struct rum_loader_t));
+    cfgs.cfgs = calloc((size_t)threads, sizeof(struct rum_cfg_t));
+    cfgs.errors = calloc(count + 1, sizeof(int));
+    int error = cfgs.classes == NULL || cfgs.loaders == NULL || cfgs.cfgs == NULL || cfgs.errors == NULL ? RUM_ERR_NOMEM
+                                                                                                            : rum_ordered_init(&cfgs.ordered, count, stdout);
+    for (int i = 0; error == RUM_OK && i < threads; i++)
     {
-        PRINT_FLAG(ret, "ACC_NATIVE");
+        rum_loader_init(&cfgs.loaders[i]);
+        cfgs.classes[i] = rum_class_new();
+        error = cfgs.classes[i] == NULL ? RUM_ERR_NOMEM : RUM_OK;
     }
-    if (flag & METHOD_INFO_ACC_ABSTRACT)
+    if (error == RUM_OK)
     {
-        PRINT_FLAG(ret, "ACC_ABSTRACT");
+        error = rum_parallel_for(count, threads, cfg_job, &cfgs);
+        rum_ordered_free(&cfgs.ordered);
     }
-    if (flag & METHOD_INFO_ACC_STRICT)
+    for (size_t i = 0; error == RUM_OK && i < count; i++)
     {
-        PRINT_FLAG(ret, "ACC_STRICT");
+        error = cfgs.errors[i];
     }
-    if (flag & METHOD_INFO_ACC_SYNTHETIC)
+    // the workers' entries were only set up once all three arrays were allocated
+    for (int i = 0; cfgs.classes != NULL && cfgs.loaders != NULL && cfgs.cfgs != NULL && i < threads; i++)
     {
-        PRINT_FLAG(ret, "ACC_SYNTHETIC");
+        rum_class_free(cfgs.classes[i]);
+        rum_loader_release(&cfgs.loaders[i]);
+        rum_cfg_free(&cfgs.cfgs[i]);
     }
-    return strlen(ret) == 0 ? "<unknown flag>" : ret;
+    free(cfgs.classes);
+    free(cfgs.loaders);
+    free(cfgs.cfgs);
+    free(cfgs.errors);
+    return error == RUM_OK ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
-void cleanup(void)
+// "Class.method(descriptor) : 412 bytes, over FreqInlineSize 325" for every method over a limit,
+// largest first, and how many there are
+int print_inlining(const struct rum_classpath_t *classpath, int threads, const struct rum_inline_limits_t *limits)
 {
-    for (int i = 0; i < class.constant_pool_count - 1; i++)
+    struct rum_inlining_t inlining;
+    int error = rum_inlining_build(&inlining, classpath, threads, limits);
+    if (error != RUM_OK)
     {
-        if (class.constant_pool[i].tag == CONSTANT_Utf8)
-        {
-            free(class.constant_pool[i].constant_utf8.bytes);
-        }
+        printf("[-] couldn't read method sizes : %s\n", rum_strerror(error));
+        return EXIT_FAILURE;
     }
-    free(class.constant_pool);
-    free(class.interfaces);
-    for (int i = 0; i < class.fields_count; i++)
+    for (size_t i = 0; i < inlining.count; i++)
     {
-        for (int j = 0; j < class.fields[i].attributes_count; j++)
+        const struct rum_inlined_t *method = &inlining.methods[i];
+        printf("%.*s.%.*s%.*s : %u bytes, ", (int)method->class_length, method->class, (int)method->name_length, method->name,
+               (int)method->descriptor_length, method->descriptor, method->code_length);
+        if (method->flags & RUM_SIZE_HUGE)
+        {
+            printf("over HugeMethodLimit %u\n", limits->huge_method);
+        }
+        else if (method->flags & RUM_SIZE_OVER_FREQ_INLINE)
+        {
+            printf("over FreqInlineSize %u\n", limits->freq_inline);
+        }
+        else
         {
-            free(class.fields[i].attributes[j].info);
+            printf("over MaxInlineSize %u\n", limits->max_inline);
         }
-        free(class.fields[i].attributes);
     }
-    free(class.fields);
+    printf("[+] %llu methods, %llu over MaxInlineSize %u, %llu over FreqInlineSize %u, %llu over HugeMethodLimit %u\n",
+           (unsigned long long)inlining.method_count, (unsigned long long)inlining.over_max_inline, limits->max_inline,
+           (unsigned long long)inlining.over_freq_inline, limits->freq_inline, (unsigned long long)inlining.huge, limits->huge_method);
+    rum_inlining_free(&inlining);
+    return EXIT_SUCCESS;
+}
+
+// the keep/remove report, and how much of the classpath is reachable
+int print_reachable(const struct rum_classpath_t *classpath, int threads, const struct rum_reach_options_t *options)
+{
+    struct rum_reach_t reach;
+    int error = rum_reach_build(&reach, classpath, threads, options);
+    if (error != RUM_OK)
+    {
+        printf("[-] couldn't work out what is reachable : %s\n", rum_strerror(error));
+        return EXIT_FAILURE;
+    }
+    error = rum_reach_write(&reach, stdout);
+    printf("[+] %u of %u classes, %u of %u methods and %u of %u fields reachable from %u entry points in %u rounds, %llu bytes of classes removable\n",
+           reach.kept_classes, reach.class_count, reach.kept_methods, reach.method_count, reach.kept_fields, reach.field_count, reach.entry_points,
+           reach.rounds, (unsigned long long)reach.removed_bytes);
+    rum_reach_free(&reach);
+    return error == RUM_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 
-    for (int i = 0; i < class.methods_count; i++)
+// writes the classes of a jar or a class file back out, stripped of whatever `flags` drops and compacted
+int rewrite(const char *input, const char *output, int threads, int flags)
+{
+    struct rum_rewrite_t stats;
+    int error = rum_ends_with(input, ".class") ? rum_rewrite_class(input, output, flags, &stats)
+                                               : rum_rewrite_jar(input, output, threads, flags, &stats);
+    if (error != RUM_OK)
     {
-        for (int j = 0; j < class.methods[i].attributes_count; j++)
-        {
-            free(class.methods[i].attributes[j].info);
-        }
-        free(class.methods[i].attributes);
+        printf("[-] couldn't rewrite '%s' into '%s' : %s\n", input, output, rum_strerror(error));
+        return EXIT_FAILURE;
+    }
+    printf("[+] wrote %zu classes of %zu entries into '%s', classes %llu -> %llu bytes, file %llu -> %llu bytes", stats.classes,
+           stats.entries, output, (unsigned long long)stats.class_bytes, (unsigned long long)stats.written_bytes,
+           (unsigned long long)stats.input_bytes, (unsigned long long)stats.output_bytes);
+    if (flags & RUM_WRITE_COMPACT_POOL)
+    {
+        printf(", constants %llu -> %llu", (unsigned long long)stats.constants, (unsigned long long)stats.written_constants);
     }
-    free(class.methods);
-    for (int i = 0; i < class.attribute_count; i++)
+    printf("\n");
+    if (stats.unparsed > 0)
     {
-        free(class.attributes[i].info);
+        printf("[-] %zu classes couldn't be parsed and were copied as they were\n", stats.unparsed);
     }
-    free(class.attributes);
+    return EXIT_SUCCESS;
+}
+
+// reads a --max-inline/--freq-inline/--huge-method byte count, 0 when it isn't a whole number that fits
+int parse_limit(const char *text, uint32_t *limit)
+{
+    char *end;
+    errno = 0;
+    unsigned long value = strtoul(text, &end, 10);
+    if (text[0] < '0' || text[0] > '9' || *end != '\0' || errno == ERANGE || value > UINT32_MAX)
+    {
+        return 0;
+    }
+    *limit = (uint32_t)value;
+    return 1;
 }
 
-void pretty_print(void)
+void usage(const char *program)
+{
+    printf("usage : %s [-j threads] [--pipeline[=threads]] [--summary] [--cache dir] <file|directory|jar|modules>...\n", program);
+    printf("        %s [-j threads] --index <index> <file|directory|jar|modules>...\n", program);
+    printf("        %s --lookup <index> [class]...\n", program);
+    printf("        %s [-j threads] --xref <index> <file|directory|jar|modules>...\n", program);
+    printf("        %s --references <index> [owner.member[descriptor]]...\n", program);
+    printf("        %s [-j threads] --annotations <index> [--annotation type]... <file|directory|jar|modules>...\n", program);
+    printf("        %s --annotated <index> [type]...\n", program);
+    printf("        %s [-j threads] --deps <dot|csv|binary|layers> <file|directory|jar|modules>...\n", program);
+    printf("        %s [-j threads] --cfg <dot|loops> <file|directory|jar|modules>...\n", program);
+    printf("        %s [-j threads] --inlining [--max-inline n] [--freq-inline n] [--huge-method n] <file|directory|jar|modules>...\n", program);
+    printf("        %s [-j threads] --reachable [--keep pattern]... <file|directory|jar|modules>...\n", program);
+    printf("        %s [-j threads] --rewrite <output> [--strip-debug] [--compact-pool] <file|jar>\n", program);
+    printf("        %s [-j threads] --hierarchy <file|directory|jar|modules>... < queries\n", program);
+}
+
+int main(int argc, char **argv)
 {
-    printf("magic                 : 0x%x\n"
-           "minor                 : %d\n"
-           "major                 : %d\n"
-           "constant_pool_count   : %d\n",
-           class.magic, class.minor, class.major, class.constant_pool_count);
-    printf("attribute_count       : %d\n", class.attribute_count);
-    printf("access_flags          : 0x%x – %s\n"
-           "this_class            : %d\n"
-           "super_class           : %d\n"
-           "interfaces_count      : %d\n",
-           class.access_flags, get_access_flags(class.access_flags),
-           class.this_class, class.super_class, class.interfaces_count);
-    printf("fields_count          : %d\n", class.fields_count);
-    printf("methods_count         : %d\n", class.methods_count);
-    printf("interfaces           -> %s", class.interfaces_count == 0 ? "[]\n" : "\n");
-    printf("constant_pool        -> %s", class.constant_pool_count == 0 ? "[]\n" : "\n");
-    for (size_t i = 0; i < class.constant_pool_count - 1; i++)
+    int threads = rum_cpu_count();
+    int pipeline = -1; // RUM_PIPELINE_* flags when reading through the pipeline
+    int summary = 0;
+    const char *cache = NULL;
+    const char *index = NULL;
+    int hierarchy = 0;
+    const char *xref = NULL;
+    const char *deps = NULL;
+    const char *cfg = NULL;
+    int inlining = 0;
+    const char *rewritten = NULL;
+    int write_flags = 0;
+    struct rum_inline_limits_t limits = {RUM_MAX_INLINE_SIZE, RUM_FREQ_INLINE_SIZE, RUM_HUGE_METHOD_LIMIT};
+    const char *annotations = NULL;
+    // --annotation types and --keep patterns are moved to argv[1] onwards, each only in its own mode
+    size_t annotation_types = 0;
+    size_t keep_patterns = 0;
+    int reachable = 0;
+    int first = 1;
+    while (first < argc && argv[first][0] == '-')
     {
-        printf("\ttag                   : %s\n", get_tag_name(class.constant_pool[i].tag));
-        if (class.constant_pool[i].tag == CONSTANT_Methodref)
+        if (strcmp(argv[first], "-j") == 0 && first + 1 < argc)
         {
-            printf("\tclass_index           : %d\n", class.constant_pool[i].constant_methodref.class_index);
-            printf("\tname_and_type_index   : %d\n", class.constant_pool[i].constant_methodref.name_and_type_index);
+            threads = atoi(argv[first + 1]);
+            first += 2;
         }
-        else if (class.constant_pool[i].tag == CONSTANT_Utf8)
+        else if (strcmp(argv[first], "--pipeline") == 0)
         {
-            printf("\tlength                : %d\n", class.constant_pool[i].constant_utf8.length);
-            printf("\tbytes                 : \"%s\"\n", class.constant_pool[i].constant_utf8.bytes);
+            pipeline = 0;
+            first++;
         }
-        else if (class.constant_pool[i].tag == CONSTANT_Class)
+        else if (strcmp(argv[first], "--pipeline=threads") == 0)
         {
-            printf("\tname_index            : %d\n", class.constant_pool[i].constant_class.name_index);
+            pipeline = RUM_PIPELINE_NO_URING;
+            first++;
         }
-        else if (class.constant_pool[i].tag == CONSTANT_NameAndType)
+        else if (strcmp(argv[first], "--summary") == 0)
         {
-            printf("\tname_index            : %d\n", class.constant_pool[i].constant_name_and_type_info.name_index);
-            printf("\tdescriptor_index      : %d\n", class.constant_pool[i].constant_name_and_type_info.descriptor_index);
+            summary = 1;
+            first++;
         }
-        else if (class.constant_pool[i].tag == CONSTANT_Fieldref)
+        else if (strcmp(argv[first], "--cache") == 0 && first + 1 < argc)
         {
-            printf("\tclass_index          : %d\n", class.constant_pool[i].constant_fieldref.class_index);
-            printf("\tname_and_type_index  : %d\n", class.constant_pool[i].constant_fieldref.name_and_type_index);
+            cache = argv[first + 1];
+            first += 2;
         }
-        else if (class.constant_pool[i].tag == CONSTANT_String)
+        else if (strcmp(argv[first], "--index") == 0 && first + 1 < argc)
         {
-            printf("\tstring_index         : %d\n", class.constant_pool[i].constant_string.string_index);
+            index = argv[first + 1];
+            first += 2;
         }
-        else if (class.constant_pool[i].tag == CONSTANT_InterfaceMethodref)
+        else if (strcmp(argv[first], "--hierarchy") == 0)
         {
-            printf("\tclass_index          : %d\n", class.constant_pool[i].constant_interface_methodref.class_index);
-            printf("\tname_and_type_index  : %d\n", class.constant_pool[i].constant_interface_methodref.name_and_type_index);
+            hierarchy = 1;
+            first++;
         }
-        else if (class.constant_pool[i].tag == CONSTANT_InvokeDynamic)
+        else if (strcmp(argv[first], "--deps") == 0 && first + 1 < argc)
         {
-            printf("\tbootstrap_method_attr_index : %d\n", class.constant_pool[i].constant_invoke_dynamic.bootstrap_method_attr_index);
-            printf("\tname_and_type_index.        : %d\n", class.constant_pool[i].constant_invoke_dynamic.name_and_type_index);
+            deps = argv[first + 1];
+            first += 2;
         }
-        else if (class.constant_pool[i].tag == CONSTANT_MethodHandle)
+        else if (strcmp(argv[first], "--cfg") == 0 && first + 1 < argc)
         {
-            printf("\treference_kind       : %d\n", class.constant_pool[i].constant_method_handle.reference_kind);
-            printf("\treference_index      : %d\n", class.constant_pool[i].constant_method_handle.reference_index);
+            cfg = argv[first + 1];
+            first += 2;
         }
-        else if (class.constant_pool[i].tag == CONSTANT_Float)
+        else if (strcmp(argv[first], "--rewrite") == 0 && first + 1 < argc)
         {
-            printf("\tbytes                : %d\n", class.constant_pool[i].constant_float.bytes);
+            rewritten = argv[first + 1];
+            first += 2;
         }
-        else if (class.constant_pool[i].tag == CONSTANT_Integer)
+        else if (strcmp(argv[first], "--strip-debug") == 0)
         {
-            printf("\tbytes                : %d\n", class.constant_pool[i].constant_integer.bytes);
+            write_flags |= RUM_WRITE_STRIP_DEBUG;
+            first++;
         }
-        else if (class.constant_pool[i].tag == CONSTANT_Double)
+        else if (strcmp(argv[first], "--compact-pool") == 0)
         {
-            printf("\thigh_bytes           : 0x%.8x\n", class.constant_pool[i].constant_double.high_bytes);
-            printf("\tlow_bytes            : 0x%.8x\n", class.constant_pool[i].constant_double.low_bytes);
+            write_flags |= RUM_WRITE_COMPACT_POOL;
+            first++;
         }
-        else if (class.constant_pool[i].tag == CONSTANT_Long)
+        else if (strcmp(argv[first], "--inlining") == 0)
         {
-            printf("\thigh_bytes           : 0x%.8x\n", class.constant_pool[i].constant_long.high_bytes);
-            printf("\tlow_bytes            : 0x%.8x\n", class.constant_pool[i].constant_long.low_bytes);
+            inlining = 1;
+            first++;
         }
-        else if (class.constant_pool[i].tag == CONSTANT_MethodType)
+        else if (strcmp(argv[first], "--max-inline") == 0 && first + 1 < argc && parse_limit(argv[first + 1], &limits.max_inline))
         {
-            printf("\tdescriptor_index     : %d\n", class.constant_pool[i].constant_method_type.descriptor_index);
+            first += 2;
         }
-        else
+        else if (strcmp(argv[first], "--freq-inline") == 0 && first + 1 < argc && parse_limit(argv[first + 1], &limits.freq_inline))
         {
-            printf("\tunknown tag value '%d'\n", class.constant_pool[i].tag);
+            first += 2;
         }
-        printf("\t-------------------------\n");
-    }
-    for (size_t i = 0; i < class.interfaces_count; i++)
-    {
-        printf("interface count %zu    : %d\n", i, class.interfaces[i]);
-    }
-    printf("fields                -> %s", class.fields_count == 0 ? "[]\n" : "\n");
-    for (size_t i = 0; i < class.fields_count; i++)
-    {
-        printf("\taccess_flags          : 0x%.4x – %s\n"
-               "\tname_index            : %d\n"
-               "\tdescriptor_index      : %d\n"
-               "\tattributes_count      : %d\n",
-               class.fields[i].access_flags, get_field_info_access_flags(class.fields[i].access_flags), class.fields[i].name_index, class.fields[i].descriptor_index, class.fields[i].attributes_count);
-        printf("\tattributes            -> %s", class.fields[i].attributes_count == 0 ? "[]\n" : "\n");
-        for (size_t k = 0; k < class.fields[i].attributes_count; k++)
+        else if (strcmp(argv[first], "--huge-method") == 0 && first + 1 < argc && parse_limit(argv[first + 1], &limits.huge_method))
         {
-            printf("\t\tattribute_name_index    : %d\n"
-                   "\t\tattribute_length        : %d\n"
-                   "\t\tinfo                    : \"%s\"\n",
-                   class.fields[i].attributes[k].attribute_name_index, class.fields[i].attributes[k].attribute_length, class.fields[i].attributes[k].info);
+            first += 2;
         }
-        printf("\t\t----------------------------\n");
-    }
-    printf("methods               -> %s", class.methods_count == 0 ? "[]\n" : "\n");
-    for (size_t i = 0; i < class.methods_count; i++)
-    {
-        printf("\taccess_flags          : 0x%.4x – %s\n"
-               "\tname_index            : %d\n"
-               "\tdescriptor_index      : %d\n"
-               "\tattributes_count      : %d\n",
-               class.methods[i].access_flags, get_method_info_access_flags(class.methods[i].access_flags), class.methods[i].name_index, class.methods[i].descriptor_index, class.methods[i].attributes_count);
-        printf("\tattributes            -> %s", class.methods[i].attributes_count == 0 ? "[]\n" : "\n");
-        for (size_t k = 0; k < class.methods[i].attributes_count; k++)
+        else if (strcmp(argv[first], "--xref") == 0 && first + 1 < argc)
         {
-            printf("\t\tattribute_name_index    : %d\n"
-                   "\t\tattribute_length        : %d\n"
-                   "\t\tinfo                    : \"%s\"\n",
-                   class.methods[i].attributes[k].attribute_name_index, class.methods[i].attributes[k].attribute_length, class.methods[i].attributes[k].info);
+            xref = argv[first + 1];
+            first += 2;
         }
-        printf("\t\t----------------------------\n");
-    }
-    printf("attributes            -> %s", class.attribute_count == 0 ? "[]\n" : "\n");
-    for (size_t i = 0; i < class.attribute_count; i++)
-    {
-        printf("\tattribute_name_index    : %d\n"
-               "\tattribute_length        : %d\n"
-               "\tinfo                    : \"%s\"\n",
-               class.attributes[i].attribute_name_index, class.attributes[i].attribute_length, class.attributes[i].info);
-        printf("\t----------------------------\n");
-    }
-}
-
-void parse_file(FILE *file)
-{
-    // read headers from file
-    fread(&class.magic, sizeof(uint32_t), 1, file);
-    READ_U2(&class.minor);
-    READ_U2(&class.major);
-    READ_U2(&class.constant_pool_count);
-    SWAP(class.constant_pool_count);
-
-    class.constant_pool = ALLOC(struct cp_info_t, class.constant_pool_count - 1);
-    for (size_t i = 0; i < class.constant_pool_count - 1; i++)
-    {
-        uint8_t tag;
-        fread(&tag, sizeof(uint8_t), 1, file);
-
-        printf("%zu : %s\n", i, get_tag_name(tag));
-        switch (tag)
+        else if (strcmp(argv[first], "--annotations") == 0 && first + 1 < argc)
         {
-        case CONSTANT_Class:
-        {
-            unsigned short name_index;
-            READ_U2(&name_index);
-            SWAP(name_index);
-
-            struct cp_info_t cp_info = {
-                .tag = tag,
-                .constant_class = {
-                    .name_index = name_index}};
-
-            class.constant_pool[i] = cp_info;
-            break;
+            annotations = argv[first + 1];
+            first += 2;
         }
-        case CONSTANT_Fieldref:
+        else if (strcmp(argv[first], "--annotation") == 0 && first + 1 < argc)
         {
-            unsigned short class_index, name_and_type_index;
-            READ_U2(&class_index);
-            READ_U2(&name_and_type_index);
-
-            SWAP(class_index);
-            SWAP(name_and_type_index);
-
-            struct cp_info_t cp_info = {
-                .tag = tag,
-                .constant_fieldref = {
-                    .class_index = class_index,
-                    .name_and_type_index = name_and_type_index}};
-            class.constant_pool[i] = cp_info;
-            break;
+            // in internal form like the index, and over the options already read, which took at
+            // least two arguments for every type
+            for (char *c = argv[first + 1]; *c != '\0'; c++)
+            {
+                *c = *c == '.' ? '/' : *c;
+            }
+            argv[1 + annotation_types++] = argv[first + 1];
+            first += 2;
         }
-        case CONSTANT_Methodref:
+        else if (strcmp(argv[first], "--reachable") == 0)
         {
-            unsigned short class_index, name_and_type_index;
-            READ_U2(&class_index);
-            READ_U2(&name_and_type_index);
-
-            SWAP(class_index);
-            SWAP(name_and_type_index);
-
-            struct cp_info_t cp_info = {
-                .tag = tag,
-                .constant_methodref = {
-                    .class_index = class_index,
-                    .name_and_type_index = name_and_type_index}};
-            class.constant_pool[i] = cp_info;
-            break;
+            reachable = 1;
+            first++;
         }
-        case CONSTANT_InterfaceMethodref:
+        else if (strcmp(argv[first], "--keep") == 0 && first + 1 < argc)
         {
-            unsigned short class_index, name_and_type_index;
-            READ_U2(&class_index);
-            READ_U2(&name_and_type_index);
-
-            SWAP(class_index);
-            SWAP(name_and_type_index);
-
-            struct cp_info_t cp_info = {
-                .tag = tag,
-                .constant_interface_methodref = {
-                    .class_index = class_index,
-                    .name_and_type_index = name_and_type_index}};
-            class.constant_pool[i] = cp_info;
-            break;
+            // dots separate the member from the class, except in annotation types
+            for (char *c = argv[first + 1]; argv[first + 1][0] == '@' && *c != '\0'; c++)
+            {
+                *c = *c == '.' ? '/' : *c;
+            }
+            argv[1 + keep_patterns++] = argv[first + 1];
+            first += 2;
         }
-        case CONSTANT_String:
+        else if (strcmp(argv[first], "--annotated") == 0 && first + 1 < argc)
         {
-            unsigned short string_index;
-            READ_U2(&string_index);
-            SWAP(string_index);
-
-            struct cp_info_t cp_info = {
-                .tag = tag,
-                .constant_string = {
-                    .string_index = string_index}};
-            class.constant_pool[i] = cp_info;
-            break;
+            return find_annotated(argv[first + 1], argv + first + 2, argc - first - 2);
         }
-        case CONSTANT_Integer:
+        else if (strcmp(argv[first], "--references") == 0 && first + 1 < argc)
         {
-            uint32_t bytes;
-            fread(&bytes, sizeof(uint32_t), 1, file);
-            bytes = __builtin_bswap32(bytes);
-
-            struct cp_info_t cp_info = {
-                .tag = tag,
-                .constant_integer = {
-                    .bytes = bytes}};
-
-            class.constant_pool[i] = cp_info;
-            break;
+            return find_references(argv[first + 1], argv + first + 2, argc - first - 2);
         }
-        case CONSTANT_Float:
+        else if (strcmp(argv[first], "--lookup") == 0 && first + 1 < argc)
         {
-            uint32_t bytes;
-            fread(&bytes, sizeof(uint32_t), 1, file);
-            bytes = __builtin_bswap32(bytes);
-
-            struct cp_info_t cp_info = {
-                .tag = tag,
-                .constant_float = {
-                    .bytes = bytes}};
-
-            class.constant_pool[i] = cp_info;
-            break;
+            return lookup(argv[first + 1], argv + first + 2, argc - first - 2);
         }
-        case CONSTANT_Long:
-        {
-            uint32_t high_bytes, low_bytes;
-            fread(&high_bytes, sizeof(uint32_t), 1, file);
-            fread(&low_bytes, sizeof(uint32_t), 1, file);
-            high_bytes = __builtin_bswap32(high_bytes);
-            low_bytes = __builtin_bswap32(low_bytes);
-
-            struct cp_info_t cp_info = {
-                .tag = tag,
-                .constant_long = {
-                    .high_bytes = high_bytes,
-                    .low_bytes = low_bytes}};
-            class.constant_pool[i] = cp_info;
-            i++;
-            break;
-        }
-        case CONSTANT_Double:
+        else
         {
-            uint32_t high_bytes, low_bytes;
-            fread(&high_bytes, sizeof(uint32_t), 1, file);
-            fread(&low_bytes, sizeof(uint32_t), 1, file);
-            high_bytes = __builtin_bswap32(high_bytes);
-            low_bytes = __builtin_bswap32(low_bytes);
-
-            struct cp_info_t cp_info = {
-                .tag = tag,
-                .constant_double = {
-                    .high_bytes = high_bytes,
-                    .low_bytes = low_bytes}};
-
-            class.constant_pool[i] = cp_info;
-            i++;
-            break;
+            usage(argv[0]);
+            return EXIT_FAILURE;
         }
-        case CONSTANT_NameAndType:
+    }
+    // one mode per run, and the cache and summary only go with plain parsing
+    int modes = (deps != NULL) + inlining + reachable + (cfg != NULL) + hierarchy + (annotations != NULL) + (xref != NULL) +
+                (index != NULL) + (rewritten != NULL);
+    int parsing = cache != NULL || summary || pipeline >= 0;
+    if (first >= argc || modes > 1 || (modes == 1 && parsing) || (annotation_types > 0 && annotations == NULL) ||
+        (keep_patterns > 0 && !reachable))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+    if (rewritten != NULL)
+    {
+        if (argc - first != 1)
         {
-            unsigned short name_index, descriptor_index;
-            READ_U2(&name_index);
-            READ_U2(&descriptor_index);
-
-            SWAP(name_index);
-            SWAP(descriptor_index);
-
-            struct cp_info_t cp_info = {
-                .tag = tag,
-                .constant_name_and_type_info = {
-                    .name_index = name_index,
-                    .descriptor_index = descriptor_index}};
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        return rewrite(argv[first], rewritten, threads, write_flags);
+    }
 
-            class.constant_pool[i] = cp_info;
-            break;
+    struct batch_t batch = {0};
+    struct rum_cache_t opened = {0};
+    int error = rum_classpath_open(&batch.classpath, argv + first, argc - first);
+    if (error != RUM_OK)
+    {
+        printf("[-] couldn't collect input files : %s\n", rum_strerror(error));
+        rum_classpath_close(&batch.classpath);
+        return EXIT_FAILURE;
+    }
+    if (cache != NULL && (error = rum_cache_open(&opened, cache)) != RUM_OK)
+    {
+        printf("[-] couldn't open cache directory '%s' : %s\n", cache, rum_strerror(error));
+        rum_classpath_close(&batch.classpath);
+        return EXIT_FAILURE;
+    }
+    batch.cache = cache != NULL ? &opened : NULL;
+    if (deps != NULL)
+    {
+        int status = print_dependencies(&batch.classpath, threads, deps);
+        rum_classpath_close(&batch.classpath);
+        rum_cache_close(&opened);
+        return status;
+    }
+    if (inlining)
+    {
+        int status = print_inlining(&batch.classpath, threads, &limits);
+        rum_classpath_close(&batch.classpath);
+        rum_cache_close(&opened);
+        return status;
+    }
+    if (reachable)
+    {
+        struct rum_reach_options_t options = {RUM_KEEP_MAIN, (const char *const *)argv + 1, keep_patterns};
+        int status = print_reachable(&batch.classpath, threads, &options);
+        rum_classpath_close(&batch.classpath);
+        rum_cache_close(&opened);
+        return status;
+    }
+    if (cfg != NULL)
+    {
+        int status = print_cfgs(&batch.classpath, threads, cfg);
+        rum_classpath_close(&batch.classpath);
+        rum_cache_close(&opened);
+        return status;
+    }
+    if (hierarchy)
+    {
+        int status = query_hierarchy(&batch.classpath, threads);
+        rum_classpath_close(&batch.classpath);
+        rum_cache_close(&opened);
+        return status;
+    }
+    if (annotations != NULL)
+    {
+        size_t types, targets;
+        error = rum_annotations_build(&batch.classpath, threads, (const char *const *)argv + 1, annotation_types, annotations, &types, &targets);
+        if (error == RUM_OK)
+        {
+            printf("[+] indexed %zu annotation types on %zu classes and members into '%s'\n", types, targets, annotations);
         }
-        case CONSTANT_Utf8:
+        else
         {
-            unsigned short length;
-            READ_U2(&length);
-            SWAP(length);
-
-            uint8_t *bytes = ALLOC(uint8_t, length);
-            fread(bytes, sizeof(uint8_t), length, file);
-            struct cp_info_t cp_info = {
-                .tag = tag,
-                .constant_utf8 = {
-                    .length = length,
-                    .bytes = bytes}};
-            class.constant_pool[i] = cp_info;
-            break;
+            printf("[-] couldn't write annotation index '%s' : %s\n", annotations, rum_strerror(error));
         }
-        case CONSTANT_MethodHandle:
+        rum_classpath_close(&batch.classpath);
+        rum_cache_close(&opened);
+        return error == RUM_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (xref != NULL)
+    {
+        size_t members, classes;
+        error = rum_xref_build(&batch.classpath, threads, xref, &members, &classes);
+        if (error == RUM_OK)
         {
-            uint8_t reference_kind;
-            unsigned short reference_index;
-
-            fread(&reference_kind, sizeof(uint8_t), 1, file);
-            READ_U2(&reference_index);
-            SWAP(reference_index);
-
-            struct cp_info_t cp_info = {
-                .tag = tag,
-                .constant_method_handle = {
-                    .reference_kind = reference_kind,
-                    .reference_index = reference_index}};
-
-            class.constant_pool[i] = cp_info;
-            break;
+            printf("[+] indexed %zu members referenced from %zu classes into '%s'\n", members, classes, xref);
         }
-        case CONSTANT_MethodType:
+        else
         {
-            unsigned short descriptor_index;
-            READ_U2(&descriptor_index);
-            SWAP(descriptor_index);
-
-            struct cp_info_t cp_info = {
-                .tag = tag,
-                .constant_method_type = {
-                    .descriptor_index = descriptor_index}};
-
-            class.constant_pool[i] = cp_info;
-            break;
+            printf("[-] couldn't write cross-reference index '%s' : %s\n", xref, rum_strerror(error));
         }
-        case CONSTANT_InvokeDynamic:
+        rum_classpath_close(&batch.classpath);
+        rum_cache_close(&opened);
+        return error == RUM_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (index != NULL)
+    {
+        size_t indexed;
+        error = rum_symbols_build(&batch.classpath, threads, index, &indexed);
+        if (error == RUM_OK)
         {
-            unsigned short bootstrap_method_attr_index, name_and_type_index;
-            READ_U2(&bootstrap_method_attr_index);
-            READ_U2(&name_and_type_index);
-
-            SWAP(bootstrap_method_attr_index);
-            SWAP(name_and_type_index);
-
-            struct cp_info_t cp_info = {
-                .tag = tag,
-                .constant_invoke_dynamic = {
-                    .bootstrap_method_attr_index = bootstrap_method_attr_index,
-                    .name_and_type_index = name_and_type_index}};
-            class.constant_pool[i] = cp_info;
-            break;
+            printf("[+] indexed %zu classes into '%s'\n", indexed, index);
         }
-        default:
-            printf("Unexpected tag with value %d\n", tag);
-            exit(EXIT_FAILURE);
+        else
+        {
+            printf("[-] couldn't write index '%s' : %s\n", index, rum_strerror(error));
         }
+        rum_classpath_close(&batch.classpath);
+        rum_cache_close(&opened);
+        return error == RUM_OK ? EXIT_SUCCESS : EXIT_FAILURE;
     }
-    READ_U2(&class.access_flags);
-    READ_U2(&class.this_class);
-    READ_U2(&class.super_class);
-    READ_U2(&class.interfaces_count);
-    SWAP(class.interfaces_count);
 
-    class.interfaces = ALLOC(unsigned short, class.interfaces_count);
-
-    for (size_t i = 0; i < class.interfaces_count; i++)
+    size_t count = batch.classpath.count;
+    batch.classes = calloc((size_t)threads, sizeof(struct class_t *));
+    batch.loaders = calloc((size_t)threads, sizeof(struct rum_loader_t));
+    batch.summaries = calloc((size_t)threads, sizeof(struct rum_summary_t));
+    batch.summary = summary;
+    batch.hits = calloc((size_t)threads, sizeof(size_t));
+    batch.jobs = malloc(sizeof(size_t) * (count + 1));
+    batch.errors = calloc(count + 1, sizeof(int));
+    error = batch.classes == NULL || batch.loaders == NULL || batch.summaries == NULL || batch.hits == NULL || batch.jobs == NULL || batch.errors == NULL
+                ? RUM_ERR_NOMEM
+                : rum_ordered_init(&batch.ordered, count, stdout);
+    for (int i = 0; error == RUM_OK && i < threads; i++)
     {
-        unsigned short interface;
-        READ_U2(&interface);
-        class.interfaces[i] = interface;
+        rum_loader_init(&batch.loaders[i]);
+        batch.classes[i] = rum_class_new();
+        error = batch.classes[i] == NULL ? RUM_ERR_NOMEM : RUM_OK;
     }
-
-    READ_U2(&class.fields_count);
-    SWAP(class.fields_count);
-    class.fields = ALLOC(struct field_info_t, class.fields_count);
-    for (size_t i = 0; i < class.fields_count; i++)
+    for (size_t i = 0; error == RUM_OK && i < count; i++)
     {
-        unsigned short access_flags, name_index, descriptor_index, attributes_count;
-        READ_U2(&access_flags);
-        READ_U2(&name_index);
-        READ_U2(&descriptor_index);
-        READ_U2(&attributes_count);
-
-        SWAP(access_flags);
-        SWAP(name_index);
-        SWAP(descriptor_index);
-        SWAP(attributes_count);
-        struct attribute_info_t *attributes = ALLOC(struct attribute_info_t, attributes_count);
-        for (size_t k = 0; k < attributes_count; k++)
-        {
-            unsigned short name_index;
-            uint32_t attribute_length;
-            READ_U2(&name_index);
-            fread(&attribute_length, sizeof(uint32_t), 1, file);
-
-            name_index = le_to_be(name_index);
-            attribute_length = __builtin_bswap32(attribute_length);
-            unsigned char *bytes = (unsigned char *)malloc(sizeof(unsigned char) * attribute_length);
-            fread(bytes, sizeof(unsigned char), attribute_length, file);
-
-            struct attribute_info_t attribute = {
-                .attribute_name_index = name_index,
-                .attribute_length = attribute_length,
-                .info = bytes};
-
-            attributes[k] = attribute;
-        }
-
-        struct field_info_t field_info = {
-            .access_flags = access_flags,
-            .name_index = name_index,
-            .descriptor_index = descriptor_index,
-            .attributes_count = attributes_count,
-            .attributes = attributes};
-
-        class.fields[i] = field_info;
+        batch.jobs[i] = i;
     }
 
-    READ_U2(&class.methods_count);
-    SWAP(class.methods_count);
-    class.methods = ALLOC(struct method_info_t, class.methods_count);
-    for (size_t i = 0; i < class.methods_count; i++)
+    // parse every class on the worker pool, output comes out in input order. Cached classes aren't
+    // read at all, so the pipeline has nothing to overlap with
+    if (error == RUM_OK)
     {
-        unsigned short access_flags, name_index, descriptor_index, attributes_count;
-        READ_U2(&access_flags);
-        READ_U2(&name_index);
-        READ_U2(&descriptor_index);
-        READ_U2(&attributes_count);
-
-        SWAP(access_flags);
-        SWAP(name_index);
-        SWAP(descriptor_index);
-        SWAP(attributes_count);
-        struct attribute_info_t *attributes = ALLOC(struct attribute_info_t, attributes_count);
-
-        for (size_t k = 0; k < attributes_count; k++)
+        error = pipeline == -1 || batch.cache != NULL ? rum_parallel_for(count, threads, print_job, &batch)
+                               : run_pipeline(&batch, threads, pipeline);
+        rum_ordered_free(&batch.ordered);
+    }
+    if (batch.cache != NULL && batch.hits != NULL)
+    {
+        size_t hits = 0;
+        for (int i = 0; i < threads; i++)
         {
-            unsigned short name_index;
-            uint32_t attribute_length;
-            READ_U2(&name_index);
-            fread(&attribute_length, sizeof(uint32_t), 1, file);
-
-            name_index = le_to_be(name_index);
-            attribute_length = __builtin_bswap32(attribute_length);
-            unsigned char *bytes = ALLOC(unsigned char, attribute_length);
-            fread(bytes, sizeof(unsigned char), attribute_length, file);
-
-            struct attribute_info_t attribute = {
-                .attribute_name_index = name_index,
-                .attribute_length = attribute_length,
-                .info = bytes};
-
-            attributes[k] = attribute;
+            hits += batch.hits[i];
         }
-
-        struct method_info_t method = {
-            .access_flags = access_flags,
-            .name_index = name_index,
-            .descriptor_index = descriptor_index,
-            .attributes_count = attributes_count,
-            .attributes = attributes};
-
-        class.methods[i] = method;
+        fprintf(stderr, "[+] %zu of %zu classes loaded from cache '%s'\n", hits, count, cache);
     }
-
-    READ_U2(&class.attribute_count);
-    SWAP(class.attribute_count);
-    class.attributes = ALLOC(struct attribute_info_t, class.attribute_count);
-    for (size_t i = 0; i < class.attribute_count; i++)
+    for (size_t i = 0; error == RUM_OK && i < count; i++)
     {
-        unsigned short name_index;
-        uint32_t attribute_length;
-        READ_U2(&name_index);
-        fread(&attribute_length, sizeof(uint32_t), 1, file);
-
-        SWAP(name_index);
-        attribute_length = __builtin_bswap32(attribute_length);
-        unsigned char *bytes = ALLOC(unsigned char, attribute_length);
-        fread(bytes, sizeof(unsigned char), attribute_length, file);
-
-        struct attribute_info_t attribute = {
-            .attribute_name_index = name_index,
-            .attribute_length = attribute_length,
-            .info = bytes};
-
-        class.attributes[i] = attribute;
+        error = batch.errors[i];
     }
 
-    // convert them from little-endian to big-endian
-    class.magic = __builtin_bswap32(class.magic);
-    SWAP(class.minor);
-    SWAP(class.major);
-    SWAP(class.access_flags);
-    SWAP(class.this_class);
-    SWAP(class.super_class);
-}
-
-int main(int argc, char **argv)
-{
-    if (argc < 2)
-    {
-        printf("usage : %s <filename>\n", argv[0]);
-        return EXIT_FAILURE;
-    }
-    FILE *file = fopen(argv[1], "rb");
-    if (file == NULL)
+    for (int i = 0; batch.classes != NULL && batch.loaders != NULL && i < threads; i++)
     {
-        printf("[-] couldn't open file '%s'\n", argv[1]);
-        return EXIT_FAILURE;
+        rum_class_free(batch.classes[i]);
+        rum_loader_release(&batch.loaders[i]);
     }
-
-    // parse the file and map it into the `class_t` struct
-    parse_file(file);
-    pretty_print();
-    cleanup();
-    fclose(file);
-
-    return EXIT_SUCCESS;
+    free(batch.classes);
+    free(batch.loaders);
+    free(batch.summaries);
+    free(batch.hits);
+    free(batch.jobs);
+    free(batch.errors);
+    rum_classpath_close(&batch.classpath);
+    rum_cache_close(&opened);
+
+    return error == RUM_OK ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -1,5 +1,16 @@
 #!/bin/sh
 
 set -xe
-clang -Wall -Wextra -pedantic -g main.c -o out/rum
-rm -rf out/*.dSYM
+CFLAGS="-Wall -Wextra -pedantic -g"
+LIB_SOURCES="rum.c visit.c batch.c pipeline.c zip.c jimage.c classpath.c print.c utf8.c pool.c summary.c cache.c symbols.c hierarchy.c xref.c deps.c annotations.c code.c cfg.c inlining.c writer.c compact.c transform.c reach.c"
+
+OBJECTS=""
+for src in $LIB_SOURCES; do
+	clang $CFLAGS -fPIC -c $src -o out/${src%.c}.o
+	OBJECTS="$OBJECTS out/${src%.c}.o"
+done
+ar rcs out/librum.a $OBJECTS
+clang -shared $OBJECTS -o out/librum.so -pthread -lz
+clang $CFLAGS main.c out/librum.a -o out/rum -pthread -lz
+clang $CFLAGS bench.c out/librum.a -o out/bench -pthread -lz
+rm -rf out/*.o out/*.dSYM
@@ -0,0 +1,533 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "rum.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+#define PIPELINE_DEPTH 64  // files the reader keeps in flight at once
+#define PIPELINE_READERS 4 // readahead threads when io_uring is not available
+
+// a file that has been read and waits for a parse worker
+struct ready_t
+{
+    size_t index;
+    uint8_t *data;
+    size_t length;
+    int error;
+};
+
+struct pipeline_t
+{
+    const struct rum_paths_t *paths;
+    rum_file_job_t job;
+    void *user;
+
+    pthread_mutex_t lock;
+    pthread_cond_t readable; // signalled when `ready` gains an entry or the readers are done
+    pthread_cond_t writable; // signalled when `ready` loses an entry
+    struct ready_t *ready;   // ring of `capacity` entries
+    size_t capacity;
+    size_t head;
+    size_t count;
+    int readers_left;
+    size_t next_path; // next file for the readahead threads
+};
+
+struct pipeline_worker_t
+{
+    struct pipeline_t *pipeline;
+    int id;
+};
+
+static void ready_push(struct pipeline_t *pipeline, size_t index, uint8_t *data, size_t length, int error)
+{
+    pthread_mutex_lock(&pipeline->lock);
+    while (pipeline->count == pipeline->capacity)
+    {
+        pthread_cond_wait(&pipeline->writable, &pipeline->lock);
+    }
+    struct ready_t *ready = &pipeline->ready[(pipeline->head + pipeline->count) % pipeline->capacity];
+    ready->index = index;
+    ready->data = data;
+    ready->length = length;
+    ready->error = error;
+    pipeline->count++;
+    pthread_cond_signal(&pipeline->readable);
+    pthread_mutex_unlock(&pipeline->lock);
+}
+
+static void reader_done(struct pipeline_t *pipeline)
+{
+    pthread_mutex_lock(&pipeline->lock);
+    pipeline->readers_left--;
+    pthread_cond_broadcast(&pipeline->readable);
+    pthread_mutex_unlock(&pipeline->lock);
+}
+
+static void *parse_worker(void *arg)
+{
+    struct pipeline_worker_t *worker = arg;
+    struct pipeline_t *pipeline = worker->pipeline;
+    for (;;)
+    {
+        pthread_mutex_lock(&pipeline->lock);
+        while (pipeline->count == 0 && pipeline->readers_left > 0)
+        {
+            pthread_cond_wait(&pipeline->readable, &pipeline->lock);
+        }
+        if (pipeline->count == 0)
+        {
+            pthread_mutex_unlock(&pipeline->lock);
+            return NULL;
+        }
+        struct ready_t ready = pipeline->ready[pipeline->head];
+        pipeline->head = (pipeline->head + 1) % pipeline->capacity;
+        pipeline->count--;
+        pthread_cond_signal(&pipeline->writable);
+        pthread_mutex_unlock(&pipeline->lock);
+
+        pipeline->job(pipeline->user, ready.index, worker->id, ready.data, ready.length, ready.error);
+        free(ready.data);
+    }
+}
+
+// reads a whole file with plain syscalls, used by the readahead threads
+static int read_file(const char *path, uint8_t **data, size_t *length)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        return RUM_ERR_IO;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1)
+    {
+        close(fd);
+        return RUM_ERR_IO;
+    }
+    uint8_t *buffer = malloc(st.st_size == 0 ? 1 : (size_t)st.st_size);
+    if (buffer == NULL)
+    {
+        close(fd);
+        return RUM_ERR_NOMEM;
+    }
+    size_t done = 0;
+    while (done < (size_t)st.st_size)
+    {
+        ssize_t count = read(fd, buffer + done, (size_t)st.st_size - done);
+        if (count <= 0)
+        {
+            if (count == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        done += (size_t)count;
+    }
+    close(fd);
+    *data = buffer;
+    *length = done;
+    return RUM_OK;
+}
+
+static void read_and_push(struct pipeline_t *pipeline, size_t index)
+{
+    uint8_t *data = NULL;
+    size_t length = 0;
+    int error = read_file(pipeline->paths->paths[index], &data, &length);
+    ready_push(pipeline, index, data, length, error);
+}
+
+static void *readahead_worker(void *arg)
+{
+    struct pipeline_t *pipeline = arg;
+    for (;;)
+    {
+        pthread_mutex_lock(&pipeline->lock);
+        size_t index = pipeline->next_path++;
+        pthread_mutex_unlock(&pipeline->lock);
+        if (index >= pipeline->paths->count)
+        {
+            break;
+        }
+        read_and_push(pipeline, index);
+    }
+    reader_done(pipeline);
+    return NULL;
+}
+
+#ifdef HAVE_IO_URING
+struct uring_t
+{
+    int fd;
+    unsigned entries;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring;
+    void *cq_ring;
+    size_t sq_ring_size;
+    size_t cq_ring_size;
+};
+
+static int uring_init(struct uring_t *ring, unsigned entries)
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(ring, 0, sizeof(struct uring_t));
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0)
+    {
+        return RUM_ERR_IO;
+    }
+    ring->entries = params.sq_entries;
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    int single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single && ring->cq_ring_size > ring->sq_ring_size)
+    {
+        ring->sq_ring_size = ring->cq_ring_size;
+    }
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED)
+    {
+        close(ring->fd);
+        return RUM_ERR_IO;
+    }
+    ring->cq_ring = single ? ring->sq_ring : mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+    ring->sqes = mmap(NULL, params.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->cq_ring == MAP_FAILED || ring->sqes == MAP_FAILED)
+    {
+        if (ring->sqes != MAP_FAILED)
+        {
+            munmap(ring->sqes, params.sq_entries * sizeof(struct io_uring_sqe));
+        }
+        if (ring->cq_ring != MAP_FAILED && ring->cq_ring != ring->sq_ring)
+        {
+            munmap(ring->cq_ring, ring->cq_ring_size);
+        }
+        munmap(ring->sq_ring, ring->sq_ring_size);
+        close(ring->fd);
+        return RUM_ERR_IO;
+    }
+
+    uint8_t *sq = ring->sq_ring, *cq = ring->cq_ring;
+    ring->sq_head = (unsigned *)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    return RUM_OK;
+}
+
+static void uring_free(struct uring_t *ring)
+{
+    munmap(ring->sqes, ring->entries * sizeof(struct io_uring_sqe));
+    if (ring->cq_ring != ring->sq_ring)
+    {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    munmap(ring->sq_ring, ring->sq_ring_size);
+    close(ring->fd);
+}
+
+// queues an sqe, it only reaches the kernel with the next `uring_enter`
+static struct io_uring_sqe *uring_sqe(struct uring_t *ring)
+{
+    unsigned tail = *ring->sq_tail;
+    unsigned index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    return sqe;
+}
+
+static int uring_enter(struct uring_t *ring, unsigned submit, unsigned wait)
+{
+    for (;;)
+    {
+        int result = (int)syscall(__NR_io_uring_enter, ring->fd, submit, wait, wait > 0 ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (result >= 0 || errno != EINTR)
+        {
+            return result;
+        }
+    }
+}
+
+// per file state of the io_uring reader
+struct uring_file_t
+{
+    int fd;
+    uint8_t *data;
+    size_t length;
+    size_t done;
+    int handed; // pushed to the parse workers
+};
+
+static void uring_queue_read(struct uring_t *ring, struct uring_file_t *file, size_t index)
+{
+    struct io_uring_sqe *sqe = uring_sqe(ring);
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = file->fd;
+    sqe->addr = (uint64_t)(uintptr_t)(file->data + file->done);
+    sqe->len = (uint32_t)(file->length - file->done);
+    sqe->off = file->done;
+    sqe->user_data = index;
+}
+
+// submits opens and reads for up to PIPELINE_DEPTH files at a time, a completed open turns into a read
+// and a completed read hands the buffer over to the parse workers
+static void *uring_reader(void *arg)
+{
+    struct pipeline_t *pipeline = arg;
+    struct uring_file_t *files = calloc(pipeline->paths->count + 1, sizeof(struct uring_file_t));
+    struct uring_t ring;
+    if (files == NULL || uring_init(&ring, PIPELINE_DEPTH * 2) != RUM_OK)
+    {
+        for (size_t i = 0; i < pipeline->paths->count; i++)
+        {
+            read_and_push(pipeline, i);
+        }
+        free(files);
+        reader_done(pipeline);
+        return NULL;
+    }
+
+    size_t next = 0, in_flight = 0, finished = 0;
+    unsigned pending = 0;
+    while (finished < pipeline->paths->count)
+    {
+        while (next < pipeline->paths->count && in_flight < PIPELINE_DEPTH)
+        {
+            struct io_uring_sqe *sqe = uring_sqe(&ring);
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = (uint64_t)(uintptr_t)pipeline->paths->paths[next];
+            sqe->open_flags = O_RDONLY;
+            sqe->user_data = next;
+            files[next].fd = -1;
+            next++;
+            in_flight++;
+            pending++;
+        }
+
+        if (uring_enter(&ring, pending, 1) < 0)
+        {
+            // finish the remaining files without the ring, buffers of reads that may still
+            // be in flight are abandoned rather than freed under the kernel. Files whose open
+            // completed are closed, an in-flight read holds its own reference to the file
+            for (size_t i = 0; i < pipeline->paths->count; i++)
+            {
+                if (!files[i].handed)
+                {
+                    if (i < next && files[i].fd >= 0)
+                    {
+                        close(files[i].fd);
+                    }
+                    read_and_push(pipeline, i);
+                }
+            }
+            break;
+        }
+        pending = 0;
+
+        unsigned head = *ring.cq_head;
+        unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++)
+        {
+            struct io_uring_cqe *cqe = &ring.cqes[head & *ring.cq_mask];
+            size_t index = (size_t)cqe->user_data;
+            struct uring_file_t *file = &files[index];
+            int error = RUM_OK;
+
+            if (file->fd == -1)
+            {
+                // the open finished, size the buffer and queue the read
+                struct stat st;
+                if (cqe->res == -EINVAL)
+                {
+                    // kernels before 5.6 know io_uring but not IORING_OP_OPENAT/READ
+                    file->handed = 1;
+                    read_and_push(pipeline, index);
+                    in_flight--;
+                    finished++;
+                    continue;
+                }
+                else if (cqe->res < 0)
+                {
+                    error = RUM_ERR_IO;
+                }
+                else if (fstat(file->fd = cqe->res, &st) == -1)
+                {
+                    error = RUM_ERR_IO;
+                }
+                else if ((file->data = malloc(st.st_size == 0 ? 1 : (size_t)st.st_size)) == NULL)
+                {
+                    error = RUM_ERR_NOMEM;
+                }
+                else if ((file->length = (size_t)st.st_size) > 0)
+                {
+                    uring_queue_read(&ring, file, index);
+                    pending++;
+                    continue;
+                }
+            }
+            else if (cqe->res < 0)
+            {
+                error = RUM_ERR_IO;
+            }
+            else if (cqe->res > 0 && (file->done += (size_t)cqe->res) < file->length)
+            {
+                // short read, ask for the rest
+                uring_queue_read(&ring, file, index);
+                pending++;
+                continue;
+            }
+
+            if (file->fd >= 0)
+            {
+                close(file->fd);
+            }
+            if (error != RUM_OK)
+            {
+                free(file->data);
+                file->data = NULL;
+            }
+            file->handed = 1;
+            ready_push(pipeline, index, file->data, file->done, error);
+            in_flight--;
+            finished++;
+        }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    free(files);
+    uring_free(&ring);
+    reader_done(pipeline);
+    return NULL;
+}
+
+int rum_pipeline_has_io_uring(void)
+{
+    struct uring_t ring;
+    if (uring_init(&ring, 1) != RUM_OK)
+    {
+        return 0;
+    }
+    uring_free(&ring);
+    return 1;
+}
+#else
+int rum_pipeline_has_io_uring(void)
+{
+    return 0;
+}
+#endif
+
+int rum_pipeline(const struct rum_paths_t *paths, int threads, int flags, rum_file_job_t job, void *user)
+{
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+    int use_uring = !(flags & RUM_PIPELINE_NO_URING) && rum_pipeline_has_io_uring();
+    int readers = use_uring ? 1 : PIPELINE_READERS;
+
+    struct pipeline_t pipeline = {
+        .paths = paths,
+        .job = job,
+        .user = user,
+        .capacity = PIPELINE_DEPTH + (size_t)threads * 4,
+        .readers_left = readers};
+    pipeline.ready = calloc(pipeline.capacity, sizeof(struct ready_t));
+    pthread_t *handles = calloc((size_t)(threads + readers), sizeof(pthread_t));
+    struct pipeline_worker_t *workers = calloc((size_t)threads, sizeof(struct pipeline_worker_t));
+    if (pipeline.ready == NULL || handles == NULL || workers == NULL)
+    {
+        free(pipeline.ready);
+        free(handles);
+        free(workers);
+        return RUM_ERR_NOMEM;
+    }
+    pthread_mutex_init(&pipeline.lock, NULL);
+    pthread_cond_init(&pipeline.readable, NULL);
+    pthread_cond_init(&pipeline.writable, NULL);
+
+    int started = 0, error = RUM_OK;
+    for (int i = 0; i < readers; i++)
+    {
+#ifdef HAVE_IO_URING
+        void *(*reader)(void *) = use_uring ? uring_reader : readahead_worker;
+#else
+        void *(*reader)(void *) = readahead_worker;
+#endif
+        if (pthread_create(&handles[started], NULL, reader, &pipeline) != 0)
+        {
+            // the readers that did start take over the missing ones' files
+            reader_done(&pipeline);
+            continue;
+        }
+        started++;
+    }
+    if (started == 0)
+    {
+        error = RUM_ERR_NOMEM;
+    }
+    for (int i = 0; error == RUM_OK && i < threads; i++)
+    {
+        workers[i].pipeline = &pipeline;
+        workers[i].id = i;
+        if (i > 0 && pthread_create(&handles[started], NULL, parse_worker, &workers[i]) == 0)
+        {
+            started++;
+        }
+    }
+    // the calling thread is parse worker 0
+    if (error == RUM_OK)
+    {
+        parse_worker(&workers[0]);
+    }
+    for (int i = 0; i < started; i++)
+    {
+        pthread_join(handles[i], NULL);
+    }
+
+    pthread_cond_destroy(&pipeline.writable);
+    pthread_cond_destroy(&pipeline.readable);
+    pthread_mutex_destroy(&pipeline.lock);
+    free(pipeline.ready);
+    free(handles);
+    free(workers);
+    return error;
+}
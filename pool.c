@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+
+#include "rum.h"
+
+// bytes after the tag, for every tag whose payload has a fixed size
+static size_t payload_size(uint8_t tag)
+{
+    switch (tag)
+    {
+    case CONSTANT_Class:
+    case CONSTANT_String:
+    case CONSTANT_MethodType:
+        return 2;
+    case CONSTANT_MethodHandle:
+        return 3;
+    case CONSTANT_Fieldref:
+    case CONSTANT_Methodref:
+    case CONSTANT_InterfaceMethodref:
+    case CONSTANT_NameAndType:
+    case CONSTANT_InvokeDynamic:
+    case CONSTANT_Integer:
+    case CONSTANT_Float:
+        return 4;
+    case CONSTANT_Long:
+    case CONSTANT_Double:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+int rum_pool_parse(struct rum_pool_t *pool, const uint8_t *data, size_t length)
+{
+    struct cursor_t cursor = {
+        .data = data,
+        .length = length,
+        .offset = 0,
+        .overflow = 0};
+
+    arena_reset(&pool->arena);
+    pool->data = data;
+    pool->length = length;
+    pool->count = 0;
+    pool->end = 0;
+
+    uint32_t magic = read_u4(&cursor);
+    read_u4(&cursor); // minor and major
+    unsigned short count = read_u2(&cursor);
+    if (cursor.overflow)
+    {
+        return RUM_ERR_TRUNCATED;
+    }
+    if (magic != 0xcafebabe)
+    {
+        return RUM_ERR_MAGIC;
+    }
+    if (count == 0)
+    {
+        return RUM_ERR_FORMAT;
+    }
+
+    // one array per column, all indexed by the pool index itself so slot 0 is just left empty
+    size_t tags_size = ((size_t)count + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (arena_reserve(&pool->arena, tags_size + (size_t)count * 8 + ARENA_ALIGN * 2) != RUM_OK)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    pool->tags = arena_alloc(&pool->arena, tags_size);
+    pool->offsets = arena_alloc(&pool->arena, sizeof(uint32_t) * count);
+    pool->values = arena_alloc(&pool->arena, sizeof(uint32_t) * count);
+    if (pool->tags == NULL || pool->offsets == NULL || pool->values == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    pool->tags[0] = 0;
+    pool->offsets[0] = 0;
+    pool->values[0] = 0;
+
+    for (unsigned short index = 1; index < count; index++)
+    {
+        uint32_t offset = (uint32_t)cursor.offset;
+        uint8_t tag = read_u1(&cursor);
+        uint32_t value;
+        if (tag == CONSTANT_Utf8)
+        {
+            unsigned short size = read_u2(&cursor);
+            const uint8_t *bytes = read_bytes(&cursor, size);
+            int valid = cursor.overflow ? RUM_MUTF8_STANDARD : rum_mutf8_valid(bytes, size);
+            if (!valid)
+            {
+                return RUM_ERR_UTF8;
+            }
+            value = size | (valid == RUM_MUTF8_MODIFIED ? RUM_POOL_MODIFIED : 0);
+        }
+        else if (payload_size(tag) == 2)
+        {
+            value = read_u2(&cursor);
+        }
+        else if (tag == CONSTANT_MethodHandle)
+        {
+            value = (uint32_t)read_u1(&cursor) << 16;
+            value |= read_u2(&cursor);
+        }
+        else if (payload_size(tag) >= 4)
+        {
+            // two u2 indices read as one u4 are already packed as `first << 16 | second`
+            value = read_u4(&cursor);
+        }
+        else
+        {
+            return cursor.overflow ? RUM_ERR_TRUNCATED : RUM_ERR_TAG;
+        }
+        if (cursor.overflow)
+        {
+            return RUM_ERR_TRUNCATED;
+        }
+
+        pool->tags[index] = tag;
+        pool->offsets[index] = offset;
+        pool->values[index] = value;
+        if (tag == CONSTANT_Long || tag == CONSTANT_Double)
+        {
+            // the low word goes in the slot the JVM leaves unusable, whose tag stays 0
+            uint32_t low = read_u4(&cursor);
+            if (index + 1 < count)
+            {
+                index++;
+                pool->tags[index] = 0;
+                pool->offsets[index] = offset;
+                pool->values[index] = low;
+            }
+        }
+    }
+    pool->count = count;
+    pool->end = cursor.offset;
+    return RUM_OK;
+}
+
+void rum_pool_release(struct rum_pool_t *pool)
+{
+    arena_release(&pool->arena);
+    memset(pool, 0, sizeof(struct rum_pool_t));
+}
+
+unsigned short rum_pool_next(const struct rum_pool_t *pool, uint8_t tag, unsigned short index)
+{
+    // the tags are one dense byte array, so this is libc's vectorized memchr
+    if (index >= pool->count)
+    {
+        return 0;
+    }
+    const uint8_t *found = memchr(pool->tags + index, tag, pool->count - index);
+    return found == NULL ? 0 : (unsigned short)(found - pool->tags);
+}
+
+size_t rum_pool_count_tag(const struct rum_pool_t *pool, uint8_t tag)
+{
+    size_t found = 0;
+    for (unsigned short i = 1; i < pool->count; i++)
+    {
+        found += pool->tags[i] == tag;
+    }
+    return found;
+}
+
+const uint8_t *rum_pool_utf8(const struct rum_pool_t *pool, unsigned short index, unsigned short *length)
+{
+    if (index == 0 || index >= pool->count || pool->tags[index] != CONSTANT_Utf8)
+    {
+        return NULL;
+    }
+    *length = (unsigned short)pool->values[index];
+    // tag and length come before the bytes
+    return pool->data + pool->offsets[index] + 3;
+}
+
+uint64_t rum_pool_wide(const struct rum_pool_t *pool, unsigned short index)
+{
+    if (index == 0 || index + 1 >= pool->count || (pool->tags[index] != CONSTANT_Long && pool->tags[index] != CONSTANT_Double))
+    {
+        return 0;
+    }
+    return (uint64_t)pool->values[index] << 32 | pool->values[index + 1];
+}
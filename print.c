@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "rum.h"
+
+// strings are printed as standard UTF-8, converted only when they hold a NUL or a surrogate pair.
+// They are written out whole, a "%.*s" would stop at the first NUL
+static int print_utf8(FILE *out, const char *before, const struct constant_utf8_t *utf8, const char *after)
+{
+    const uint8_t *bytes = utf8->bytes;
+    size_t length = utf8->length;
+    uint8_t *converted = NULL;
+    if (utf8->modified)
+    {
+        if ((converted = malloc(utf8->length)) == NULL)
+        {
+            return RUM_ERR_NOMEM;
+        }
+        length = rum_mutf8_to_utf8(utf8->bytes, utf8->length, converted);
+        bytes = converted;
+    }
+    fputs(before, out);
+    fwrite(bytes, 1, length, out);
+    fputs(after, out);
+    free(converted);
+    return RUM_OK;
+}
+
+// "pc : mnemonic operands", pool indices as #index and branches as the pc they go to
+static void print_insn(FILE *out, const struct rum_insn_t *insn)
+{
+    const uint8_t *operands = insn->operands;
+    fprintf(out, "\t\t\t%-6u : %s%s", insn->pc, insn->wide ? "wide " : "", rum_opcode_name(insn->opcode));
+    if (insn->flags & RUM_INSN_SWITCH)
+    {
+        struct rum_switch_t table;
+        rum_insn_switch(insn, &table);
+        fprintf(out, " default -> %lld", (long long)table.default_target);
+        for (uint32_t i = 0; i < table.count; i++)
+        {
+            int32_t match;
+            int64_t target = rum_switch_case(&table, i, &match);
+            fprintf(out, ", %d -> %lld", match, (long long)target);
+        }
+    }
+    else if (insn->flags & RUM_INSN_BRANCH)
+    {
+        fprintf(out, " %lld", (long long)rum_insn_target(insn));
+    }
+    else if (insn->flags & RUM_INSN_POOL)
+    {
+        fprintf(out, " #%u", insn->opcode == OP_ldc ? operands[0] : rum_insn_u2(insn));
+        if (insn->opcode == OP_invokeinterface || insn->opcode == OP_multianewarray)
+        {
+            fprintf(out, ", %u", operands[2]);
+        }
+    }
+    else if (insn->flags & RUM_INSN_LOCAL)
+    {
+        fprintf(out, " %u", insn->wide ? rum_insn_u2(insn) : operands[0]);
+        if (insn->opcode == OP_iinc)
+        {
+            fprintf(out, ", %d", insn->wide ? (int16_t)(operands[2] << 8 | operands[3]) : (int8_t)operands[1]);
+        }
+    }
+    else if (insn->opcode == OP_bipush || insn->opcode == OP_newarray)
+    {
+        fprintf(out, " %d", insn->opcode == OP_bipush ? (int8_t)operands[0] : operands[0]);
+    }
+    else if (insn->opcode == OP_sipush)
+    {
+        fprintf(out, " %d", (int16_t)rum_insn_u2(insn));
+    }
+    fprintf(out, "\n");
+}
+
+// a method's Code attribute with its instructions, exception table and nested attributes
+static void print_code(FILE *out, const struct class_t *class, const struct attribute_info_t *attribute)
+{
+    struct rum_code_t code;
+    int error = rum_code_decode(class->data, attribute, &code);
+    if (error != RUM_OK)
+    {
+        fprintf(out, "\t\tinfo                    : <%s>\n", rum_strerror(error));
+        return;
+    }
+    fprintf(out, "\t\tmax_stack               : %d\n"
+                 "\t\tmax_locals              : %d\n"
+                 "\t\tcode_length             : %u\n"
+                 "\t\tcode                    -> \n",
+                 code.max_stack, code.max_locals, code.code_length);
+    struct rum_insn_iter_t iter;
+    struct rum_insn_t insn;
+    rum_insn_begin(&iter, &code);
+    while (rum_insn_next(&iter, &insn))
+    {
+        print_insn(out, &insn);
+    }
+    if (iter.error != RUM_OK)
+    {
+        fprintf(out, "\t\t\t%-6u : <%s>\n", iter.pc, rum_strerror(iter.error));
+    }
+    fprintf(out, "\t\texception_table         -> %s", code.exception_table_length == 0 ? "[]\n" : "\n");
+    for (unsigned short i = 0; i < code.exception_table_length; i++)
+    {
+        struct rum_exception_t exception;
+        rum_code_exception(&code, i, &exception);
+        fprintf(out, "\t\t\tstart_pc %d, end_pc %d, handler_pc %d, catch_type #%d\n",
+                exception.start_pc, exception.end_pc, exception.handler_pc, exception.catch_type);
+    }
+    fprintf(out, "\t\tattributes              -> %s", code.attributes_count == 0 ? "[]\n" : "\n");
+    uint32_t offset = 0;
+    for (unsigned short i = 0; i < code.attributes_count; i++)
+    {
+        struct attribute_info_t nested;
+        rum_code_attribute(class->data, &code, &offset, &nested);
+        fprintf(out, "\t\t\tattribute_name_index    : %d\n"
+                     "\t\t\tattribute_length        : %d\n"
+                     "\t\t\tinfo                    : \"%.*s\"\n",
+                     nested.attribute_name_index, nested.attribute_length, (int)nested.attribute_length, rum_attribute_info(class, &nested));
+    }
+}
+
+int rum_pretty_print(FILE *out, const struct class_t *class)
+{
+    char flags[ACCESS_FLAGS_MAX];
+
+    fprintf(out, "magic                 : 0x%x\n"
+                 "minor                 : %d\n"
+                 "major                 : %d\n"
+                 "constant_pool_count   : %d\n",
+                 class->magic, class->minor, class->major, class->constant_pool_count);
+    fprintf(out, "attribute_count       : %d\n", class->attribute_count);
+    fprintf(out, "access_flags          : 0x%x – %s\n"
+                 "this_class            : %d\n"
+                 "super_class           : %d\n"
+                 "interfaces_count      : %d\n",
+                 class->access_flags, get_access_flags(class->access_flags, flags),
+                 class->this_class, class->super_class, class->interfaces_count);
+    fprintf(out, "fields_count          : %d\n", class->fields_count);
+    fprintf(out, "methods_count         : %d\n", class->methods_count);
+    fprintf(out, "interfaces           -> %s", class->interfaces_count == 0 ? "[]\n" : "\n");
+    fprintf(out, "constant_pool        -> %s", class->constant_pool_count == 0 ? "[]\n" : "\n");
+    for (size_t i = 0; i < class->constant_pool_count - 1; i++)
+    {
+        fprintf(out, "\ttag                   : %s\n", get_tag_name(class->constant_pool[i].tag));
+        if (class->constant_pool[i].tag == CONSTANT_Methodref)
+        {
+            fprintf(out, "\tclass_index           : %d\n", class->constant_pool[i].constant_methodref.class_index);
+            fprintf(out, "\tname_and_type_index   : %d\n", class->constant_pool[i].constant_methodref.name_and_type_index);
+        }
+        else if (class->constant_pool[i].tag == CONSTANT_Utf8)
+        {
+            fprintf(out, "\tlength                : %d\n", class->constant_pool[i].constant_utf8.length);
+            int error = print_utf8(out, "\tbytes                 : \"", &class->constant_pool[i].constant_utf8, "\"\n");
+            if (error != RUM_OK)
+            {
+                return error;
+            }
+        }
+        else if (class->constant_pool[i].tag == CONSTANT_Class)
+        {
+            fprintf(out, "\tname_index            : %d\n", class->constant_pool[i].constant_class.name_index);
+        }
+        else if (class->constant_pool[i].tag == CONSTANT_NameAndType)
+        {
+            fprintf(out, "\tname_index            : %d\n", class->constant_pool[i].constant_name_and_type_info.name_index);
+            fprintf(out, "\tdescriptor_index      : %d\n", class->constant_pool[i].constant_name_and_type_info.descriptor_index);
+        }
+        else if (class->constant_pool[i].tag == CONSTANT_Fieldref)
+        {
+            fprintf(out, "\tclass_index          : %d\n", class->constant_pool[i].constant_fieldref.class_index);
+            fprintf(out, "\tname_and_type_index  : %d\n", class->constant_pool[i].constant_fieldref.name_and_type_index);
+        }
+        else if (class->constant_pool[i].tag == CONSTANT_String)
+        {
+            fprintf(out, "\tstring_index         : %d\n", class->constant_pool[i].constant_string.string_index);
+        }
+        else if (class->constant_pool[i].tag == CONSTANT_InterfaceMethodref)
+        {
+            fprintf(out, "\tclass_index          : %d\n", class->constant_pool[i].constant_interface_methodref.class_index);
+            fprintf(out, "\tname_and_type_index  : %d\n", class->constant_pool[i].constant_interface_methodref.name_and_type_index);
+        }
+        else if (class->constant_pool[i].tag == CONSTANT_InvokeDynamic)
+        {
+            fprintf(out, "\tbootstrap_method_attr_index : %d\n", class->constant_pool[i].constant_invoke_dynamic.bootstrap_method_attr_index);
+            fprintf(out, "\tname_and_type_index.        : %d\n", class->constant_pool[i].constant_invoke_dynamic.name_and_type_index);
+        }
+        else if (class->constant_pool[i].tag == CONSTANT_MethodHandle)
+        {
+            fprintf(out, "\treference_kind       : %d\n", class->constant_pool[i].constant_method_handle.reference_kind);
+            fprintf(out, "\treference_index      : %d\n", class->constant_pool[i].constant_method_handle.reference_index);
+        }
+        else if (class->constant_pool[i].tag == CONSTANT_Float)
+        {
+            fprintf(out, "\tbytes                : %d\n", class->constant_pool[i].constant_float.bytes);
+        }
+        else if (class->constant_pool[i].tag == CONSTANT_Integer)
+        {
+            fprintf(out, "\tbytes                : %d\n", class->constant_pool[i].constant_integer.bytes);
+        }
+        else if (class->constant_pool[i].tag == CONSTANT_Double)
+        {
+            fprintf(out, "\thigh_bytes           : 0x%.8x\n", class->constant_pool[i].constant_double.high_bytes);
+            fprintf(out, "\tlow_bytes            : 0x%.8x\n", class->constant_pool[i].constant_double.low_bytes);
+        }
+        else if (class->constant_pool[i].tag == CONSTANT_Long)
+        {
+            fprintf(out, "\thigh_bytes           : 0x%.8x\n", class->constant_pool[i].constant_long.high_bytes);
+            fprintf(out, "\tlow_bytes            : 0x%.8x\n", class->constant_pool[i].constant_long.low_bytes);
+        }
+        else if (class->constant_pool[i].tag == CONSTANT_MethodType)
+        {
+            fprintf(out, "\tdescriptor_index     : %d\n", class->constant_pool[i].constant_method_type.descriptor_index);
+        }
+        else
+        {
+            fprintf(out, "\tunknown tag value '%d'\n", class->constant_pool[i].tag);
+        }
+        fprintf(out, "\t-------------------------\n");
+    }
+    for (size_t i = 0; i < class->interfaces_count; i++)
+    {
+        fprintf(out, "interface count %zu    : %d\n", i, class->interfaces[i]);
+    }
+    fprintf(out, "fields                -> %s", class->fields_count == 0 ? "[]\n" : "\n");
+    for (size_t i = 0; i < class->fields_count; i++)
+    {
+        fprintf(out, "\taccess_flags          : 0x%.4x – %s\n"
+                     "\tname_index            : %d\n"
+                     "\tdescriptor_index      : %d\n"
+                     "\tattributes_count      : %d\n",
+                     class->fields[i].access_flags, get_field_info_access_flags(class->fields[i].access_flags, flags), class->fields[i].name_index, class->fields[i].descriptor_index, class->fields[i].attributes_count);
+        fprintf(out, "\tattributes            -> %s", class->fields[i].attributes_count == 0 ? "[]\n" : "\n");
+        for (size_t k = 0; k < class->fields[i].attributes_count; k++)
+        {
+            fprintf(out, "\t\tattribute_name_index    : %d\n"
+                         "\t\tattribute_length        : %d\n"
+                         "\t\tinfo                    : \"%.*s\"\n",
+                         class->fields[i].attributes[k].attribute_name_index, class->fields[i].attributes[k].attribute_length, (int)class->fields[i].attributes[k].attribute_length, rum_attribute_info(class, &class->fields[i].attributes[k]));
+        }
+        fprintf(out, "\t\t----------------------------\n");
+    }
+    fprintf(out, "methods               -> %s", class->methods_count == 0 ? "[]\n" : "\n");
+    for (size_t i = 0; i < class->methods_count; i++)
+    {
+        fprintf(out, "\taccess_flags          : 0x%.4x – %s\n"
+                     "\tname_index            : %d\n"
+                     "\tdescriptor_index      : %d\n"
+                     "\tattributes_count      : %d\n",
+                     class->methods[i].access_flags, get_method_info_access_flags(class->methods[i].access_flags, flags), class->methods[i].name_index, class->methods[i].descriptor_index, class->methods[i].attributes_count);
+        fprintf(out, "\tattributes            -> %s", class->methods[i].attributes_count == 0 ? "[]\n" : "\n");
+        for (size_t k = 0; k < class->methods[i].attributes_count; k++)
+        {
+            const struct attribute_info_t *attribute = &class->methods[i].attributes[k];
+            fprintf(out, "\t\tattribute_name_index    : %d\n"
+                         "\t\tattribute_length        : %d\n",
+                         attribute->attribute_name_index, attribute->attribute_length);
+            if (rum_attribute_is(class, attribute, "Code"))
+            {
+                print_code(out, class, attribute);
+            }
+            else
+            {
+                fprintf(out, "\t\tinfo                    : \"%.*s\"\n", (int)attribute->attribute_length, rum_attribute_info(class, attribute));
+            }
+        }
+        fprintf(out, "\t\t----------------------------\n");
+    }
+    fprintf(out, "attributes            -> %s", class->attribute_count == 0 ? "[]\n" : "\n");
+    for (size_t i = 0; i < class->attribute_count; i++)
+    {
+        fprintf(out, "\tattribute_name_index    : %d\n"
+                     "\tattribute_length        : %d\n"
+                     "\tinfo                    : \"%.*s\"\n",
+                     class->attributes[i].attribute_name_index, class->attributes[i].attribute_length, (int)class->attributes[i].attribute_length, rum_attribute_info(class, &class->attributes[i]));
+        fprintf(out, "\t----------------------------\n");
+    }
+    return RUM_OK;
+}
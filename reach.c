@@ -0,0 +1,1461 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "rum.h"
+
+#define TABLE_SEED 0x52454143
+
+// what code does with a class or member, by name until the classpath is merged
+#define USE_CLASS 0   // a cast, a catch, a class literal or a type in a descriptor, loads the class
+#define USE_NEW 1     // new, or a constructor handle
+#define USE_INVOKE 2  // invokestatic and invokespecial, the one method they resolve to
+#define USE_VIRTUAL 3 // invokevirtual and invokeinterface, dispatched on every instantiated subtype
+#define USE_FIELD 4
+
+// what a round's workers found for the serial part to apply
+#define EVENT_CLASS 0  // `a` is a name
+#define EVENT_NEW 1    // `a` is a name
+#define EVENT_METHOD 2 // `a` is a method
+#define EVENT_FIELD 3  // `a` is a field
+#define EVENT_CALL 4   // a virtual call on `a`, the name `b` and descriptor `c`
+
+struct use_t
+{
+    uint32_t kind; // USE_*
+    uint32_t owner;
+    uint32_t name; // RUM_HIERARCHY_NONE for classes
+    uint32_t descriptor;
+};
+
+struct event_t
+{
+    uint32_t kind; // EVENT_*
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+};
+
+struct found_member_t
+{
+    uint32_t name;
+    uint32_t descriptor;
+    unsigned short access_flags;
+    uint8_t entry;
+    uint32_t first_use; // into the worker's uses
+    uint32_t use_count;
+};
+
+struct found_class_t
+{
+    size_t entry;
+    uint32_t name;
+    uint32_t superclass;
+    uint32_t length;
+    unsigned short access_flags;
+    uint8_t entry_point;
+    unsigned short interface_count;
+    uint32_t first_interface; // into the worker's interfaces
+    uint32_t first_member;    // the fields, then the methods
+    unsigned short field_count;
+    unsigned short method_count;
+};
+
+struct pattern_t
+{
+    const char *class;
+    size_t class_length;
+    const char *member; // NULL when the whole class is kept
+    size_t member_length;
+    int prefix;     // the class only has to start with `class`
+    int annotation; // `class` is an annotation type
+};
+
+struct reach_worker_t
+{
+    struct class_t *class;
+    struct rum_loader_t loader;
+    struct rum_names_t names;
+    struct found_class_t *classes;
+    size_t class_count;
+    size_t class_capacity;
+    struct found_member_t *members;
+    size_t member_count;
+    size_t member_capacity;
+    struct use_t *uses;
+    size_t use_count;
+    size_t use_capacity;
+    uint32_t *interfaces;
+    size_t interface_count;
+    size_t interface_capacity;
+    const uint8_t *bootstrap_methods; // the current class's BootstrapMethods body, entries at `bootstraps`
+    uint32_t *bootstraps;
+    size_t bootstrap_count;
+    size_t bootstrap_capacity;
+    int bootstraps_read;
+    struct event_t *events;
+    size_t event_count;
+    size_t event_capacity;
+    struct rum_walk_t walk;
+    int error;
+};
+
+// a (class or name, name, descriptor) key to a value, open addressing
+struct table_t
+{
+    uint32_t *slots; // four words per slot, the value last and RUM_HIERARCHY_NONE in empty ones
+    uint32_t slot_count;
+    uint32_t count;
+};
+
+// a virtual call site, chained off the name it was made on
+struct site_t
+{
+    uint32_t name;
+    uint32_t descriptor;
+    uint32_t next;
+};
+
+struct reach_build_t
+{
+    const struct rum_classpath_t *classpath;
+    int flags;
+    struct pattern_t *patterns;
+    size_t pattern_count;
+    int annotations; // some of the patterns are annotation types
+    struct reach_worker_t *workers;
+    struct rum_reach_t *reach;
+    uint32_t *class_of; // class of every name, RUM_HIERARCHY_NONE for the ones not in the classpath
+    uint32_t *super_offsets; // direct supertypes of class k, by name, the superclass first
+    uint32_t *supers;
+    uint32_t *sub_offsets; // classes extending or implementing name n directly
+    uint32_t *subs;
+    uint32_t *field_class;
+    uint32_t *method_class;
+    uint32_t *field_uses; // uses of field f are uses[field_uses[f]] to uses[field_uses[f + 1] - 1]
+    uint32_t *method_uses;
+    struct use_t *uses;
+    struct table_t fields; // (class, name, descriptor) to the member
+    struct table_t methods;
+    struct table_t calls; // (name, name, descriptor) of every virtual call seen
+    uint32_t *heads;      // first call site of every name, into `sites`
+    struct site_t *sites;
+    size_t site_count;
+    size_t site_capacity;
+    uint32_t *stack;  // classes still to mark
+    uint32_t *frontier; // methods the current round expands
+    uint32_t frontier_count;
+    uint32_t *next; // and the ones it reached
+    uint32_t next_count;
+    struct rum_walk_t walk; // for the serial part, `inner` for the walks nested in it
+    struct rum_walk_t inner;
+    uint32_t object; // names looked up once, RUM_HIERARCHY_NONE when nothing names them
+    uint32_t clinit;
+    uint32_t void_descriptor;
+    uint32_t object_methods[10]; // name and descriptor of the java/lang/Object methods a library can call
+    int error;
+};
+
+static const char *const object_methods[10] = {
+    "equals", "(Ljava/lang/Object;)Z",
+    "hashCode", "()I",
+    "toString", "()Ljava/lang/String;",
+    "finalize", "()V",
+    "clone", "()Ljava/lang/Object;"};
+
+// `name` and every type it extends or implements, the ones outside the classpath included
+static void supertypes(const struct reach_build_t *build, struct rum_walk_t *walk, uint32_t name)
+{
+    rum_walk_begin(walk);
+    rum_walk_add(walk, name);
+    for (size_t i = 0; i < walk->found_count; i++)
+    {
+        uint32_t class = build->class_of[walk->found[i]];
+        for (uint32_t e = class == RUM_HIERARCHY_NONE ? 0 : build->super_offsets[class]; class != RUM_HIERARCHY_NONE && e < build->super_offsets[class + 1]; e++)
+        {
+            rum_walk_add(walk, build->supers[e]);
+        }
+    }
+}
+
+// `name` and every class of the classpath extending or implementing it
+static void subtypes(const struct reach_build_t *build, struct rum_walk_t *walk, uint32_t name)
+{
+    rum_walk_begin(walk);
+    rum_walk_add(walk, name);
+    for (size_t i = 0; i < walk->found_count; i++)
+    {
+        uint32_t current = walk->found[i];
+        for (uint32_t e = build->sub_offsets[current]; e < build->sub_offsets[current + 1]; e++)
+        {
+            rum_walk_add(walk, build->reach->classes[build->subs[e]].name);
+        }
+    }
+}
+
+static uint32_t table_slot(const struct table_t *table, uint32_t a, uint32_t b, uint32_t c)
+{
+    uint32_t key[3] = {a, b, c};
+    uint32_t mask = table->slot_count - 1;
+    uint32_t slot = (uint32_t)rum_hash_bytes((const uint8_t *)key, sizeof(key), TABLE_SEED) & mask;
+    while (table->slots[4 * slot + 3] != RUM_HIERARCHY_NONE &&
+           (table->slots[4 * slot] != a || table->slots[4 * slot + 1] != b || table->slots[4 * slot + 2] != c))
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static uint32_t table_get(const struct table_t *table, uint32_t a, uint32_t b, uint32_t c)
+{
+    return table->slot_count == 0 ? RUM_HIERARCHY_NONE : table->slots[4 * table_slot(table, a, b, c) + 3];
+}
+
+// keeps the value already there for a key added twice
+static int table_put(struct table_t *table, uint32_t a, uint32_t b, uint32_t c, uint32_t value)
+{
+    if (2 * (table->count + 1) > table->slot_count)
+    {
+        struct table_t grown = {.slot_count = table->slot_count == 0 ? 256 : table->slot_count * 2, .count = table->count};
+        grown.slots = malloc(sizeof(uint32_t) * 4 * grown.slot_count);
+        if (grown.slots == NULL)
+        {
+            return RUM_ERR_NOMEM;
+        }
+        memset(grown.slots, 0xff, sizeof(uint32_t) * 4 * grown.slot_count);
+        for (uint32_t s = 0; s < table->slot_count; s++)
+        {
+            if (table->slots[4 * s + 3] != RUM_HIERARCHY_NONE)
+            {
+                memcpy(&grown.slots[4 * table_slot(&grown, table->slots[4 * s], table->slots[4 * s + 1], table->slots[4 * s + 2])], &table->slots[4 * s], sizeof(uint32_t) * 4);
+            }
+        }
+        free(table->slots);
+        *table = grown;
+    }
+    uint32_t slot = table_slot(table, a, b, c);
+    if (table->slots[4 * slot + 3] == RUM_HIERARCHY_NONE)
+    {
+        uint32_t entry[4] = {a, b, c, value};
+        memcpy(&table->slots[4 * slot], entry, sizeof(entry));
+        table->count++;
+    }
+    return RUM_OK;
+}
+
+static int utf8_is(const struct constant_utf8_t *utf8, const char *string)
+{
+    size_t length = strlen(string);
+    return utf8->length == length && memcmp(utf8->bytes, string, length) == 0;
+}
+
+static uint32_t intern(struct reach_worker_t *worker, const uint8_t *bytes, size_t length)
+{
+    uint32_t id = rum_names_add(&worker->names, (const char *)bytes, length);
+    worker->error = id == RUM_HIERARCHY_NONE ? RUM_ERR_NOMEM : worker->error;
+    return id;
+}
+
+static void add_use(struct reach_worker_t *worker, uint32_t kind, uint32_t owner, uint32_t name, uint32_t descriptor)
+{
+    struct use_t *uses = array_grow(worker->uses, &worker->use_capacity, worker->use_count + 1, sizeof(struct use_t));
+    worker->uses = uses != NULL ? uses : worker->uses;
+    if (uses == NULL || owner == RUM_HIERARCHY_NONE)
+    {
+        worker->error = RUM_ERR_NOMEM;
+        return;
+    }
+    uses[worker->use_count++] = (struct use_t){kind, owner, name, descriptor};
+}
+
+// every class a descriptor names, "L...;" wherever a type can start
+static void add_descriptor_uses(struct reach_worker_t *worker, const uint8_t *descriptor, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        if (descriptor[i] != 'L')
+        {
+            continue;
+        }
+        const uint8_t *end = memchr(descriptor + i, ';', length - i);
+        if (end == NULL)
+        {
+            return;
+        }
+        add_use(worker, USE_CLASS, intern(worker, descriptor + i + 1, (size_t)(end - descriptor) - i - 1), RUM_HIERARCHY_NONE, RUM_HIERARCHY_NONE);
+        i = (size_t)(end - descriptor);
+    }
+}
+
+static void add_class_use(struct reach_worker_t *worker, uint32_t kind, unsigned short index)
+{
+    const struct constant_utf8_t *name = rum_constant_class_name(worker->class, index);
+    if (name != NULL && name->length > 0 && name->bytes[0] == '[')
+    {
+        add_descriptor_uses(worker, name->bytes, name->length); // creating an array creates none of its elements
+    }
+    else if (name != NULL)
+    {
+        add_use(worker, kind, intern(worker, name->bytes, name->length), RUM_HIERARCHY_NONE, RUM_HIERARCHY_NONE);
+    }
+}
+
+// the Fieldref, Methodref or InterfaceMethodref at `index`
+static void add_member_use(struct reach_worker_t *worker, uint32_t kind, unsigned short index)
+{
+    const struct class_t *class = worker->class;
+    if (index == 0 || index >= class->constant_pool_count)
+    {
+        return;
+    }
+    const struct cp_info_t *constant = &class->constant_pool[index - 1];
+    if (constant->tag != CONSTANT_Fieldref && constant->tag != CONSTANT_Methodref && constant->tag != CONSTANT_InterfaceMethodref)
+    {
+        return;
+    }
+    const struct constant_utf8_t *owner = rum_constant_class_name(class, constant->constant_methodref.class_index);
+    unsigned short name_and_type = constant->constant_methodref.name_and_type_index;
+    if (owner == NULL || name_and_type == 0 || name_and_type >= class->constant_pool_count ||
+        class->constant_pool[name_and_type - 1].tag != CONSTANT_NameAndType)
+    {
+        return;
+    }
+    const struct constant_utf8_t *name = rum_constant_utf8(class, class->constant_pool[name_and_type - 1].constant_name_and_type_info.name_index);
+    const struct constant_utf8_t *descriptor = rum_constant_utf8(class, class->constant_pool[name_and_type - 1].constant_name_and_type_info.descriptor_index);
+    if (name == NULL || descriptor == NULL)
+    {
+        return;
+    }
+    if (owner->length > 0 && owner->bytes[0] == '[')
+    {
+        add_descriptor_uses(worker, owner->bytes, owner->length); // clone() and the Object methods of an array
+        return;
+    }
+    add_use(worker, kind, intern(worker, owner->bytes, owner->length), intern(worker, name->bytes, name->length),
+            intern(worker, descriptor->bytes, descriptor->length));
+}
+
+// a method handle does what the instruction of its kind would
+static void add_handle_use(struct reach_worker_t *worker, unsigned short index)
+{
+    const struct class_t *class = worker->class;
+    if (index == 0 || index >= class->constant_pool_count || class->constant_pool[index - 1].tag != CONSTANT_MethodHandle)
+    {
+        return;
+    }
+    const struct constant_method_handle_t *handle = &class->constant_pool[index - 1].constant_method_handle;
+    switch (handle->reference_kind)
+    {
+    case 1: // getField, getStatic, putField and putStatic
+    case 2:
+    case 3:
+    case 4:
+        add_member_use(worker, USE_FIELD, handle->reference_index);
+        break;
+    case 5: // invokeVirtual and invokeInterface
+    case 9:
+        add_member_use(worker, USE_VIRTUAL, handle->reference_index);
+        break;
+    case 8: // newInvokeSpecial, the class is created and its constructor called
+    {
+        const struct cp_info_t *reference = handle->reference_index == 0 || handle->reference_index >= class->constant_pool_count
+                                                ? NULL
+                                                : &class->constant_pool[handle->reference_index - 1];
+        if (reference != NULL && reference->tag == CONSTANT_Methodref)
+        {
+            add_class_use(worker, USE_NEW, reference->constant_methodref.class_index);
+        }
+        add_member_use(worker, USE_INVOKE, handle->reference_index);
+        break;
+    }
+    default: // invokeStatic and invokeSpecial
+        add_member_use(worker, USE_INVOKE, handle->reference_index);
+        break;
+    }
+}
+
+// an ldc operand, a static argument of a bootstrap method or any other loadable constant
+static void add_constant_use(struct reach_worker_t *worker, unsigned short index)
+{
+    const struct class_t *class = worker->class;
+    if (index == 0 || index >= class->constant_pool_count)
+    {
+        return;
+    }
+    const struct cp_info_t *constant = &class->constant_pool[index - 1];
+    if (constant->tag == CONSTANT_Class)
+    {
+        add_class_use(worker, USE_CLASS, index);
+    }
+    else if (constant->tag == CONSTANT_MethodHandle)
+    {
+        add_handle_use(worker, index);
+    }
+    else if (constant->tag == CONSTANT_MethodType)
+    {
+        const struct constant_utf8_t *descriptor = rum_constant_utf8(class, constant->constant_method_type.descriptor_index);
+        if (descriptor != NULL)
+        {
+            add_descriptor_uses(worker, descriptor->bytes, descriptor->length);
+        }
+    }
+}
+
+// where every entry of the class's BootstrapMethods starts, read the first time an invokedynamic needs it
+static void read_bootstraps(struct reach_worker_t *worker)
+{
+    const struct class_t *class = worker->class;
+    worker->bootstraps_read = 1;
+    worker->bootstrap_count = 0;
+    const struct attribute_info_t *attribute = rum_find_attribute(class, class->attributes, class->attribute_count, "BootstrapMethods");
+    if (attribute == NULL)
+    {
+        return;
+    }
+    struct cursor_t cursor = {
+        .data = rum_attribute_info(class, attribute),
+        .length = attribute->attribute_length,
+        .offset = 0,
+        .overflow = 0};
+    unsigned short count = read_u2(&cursor);
+    uint32_t *bootstraps = array_grow(worker->bootstraps, &worker->bootstrap_capacity, (size_t)count + 1, sizeof(uint32_t));
+    if (bootstraps == NULL)
+    {
+        worker->error = RUM_ERR_NOMEM;
+        return;
+    }
+    worker->bootstraps = bootstraps;
+    for (unsigned short i = 0; i < count && !cursor.overflow; i++)
+    {
+        bootstraps[i] = (uint32_t)cursor.offset;
+        read_u2(&cursor);
+        read_bytes(&cursor, 2 * (size_t)read_u2(&cursor));
+    }
+    worker->bootstrap_methods = cursor.data;
+    worker->bootstrap_count = cursor.overflow ? 0 : count;
+}
+
+// the bootstrap method's handle and its static arguments, which is where a lambda's body is named
+static void add_dynamic_use(struct reach_worker_t *worker, unsigned short index)
+{
+    const struct class_t *class = worker->class;
+    if (index == 0 || index >= class->constant_pool_count || class->constant_pool[index - 1].tag != CONSTANT_InvokeDynamic)
+    {
+        return;
+    }
+    if (!worker->bootstraps_read)
+    {
+        read_bootstraps(worker);
+    }
+    unsigned short bootstrap = class->constant_pool[index - 1].constant_invoke_dynamic.bootstrap_method_attr_index;
+    if (bootstrap >= worker->bootstrap_count)
+    {
+        return;
+    }
+    // read_bootstraps checked the entries are all there
+    const uint8_t *entry = worker->bootstrap_methods + worker->bootstraps[bootstrap];
+    add_handle_use(worker, (unsigned short)(entry[0] << 8 | entry[1]));
+    unsigned short count = (unsigned short)(entry[2] << 8 | entry[3]);
+    for (unsigned short i = 0; i < count; i++)
+    {
+        add_constant_use(worker, (unsigned short)(entry[4 + 2 * i] << 8 | entry[5 + 2 * i]));
+    }
+}
+
+static void add_code_uses(struct reach_worker_t *worker, const struct attribute_info_t *attribute)
+{
+    struct rum_code_t code;
+    if (rum_code_decode(worker->class->data, attribute, &code) != RUM_OK)
+    {
+        return;
+    }
+    struct rum_insn_iter_t iter;
+    struct rum_insn_t insn;
+    rum_insn_begin(&iter, &code);
+    while (rum_insn_next(&iter, &insn))
+    {
+        if (!(insn.flags & RUM_INSN_POOL))
+        {
+            continue;
+        }
+        unsigned short index = insn.opcode == OP_ldc ? insn.operands[0] : rum_insn_u2(&insn);
+        switch (insn.opcode)
+        {
+        case OP_new:
+            add_class_use(worker, USE_NEW, index);
+            break;
+        case OP_getstatic:
+        case OP_putstatic:
+        case OP_getfield:
+        case OP_putfield:
+            add_member_use(worker, USE_FIELD, index);
+            break;
+        case OP_invokevirtual:
+        case OP_invokeinterface:
+            add_member_use(worker, USE_VIRTUAL, index);
+            break;
+        case OP_invokespecial:
+        case OP_invokestatic:
+            add_member_use(worker, USE_INVOKE, index);
+            break;
+        case OP_invokedynamic:
+            add_dynamic_use(worker, index);
+            break;
+        default: // the ldcs, anewarray, checkcast, instanceof and multianewarray
+            add_constant_use(worker, index);
+            break;
+        }
+    }
+    for (unsigned short i = 0; i < code.exception_table_length; i++)
+    {
+        struct rum_exception_t exception;
+        rum_code_exception(&code, i, &exception);
+        if (exception.catch_type != 0)
+        {
+            add_class_use(worker, USE_CLASS, exception.catch_type);
+        }
+    }
+}
+
+static int matches_class(const struct pattern_t *pattern, const uint8_t *name, size_t length)
+{
+    return pattern->prefix ? length >= pattern->class_length && memcmp(name, pattern->class, pattern->class_length) == 0
+                           : length == pattern->class_length && memcmp(name, pattern->class, length) == 0;
+}
+
+// "Class" and "prefix*" patterns
+static int keeps_class(const struct reach_build_t *build, const struct constant_utf8_t *name)
+{
+    for (size_t i = 0; i < build->pattern_count; i++)
+    {
+        const struct pattern_t *pattern = &build->patterns[i];
+        if (!pattern->annotation && pattern->member == NULL && matches_class(pattern, name->bytes, name->length))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int keeps_member(const struct reach_build_t *build, const struct constant_utf8_t *owner, const struct constant_utf8_t *name)
+{
+    for (size_t i = 0; i < build->pattern_count; i++)
+    {
+        const struct pattern_t *pattern = &build->patterns[i];
+        if (!pattern->annotation && pattern->member != NULL && pattern->member_length == name->length &&
+            memcmp(pattern->member, name->bytes, name->length) == 0 && matches_class(pattern, owner->bytes, owner->length))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// whether one of the annotations in `attributes`, visible or not, is of a type an "@Type" pattern names
+static int annotated(const struct reach_build_t *build, const struct class_t *class, const struct attribute_info_t *attributes, unsigned short count)
+{
+    for (unsigned short a = 0; build->annotations && a < count; a++)
+    {
+        if (!rum_attribute_is(class, &attributes[a], "RuntimeVisibleAnnotations") && !rum_attribute_is(class, &attributes[a], "RuntimeInvisibleAnnotations"))
+        {
+            continue;
+        }
+        struct cursor_t cursor = {
+            .data = rum_attribute_info(class, &attributes[a]),
+            .length = attributes[a].attribute_length,
+            .offset = 0,
+            .overflow = 0};
+        unsigned short annotations = read_u2(&cursor);
+        for (unsigned short i = 0; i < annotations && !cursor.overflow; i++)
+        {
+            // a field descriptor, "Ljavax/inject/Singleton;", read again by rum_annotation_skip
+            struct cursor_t peek = cursor;
+            const struct constant_utf8_t *type = rum_constant_utf8(class, read_u2(&peek));
+            for (size_t p = 0; type != NULL && type->length > 2 && p < build->pattern_count; p++)
+            {
+                if (build->patterns[p].annotation && matches_class(&build->patterns[p], type->bytes + 1, type->length - 2))
+                {
+                    return 1;
+                }
+            }
+            if (rum_annotation_skip(&cursor) != RUM_OK)
+            {
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+// 1 when the member was added
+static int add_member(struct reach_build_t *build, struct reach_worker_t *worker, const struct constant_utf8_t *owner, unsigned short access_flags,
+                      unsigned short name_index, unsigned short descriptor_index, const struct attribute_info_t *attributes, unsigned short attributes_count)
+{
+    const struct class_t *class = worker->class;
+    const struct constant_utf8_t *name = rum_constant_utf8(class, name_index);
+    const struct constant_utf8_t *descriptor = rum_constant_utf8(class, descriptor_index);
+    struct found_member_t *members = array_grow(worker->members, &worker->member_capacity, worker->member_count + 1, sizeof(struct found_member_t));
+    worker->members = members != NULL ? members : worker->members;
+    if (name == NULL || descriptor == NULL || members == NULL)
+    {
+        worker->error = members == NULL ? RUM_ERR_NOMEM : worker->error;
+        return 0;
+    }
+    struct found_member_t *member = &members[worker->member_count++];
+    member->name = intern(worker, name->bytes, name->length);
+    member->descriptor = intern(worker, descriptor->bytes, descriptor->length);
+    member->access_flags = access_flags;
+    member->entry = keeps_member(build, owner, name) || annotated(build, class, attributes, attributes_count) ||
+                    ((build->flags & RUM_KEEP_MAIN) && (access_flags & METHOD_INFO_ACC_PUBLIC) && (access_flags & METHOD_INFO_ACC_STATIC) &&
+                     utf8_is(name, "main") && utf8_is(descriptor, "([Ljava/lang/String;)V"));
+    member->first_use = (uint32_t)worker->use_count;
+    add_descriptor_uses(worker, descriptor->bytes, descriptor->length);
+    const struct attribute_info_t *code = rum_find_attribute(class, attributes, attributes_count, "Code");
+    if (code != NULL)
+    {
+        add_code_uses(worker, code);
+    }
+    member->use_count = (uint32_t)worker->use_count - member->first_use;
+    return 1;
+}
+
+// the class's supertypes, its members and by name everything their code uses
+static void reach_job(void *user, size_t index, int id)
+{
+    struct reach_build_t *build = user;
+    struct reach_worker_t *worker = &build->workers[id];
+    struct class_t *class = worker->class;
+    const uint8_t *data;
+    size_t length;
+    if (worker->error != RUM_OK || rum_classpath_load(build->classpath, index, &worker->loader, &data, &length) != RUM_OK ||
+        rum_class_parse_buffer(class, data, length) != RUM_OK)
+    {
+        return;
+    }
+    const struct constant_utf8_t *this_name = rum_constant_class_name(class, class->this_class);
+    struct found_class_t *classes = array_grow(worker->classes, &worker->class_capacity, worker->class_count + 1, sizeof(struct found_class_t));
+    uint32_t *interfaces = array_grow(worker->interfaces, &worker->interface_capacity, worker->interface_count + class->interfaces_count + 1, sizeof(uint32_t));
+    worker->classes = classes != NULL ? classes : worker->classes;
+    worker->interfaces = interfaces != NULL ? interfaces : worker->interfaces;
+    if (this_name == NULL || classes == NULL || interfaces == NULL)
+    {
+        worker->error = classes == NULL || interfaces == NULL ? RUM_ERR_NOMEM : RUM_OK;
+        return;
+    }
+
+    struct found_class_t found = {
+        .entry = index,
+        .name = intern(worker, this_name->bytes, this_name->length),
+        .superclass = RUM_HIERARCHY_NONE,
+        .length = (uint32_t)length,
+        .access_flags = class->access_flags,
+        .entry_point = keeps_class(build, this_name) || annotated(build, class, class->attributes, class->attribute_count),
+        .first_interface = (uint32_t)worker->interface_count,
+        .first_member = (uint32_t)worker->member_count};
+    const struct constant_utf8_t *super_name = rum_constant_class_name(class, class->super_class);
+    if (super_name != NULL)
+    {
+        found.superclass = intern(worker, super_name->bytes, super_name->length);
+    }
+    for (unsigned short i = 0; i < class->interfaces_count; i++)
+    {
+        const struct constant_utf8_t *name = rum_constant_class_name(class, class->interfaces[i]);
+        if (name != NULL)
+        {
+            worker->interfaces[worker->interface_count++] = intern(worker, name->bytes, name->length);
+            found.interface_count++;
+        }
+    }
+    worker->bootstraps_read = 0;
+    for (unsigned short i = 0; i < class->fields_count; i++)
+    {
+        const struct field_info_t *field = &class->fields[i];
+        found.field_count += add_member(build, worker, this_name, field->access_flags, field->name_index, field->descriptor_index, field->attributes, field->attributes_count);
+    }
+    for (unsigned short i = 0; i < class->methods_count; i++)
+    {
+        const struct method_info_t *method = &class->methods[i];
+        found.method_count += add_member(build, worker, this_name, method->access_flags, method->name_index, method->descriptor_index, method->attributes, method->attributes_count);
+    }
+    worker->classes[worker->class_count++] = found;
+}
+
+struct winner_t
+{
+    size_t entry;
+    int worker;
+    uint32_t index;
+};
+
+static int compare_winners(const void *a, const void *b)
+{
+    size_t x = ((const struct winner_t *)a)->entry, y = ((const struct winner_t *)b)->entry;
+    return (x > y) - (x < y);
+}
+
+static uint32_t map_name(const uint32_t *map, uint32_t id)
+{
+    return id == RUM_HIERARCHY_NONE ? RUM_HIERARCHY_NONE : map[id];
+}
+
+// copies a class's members and their uses out of the worker that found it, under merged names
+static int merge_members(struct reach_build_t *build, const struct reach_worker_t *worker, const uint32_t *map, uint32_t class, const struct found_member_t *found,
+                         uint32_t count, struct rum_reach_member_t *members, uint32_t first, uint32_t *owners, uint32_t *offsets, struct table_t *table, uint32_t *use_count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        struct rum_reach_member_t *member = &members[first + i];
+        member->name = map[found[i].name];
+        member->descriptor = map[found[i].descriptor];
+        member->access_flags = found[i].access_flags;
+        member->flags = found[i].entry ? RUM_REACH_ENTRY : 0;
+        owners[first + i] = class;
+        offsets[first + i] = *use_count;
+        for (uint32_t u = found[i].first_use; u < found[i].first_use + found[i].use_count; u++)
+        {
+            const struct use_t *use = &worker->uses[u];
+            build->uses[(*use_count)++] = (struct use_t){use->kind, map[use->owner], map_name(map, use->name), map_name(map, use->descriptor)};
+        }
+        if (table_put(table, class, member->name, member->descriptor, first + i) != RUM_OK)
+        {
+            return RUM_ERR_NOMEM;
+        }
+    }
+    return RUM_OK;
+}
+
+// merges the workers' names, keeps the first definition of every class in classpath order and
+// links the classes both ways
+static int merge(struct reach_build_t *build, int threads)
+{
+    struct rum_reach_t *reach = build->reach;
+    uint32_t **maps = calloc((size_t)threads, sizeof(uint32_t *));
+    int error = maps == NULL ? RUM_ERR_NOMEM : RUM_OK;
+    size_t candidates = 0;
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        const struct reach_worker_t *worker = &build->workers[w];
+        maps[w] = malloc(sizeof(uint32_t) * ((size_t)worker->names.count + 1));
+        error = maps[w] == NULL ? RUM_ERR_NOMEM : RUM_OK;
+        for (uint32_t n = 0; error == RUM_OK && n < worker->names.count; n++)
+        {
+            const char *name = rum_names_get(&worker->names, n);
+            maps[w][n] = rum_names_add(&reach->names, name, worker->names.offsets[n + 1] - worker->names.offsets[n] - 1);
+            error = maps[w][n] == RUM_HIERARCHY_NONE ? RUM_ERR_NOMEM : RUM_OK;
+        }
+        candidates += worker->class_count;
+    }
+    uint32_t names = reach->names.count;
+    struct winner_t *winners = malloc(sizeof(struct winner_t) * (candidates + 1));
+    build->class_of = malloc(sizeof(uint32_t) * ((size_t)names + 1));
+    build->heads = malloc(sizeof(uint32_t) * ((size_t)names + 1));
+    build->sub_offsets = calloc((size_t)names + 2, sizeof(uint32_t));
+    if (error == RUM_OK && (winners == NULL || build->class_of == NULL || build->heads == NULL || build->sub_offsets == NULL || candidates >= UINT32_MAX))
+    {
+        error = RUM_ERR_NOMEM;
+    }
+    size_t count = 0;
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        for (size_t i = 0; i < build->workers[w].class_count; i++)
+        {
+            winners[count++] = (struct winner_t){build->workers[w].classes[i].entry, w, (uint32_t)i};
+        }
+    }
+    if (error == RUM_OK)
+    {
+        memset(build->class_of, 0xff, sizeof(uint32_t) * ((size_t)names + 1));
+        memset(build->heads, 0xff, sizeof(uint32_t) * ((size_t)names + 1));
+        qsort(winners, count, sizeof(struct winner_t), compare_winners);
+    }
+
+    // the first definition of every name, and how much room its members take
+    size_t kept = 0, fields = 0, methods = 0, uses = 0, supers = 0;
+    for (size_t i = 0; error == RUM_OK && i < count; i++)
+    {
+        const struct reach_worker_t *worker = &build->workers[winners[i].worker];
+        const struct found_class_t *found = &worker->classes[winners[i].index];
+        uint32_t name = maps[winners[i].worker][found->name];
+        if (build->class_of[name] != RUM_HIERARCHY_NONE)
+        {
+            continue;
+        }
+        build->class_of[name] = (uint32_t)kept;
+        winners[kept++] = winners[i];
+        fields += found->field_count;
+        methods += found->method_count;
+        supers += found->interface_count + (found->superclass != RUM_HIERARCHY_NONE);
+        if (found->field_count + found->method_count > 0)
+        {
+            const struct found_member_t *last = &worker->members[found->first_member + found->field_count + found->method_count - 1];
+            uses += last->first_use + last->use_count - worker->members[found->first_member].first_use;
+        }
+    }
+    reach->class_count = (uint32_t)kept;
+    reach->field_count = (uint32_t)fields;
+    reach->method_count = (uint32_t)methods;
+    reach->classes = calloc(kept + 1, sizeof(struct rum_reach_class_t));
+    reach->fields = calloc(fields + 1, sizeof(struct rum_reach_member_t));
+    reach->methods = calloc(methods + 1, sizeof(struct rum_reach_member_t));
+    build->field_class = malloc(sizeof(uint32_t) * (fields + 1));
+    build->method_class = malloc(sizeof(uint32_t) * (methods + 1));
+    build->field_uses = malloc(sizeof(uint32_t) * (fields + 1));
+    build->method_uses = malloc(sizeof(uint32_t) * (methods + 1));
+    build->uses = malloc(sizeof(struct use_t) * (uses + 1));
+    build->super_offsets = malloc(sizeof(uint32_t) * (kept + 1));
+    build->supers = malloc(sizeof(uint32_t) * (supers + 1));
+    build->subs = malloc(sizeof(uint32_t) * (supers + 1));
+    build->stack = malloc(sizeof(uint32_t) * (kept + 1));
+    build->frontier = malloc(sizeof(uint32_t) * (methods + 1));
+    build->next = malloc(sizeof(uint32_t) * (methods + 1));
+    if (error == RUM_OK && (reach->classes == NULL || reach->fields == NULL || reach->methods == NULL || build->field_class == NULL ||
+                            build->method_class == NULL || build->field_uses == NULL || build->method_uses == NULL || build->uses == NULL ||
+                            build->super_offsets == NULL || build->supers == NULL || build->subs == NULL || build->stack == NULL ||
+                            build->frontier == NULL || build->next == NULL || uses >= UINT32_MAX || supers >= UINT32_MAX))
+    {
+        error = RUM_ERR_NOMEM;
+    }
+
+    uint32_t field = 0, method = 0, use_count = 0, super_count = 0;
+    for (uint32_t k = 0; error == RUM_OK && k < kept; k++)
+    {
+        const struct reach_worker_t *worker = &build->workers[winners[k].worker];
+        const uint32_t *map = maps[winners[k].worker];
+        const struct found_class_t *found = &worker->classes[winners[k].index];
+        struct rum_reach_class_t *class = &reach->classes[k];
+        class->name = map[found->name];
+        class->superclass = map_name(map, found->superclass);
+        class->entry = found->entry;
+        class->length = found->length;
+        class->access_flags = found->access_flags;
+        class->flags = found->entry_point ? RUM_REACH_ENTRY : 0;
+        build->super_offsets[k] = super_count;
+        if (class->superclass != RUM_HIERARCHY_NONE)
+        {
+            build->supers[super_count++] = class->superclass;
+        }
+        for (uint32_t i = 0; i < found->interface_count; i++)
+        {
+            build->supers[super_count++] = map[worker->interfaces[found->first_interface + i]];
+        }
+        class->first_field = field;
+        class->field_count = found->field_count;
+        class->first_method = method;
+        class->method_count = found->method_count;
+        error = merge_members(build, worker, map, k, worker->members + found->first_member, found->field_count, reach->fields, field,
+                              build->field_class, build->field_uses, &build->fields, &use_count);
+        field += found->field_count;
+        method += found->method_count;
+    }
+    // the methods' uses after all of the fields', so each has its uses in one row
+    if (error == RUM_OK)
+    {
+        build->field_uses[field] = use_count;
+    }
+    for (uint32_t k = 0; error == RUM_OK && k < kept; k++)
+    {
+        const struct reach_worker_t *worker = &build->workers[winners[k].worker];
+        const struct found_class_t *found = &worker->classes[winners[k].index];
+        error = merge_members(build, worker, maps[winners[k].worker], k, worker->members + found->first_member + found->field_count, found->method_count,
+                              reach->methods, reach->classes[k].first_method, build->method_class, build->method_uses, &build->methods, &use_count);
+    }
+    if (error == RUM_OK)
+    {
+        build->super_offsets[kept] = super_count;
+        build->method_uses[method] = use_count;
+        // subclasses by supertype name, counted into sub_offsets[n + 2] and filled through sub_offsets[n + 1],
+        // which ends up where row n ends
+        for (uint32_t e = 0; e < super_count; e++)
+        {
+            build->sub_offsets[build->supers[e] + 2]++;
+        }
+        for (uint32_t n = 0; n < names; n++)
+        {
+            build->sub_offsets[n + 2] += build->sub_offsets[n + 1];
+        }
+        for (uint32_t k = 0; k < kept; k++)
+        {
+            for (uint32_t e = build->super_offsets[k]; e < build->super_offsets[k + 1]; e++)
+            {
+                build->subs[build->sub_offsets[build->supers[e] + 1]++] = k;
+            }
+        }
+    }
+
+    for (int w = 0; maps != NULL && w < threads; w++)
+    {
+        free(maps[w]);
+    }
+    free(maps);
+    free(winners);
+    return error;
+}
+
+static void add_event(struct reach_worker_t *worker, uint32_t kind, uint32_t a, uint32_t b, uint32_t c)
+{
+    struct event_t *events = array_grow(worker->events, &worker->event_capacity, worker->event_count + 1, sizeof(struct event_t));
+    if (events == NULL)
+    {
+        worker->error = RUM_ERR_NOMEM;
+        return;
+    }
+    worker->events = events;
+    events[worker->event_count++] = (struct event_t){kind, a, b, c};
+}
+
+// the method a call names, up the superclasses and then every declaration in the superinterfaces,
+// which is more than the maximally specific one resolution would pick
+static void resolve_method(const struct reach_build_t *build, struct reach_worker_t *worker, const struct use_t *use)
+{
+    const struct rum_reach_t *reach = build->reach;
+    uint32_t class = build->class_of[use->owner];
+    for (uint32_t steps = 0; class != RUM_HIERARCHY_NONE && steps < reach->class_count; steps++)
+    {
+        uint32_t method = table_get(&build->methods, class, use->name, use->descriptor);
+        if (method != RUM_HIERARCHY_NONE)
+        {
+            add_event(worker, EVENT_METHOD, method, 0, 0);
+            return;
+        }
+        uint32_t superclass = reach->classes[class].superclass;
+        class = superclass == RUM_HIERARCHY_NONE ? RUM_HIERARCHY_NONE : build->class_of[superclass];
+    }
+    supertypes(build, &worker->walk, use->owner);
+    for (size_t i = 0; i < worker->walk.found_count; i++)
+    {
+        class = build->class_of[worker->walk.found[i]];
+        uint32_t method = class == RUM_HIERARCHY_NONE || !(reach->classes[class].access_flags & ACC_INTERFACE)
+                              ? RUM_HIERARCHY_NONE
+                              : table_get(&build->methods, class, use->name, use->descriptor);
+        if (method != RUM_HIERARCHY_NONE)
+        {
+            add_event(worker, EVENT_METHOD, method, 0, 0);
+        }
+    }
+}
+
+// the field a reference names, the class's own and its superinterfaces' before its superclass's
+static void resolve_field(const struct reach_build_t *build, struct reach_worker_t *worker, const struct use_t *use)
+{
+    const struct rum_reach_t *reach = build->reach;
+    uint32_t class = build->class_of[use->owner];
+    for (uint32_t steps = 0; class != RUM_HIERARCHY_NONE && steps < reach->class_count; steps++)
+    {
+        uint32_t field = table_get(&build->fields, class, use->name, use->descriptor);
+        if (field == RUM_HIERARCHY_NONE)
+        {
+            supertypes(build, &worker->walk, reach->classes[class].name);
+            for (size_t i = 1; field == RUM_HIERARCHY_NONE && i < worker->walk.found_count; i++)
+            {
+                uint32_t super = build->class_of[worker->walk.found[i]];
+                field = super != RUM_HIERARCHY_NONE && (reach->classes[super].access_flags & ACC_INTERFACE)
+                            ? table_get(&build->fields, super, use->name, use->descriptor)
+                            : RUM_HIERARCHY_NONE;
+            }
+        }
+        if (field != RUM_HIERARCHY_NONE)
+        {
+            add_event(worker, EVENT_FIELD, field, 0, 0);
+            return;
+        }
+        uint32_t superclass = reach->classes[class].superclass;
+        class = superclass == RUM_HIERARCHY_NONE ? RUM_HIERARCHY_NONE : build->class_of[superclass];
+    }
+}
+
+// the uses of one method of the frontier, read-only over everything but the worker
+static void expand_job(void *user, size_t index, int id)
+{
+    struct reach_build_t *build = user;
+    struct reach_worker_t *worker = &build->workers[id];
+    uint32_t method = build->frontier[index];
+    for (uint32_t u = build->method_uses[method]; worker->error == RUM_OK && u < build->method_uses[method + 1]; u++)
+    {
+        const struct use_t *use = &build->uses[u];
+        add_event(worker, use->kind == USE_NEW ? EVENT_NEW : EVENT_CLASS, use->owner, 0, 0);
+        if (use->kind == USE_INVOKE || use->kind == USE_VIRTUAL)
+        {
+            resolve_method(build, worker, use);
+        }
+        if (use->kind == USE_VIRTUAL)
+        {
+            add_event(worker, EVENT_CALL, use->owner, use->name, use->descriptor);
+        }
+        if (use->kind == USE_FIELD)
+        {
+            resolve_field(build, worker, use);
+        }
+    }
+}
+
+static void mark_class(struct reach_build_t *build, uint32_t name);
+
+static void mark_method(struct reach_build_t *build, uint32_t method)
+{
+    struct rum_reach_t *reach = build->reach;
+    if (reach->methods[method].flags & RUM_REACH_KEPT)
+    {
+        return;
+    }
+    reach->methods[method].flags |= RUM_REACH_KEPT;
+    reach->kept_methods++;
+    build->next[build->next_count++] = method;
+    mark_class(build, reach->classes[build->method_class[method]].name);
+}
+
+// the class, unless it was kept already, and the classes loading it loads
+static uint32_t take_class(struct reach_build_t *build, uint32_t name)
+{
+    uint32_t class = build->class_of[name];
+    if (class == RUM_HIERARCHY_NONE || (build->reach->classes[class].flags & RUM_REACH_KEPT))
+    {
+        return RUM_HIERARCHY_NONE;
+    }
+    build->reach->classes[class].flags |= RUM_REACH_KEPT;
+    build->reach->kept_classes++;
+    return class;
+}
+
+// a class that is loaded has its supertypes loaded and its static initializer run
+static void mark_class(struct reach_build_t *build, uint32_t name)
+{
+    size_t depth = 0;
+    uint32_t class = take_class(build, name);
+    if (class != RUM_HIERARCHY_NONE)
+    {
+        build->stack[depth++] = class;
+    }
+    while (depth > 0)
+    {
+        class = build->stack[--depth];
+        for (uint32_t e = build->super_offsets[class]; e < build->super_offsets[class + 1]; e++)
+        {
+            uint32_t super = take_class(build, build->supers[e]);
+            if (super != RUM_HIERARCHY_NONE)
+            {
+                build->stack[depth++] = super;
+            }
+        }
+        // its class is kept by now, so this doesn't come back here
+        uint32_t clinit = table_get(&build->methods, class, build->clinit, build->void_descriptor);
+        if (clinit != RUM_HIERARCHY_NONE)
+        {
+            mark_method(build, clinit);
+        }
+    }
+}
+
+static void mark_field(struct reach_build_t *build, uint32_t field)
+{
+    struct rum_reach_t *reach = build->reach;
+    if (reach->fields[field].flags & RUM_REACH_KEPT)
+    {
+        return;
+    }
+    reach->fields[field].flags |= RUM_REACH_KEPT;
+    reach->kept_fields++;
+    mark_class(build, reach->classes[build->field_class[field]].name);
+    for (uint32_t u = build->field_uses[field]; u < build->field_uses[field + 1]; u++)
+    {
+        mark_class(build, build->uses[u].owner);
+    }
+}
+
+// what a virtual call on an instance of `class` runs, the override up its superclasses or, when
+// there's none, every default method of its superinterfaces
+static void dispatch(struct reach_build_t *build, uint32_t class, uint32_t name, uint32_t descriptor)
+{
+    const struct rum_reach_t *reach = build->reach;
+    uint32_t current = class;
+    for (uint32_t steps = 0; current != RUM_HIERARCHY_NONE && steps < reach->class_count; steps++)
+    {
+        uint32_t method = table_get(&build->methods, current, name, descriptor);
+        unsigned short access_flags = method == RUM_HIERARCHY_NONE ? 0 : reach->methods[method].access_flags;
+        if (method != RUM_HIERARCHY_NONE && !(access_flags & (METHOD_INFO_ACC_STATIC | METHOD_INFO_ACC_PRIVATE)))
+        {
+            if (!(access_flags & METHOD_INFO_ACC_ABSTRACT))
+            {
+                mark_method(build, method);
+            }
+            return;
+        }
+        uint32_t superclass = reach->classes[current].superclass;
+        current = superclass == RUM_HIERARCHY_NONE ? RUM_HIERARCHY_NONE : build->class_of[superclass];
+    }
+    supertypes(build, &build->inner, reach->classes[class].name);
+    for (size_t i = 0; i < build->inner.found_count; i++)
+    {
+        current = build->class_of[build->inner.found[i]];
+        uint32_t method = current == RUM_HIERARCHY_NONE || !(reach->classes[current].access_flags & ACC_INTERFACE)
+                              ? RUM_HIERARCHY_NONE
+                              : table_get(&build->methods, current, name, descriptor);
+        if (method != RUM_HIERARCHY_NONE && !(reach->methods[method].access_flags & (METHOD_INFO_ACC_STATIC | METHOD_INFO_ACC_PRIVATE | METHOD_INFO_ACC_ABSTRACT)))
+        {
+            mark_method(build, method);
+        }
+    }
+}
+
+static int is_object_method(const struct reach_build_t *build, const struct rum_reach_member_t *method)
+{
+    for (int i = 0; i < 10; i += 2)
+    {
+        if (method->name == build->object_methods[i] && method->descriptor == build->object_methods[i + 1])
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// an instance of the class exists, so every call already made on one of its supertypes can land on
+// it. Code outside the classpath can call it too: the java/lang/Object methods on anything, and
+// every method of a class extending or implementing a type that isn't in the classpath
+static void instantiate(struct reach_build_t *build, uint32_t name)
+{
+    struct rum_reach_t *reach = build->reach;
+    mark_class(build, name);
+    uint32_t class = build->class_of[name];
+    if (class == RUM_HIERARCHY_NONE || (reach->classes[class].flags & RUM_REACH_INSTANTIATED))
+    {
+        return;
+    }
+    reach->classes[class].flags |= RUM_REACH_INSTANTIATED;
+    int open = 0;
+    supertypes(build, &build->walk, name);
+    for (size_t i = 0; i < build->walk.found_count; i++)
+    {
+        uint32_t super = build->walk.found[i];
+        open |= build->class_of[super] == RUM_HIERARCHY_NONE && super != build->object;
+        for (uint32_t site = build->heads[super]; site != RUM_HIERARCHY_NONE; site = build->sites[site].next)
+        {
+            dispatch(build, class, build->sites[site].name, build->sites[site].descriptor);
+        }
+    }
+    for (size_t i = 0; i < build->walk.found_count; i++)
+    {
+        uint32_t super = build->class_of[build->walk.found[i]];
+        for (uint32_t m = super == RUM_HIERARCHY_NONE ? 0 : reach->classes[super].first_method;
+             super != RUM_HIERARCHY_NONE && m < reach->classes[super].first_method + reach->classes[super].method_count; m++)
+        {
+            const struct rum_reach_member_t *method = &reach->methods[m];
+            const char *method_name = rum_names_get(&reach->names, method->name);
+            if (!(method->access_flags & (METHOD_INFO_ACC_STATIC | METHOD_INFO_ACC_PRIVATE)) && method_name[0] != '<' &&
+                (open || is_object_method(build, method)))
+            {
+                dispatch(build, class, method->name, method->descriptor);
+            }
+        }
+    }
+}
+
+// a virtual call seen for the first time, on every instantiated class it can land on
+static void add_call(struct reach_build_t *build, uint32_t owner, uint32_t name, uint32_t descriptor)
+{
+    if (table_get(&build->calls, owner, name, descriptor) != RUM_HIERARCHY_NONE)
+    {
+        return;
+    }
+    struct site_t *sites = array_grow(build->sites, &build->site_capacity, build->site_count + 1, sizeof(struct site_t));
+    if (sites == NULL || table_put(&build->calls, owner, name, descriptor, 1) != RUM_OK)
+    {
+        build->sites = sites != NULL ? sites : build->sites;
+        build->error = RUM_ERR_NOMEM;
+        return;
+    }
+    build->sites = sites;
+    sites[build->site_count] = (struct site_t){name, descriptor, build->heads[owner]};
+    build->heads[owner] = (uint32_t)build->site_count++;
+    subtypes(build, &build->walk, owner);
+    for (size_t i = 0; i < build->walk.found_count; i++)
+    {
+        uint32_t class = build->class_of[build->walk.found[i]];
+        if (class != RUM_HIERARCHY_NONE && (build->reach->classes[class].flags & RUM_REACH_INSTANTIATED))
+        {
+            dispatch(build, class, name, descriptor);
+        }
+    }
+}
+
+static void apply(struct reach_build_t *build, const struct event_t *event)
+{
+    switch (event->kind)
+    {
+    case EVENT_CLASS:
+        mark_class(build, event->a);
+        break;
+    case EVENT_NEW:
+        instantiate(build, event->a);
+        break;
+    case EVENT_METHOD:
+        mark_method(build, event->a);
+        break;
+    case EVENT_FIELD:
+        mark_field(build, event->a);
+        break;
+    default:
+        add_call(build, event->a, event->b, event->c);
+        break;
+    }
+}
+
+static uint32_t find_name(const struct rum_reach_t *reach, const char *name)
+{
+    return rum_names_find(&reach->names, name, strlen(name));
+}
+
+// level by level, the methods a round reached are expanded on the workers and what they found is
+// applied in between, which is the only time anything is marked
+static int propagate(struct reach_build_t *build, int threads)
+{
+    struct rum_reach_t *reach = build->reach;
+    uint32_t names = reach->names.count;
+    int error = rum_walk_init(&build->walk, names);
+    error = error != RUM_OK ? error : rum_walk_init(&build->inner, names);
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        error = rum_walk_init(&build->workers[w].walk, names);
+    }
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+    build->object = find_name(reach, "java/lang/Object");
+    build->clinit = find_name(reach, "<clinit>");
+    build->void_descriptor = find_name(reach, "()V");
+    for (int i = 0; i < 10; i++)
+    {
+        build->object_methods[i] = find_name(reach, object_methods[i]);
+    }
+
+    for (uint32_t k = 0; k < reach->class_count; k++)
+    {
+        const struct rum_reach_class_t *class = &reach->classes[k];
+        if (class->flags & RUM_REACH_ENTRY)
+        {
+            reach->entry_points++;
+            instantiate(build, class->name);
+            for (uint32_t f = class->first_field; f < class->first_field + class->field_count; f++)
+            {
+                mark_field(build, f);
+            }
+            for (uint32_t m = class->first_method; m < class->first_method + class->method_count; m++)
+            {
+                mark_method(build, m);
+            }
+        }
+    }
+    for (uint32_t f = 0; f < reach->field_count; f++)
+    {
+        if (reach->fields[f].flags & RUM_REACH_ENTRY)
+        {
+            reach->entry_points++;
+            mark_field(build, f);
+        }
+    }
+    for (uint32_t m = 0; m < reach->method_count; m++)
+    {
+        if (reach->methods[m].flags & RUM_REACH_ENTRY)
+        {
+            reach->entry_points++;
+            mark_method(build, m);
+        }
+    }
+
+    while (build->error == RUM_OK && build->next_count > 0)
+    {
+        uint32_t *frontier = build->frontier;
+        build->frontier = build->next;
+        build->frontier_count = build->next_count;
+        build->next = frontier;
+        build->next_count = 0;
+        reach->rounds++;
+        for (int w = 0; w < threads; w++)
+        {
+            build->workers[w].event_count = 0;
+        }
+        build->error = rum_parallel_for(build->frontier_count, threads, expand_job, build);
+        for (int w = 0; build->error == RUM_OK && w < threads; w++)
+        {
+            build->error = build->workers[w].error;
+        }
+        for (int w = 0; build->error == RUM_OK && w < threads; w++)
+        {
+            for (size_t e = 0; e < build->workers[w].event_count; e++)
+            {
+                apply(build, &build->workers[w].events[e]);
+            }
+        }
+    }
+    for (uint32_t k = 0; k < reach->class_count; k++)
+    {
+        reach->removed_bytes += reach->classes[k].flags & RUM_REACH_KEPT ? 0 : reach->classes[k].length;
+    }
+    return build->error;
+}
+
+// "Class", "prefix*", "Class.member" and "@Type"
+static int parse_patterns(struct reach_build_t *build, const struct rum_reach_options_t *options)
+{
+    build->patterns = calloc(options->keep_count + 1, sizeof(struct pattern_t));
+    if (build->patterns == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    for (size_t i = 0; i < options->keep_count; i++)
+    {
+        struct pattern_t *pattern = &build->patterns[build->pattern_count++];
+        const char *keep = options->keep[i];
+        pattern->annotation = keep[0] == '@';
+        pattern->class = keep + pattern->annotation;
+        const char *dot = pattern->annotation ? NULL : strchr(pattern->class, '.');
+        pattern->class_length = dot != NULL ? (size_t)(dot - pattern->class) : strlen(pattern->class);
+        if (dot != NULL)
+        {
+            pattern->member = dot + 1;
+            pattern->member_length = strlen(dot + 1);
+        }
+        pattern->prefix = pattern->class_length > 0 && pattern->class[pattern->class_length - 1] == '*';
+        pattern->class_length -= pattern->prefix;
+        build->annotations |= pattern->annotation;
+    }
+    return RUM_OK;
+}
+
+int rum_reach_build(struct rum_reach_t *reach, const struct rum_classpath_t *classpath, int threads, const struct rum_reach_options_t *options)
+{
+    memset(reach, 0, sizeof(struct rum_reach_t));
+    struct reach_build_t build = {
+        .classpath = classpath,
+        .flags = options->flags,
+        .reach = reach,
+        .workers = calloc((size_t)threads, sizeof(struct reach_worker_t))};
+    int error = build.workers == NULL ? RUM_ERR_NOMEM : parse_patterns(&build, options);
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        build.workers[w].class = rum_class_new();
+        error = build.workers[w].class == NULL ? RUM_ERR_NOMEM : RUM_OK;
+    }
+    if (error == RUM_OK)
+    {
+        error = rum_parallel_for(classpath->count, threads, reach_job, &build);
+    }
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        error = build.workers[w].error;
+    }
+    if (error == RUM_OK)
+    {
+        error = merge(&build, threads);
+    }
+    // the classes and their names aren't needed past the merge
+    for (int w = 0; build.workers != NULL && w < threads; w++)
+    {
+        struct reach_worker_t *worker = &build.workers[w];
+        rum_class_free(worker->class);
+        rum_loader_release(&worker->loader);
+        rum_names_free(&worker->names);
+        free(worker->classes);
+        free(worker->members);
+        free(worker->uses);
+        free(worker->interfaces);
+        free(worker->bootstraps);
+        memset(worker, 0, sizeof(struct reach_worker_t));
+    }
+    if (error == RUM_OK)
+    {
+        error = propagate(&build, threads);
+    }
+
+    for (int w = 0; build.workers != NULL && w < threads; w++)
+    {
+        free(build.workers[w].events);
+        rum_walk_free(&build.workers[w].walk);
+    }
+    free(build.workers);
+    free(build.patterns);
+    free(build.class_of);
+    free(build.super_offsets);
+    free(build.supers);
+    free(build.sub_offsets);
+    free(build.subs);
+    free(build.field_class);
+    free(build.method_class);
+    free(build.field_uses);
+    free(build.method_uses);
+    free(build.uses);
+    free(build.fields.slots);
+    free(build.methods.slots);
+    free(build.calls.slots);
+    free(build.heads);
+    free(build.sites);
+    free(build.stack);
+    free(build.frontier);
+    free(build.next);
+    rum_walk_free(&build.walk);
+    rum_walk_free(&build.inner);
+    if (error != RUM_OK)
+    {
+        rum_reach_free(reach);
+    }
+    return error;
+}
+
+void rum_reach_free(struct rum_reach_t *reach)
+{
+    rum_names_free(&reach->names);
+    free(reach->classes);
+    free(reach->fields);
+    free(reach->methods);
+    memset(reach, 0, sizeof(struct rum_reach_t));
+}
+
+struct sorted_t
+{
+    const char *name;
+    const struct rum_reach_class_t *class;
+};
+
+static int compare_sorted(const void *a, const void *b)
+{
+    return strcmp(((const struct sorted_t *)a)->name, ((const struct sorted_t *)b)->name);
+}
+
+int rum_reach_write(const struct rum_reach_t *reach, FILE *out)
+{
+    struct sorted_t *order = malloc(sizeof(struct sorted_t) * ((size_t)reach->class_count + 1));
+    if (order == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    for (uint32_t k = 0; k < reach->class_count; k++)
+    {
+        order[k] = (struct sorted_t){rum_names_get(&reach->names, reach->classes[k].name), &reach->classes[k]};
+    }
+    qsort(order, reach->class_count, sizeof(struct sorted_t), compare_sorted);
+    for (uint32_t i = 0; i < reach->class_count; i++)
+    {
+        const struct rum_reach_class_t *class = order[i].class;
+        const char *name = order[i].name;
+        fprintf(out, "%s class %s\n", class->flags & RUM_REACH_KEPT ? "keep" : "remove", name);
+        for (uint32_t f = class->first_field; (class->flags & RUM_REACH_KEPT) && f < class->first_field + class->field_count; f++)
+        {
+            const struct rum_reach_member_t *field = &reach->fields[f];
+            fprintf(out, "%s field %s.%s:%s\n", field->flags & RUM_REACH_KEPT ? "keep" : "remove", name, rum_names_get(&reach->names, field->name),
+                    rum_names_get(&reach->names, field->descriptor));
+        }
+        for (uint32_t m = class->first_method; (class->flags & RUM_REACH_KEPT) && m < class->first_method + class->method_count; m++)
+        {
+            const struct rum_reach_member_t *method = &reach->methods[m];
+            fprintf(out, "%s method %s.%s%s\n", method->flags & RUM_REACH_KEPT ? "keep" : "remove", name, rum_names_get(&reach->names, method->name),
+                    rum_names_get(&reach->names, method->descriptor));
+        }
+    }
+    free(order);
+    return ferror(out) ? RUM_ERR_IO : RUM_OK;
+}
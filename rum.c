@@ -0,0 +1,853 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "rum.h"
+
+#define ALLOC(arena, type, count) (type *)arena_alloc(arena, sizeof(type) * (count))
+#define PRINT_FLAG(str, flag) strcat(strcat(str, strlen(str) == 0 ? "" : ", "), flag);
+
+// makes sure the arena can hold `capacity` bytes without falling back to overflow blocks
+int arena_reserve(struct arena_t *arena, size_t capacity)
+{
+    if (arena->capacity >= capacity)
+    {
+        return RUM_OK;
+    }
+    free(arena->base);
+    arena->capacity = 0;
+    arena->used = 0;
+    arena->base = malloc(capacity);
+    if (arena->base == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    arena->capacity = capacity;
+    return RUM_OK;
+}
+
+void *arena_alloc(struct arena_t *arena, size_t size)
+{
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (arena->base != NULL && arena->capacity - arena->used >= size)
+    {
+        void *ptr = arena->base + arena->used;
+        arena->used += size;
+        return ptr;
+    }
+
+    struct arena_block_t *block = arena->overflow;
+    if (block == NULL || block->capacity - block->used < size)
+    {
+        size_t capacity = block == NULL ? ARENA_BLOCK : block->capacity * 2;
+        capacity = capacity < size ? size : capacity;
+        block = malloc(sizeof(struct arena_block_t) + capacity);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+        block->capacity = capacity;
+        block->used = 0;
+        block->next = arena->overflow;
+        arena->overflow = block;
+    }
+    void *ptr = block->data + block->used;
+    block->used += size;
+    return ptr;
+}
+
+// forgets every allocation but keeps the main block around for the next class
+void arena_reset(struct arena_t *arena)
+{
+    while (arena->overflow != NULL)
+    {
+        struct arena_block_t *next = arena->overflow->next;
+        free(arena->overflow);
+        arena->overflow = next;
+    }
+    arena->used = 0;
+}
+
+void arena_release(struct arena_t *arena)
+{
+    arena_reset(arena);
+    free(arena->base);
+    arena->base = NULL;
+    arena->capacity = 0;
+}
+
+void *array_grow(void *array, size_t *capacity, size_t needed, size_t size)
+{
+    if (needed <= *capacity && array != NULL)
+    {
+        return array;
+    }
+    size_t grown = *capacity == 0 ? 256 : *capacity * 2;
+    grown = grown < needed ? needed : grown;
+    void *resized = realloc(array, size * grown);
+    if (resized != NULL)
+    {
+        *capacity = grown;
+    }
+    return resized;
+}
+
+const char *get_tag_name(uint8_t tag)
+{
+    switch (tag)
+    {
+    case CONSTANT_Class:
+        return "CONSTANT_Class";
+    case CONSTANT_Fieldref:
+        return "CONSTANT_Fieldref";
+    case CONSTANT_Methodref:
+        return "CONSTANT_Methodref";
+    case CONSTANT_InterfaceMethodref:
+        return "CONSTANT_InterfaceMethodref";
+    case CONSTANT_String:
+        return "CONSTANT_String";
+    case CONSTANT_Integer:
+        return "CONSTANT_Integer";
+    case CONSTANT_Float:
+        return "CONSTANT_Float";
+    case CONSTANT_Long:
+        return "CONSTANT_Long";
+    case CONSTANT_Double:
+        return "CONSTANT_Double";
+    case CONSTANT_NameAndType:
+        return "CONSTANT_NameAndType";
+    case CONSTANT_Utf8:
+        return "CONSTANT_Utf8";
+    case CONSTANT_MethodHandle:
+        return "CONSTANT_MethodHandle";
+    case CONSTANT_MethodType:
+        return "CONSTANT_MethodType";
+    case CONSTANT_InvokeDynamic:
+        return "CONSTANT_InvokeDynamic";
+    default:
+        return "<unknown tag>";
+    }
+}
+
+char *get_access_flags(unsigned short flag, char *ret)
+{
+    ret[0] = '\0';
+    if (flag & ACC_PUBLIC)
+    {
+        PRINT_FLAG(ret, "ACC_PUBLIC");
+    }
+    if (flag & ACC_FINAL)
+    {
+        PRINT_FLAG(ret, "ACC_FINAL");
+    }
+    if (flag & ACC_SUPER)
+    {
+        PRINT_FLAG(ret, "ACC_SUPER");
+    }
+    if (flag & ACC_INTERFACE)
+    {
+        PRINT_FLAG(ret, "ACC_INTERFACE");
+    }
+    if (flag & ACC_ABSTRACT)
+    {
+        PRINT_FLAG(ret, "ACC_ABSTRACT");
+    }
+    if (flag & ACC_SYNTHETIC)
+    {
+        PRINT_FLAG(ret, "ACC_SYNTHETIC");
+    }
+    if (flag & ACC_ANNOTATION)
+    {
+        PRINT_FLAG(ret, "ACC_ANNOTATION");
+    }
+    if (flag & ACC_ENUM)
+    {
+        PRINT_FLAG(ret, "ACC_ENUM");
+    }
+    return strlen(ret) == 0 ? "<unknown flag>" : ret;
+}
+
+char *get_field_info_access_flags(unsigned short flag, char *ret)
+{
+    ret[0] = '\0';
+    if (flag & FIELD_INFO_ACC_PUBLIC)
+    {
+        PRINT_FLAG(ret, "ACC_PUBLIC");
+    }
+    if (flag & FIELD_INFO_ACC_PRIVATE)
+    {
+        PRINT_FLAG(ret, "ACC_PRIVATE");
+    }
+    if (flag & FIELD_INFO_ACC_PROTECTED)
+    {
+        PRINT_FLAG(ret, "ACC_PROTECTED");
+    }
+    if (flag & FIELD_INFO_ACC_STATIC)
+    {
+        PRINT_FLAG(ret, "ACC_STATIC");
+    }
+    if (flag & FIELD_INFO_ACC_FINAL)
+    {
+        PRINT_FLAG(ret, "ACC_FINAL");
+    }
+    if (flag & FIELD_INFO_ACC_VOLATILE)
+    {
+        PRINT_FLAG(ret, "ACC_VOLATILE");
+    }
+    if (flag & FIELD_INFO_ACC_TRANSIENT)
+    {
+        PRINT_FLAG(ret, "ACC_TRANSIENT");
+    }
+    if (flag & FIELD_INFO_ACC_SYNTHETIC)
+    {
+        PRINT_FLAG(ret, "ACC_SYNTHETIC");
+    }
+    if (flag & FIELD_INFO_ACC_ENUM)
+    {
+        PRINT_FLAG(ret, "ACC_ENUM");
+    }
+    return strlen(ret) == 0 ? "<unknown flag>" : ret;
+}
+
+char *get_method_info_access_flags(unsigned short flag, char *ret)
+{
+    ret[0] = '\0';
+    if (flag & METHOD_INFO_ACC_PUBLIC)
+    {
+        PRINT_FLAG(ret, "ACC_PUBLIC");
+    }
+    if (flag & METHOD_INFO_ACC_PRIVATE)
+    {
+        PRINT_FLAG(ret, "ACC_PRIVATE");
+    }
+    if (flag & METHOD_INFO_ACC_PROTECTED)
+    {
+        PRINT_FLAG(ret, "ACC_PROTECTED");
+    }
+    if (flag & METHOD_INFO_ACC_STATIC)
+    {
+        PRINT_FLAG(ret, "ACC_STATIC");
+    }
+    if (flag & METHOD_INFO_ACC_FINAL)
+    {
+        PRINT_FLAG(ret, "ACC_FINAL");
+    }
+    if (flag & METHOD_INFO_ACC_SYNCHRONIZED)
+    {
+        PRINT_FLAG(ret, "ACC_SYNCHRONIZED");
+    }
+    if (flag & METHOD_INFO_ACC_BRIDGE)
+    {
+        PRINT_FLAG(ret, "ACC_BRIDGE");
+    }
+    if (flag & METHOD_INFO_ACC_VARARGS)
+    {
+        PRINT_FLAG(ret, "ACC_VARARGS");
+    }
+    if (flag & METHOD_INFO_ACC_NATIVE)
+    {
+        PRINT_FLAG(ret, "ACC_NATIVE");
+    }
+    if (flag & METHOD_INFO_ACC_ABSTRACT)
+    {
+        PRINT_FLAG(ret, "ACC_ABSTRACT");
+    }
+    if (flag & METHOD_INFO_ACC_STRICT)
+    {
+        PRINT_FLAG(ret, "ACC_STRICT");
+    }
+    if (flag & METHOD_INFO_ACC_SYNTHETIC)
+    {
+        PRINT_FLAG(ret, "ACC_SYNTHETIC");
+    }
+    return strlen(ret) == 0 ? "<unknown flag>" : ret;
+}
+
+const char *rum_strerror(int error)
+{
+    switch (error)
+    {
+    case RUM_OK:
+        return "success";
+    case RUM_ERR_IO:
+        return "couldn't read file";
+    case RUM_ERR_NOMEM:
+        return "out of memory";
+    case RUM_ERR_TRUNCATED:
+        return "unexpected end of class file";
+    case RUM_ERR_MAGIC:
+        return "not a class file";
+    case RUM_ERR_TAG:
+        return "unknown constant pool tag";
+    case RUM_STOPPED:
+        return "stopped by visitor";
+    case RUM_ERR_ARCHIVE:
+        return "malformed or unsupported archive";
+    case RUM_ERR_UTF8:
+        return "malformed modified UTF-8 string";
+    case RUM_ERR_CACHE:
+        return "corrupt or incompatible cache image";
+    case RUM_ERR_CODE:
+        return "malformed bytecode";
+    case RUM_ERR_FORMAT:
+        return "malformed class file";
+    default:
+        return "<unknown error>";
+    }
+}
+
+// decodes the constant pool entry under the cursor, `bytes` of a CONSTANT_Utf8 points into the buffer
+int read_constant(struct cursor_t *cursor, struct cp_info_t *constant)
+{
+    uint8_t tag = read_u1(cursor);
+    if (cursor->overflow)
+    {
+        return RUM_ERR_TRUNCATED;
+    }
+
+    switch (tag)
+    {
+    case CONSTANT_Class:
+    {
+        struct cp_info_t cp_info = {
+            .tag = tag,
+            .constant_class = {
+                .name_index = read_u2(cursor)}};
+
+        *constant = cp_info;
+        break;
+    }
+    case CONSTANT_Fieldref:
+    {
+        unsigned short class_index = read_u2(cursor);
+        unsigned short name_and_type_index = read_u2(cursor);
+
+        struct cp_info_t cp_info = {
+            .tag = tag,
+            .constant_fieldref = {
+                .class_index = class_index,
+                .name_and_type_index = name_and_type_index}};
+        *constant = cp_info;
+        break;
+    }
+    case CONSTANT_Methodref:
+    {
+        unsigned short class_index = read_u2(cursor);
+        unsigned short name_and_type_index = read_u2(cursor);
+
+        struct cp_info_t cp_info = {
+            .tag = tag,
+            .constant_methodref = {
+                .class_index = class_index,
+                .name_and_type_index = name_and_type_index}};
+        *constant = cp_info;
+        break;
+    }
+    case CONSTANT_InterfaceMethodref:
+    {
+        unsigned short class_index = read_u2(cursor);
+        unsigned short name_and_type_index = read_u2(cursor);
+
+        struct cp_info_t cp_info = {
+            .tag = tag,
+            .constant_interface_methodref = {
+                .class_index = class_index,
+                .name_and_type_index = name_and_type_index}};
+        *constant = cp_info;
+        break;
+    }
+    case CONSTANT_String:
+    {
+        struct cp_info_t cp_info = {
+            .tag = tag,
+            .constant_string = {
+                .string_index = read_u2(cursor)}};
+        *constant = cp_info;
+        break;
+    }
+    case CONSTANT_Integer:
+    {
+        struct cp_info_t cp_info = {
+            .tag = tag,
+            .constant_integer = {
+                .bytes = read_u4(cursor)}};
+
+        *constant = cp_info;
+        break;
+    }
+    case CONSTANT_Float:
+    {
+        struct cp_info_t cp_info = {
+            .tag = tag,
+            .constant_float = {
+                .bytes = read_u4(cursor)}};
+
+        *constant = cp_info;
+        break;
+    }
+    case CONSTANT_Long:
+    {
+        uint32_t high_bytes = read_u4(cursor);
+        uint32_t low_bytes = read_u4(cursor);
+
+        struct cp_info_t cp_info = {
+            .tag = tag,
+            .constant_long = {
+                .high_bytes = high_bytes,
+                .low_bytes = low_bytes}};
+        *constant = cp_info;
+        break;
+    }
+    case CONSTANT_Double:
+    {
+        uint32_t high_bytes = read_u4(cursor);
+        uint32_t low_bytes = read_u4(cursor);
+
+        struct cp_info_t cp_info = {
+            .tag = tag,
+            .constant_double = {
+                .high_bytes = high_bytes,
+                .low_bytes = low_bytes}};
+
+        *constant = cp_info;
+        break;
+    }
+    case CONSTANT_NameAndType:
+    {
+        unsigned short name_index = read_u2(cursor);
+        unsigned short descriptor_index = read_u2(cursor);
+
+        struct cp_info_t cp_info = {
+            .tag = tag,
+            .constant_name_and_type_info = {
+                .name_index = name_index,
+                .descriptor_index = descriptor_index}};
+
+        *constant = cp_info;
+        break;
+    }
+    case CONSTANT_Utf8:
+    {
+        unsigned short length = read_u2(cursor);
+
+        // the bytes are not copied, they point straight into the mapping
+        struct cp_info_t cp_info = {
+            .tag = tag,
+            .constant_utf8 = {
+                .length = length,
+                .bytes = read_bytes(cursor, length)}};
+        if (!cursor->overflow)
+        {
+            int valid = rum_mutf8_valid(cp_info.constant_utf8.bytes, length);
+            if (!valid)
+            {
+                return RUM_ERR_UTF8;
+            }
+            cp_info.constant_utf8.modified = valid == RUM_MUTF8_MODIFIED;
+        }
+        *constant = cp_info;
+        break;
+    }
+    case CONSTANT_MethodHandle:
+    {
+        uint8_t reference_kind = read_u1(cursor);
+        unsigned short reference_index = read_u2(cursor);
+
+        struct cp_info_t cp_info = {
+            .tag = tag,
+            .constant_method_handle = {
+                .reference_kind = reference_kind,
+                .reference_index = reference_index}};
+
+        *constant = cp_info;
+        break;
+    }
+    case CONSTANT_MethodType:
+    {
+        struct cp_info_t cp_info = {
+            .tag = tag,
+            .constant_method_type = {
+                .descriptor_index = read_u2(cursor)}};
+
+        *constant = cp_info;
+        break;
+    }
+    case CONSTANT_InvokeDynamic:
+    {
+        unsigned short bootstrap_method_attr_index = read_u2(cursor);
+        unsigned short name_and_type_index = read_u2(cursor);
+
+        struct cp_info_t cp_info = {
+            .tag = tag,
+            .constant_invoke_dynamic = {
+                .bootstrap_method_attr_index = bootstrap_method_attr_index,
+                .name_and_type_index = name_and_type_index}};
+        *constant = cp_info;
+        break;
+    }
+    default:
+        return RUM_ERR_TAG;
+    }
+    return RUM_OK;
+}
+
+static struct attribute_info_t *parse_attributes(struct class_t *class, struct cursor_t *cursor, unsigned short attributes_count)
+{
+    struct attribute_info_t *attributes = ALLOC(&class->arena, struct attribute_info_t, attributes_count);
+    if (attributes == NULL)
+    {
+        return NULL;
+    }
+    for (size_t k = 0; k < attributes_count; k++)
+    {
+        unsigned short name_index = read_u2(cursor);
+        uint32_t attribute_length = read_u4(cursor);
+
+        // only remember where the body is, it is skipped without being touched
+        struct attribute_info_t attribute = {
+            .attribute_name_index = name_index,
+            .attribute_length = attribute_length,
+            .offset = (uint32_t)cursor->offset};
+        read_bytes(cursor, attribute_length);
+
+        attributes[k] = attribute;
+    }
+    return attributes;
+}
+
+int rum_class_parse_buffer(struct class_t *class, const uint8_t *data, size_t length)
+{
+    struct cursor_t cursor = {
+        .data = data,
+        .length = length,
+        .offset = 0,
+        .overflow = 0};
+
+    rum_class_clear(class);
+    class->data = data;
+    class->length = length;
+    // read headers from file
+    class->magic = read_u4(&cursor);
+    class->minor = read_u2(&cursor);
+    class->major = read_u2(&cursor);
+    class->constant_pool_count = read_u2(&cursor);
+    if (cursor.overflow)
+    {
+        return RUM_ERR_TRUNCATED;
+    }
+    if (class->magic != 0xcafebabe)
+    {
+        return RUM_ERR_MAGIC;
+    }
+    if (class->constant_pool_count == 0)
+    {
+        return RUM_ERR_FORMAT; // the count includes the unused slot 0, so it is never zero
+    }
+
+    // the main block holds the pool and a first block's worth of the smaller arrays, the members and
+    // their attributes only cost what they take, in overflow blocks
+    size_t constants = (size_t)class->constant_pool_count - 1; // slot 0 isn't stored
+    if (arena_reserve(&class->arena, sizeof(struct cp_info_t) * constants + ARENA_BLOCK) != RUM_OK)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    class->constant_pool = ALLOC(&class->arena, struct cp_info_t, constants);
+    if (class->constant_pool == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    for (size_t i = 0; i < constants; i++)
+    {
+        int error = read_constant(&cursor, &class->constant_pool[i]);
+        if (error != RUM_OK)
+        {
+            return error;
+        }
+        // Long and Double take up two slots of the pool, the second one is left unusable
+        if ((class->constant_pool[i].tag == CONSTANT_Long || class->constant_pool[i].tag == CONSTANT_Double) && ++i < constants)
+        {
+            memset(&class->constant_pool[i], 0, sizeof(struct cp_info_t));
+        }
+    }
+    class->access_flags = read_u2(&cursor);
+    class->this_class = read_u2(&cursor);
+    class->super_class = read_u2(&cursor);
+    class->interfaces_count = read_u2(&cursor);
+
+    class->interfaces = ALLOC(&class->arena, unsigned short, class->interfaces_count);
+    if (class->interfaces == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    for (size_t i = 0; i < class->interfaces_count; i++)
+    {
+        class->interfaces[i] = read_u2(&cursor);
+    }
+
+    class->fields_count = read_u2(&cursor);
+    class->fields = ALLOC(&class->arena, struct field_info_t, class->fields_count);
+    if (class->fields == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    for (size_t i = 0; i < class->fields_count; i++)
+    {
+        unsigned short access_flags = read_u2(&cursor);
+        unsigned short name_index = read_u2(&cursor);
+        unsigned short descriptor_index = read_u2(&cursor);
+        unsigned short attributes_count = read_u2(&cursor);
+
+        struct field_info_t field_info = {
+            .access_flags = access_flags,
+            .name_index = name_index,
+            .descriptor_index = descriptor_index,
+            .attributes_count = attributes_count,
+            .attributes = parse_attributes(class, &cursor, attributes_count)};
+        if (field_info.attributes == NULL)
+        {
+            return RUM_ERR_NOMEM;
+        }
+
+        class->fields[i] = field_info;
+    }
+
+    class->methods_count = read_u2(&cursor);
+    class->methods = ALLOC(&class->arena, struct method_info_t, class->methods_count);
+    if (class->methods == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    for (size_t i = 0; i < class->methods_count; i++)
+    {
+        unsigned short access_flags = read_u2(&cursor);
+        unsigned short name_index = read_u2(&cursor);
+        unsigned short descriptor_index = read_u2(&cursor);
+        unsigned short attributes_count = read_u2(&cursor);
+
+        struct method_info_t method = {
+            .access_flags = access_flags,
+            .name_index = name_index,
+            .descriptor_index = descriptor_index,
+            .attributes_count = attributes_count,
+            .attributes = parse_attributes(class, &cursor, attributes_count)};
+        if (method.attributes == NULL)
+        {
+            return RUM_ERR_NOMEM;
+        }
+
+        class->methods[i] = method;
+    }
+
+    class->attribute_count = read_u2(&cursor);
+    class->attributes = parse_attributes(class, &cursor, class->attribute_count);
+    if (class->attributes == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+
+    if (cursor.overflow)
+    {
+        return RUM_ERR_TRUNCATED;
+    }
+    return RUM_OK;
+}
+
+const uint8_t *rum_attribute_info(const struct class_t *class, const struct attribute_info_t *attribute)
+{
+    return class->data + attribute->offset;
+}
+
+// compares the CONSTANT_Utf8 naming `attribute` against `name`
+int rum_attribute_is(const struct class_t *class, const struct attribute_info_t *attribute, const char *name)
+{
+    const struct constant_utf8_t *utf8 = rum_constant_utf8(class, attribute->attribute_name_index);
+    return utf8 != NULL && strlen(name) == utf8->length && memcmp(utf8->bytes, name, utf8->length) == 0;
+}
+
+const struct attribute_info_t *rum_find_attribute(const struct class_t *class, const struct attribute_info_t *attributes, unsigned short count, const char *name)
+{
+    for (unsigned short i = 0; i < count; i++)
+    {
+        if (rum_attribute_is(class, &attributes[i], name))
+        {
+            return &attributes[i];
+        }
+    }
+    return NULL;
+}
+
+const struct constant_utf8_t *rum_constant_utf8(const struct class_t *class, unsigned short index)
+{
+    if (index == 0 || index >= class->constant_pool_count || class->constant_pool[index - 1].tag != CONSTANT_Utf8)
+    {
+        return NULL;
+    }
+    return &class->constant_pool[index - 1].constant_utf8;
+}
+
+const struct constant_utf8_t *rum_constant_class_name(const struct class_t *class, unsigned short index)
+{
+    if (index == 0 || index >= class->constant_pool_count || class->constant_pool[index - 1].tag != CONSTANT_Class)
+    {
+        return NULL;
+    }
+    return rum_constant_utf8(class, class->constant_pool[index - 1].constant_class.name_index);
+}
+
+int rum_write_atomic(const char *path, int (*write_fn)(void *user, FILE *file), void *user)
+{
+    char temporary[4096];
+    if (snprintf(temporary, sizeof(temporary), "%s.XXXXXX", path) >= (int)sizeof(temporary))
+    {
+        return RUM_ERR_IO;
+    }
+    int fd = mkstemp(temporary);
+    FILE *file = fd < 0 ? NULL : fdopen(fd, "wb");
+    if (file == NULL)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+            unlink(temporary);
+        }
+        return RUM_ERR_IO;
+    }
+    int error = write_fn(user, file);
+    error = fclose(file) != 0 && error == RUM_OK ? RUM_ERR_IO : error;
+    if (error == RUM_OK && rename(temporary, path) != 0)
+    {
+        error = RUM_ERR_IO;
+    }
+    if (error != RUM_OK)
+    {
+        unlink(temporary);
+    }
+    return error;
+}
+
+int rum_map_file(const char *path, const uint8_t **data, size_t *length)
+{
+    // map the whole file once instead of issuing a read per field
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        return RUM_ERR_IO;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1)
+    {
+        close(fd);
+        return RUM_ERR_IO;
+    }
+    if (st.st_size == 0)
+    {
+        close(fd);
+        return RUM_ERR_TRUNCATED;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return RUM_ERR_IO;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    *data = map;
+    *length = (size_t)st.st_size;
+    return RUM_OK;
+}
+
+void rum_unmap_file(const uint8_t *data, size_t length)
+{
+    munmap((void *)data, length);
+}
+
+int rum_class_parse_path(struct class_t *class, const char *path)
+{
+    rum_class_clear(class);
+
+    const uint8_t *data;
+    size_t length;
+    int error = rum_map_file(path, &data, &length);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+
+    error = rum_class_parse_buffer(class, data, length);
+    class->mapped = 1;
+    return error;
+}
+
+struct class_t *rum_class_new(void)
+{
+    return calloc(1, sizeof(struct class_t));
+}
+
+void rum_class_clear(struct class_t *class)
+{
+    if (class->image != NULL)
+    {
+        rum_unmap_file(class->image, class->image_length);
+    }
+    else if (class->mapped)
+    {
+        rum_unmap_file(class->data, class->length);
+    }
+    struct arena_t arena = class->arena;
+    arena_reset(&arena);
+    memset(class, 0, sizeof(struct class_t));
+    class->arena = arena;
+}
+
+void rum_class_free(struct class_t *class)
+{
+    if (class == NULL)
+    {
+        return;
+    }
+    rum_class_clear(class);
+    arena_release(&class->arena);
+    free(class);
+}
+
+struct class_t *rum_parse_buffer(const uint8_t *data, size_t length, int *error)
+{
+    struct class_t *class = rum_class_new();
+    int status = class == NULL ? RUM_ERR_NOMEM : rum_class_parse_buffer(class, data, length);
+    if (error != NULL)
+    {
+        *error = status;
+    }
+    if (status != RUM_OK)
+    {
+        rum_class_free(class);
+        return NULL;
+    }
+    return class;
+}
+
+struct class_t *rum_parse_path(const char *path, int *error)
+{
+    struct class_t *class = rum_class_new();
+    int status = class == NULL ? RUM_ERR_NOMEM : rum_class_parse_path(class, path);
+    if (error != NULL)
+    {
+        *error = status;
+    }
+    if (status != RUM_OK)
+    {
+        rum_class_free(class);
+        return NULL;
+    }
+    return class;
+}
@@ -0,0 +1,1413 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef RUM_H
+#define RUM_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// cp_info_tag values
+#define CONSTANT_Class 7
+#define CONSTANT_Fieldref 9
+#define CONSTANT_Methodref 10
+#define CONSTANT_InterfaceMethodref 11
+#define CONSTANT_String 8
+#define CONSTANT_Integer 3
+#define CONSTANT_Float 4
+#define CONSTANT_Long 5
+#define CONSTANT_Double 6
+#define CONSTANT_NameAndType 12
+#define CONSTANT_Utf8 1
+#define CONSTANT_MethodHandle 15
+#define CONSTANT_MethodType 16
+#define CONSTANT_InvokeDynamic 18
+
+// opcodes, as in the JVM specification
+#define OP_nop 0x00
+#define OP_aconst_null 0x01
+#define OP_iconst_m1 0x02
+#define OP_iconst_0 0x03
+#define OP_iconst_1 0x04
+#define OP_iconst_2 0x05
+#define OP_iconst_3 0x06
+#define OP_iconst_4 0x07
+#define OP_iconst_5 0x08
+#define OP_lconst_0 0x09
+#define OP_lconst_1 0x0a
+#define OP_fconst_0 0x0b
+#define OP_fconst_1 0x0c
+#define OP_fconst_2 0x0d
+#define OP_dconst_0 0x0e
+#define OP_dconst_1 0x0f
+#define OP_bipush 0x10
+#define OP_sipush 0x11
+#define OP_ldc 0x12
+#define OP_ldc_w 0x13
+#define OP_ldc2_w 0x14
+#define OP_iload 0x15
+#define OP_lload 0x16
+#define OP_fload 0x17
+#define OP_dload 0x18
+#define OP_aload 0x19
+#define OP_iload_0 0x1a
+#define OP_iload_1 0x1b
+#define OP_iload_2 0x1c
+#define OP_iload_3 0x1d
+#define OP_lload_0 0x1e
+#define OP_lload_1 0x1f
+#define OP_lload_2 0x20
+#define OP_lload_3 0x21
+#define OP_fload_0 0x22
+#define OP_fload_1 0x23
+#define OP_fload_2 0x24
+#define OP_fload_3 0x25
+#define OP_dload_0 0x26
+#define OP_dload_1 0x27
+#define OP_dload_2 0x28
+#define OP_dload_3 0x29
+#define OP_aload_0 0x2a
+#define OP_aload_1 0x2b
+#define OP_aload_2 0x2c
+#define OP_aload_3 0x2d
+#define OP_iaload 0x2e
+#define OP_laload 0x2f
+#define OP_faload 0x30
+#define OP_daload 0x31
+#define OP_aaload 0x32
+#define OP_baload 0x33
+#define OP_caload 0x34
+#define OP_saload 0x35
+#define OP_istore 0x36
+#define OP_lstore 0x37
+#define OP_fstore 0x38
+#define OP_dstore 0x39
+#define OP_astore 0x3a
+#define OP_istore_0 0x3b
+#define OP_istore_1 0x3c
+#define OP_istore_2 0x3d
+#define OP_istore_3 0x3e
+#define OP_lstore_0 0x3f
+#define OP_lstore_1 0x40
+#define OP_lstore_2 0x41
+#define OP_lstore_3 0x42
+#define OP_fstore_0 0x43
+#define OP_fstore_1 0x44
+#define OP_fstore_2 0x45
+#define OP_fstore_3 0x46
+#define OP_dstore_0 0x47
+#define OP_dstore_1 0x48
+#define OP_dstore_2 0x49
+#define OP_dstore_3 0x4a
+#define OP_astore_0 0x4b
+#define OP_astore_1 0x4c
+#define OP_astore_2 0x4d
+#define OP_astore_3 0x4e
+#define OP_iastore 0x4f
+#define OP_lastore 0x50
+#define OP_fastore 0x51
+#define OP_dastore 0x52
+#define OP_aastore 0x53
+#define OP_bastore 0x54
+#define OP_castore 0x55
+#define OP_sastore 0x56
+#define OP_pop 0x57
+#define OP_pop2 0x58
+#define OP_dup 0x59
+#define OP_dup_x1 0x5a
+#define OP_dup_x2 0x5b
+#define OP_dup2 0x5c
+#define OP_dup2_x1 0x5d
+#define OP_dup2_x2 0x5e
+#define OP_swap 0x5f
+#define OP_iadd 0x60
+#define OP_ladd 0x61
+#define OP_fadd 0x62
+#define OP_dadd 0x63
+#define OP_isub 0x64
+#define OP_lsub 0x65
+#define OP_fsub 0x66
+#define OP_dsub 0x67
+#define OP_imul 0x68
+#define OP_lmul 0x69
+#define OP_fmul 0x6a
+#define OP_dmul 0x6b
+#define OP_idiv 0x6c
+#define OP_ldiv 0x6d
+#define OP_fdiv 0x6e
+#define OP_ddiv 0x6f
+#define OP_irem 0x70
+#define OP_lrem 0x71
+#define OP_frem 0x72
+#define OP_drem 0x73
+#define OP_ineg 0x74
+#define OP_lneg 0x75
+#define OP_fneg 0x76
+#define OP_dneg 0x77
+#define OP_ishl 0x78
+#define OP_lshl 0x79
+#define OP_ishr 0x7a
+#define OP_lshr 0x7b
+#define OP_iushr 0x7c
+#define OP_lushr 0x7d
+#define OP_iand 0x7e
+#define OP_land 0x7f
+#define OP_ior 0x80
+#define OP_lor 0x81
+#define OP_ixor 0x82
+#define OP_lxor 0x83
+#define OP_iinc 0x84
+#define OP_i2l 0x85
+#define OP_i2f 0x86
+#define OP_i2d 0x87
+#define OP_l2i 0x88
+#define OP_l2f 0x89
+#define OP_l2d 0x8a
+#define OP_f2i 0x8b
+#define OP_f2l 0x8c
+#define OP_f2d 0x8d
+#define OP_d2i 0x8e
+#define OP_d2l 0x8f
+#define OP_d2f 0x90
+#define OP_i2b 0x91
+#define OP_i2c 0x92
+#define OP_i2s 0x93
+#define OP_lcmp 0x94
+#define OP_fcmpl 0x95
+#define OP_fcmpg 0x96
+#define OP_dcmpl 0x97
+#define OP_dcmpg 0x98
+#define OP_ifeq 0x99
+#define OP_ifne 0x9a
+#define OP_iflt 0x9b
+#define OP_ifge 0x9c
+#define OP_ifgt 0x9d
+#define OP_ifle 0x9e
+#define OP_if_icmpeq 0x9f
+#define OP_if_icmpne 0xa0
+#define OP_if_icmplt 0xa1
+#define OP_if_icmpge 0xa2
+#define OP_if_icmpgt 0xa3
+#define OP_if_icmple 0xa4
+#define OP_if_acmpeq 0xa5
+#define OP_if_acmpne 0xa6
+#define OP_goto 0xa7
+#define OP_jsr 0xa8
+#define OP_ret 0xa9
+#define OP_tableswitch 0xaa
+#define OP_lookupswitch 0xab
+#define OP_ireturn 0xac
+#define OP_lreturn 0xad
+#define OP_freturn 0xae
+#define OP_dreturn 0xaf
+#define OP_areturn 0xb0
+#define OP_return 0xb1
+#define OP_getstatic 0xb2
+#define OP_putstatic 0xb3
+#define OP_getfield 0xb4
+#define OP_putfield 0xb5
+#define OP_invokevirtual 0xb6
+#define OP_invokespecial 0xb7
+#define OP_invokestatic 0xb8
+#define OP_invokeinterface 0xb9
+#define OP_invokedynamic 0xba
+#define OP_new 0xbb
+#define OP_newarray 0xbc
+#define OP_anewarray 0xbd
+#define OP_arraylength 0xbe
+#define OP_athrow 0xbf
+#define OP_checkcast 0xc0
+#define OP_instanceof 0xc1
+#define OP_monitorenter 0xc2
+#define OP_monitorexit 0xc3
+#define OP_wide 0xc4
+#define OP_multianewarray 0xc5
+#define OP_ifnull 0xc6
+#define OP_ifnonnull 0xc7
+#define OP_goto_w 0xc8
+#define OP_jsr_w 0xc9
+
+// method_info access_flags mask table
+#define METHOD_INFO_ACC_PUBLIC 0x0001
+#define METHOD_INFO_ACC_PRIVATE 0x0002
+#define METHOD_INFO_ACC_PROTECTED 0x0004
+#define METHOD_INFO_ACC_STATIC 0x0008
+#define METHOD_INFO_ACC_FINAL 0x0010
+#define METHOD_INFO_ACC_SYNCHRONIZED 0x0020
+#define METHOD_INFO_ACC_BRIDGE 0x0040
+#define METHOD_INFO_ACC_VARARGS 0x0080
+#define METHOD_INFO_ACC_NATIVE 0x0100
+#define METHOD_INFO_ACC_ABSTRACT 0x0400
+#define METHOD_INFO_ACC_STRICT 0x0800
+#define METHOD_INFO_ACC_SYNTHETIC 0x1000
+
+// class file access_flags mask table
+#define ACC_PUBLIC 0x0001
+#define ACC_FINAL 0x0010
+#define ACC_SUPER 0x0020
+#define ACC_INTERFACE 0x0200
+#define ACC_ABSTRACT 0x0400
+#define ACC_SYNTHETIC 0x1000
+#define ACC_ANNOTATION 0x2000
+#define ACC_ENUM 0x4000
+
+// field_info access_flags mask table
+#define FIELD_INFO_ACC_PUBLIC 0x0001
+#define FIELD_INFO_ACC_PRIVATE 0x0002
+#define FIELD_INFO_ACC_PROTECTED 0x0004
+#define FIELD_INFO_ACC_STATIC 0x0008
+#define FIELD_INFO_ACC_FINAL 0x0010
+#define FIELD_INFO_ACC_VOLATILE 0x0040
+#define FIELD_INFO_ACC_TRANSIENT 0x0080
+#define FIELD_INFO_ACC_SYNTHETIC 0x1000
+#define FIELD_INFO_ACC_ENUM 0x4000
+
+// errors reported by the parse functions, see `rum_strerror`
+#define RUM_OK 0
+#define RUM_ERR_IO 1        // the file couldn't be opened, stat'd or mapped
+#define RUM_ERR_NOMEM 2     // an allocation failed
+#define RUM_ERR_TRUNCATED 3 // the class file ends in the middle of a structure
+#define RUM_ERR_MAGIC 4     // the file doesn't start with 0xcafebabe
+#define RUM_ERR_TAG 5       // the constant pool holds an unknown tag
+#define RUM_STOPPED 6       // a visitor callback asked to stop, not a failure
+#define RUM_ERR_ARCHIVE 7   // a zip/jar archive is malformed or uses an unsupported feature
+#define RUM_ERR_UTF8 8      // a CONSTANT_Utf8 entry isn't valid Modified UTF-8
+#define RUM_ERR_CACHE 9     // a cache image is corrupt or was written by a different build
+#define RUM_ERR_CODE 10     // a Code attribute holds an unknown opcode, an instruction running past its end or a stray branch
+#define RUM_ERR_FORMAT 11   // a count or index in the class file is out of range
+
+// size of the buffers `get_*access_flags` format into
+#define ACCESS_FLAGS_MAX 256
+
+struct constant_methodref_t
+{
+    unsigned short class_index;
+    unsigned short name_and_type_index;
+};
+
+struct constant_utf8_t
+{
+    unsigned short length;
+    const uint8_t *bytes; // not NUL-terminated, points into the mapped class file
+    uint8_t modified;     // holds a NUL or surrogate pairs, so isn't standard UTF-8 as it is
+};
+
+struct constant_class_t
+{
+    unsigned short name_index;
+};
+
+struct constant_name_and_type_info_t
+{
+    unsigned short name_index;
+    unsigned short descriptor_index;
+};
+
+struct constant_fieldref_t
+{
+    unsigned short class_index;
+    unsigned short name_and_type_index;
+};
+
+struct constant_string_t
+{
+    unsigned short string_index;
+};
+
+struct constant_interface_methodref_t
+{
+    unsigned short class_index;
+    unsigned short name_and_type_index;
+};
+
+struct constant_invoke_dynamic_t
+{
+    unsigned short bootstrap_method_attr_index;
+    unsigned short name_and_type_index;
+};
+
+struct constant_method_handle_t
+{
+    uint8_t reference_kind;
+    unsigned short reference_index;
+};
+
+struct constant_float_t
+{
+    uint32_t bytes;
+};
+
+struct constant_integer_t
+{
+    uint32_t bytes;
+};
+
+struct constant_double_t
+{
+    uint32_t high_bytes;
+    uint32_t low_bytes;
+};
+
+struct constant_long_t
+{
+    uint32_t high_bytes;
+    uint32_t low_bytes;
+};
+
+struct constant_method_type_t
+{
+    unsigned short descriptor_index;
+};
+
+struct cp_info_t
+{
+    uint8_t tag;
+    union
+    {
+        struct constant_methodref_t constant_methodref;
+        struct constant_utf8_t constant_utf8;
+        struct constant_class_t constant_class;
+        struct constant_name_and_type_info_t constant_name_and_type_info;
+        struct constant_fieldref_t constant_fieldref;
+        struct constant_string_t constant_string;
+        struct constant_interface_methodref_t constant_interface_methodref;
+        struct constant_invoke_dynamic_t constant_invoke_dynamic;
+        struct constant_method_handle_t constant_method_handle;
+        struct constant_float_t constant_float;
+        struct constant_integer_t constant_integer;
+        struct constant_double_t constant_double;
+        struct constant_long_t constant_long;
+        struct constant_method_type_t constant_method_type;
+    };
+};
+
+// overflow block, chained off the arena when the initial size estimate was too small
+struct arena_block_t
+{
+    struct arena_block_t *next;
+    size_t capacity;
+    size_t used;
+    uint8_t data[];
+};
+
+// bump allocator owned by a class, everything the parser allocates lives in it. What doesn't fit
+// the main block goes to overflow blocks, the first ARENA_BLOCK bytes and each one after twice the last
+#define ARENA_ALIGN 8
+#define ARENA_BLOCK 4096
+
+struct arena_t
+{
+    uint8_t *base;
+    size_t capacity;
+    size_t used;
+    struct arena_block_t *overflow;
+};
+
+struct attribute_info_t
+{
+    unsigned short attribute_name_index;
+    uint32_t attribute_length;
+    uint32_t offset; // where the `attribute_length` bytes of the body start in the class file, see `rum_attribute_info`
+};
+
+struct field_info_t
+{
+    unsigned short access_flags;
+    unsigned short name_index;
+    unsigned short descriptor_index;
+    unsigned short attributes_count;
+    struct attribute_info_t *attributes; // `attributes_count` number of elements
+};
+
+struct method_info_t
+{
+    unsigned short access_flags;
+    unsigned short name_index;
+    unsigned short descriptor_index;
+    unsigned short attributes_count;
+    struct attribute_info_t *attributes; // `attributes_count` number of elements
+};
+
+struct class_t
+{
+    uint32_t magic;
+    unsigned short minor;
+    unsigned short major;
+    unsigned short constant_pool_count;
+    struct cp_info_t *constant_pool; // `constant_pool_count` -1 number of elements
+    unsigned short access_flags;
+    unsigned short this_class;
+    unsigned short super_class;
+    unsigned short interfaces_count;
+    unsigned short *interfaces; // `interface_count` number of elements
+    unsigned short fields_count;
+    struct field_info_t *fields; // `fields_count` number of elements
+    unsigned short methods_count;
+    struct method_info_t *methods; // `methods_count` number of elements
+    unsigned short attribute_count;
+    struct attribute_info_t *attributes; // `attribute_count` number of elements
+    const uint8_t *data;                 // the class file bytes, mapped or borrowed from the caller
+    size_t length;
+    int mapped;           // `data` was mmap'd by `rum_parse_path` and is unmapped with the class
+    const uint8_t *image; // the cache image `data` lives in when loaded from one, unmapped with the class
+    size_t image_length;
+    struct arena_t arena; // backs every array above
+};
+
+// bounds-aware reader over a class file buffer
+struct cursor_t
+{
+    const uint8_t *data;
+    size_t length;
+    size_t offset;
+    int overflow; // set once a read runs past `length`, reads then return 0
+};
+
+
+static inline uint8_t read_u1(struct cursor_t *cursor)
+{
+    if (cursor->offset >= cursor->length)
+    {
+        cursor->overflow = 1;
+        return 0;
+    }
+    return cursor->data[cursor->offset++];
+}
+
+static inline unsigned short read_u2(struct cursor_t *cursor)
+{
+    if (cursor->length - cursor->offset < 2)
+    {
+        cursor->overflow = 1;
+        cursor->offset = cursor->length;
+        return 0;
+    }
+    const uint8_t *p = cursor->data + cursor->offset;
+    cursor->offset += 2;
+    return (unsigned short)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t read_u4(struct cursor_t *cursor)
+{
+    if (cursor->length - cursor->offset < 4)
+    {
+        cursor->overflow = 1;
+        cursor->offset = cursor->length;
+        return 0;
+    }
+    const uint8_t *p = cursor->data + cursor->offset;
+    cursor->offset += 4;
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+// returns a pointer to the next `count` bytes of the buffer and skips over them
+static inline const uint8_t *read_bytes(struct cursor_t *cursor, size_t count)
+{
+    if (cursor->length - cursor->offset < count)
+    {
+        cursor->overflow = 1;
+        cursor->offset = cursor->length;
+        return cursor->data + cursor->length;
+    }
+    const uint8_t *p = cursor->data + cursor->offset;
+    cursor->offset += count;
+    return p;
+}
+
+// zip/jar archives, read by zip.c and written by transform.c
+#define ZIP_EOCD 0x06054b50
+#define ZIP_EOCD64 0x06064b50
+#define ZIP_EOCD64_LOCATOR 0x07064b50
+#define ZIP_CENTRAL 0x02014b50
+#define ZIP_LOCAL 0x04034b50
+#define ZIP_STORED 0
+#define ZIP_DEFLATED 8
+
+// zip fields are little-endian, unlike everything in a class file
+static inline uint16_t le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t le64(const uint8_t *p)
+{
+    return (uint64_t)le32(p) | ((uint64_t)le32(p + 4) << 32);
+}
+
+// arena
+int arena_reserve(struct arena_t *arena, size_t capacity);
+void *arena_alloc(struct arena_t *arena, size_t size);
+void arena_reset(struct arena_t *arena);
+void arena_release(struct arena_t *arena);
+
+// growable arrays: `array` itself when there's room, NULL when it couldn't be grown, in which case
+// it's still valid and `capacity` is left alone
+void *array_grow(void *array, size_t *capacity, size_t needed, size_t size);
+
+// reading
+int rum_map_file(const char *path, const uint8_t **data, size_t *length);
+void rum_unmap_file(const uint8_t *data, size_t length);
+int read_constant(struct cursor_t *cursor, struct cp_info_t *constant);
+
+// writing: `write_fn` fills a temporary file next to `path`, which is renamed over it only once
+// complete, so readers never see half a file. It returns RUM_OK or the error to fail with
+int rum_write_atomic(const char *path, int (*write_fn)(void *user, FILE *file), void *user);
+
+// attributes are only located while parsing, their bodies are read on demand
+const uint8_t *rum_attribute_info(const struct class_t *class, const struct attribute_info_t *attribute);
+int rum_attribute_is(const struct class_t *class, const struct attribute_info_t *attribute, const char *name);
+const struct attribute_info_t *rum_find_attribute(const struct class_t *class, const struct attribute_info_t *attributes, unsigned short count, const char *name);
+
+// the CONSTANT_Utf8 at `index`, or the one naming the CONSTANT_Class at `index`, NULL when the
+// index doesn't hold that kind of constant
+const struct constant_utf8_t *rum_constant_utf8(const struct class_t *class, unsigned short index);
+const struct constant_utf8_t *rum_constant_class_name(const struct class_t *class, unsigned short index);
+
+// Code attributes, decoded in place from the class file bytes. `data` is `class->data`, or the
+// bytes a pool or visitor was given, and attributes are located as the parser locates them
+struct rum_code_t
+{
+    unsigned short max_stack;
+    unsigned short max_locals;
+    uint32_t code_length;
+    const uint8_t *code;
+    unsigned short exception_table_length;
+    const uint8_t *exception_table; // 8 bytes per entry, see `rum_code_exception`
+    unsigned short attributes_count;
+    uint32_t attributes_offset; // of the first nested attribute in the class file
+};
+
+struct rum_exception_t
+{
+    unsigned short start_pc;
+    unsigned short end_pc;
+    unsigned short handler_pc;
+    unsigned short catch_type; // 0 for any exception
+};
+
+// what an instruction is to an analysis, from a constant table indexed by opcode
+#define RUM_INSN_BRANCH 1          // has a branch target, see `rum_insn_target`
+#define RUM_INSN_SWITCH 2          // tableswitch or lookupswitch, see `rum_insn_switch`
+#define RUM_INSN_NO_FALLTHROUGH 4  // never continues with the next instruction
+#define RUM_INSN_RETURN 8          // one of the return instructions
+#define RUM_INSN_SUBROUTINE 16     // jsr, jsr_w or ret
+#define RUM_INSN_INVOKE 32         // one of the invoke instructions
+#define RUM_INSN_POOL 64           // its first operand is a constant pool index, one byte for ldc and two otherwise
+#define RUM_INSN_LOCAL 128         // its first operand is a local variable index, two bytes when `wide`
+
+struct rum_insn_t
+{
+    uint32_t pc;
+    uint8_t opcode; // the instruction a `wide` prefix modifies rather than the prefix
+    uint8_t wide;
+    uint8_t flags;           // RUM_INSN_*
+    uint32_t length;         // in bytes, opcode, prefix and padding included
+    const uint8_t *operands; // past the opcode, and past the padding for switches
+};
+
+// walks the instructions of a Code attribute without allocating
+struct rum_insn_iter_t
+{
+    const uint8_t *code;
+    uint32_t length;
+    uint32_t pc; // of the next instruction
+    int error;   // RUM_ERR_CODE once an instruction couldn't be decoded
+};
+
+struct rum_switch_t
+{
+    uint32_t pc;
+    int lookup; // lookupswitch, the cases are (match, offset) pairs rather than offsets from `low`
+    int64_t default_target;
+    int32_t low;
+    uint32_t count;
+    const uint8_t *cases;
+};
+
+// checks the lengths in the attribute against its body, nested attributes included, but not the instructions
+int rum_code_decode(const uint8_t *data, const struct attribute_info_t *attribute, struct rum_code_t *code);
+void rum_code_exception(const struct rum_code_t *code, unsigned short index, struct rum_exception_t *exception);
+// the nested attribute at `*offset`, which starts at 0 and is moved past it. Call it `attributes_count` times
+void rum_code_attribute(const uint8_t *data, const struct rum_code_t *code, uint32_t *offset, struct attribute_info_t *attribute);
+const char *rum_opcode_name(uint8_t opcode);
+void rum_insn_begin(struct rum_insn_iter_t *iter, const struct rum_code_t *code);
+// 1 when another instruction was decoded into `insn`, 0 at the end of the code or on an error
+int rum_insn_next(struct rum_insn_iter_t *iter, struct rum_insn_t *insn);
+uint16_t rum_insn_u2(const struct rum_insn_t *insn); // the first two operand bytes
+// absolute target of a branch, which may be outside the code when the class is malformed
+int64_t rum_insn_target(const struct rum_insn_t *insn);
+void rum_insn_switch(const struct rum_insn_t *insn, struct rum_switch_t *table);
+// absolute target of case `index` below `table->count`, and the value it matches
+int64_t rum_switch_case(const struct rum_switch_t *table, uint32_t index, int32_t *match);
+
+// control-flow graph of a Code attribute: basic blocks in code order, successors and predecessors
+// in compressed rows, dominators and natural loops. Every array belongs to the graph and is reused
+// by the next build, so a zeroed graph per thread builds every method without allocating once it
+// has grown to the largest
+#define RUM_CFG_NONE UINT32_MAX
+#define RUM_EDGE_EXCEPTION 1 // to the handler of an exception table entry covering the block
+#define RUM_EDGE_BACK 2      // to a loop header from inside its loop
+
+struct rum_loop_t
+{
+    uint32_t header; // block every way into the loop goes through
+    uint32_t parent; // innermost loop around this one, RUM_CFG_NONE for outermost loops
+    uint32_t depth;  // 1 for outermost loops
+    uint32_t blocks; // in the body, nested loops included
+    uint32_t bytes;  // of bytecode in the body
+    uint32_t back_edges;
+};
+
+struct rum_cfg_t
+{
+    uint32_t block_count;
+    uint32_t *starts;       // pc of each block, starts[block_count] is code_length
+    uint32_t *succ_offsets; // block b goes to succs[succ_offsets[b]] to succs[succ_offsets[b + 1] - 1]
+    uint32_t *succs;
+    uint8_t *edge_flags; // RUM_EDGE_* of each successor
+    uint32_t *pred_offsets;
+    uint32_t *preds;
+    uint32_t edge_count;
+    uint32_t reachable; // blocks reachable from the entry, block 0
+    uint32_t *idom;     // immediate dominator, RUM_CFG_NONE for the entry and unreachable blocks
+    uint32_t *loop_of;  // innermost loop of each block, RUM_CFG_NONE outside loops
+    uint32_t loop_count;
+    struct rum_loop_t *loops; // inner loops come before the loops around them
+    // scratch
+    uint8_t *marks;
+    uint32_t *pc_blocks;
+    uint32_t *order, *rpo, *pre, *last, *next, *child_offsets, *children, *seen;
+    uint32_t *stack, *edge_from, *edge_to;
+    uint8_t *edge_kinds;
+    size_t pc_capacity, block_capacity, edge_capacity, loop_capacity;
+};
+
+// RUM_ERR_CODE for instructions the iterator rejects and for branches, switch cases or exception
+// ranges not landing on an instruction
+int rum_cfg_build(struct rum_cfg_t *cfg, const struct rum_code_t *code);
+void rum_cfg_free(struct rum_cfg_t *cfg);
+// whether every path from the entry to block `b` goes through block `a`, in constant time
+int rum_cfg_dominates(const struct rum_cfg_t *cfg, uint32_t a, uint32_t b);
+// the block holding `pc`, RUM_CFG_NONE past the end of the code
+uint32_t rum_cfg_block(const struct rum_cfg_t *cfg, uint32_t pc);
+uint32_t rum_cfg_max_depth(const struct rum_cfg_t *cfg);
+int rum_cfg_write_dot(const struct rum_cfg_t *cfg, FILE *out, const char *name, size_t length);
+
+// names
+const char *get_tag_name(uint8_t tag);
+char *get_access_flags(unsigned short flag, char *ret);
+char *get_field_info_access_flags(unsigned short flag, char *ret);
+char *get_method_info_access_flags(unsigned short flag, char *ret);
+const char *rum_strerror(int error);
+// Modified UTF-8, as CONSTANT_Utf8 entries hold it: NUL is c0 80 and characters past U+FFFF are
+// surrogate pairs of three bytes each
+#define RUM_MUTF8_STANDARD 1 // also valid standard UTF-8
+#define RUM_MUTF8_MODIFIED 2 // needs `rum_mutf8_to_utf8` to be standard UTF-8
+
+// 0 when the bytes aren't valid Modified UTF-8
+int rum_mutf8_valid(const uint8_t *bytes, size_t length);
+// converts valid Modified UTF-8 into standard UTF-8, which is never longer, returns its length
+size_t rum_mutf8_to_utf8(const uint8_t *bytes, size_t length, uint8_t *out);
+
+// structure-of-arrays constant pool: one dense column per field, indexed by the pool index itself.
+// Long and Double keep their low word in the unusable slot after them, whose tag is 0
+#define RUM_POOL_MODIFIED 0x10000 // set in a Utf8 value when it isn't standard UTF-8 as it is
+
+struct rum_pool_t
+{
+    unsigned short count; // constant_pool_count, slot 0 is unused
+    uint8_t *tags;        // CONSTANT_* per slot
+    uint32_t *offsets;    // of the tag byte in the class file
+    uint32_t *values;     // the payload packed into 32 bits: index, first << 16 | second, bytes or Utf8 length
+    const uint8_t *data;  // borrowed, not copied
+    size_t length;
+    size_t end;           // offset of access_flags, just past the pool
+    struct arena_t arena; // backs the columns, kept between parses
+};
+
+// a zeroed pool is ready for parsing, and can be parsed into over and over
+int rum_pool_parse(struct rum_pool_t *pool, const uint8_t *data, size_t length);
+void rum_pool_release(struct rum_pool_t *pool);
+// next index at or after `index` holding `tag`, 0 when there is none
+unsigned short rum_pool_next(const struct rum_pool_t *pool, uint8_t tag, unsigned short index);
+size_t rum_pool_count_tag(const struct rum_pool_t *pool, uint8_t tag);
+const uint8_t *rum_pool_utf8(const struct rum_pool_t *pool, unsigned short index, unsigned short *length);
+uint64_t rum_pool_wide(const struct rum_pool_t *pool, unsigned short index); // Long and Double bits
+
+// what a classpath scan needs of a class, found without decoding the pool or allocating. Names
+// point into the class file
+#define RUM_SUMMARY_INTERFACES 64 // interfaces past these are counted, but not named
+
+struct rum_name_t
+{
+    const uint8_t *bytes; // Modified UTF-8, not NUL-terminated
+    unsigned short length;
+};
+
+struct rum_summary_t
+{
+    unsigned short minor;
+    unsigned short major;
+    unsigned short access_flags;
+    struct rum_name_t this_class;
+    struct rum_name_t super_class; // empty for java/lang/Object
+    unsigned short interfaces_count;
+    struct rum_name_t interfaces[RUM_SUMMARY_INTERFACES];
+};
+
+// stops after the interfaces table, the pool is skipped through by tag size and read only where
+// the names are
+int rum_summarize(const uint8_t *data, size_t length, struct rum_summary_t *summary);
+
+// the human readable dump `rum` prints, RUM_ERR_NOMEM when a string couldn't be converted to UTF-8
+int rum_pretty_print(FILE *out, const struct class_t *class);
+
+// parsing, every function here is reentrant and only touches the class it is given.
+// `rum_parse_buffer` borrows `data`, which has to outlive the class.
+struct class_t *rum_class_new(void);
+int rum_class_parse_buffer(struct class_t *class, const uint8_t *data, size_t length);
+int rum_class_parse_path(struct class_t *class, const char *path);
+void rum_class_clear(struct class_t *class); // drops the parsed contents, keeps the arena for reuse
+void rum_class_free(struct class_t *class);
+struct class_t *rum_parse_buffer(const uint8_t *data, size_t length, int *error);
+struct class_t *rum_parse_path(const char *path, int *error);
+
+// writing, a parsed class back out as the bytes it was parsed from. Attributes are copied from
+// `class->data` as they are, apart from what the flags drop
+#define RUM_WRITE_STRIP_DEBUG 1 // LineNumberTable, LocalVariableTable, LocalVariableTypeTable and SourceFile, in Code attributes too
+#define RUM_WRITE_COMPACT_POOL 2 // drops the constants nothing written refers to, merges equal ones and renumbers the rest
+
+// growable output, `failed` sticks once an allocation fails and everything after it is dropped
+struct rum_buffer_t
+{
+    uint8_t *data;
+    size_t length;
+    size_t capacity;
+    int failed;
+};
+
+void rum_buffer_put(struct rum_buffer_t *buffer, const void *bytes, size_t length);
+void rum_buffer_u1(struct rum_buffer_t *buffer, uint8_t value);
+void rum_buffer_u2(struct rum_buffer_t *buffer, uint16_t value);
+void rum_buffer_u4(struct rum_buffer_t *buffer, uint32_t value);
+void rum_buffer_free(struct rum_buffer_t *buffer);
+// appends the class file to `out`
+int rum_class_write(const struct class_t *class, int flags, struct rum_buffer_t *out);
+// whether `flags` drop the attribute named by the pool entry at `name_index`
+int rum_write_drops(const struct class_t *class, int flags, unsigned short name_index);
+
+// constant pool compaction. `map` gets `constant_pool_count` slots, the new index of every entry
+// (0 for dead ones, merged ones share one) and `count` the new constant_pool_count. Entries keep
+// their order, so no index grows and ldc operands still fit. RUM_STOPPED, not a failure, when an
+// attribute `flags` keeps isn't one the JVM spec defines, as its indices can't be found
+int rum_pool_compact(const struct class_t *class, int flags, unsigned short *map, unsigned short *count);
+// renumbers the attribute at `attribute`, header included, in place through a `rum_pool_compact` map
+int rum_pool_remap(const struct class_t *class, const unsigned short *map, uint8_t *attribute, size_t length);
+
+struct rum_rewrite_t
+{
+    size_t entries;
+    size_t classes;         // written back
+    size_t unparsed;        // class entries that couldn't be parsed, copied as they were
+    uint64_t class_bytes;   // of the classes written back, before
+    uint64_t written_bytes; // and after
+    uint64_t constants;     // constant pool slots of the classes written back, before
+    uint64_t written_constants;
+    uint64_t input_bytes;   // of the whole file
+    uint64_t output_bytes;
+};
+
+// writes every class of a jar back with `flags` on `threads` workers, recompressed the way it was.
+// Entries stream out in archive order as they are done, and other entries are copied compressed.
+// The output replaces `output` once it is complete
+int rum_rewrite_jar(const char *input, const char *output, int threads, int flags, struct rum_rewrite_t *stats);
+int rum_rewrite_class(const char *input, const char *output, int flags, struct rum_rewrite_t *stats);
+
+// owner of an attribute passed to `on_attribute`
+#define RUM_OWNER_CLASS 0
+#define RUM_OWNER_FIELD 1
+#define RUM_OWNER_METHOD 2
+
+// callbacks fired by `rum_visit_buffer` in file order while the bytes are scanned, without
+// building a `class_t` or allocating anything. every callback may be NULL, returning non-zero
+// from one stops the scan and makes `rum_visit_buffer` return RUM_STOPPED.
+// constants are passed with their pool index (starting at 1), fields and methods come with
+// `attributes` set to NULL and are followed by one `on_attribute` call per attribute, which
+// also gets a pointer to the attribute body.
+struct rum_visitor_t
+{
+    void *user;
+    int (*on_header)(void *user, uint32_t magic, unsigned short minor, unsigned short major, unsigned short constant_pool_count);
+    int (*on_constant)(void *user, unsigned short index, const struct cp_info_t *constant);
+    int (*on_class)(void *user, unsigned short access_flags, unsigned short this_class, unsigned short super_class, unsigned short interfaces_count);
+    int (*on_interface)(void *user, unsigned short index, unsigned short interface);
+    int (*on_field)(void *user, unsigned short index, const struct field_info_t *field);
+    int (*on_method)(void *user, unsigned short index, const struct method_info_t *method);
+    int (*on_attribute)(void *user, int owner, unsigned short owner_index, const struct attribute_info_t *attribute, const uint8_t *info);
+};
+
+int rum_visit_buffer(const uint8_t *data, size_t length, const struct rum_visitor_t *visitor);
+int rum_visit_path(const char *path, const struct rum_visitor_t *visitor);
+
+// batches
+struct rum_paths_t
+{
+    char **paths;
+    size_t count;
+    size_t capacity;
+};
+
+struct rum_ordered_slot_t
+{
+    char *text; // malloc'd, freed once written
+    size_t length;
+    int done;
+};
+
+// collects job outputs and writes them in job order no matter which order they finish in
+struct rum_ordered_t
+{
+    pthread_mutex_t lock;
+    struct rum_ordered_slot_t *slots;
+    size_t count;
+    size_t next; // first job that hasn't been written yet
+    FILE *out;
+};
+
+int rum_cpu_count(void);
+int rum_ends_with(const char *str, const char *suffix);
+// expands directories recursively into the .class and .jar files below them, in sorted order
+int rum_collect_paths(struct rum_paths_t *paths, char **inputs, int count);
+void rum_paths_free(struct rum_paths_t *paths);
+// runs `job` once for every index below `count` on `threads` work-stealing workers, the
+// calling thread is one of them. `worker` is below `threads` and can index per-thread state.
+int rum_parallel_for(size_t count, int threads, void (*job)(void *user, size_t index, int worker), void *user);
+int rum_ordered_init(struct rum_ordered_t *ordered, size_t count, FILE *out);
+void rum_ordered_submit(struct rum_ordered_t *ordered, size_t index, char *text, size_t length);
+void rum_ordered_free(struct rum_ordered_t *ordered);
+
+// pipelined reading: a reader stage keeps many reads in flight (through io_uring where the kernel
+// has it, readahead threads otherwise) and `threads` parse workers run `job` on each file as soon
+// as it is in memory. `data` is freed once `job` returns, `error` is set when the file couldn't be read.
+typedef void (*rum_file_job_t)(void *user, size_t index, int worker, const uint8_t *data, size_t length, int error);
+
+#define RUM_PIPELINE_NO_URING 1 // always use the readahead threads
+
+int rum_pipeline_has_io_uring(void);
+int rum_pipeline(const struct rum_paths_t *paths, int threads, int flags, rum_file_job_t job, void *user);
+
+// zip and jar archives
+struct rum_zip_entry_t
+{
+    const char *name; // not NUL-terminated, points into the central directory
+    uint16_t name_length;
+    uint16_t method;
+    uint32_t crc32;
+    uint64_t compressed_size;
+    uint64_t uncompressed_size;
+    uint64_t local_header_offset;
+};
+
+struct rum_zip_t
+{
+    const uint8_t *data;
+    size_t length;
+    int mapped;
+    struct rum_zip_entry_t *entries; // in central directory order
+    size_t count;
+};
+
+struct rum_inflater_t; // reusable zlib state and output buffers, one per thread
+
+int rum_zip_open(struct rum_zip_t *zip, const char *path);
+int rum_zip_open_buffer(struct rum_zip_t *zip, const uint8_t *data, size_t length);
+void rum_zip_close(struct rum_zip_t *zip);
+int rum_zip_entry_is(const struct rum_zip_entry_t *entry, const char *suffix);
+// stored entries are returned in place, deflated ones are inflated into the inflater's buffer and
+// stay valid until its next use
+int rum_zip_read(const struct rum_zip_t *zip, size_t index, struct rum_inflater_t *inflater, const uint8_t **data, size_t *length);
+struct rum_inflater_t *rum_inflater_new(void);
+void rum_inflater_free(struct rum_inflater_t *inflater);
+// `raw` streams have no zlib header, as in zip archives
+int rum_inflate(struct rum_inflater_t *inflater, const uint8_t *input, size_t input_length, size_t output_length, int raw, const uint8_t **output);
+
+// jimage containers, the lib/modules file of a JDK
+struct rum_jimage_t
+{
+    const uint8_t *data;
+    size_t length;
+    int mapped;
+    int big_endian; // images are written in the byte order of the platform that built them
+    uint32_t version;
+    uint32_t flags;
+    uint32_t resource_count;
+    uint32_t table_length;
+    uint32_t locations_size;
+    uint32_t strings_size;
+    const uint8_t *redirect;  // perfect hash seeds, table_length s4
+    const uint8_t *offsets;   // location offsets, table_length u4
+    const uint8_t *locations; // attribute streams
+    const uint8_t *strings;   // NUL-terminated names
+    size_t index_size;        // resource offsets are relative to the end of the index
+};
+
+// strings are offsets into the image's strings table
+struct rum_jimage_location_t
+{
+    uint64_t module;
+    uint64_t parent;
+    uint64_t base;
+    uint64_t extension;
+    uint64_t offset;
+    uint64_t compressed; // 0 when stored as is
+    uint64_t uncompressed;
+};
+
+int rum_jimage_open(struct rum_jimage_t *image, const char *path);
+int rum_jimage_open_buffer(struct rum_jimage_t *image, const uint8_t *data, size_t length);
+void rum_jimage_close(struct rum_jimage_t *image);
+int rum_jimage_location(const struct rum_jimage_t *image, uint32_t index, struct rum_jimage_location_t *location);
+// writes "/module/parent/base.extension"
+int rum_jimage_name(const struct rum_jimage_t *image, const struct rum_jimage_location_t *location, char *buffer, size_t size);
+int rum_jimage_is_class(const struct rum_jimage_t *image, const struct rum_jimage_location_t *location);
+// looks a full name up through the perfect hash table, RUM_ERR_IO when it isn't there
+int rum_jimage_find(const struct rum_jimage_t *image, const char *name, uint32_t *index);
+// like `rum_zip_read`, uncompressed resources point into the mapping
+int rum_jimage_read(const struct rum_jimage_t *image, const struct rum_jimage_location_t *location, struct rum_inflater_t *inflater, const uint8_t **data, size_t *length);
+
+// classpaths, the class files found in a list of files, directories and archives
+#define RUM_SOURCE_FILE 0
+#define RUM_SOURCE_ZIP 1
+#define RUM_SOURCE_JIMAGE 2
+
+struct rum_source_t
+{
+    const char *path;
+    int kind;
+    int error; // why an archive couldn't be opened
+    struct rum_zip_t zip;
+    struct rum_jimage_t jimage;
+};
+
+struct rum_entry_t
+{
+    uint32_t source;
+    uint32_t entry; // index into the archive's entries or the image's locations, 0 for class files
+};
+
+struct rum_classpath_t
+{
+    struct rum_paths_t paths;
+    struct rum_source_t *sources; // one per path
+    struct rum_entry_t *entries;  // every class, in input order
+    size_t count;
+    size_t capacity;
+};
+
+// per-thread state for `rum_classpath_load`
+struct rum_loader_t
+{
+    struct rum_inflater_t *inflater;
+    const uint8_t *mapped;
+    size_t mapped_length;
+};
+
+int rum_classpath_open(struct rum_classpath_t *classpath, char **inputs, int count);
+void rum_classpath_close(struct rum_classpath_t *classpath);
+int rum_classpath_name(const struct rum_classpath_t *classpath, size_t index, char *buffer, size_t size);
+void rum_loader_init(struct rum_loader_t *loader);
+void rum_loader_release(struct rum_loader_t *loader);
+// the bytes stay valid until the next load through the same loader
+int rum_classpath_load(const struct rum_classpath_t *classpath, size_t index, struct rum_loader_t *loader, const uint8_t **data, size_t *length);
+
+// parse cache, a directory of class images that load with one mmap and a memcpy instead of a parse
+#define RUM_CACHE_IDENTITY 1 // found by name, size and mtime, without reading the class file
+#define RUM_CACHE_CONTENT 2  // found by a hash of the class file's bytes
+
+struct rum_cache_t
+{
+    char *directory;
+};
+
+int rum_cache_open(struct rum_cache_t *cache, const char *directory); // creates the directory if needed
+void rum_cache_close(struct rum_cache_t *cache);
+// loads the class from the cache, or parses it and stores its image. `hit` says which, 0 for a parse
+int rum_cache_load(const struct rum_cache_t *cache, const struct rum_classpath_t *classpath, size_t index, struct rum_loader_t *loader, struct class_t *class, int *hit);
+// loads an image written by the cache, `hash` of the class file is checked unless it is 0
+int rum_class_load_image(struct class_t *class, const char *path, uint64_t hash);
+// the hash the cache keys images by, fast but not cryptographic
+uint64_t rum_hash_bytes(const uint8_t *data, size_t length, uint64_t seed);
+
+// symbol index, a file mapping the class names in a classpath to where each class is stored
+struct rum_symbols_t
+{
+    const uint8_t *data;
+    size_t length;
+    uint32_t count;      // records, one per distinct class name
+    uint32_t slot_count; // a power of two
+    const uint32_t *slots;
+    const uint8_t *records;
+    const char *strings;
+    uint64_t strings_size;
+};
+
+struct rum_symbol_t
+{
+    const char *name; // internal form, "java/lang/Object"
+    size_t name_length;
+    const char *entry; // what `rum_classpath_name` calls the class, starting with its container's path
+    size_t entry_length;
+    size_t container_length; // of the container's path at the start of `entry`
+    int kind;                // RUM_SOURCE_*
+    uint64_t offset;         // of the local header in a jar, of the resource in a jimage, 0 for class files
+    uint64_t length;         // stored (compressed) size
+};
+
+// summarizes every class on `threads` workers and writes the index, the first class with a given
+// name in classpath order wins as it would on the JVM. `indexed` is set to the number of records
+int rum_symbols_build(const struct rum_classpath_t *classpath, int threads, const char *path, size_t *indexed);
+int rum_symbols_open(struct rum_symbols_t *symbols, const char *path);
+void rum_symbols_close(struct rum_symbols_t *symbols);
+// RUM_ERR_IO when the name isn't in the index
+int rum_symbols_find(const struct rum_symbols_t *symbols, const char *name, size_t name_length, struct rum_symbol_t *symbol);
+
+// class hierarchy, every class of a classpath and every type they extend or implement as nodes,
+// linked both ways in compressed rows
+#define RUM_HIERARCHY_NONE UINT32_MAX
+#define RUM_TYPE_DEFINED 1   // found in the classpath, not only named by a class that was
+#define RUM_TYPE_INTERFACE 2 // guessed from how it is named for types that aren't defined
+
+struct rum_hierarchy_t
+{
+    uint32_t count;
+    char *names; // NUL-terminated, at `name_offsets`
+    size_t names_size;
+    uint32_t *name_offsets;
+    uint8_t *flags; // RUM_TYPE_*
+    unsigned short *access_flags;
+    uint32_t *superclass;    // RUM_HIERARCHY_NONE for roots
+    uint32_t *super_offsets; // direct supertypes of node n are supers[super_offsets[n]] to supers[super_offsets[n + 1] - 1]
+    uint32_t *supers;
+    uint32_t *sub_offsets; // and the other way around
+    uint32_t *subs;
+    uint32_t *first; // preorder number over the superclass forest, subclasses are numbered from first + 1 to last
+    uint32_t *last;
+    uint32_t *order; // node of every preorder number
+    uint32_t *slots; // name lookup, open addressing
+    uint32_t slot_count;
+};
+
+// per-thread state for the queries that have to walk the graph
+struct rum_walk_t
+{
+    uint32_t *marks; // generation that last reached each node
+    uint32_t generation;
+    uint32_t *found; // nodes the last query found
+    size_t found_count;
+    uint32_t count; // nodes the marks cover
+};
+
+// summarizes every class on `threads` workers, the first definition of a name wins
+int rum_hierarchy_build(struct rum_hierarchy_t *hierarchy, const struct rum_classpath_t *classpath, int threads);
+void rum_hierarchy_free(struct rum_hierarchy_t *hierarchy);
+uint32_t rum_hierarchy_find(const struct rum_hierarchy_t *hierarchy, const char *name, size_t length);
+const char *rum_hierarchy_name(const struct rum_hierarchy_t *hierarchy, uint32_t node);
+// a walk over the nodes 0 to `count`, for the hierarchy or any other graph numbered the same way.
+// `rum_walk_begin` starts a query and `rum_walk_add` marks a node found once
+int rum_walk_init(struct rum_walk_t *walk, uint32_t count);
+void rum_walk_free(struct rum_walk_t *walk);
+void rum_walk_begin(struct rum_walk_t *walk);
+void rum_walk_add(struct rum_walk_t *walk, uint32_t node);
+// constant time when `super` is a class, a walk up from `node` when it's an interface
+int rum_hierarchy_is_subtype(const struct rum_hierarchy_t *hierarchy, struct rum_walk_t *walk, uint32_t node, uint32_t super);
+// every transitive supertype or subtype into `walk->found`, returns how many
+size_t rum_hierarchy_supertypes(const struct rum_hierarchy_t *hierarchy, struct rum_walk_t *walk, uint32_t node);
+size_t rum_hierarchy_subtypes(const struct rum_hierarchy_t *hierarchy, struct rum_walk_t *walk, uint32_t node);
+
+// cross-reference index, from every field and method a classpath references to the classes that
+// reference it, as delta and varint encoded posting lists read in place from the mapping
+#define RUM_XREF_FIELD 1
+#define RUM_XREF_METHOD 2
+#define RUM_XREF_INTERFACE_METHOD 4
+
+struct rum_xref_t
+{
+    const uint8_t *data;
+    size_t length;
+    uint32_t member_count;
+    uint32_t class_count;
+    uint32_t slot_count;
+    const uint8_t *slots;
+    const uint8_t *members;
+    const uint8_t *classes;
+    const char *strings;
+    uint64_t strings_size;
+    const uint8_t *postings;
+    uint64_t postings_size;
+};
+
+struct rum_member_ref_t
+{
+    const char *owner; // internal form, none of these are NUL-terminated
+    size_t owner_length;
+    const char *name;
+    size_t name_length;
+    const char *descriptor;
+    size_t descriptor_length;
+    int kinds;      // RUM_XREF_* of the pool entries it was referenced through
+    uint32_t count; // classes referencing it
+    const uint8_t *postings;
+    size_t postings_length;
+};
+
+// resolves the Fieldref, Methodref and InterfaceMethodref entries of every class on `threads`
+// workers and writes the index
+int rum_xref_build(const struct rum_classpath_t *classpath, int threads, const char *path, size_t *member_count, size_t *class_count);
+int rum_xref_open(struct rum_xref_t *xref, const char *path);
+void rum_xref_close(struct rum_xref_t *xref);
+// calls `found` for every descriptor `owner.name` is referenced with, until it returns non-zero.
+// returns how many there were
+size_t rum_xref_find(const struct rum_xref_t *xref, const char *owner, size_t owner_length, const char *name, size_t name_length, int (*found)(void *user, const struct rum_member_ref_t *member), void *user);
+// decodes the member's posting list into `classes`, room for `member->count` of them
+size_t rum_xref_classes(const struct rum_member_ref_t *member, uint32_t *classes);
+const char *rum_xref_class(const struct rum_xref_t *xref, uint32_t class, size_t *length);
+
+// interned names, ids are dense and given out in the order names are first added
+struct rum_names_t
+{
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t slot_count;
+    uint32_t *slots;
+    uint32_t *offsets; // name `id` is at strings + offsets[id], NUL-terminated, and ends before offsets[id + 1]
+    uint64_t *hashes;
+    char *strings;
+    size_t strings_size;
+    size_t strings_capacity;
+};
+
+// RUM_HIERARCHY_NONE when out of memory
+uint32_t rum_names_add(struct rum_names_t *names, const char *name, size_t length);
+uint32_t rum_names_find(const struct rum_names_t *names, const char *name, size_t length);
+const char *rum_names_get(const struct rum_names_t *names, uint32_t id);
+void rum_names_free(struct rum_names_t *names);
+
+// class dependency graph, an edge from every class to each class its constant pool or member
+// descriptors name, in compressed rows sorted by target
+#define RUM_DEPS_DOT 0
+#define RUM_DEPS_CSV 1
+#define RUM_DEPS_BINARY 2
+
+struct rum_deps_t
+{
+    struct rum_names_t names; // node ids
+    uint32_t count;
+    uint8_t *flags;    // RUM_TYPE_DEFINED for the classes in the classpath
+    uint32_t *offsets; // node n depends on targets[offsets[n]] to targets[offsets[n + 1] - 1]
+    uint32_t *targets;
+    uint32_t edge_count;
+};
+
+// parses every class on `threads` workers
+int rum_deps_build(struct rum_deps_t *deps, const struct rum_classpath_t *classpath, int threads);
+void rum_deps_free(struct rum_deps_t *deps);
+// strongly connected components, numbered so a component comes after everything it depends on, and
+// the layer of every node: 0 for those depending on nothing, one more than their highest dependency
+// otherwise. `components` and `layers` have room for every node
+int rum_deps_components(const struct rum_deps_t *deps, uint32_t *components, uint32_t *layers, uint32_t *component_count);
+int rum_deps_write(const struct rum_deps_t *deps, FILE *out, int format);
+
+// annotation index, from every RuntimeVisibleAnnotations type in a classpath to the classes, fields
+// and methods it annotates, read in place from the mapping
+#define RUM_ANNOTATED_CLASS 0
+#define RUM_ANNOTATED_FIELD 1
+#define RUM_ANNOTATED_METHOD 2
+
+// names point into the class file
+struct rum_annotation_t
+{
+    int target;             // RUM_ANNOTATED_*
+    struct rum_name_t type; // a field descriptor, "Ljavax/inject/Singleton;"
+    struct rum_name_t name; // of the field or method, empty for the class
+    struct rum_name_t descriptor;
+};
+
+struct rum_annotations_t
+{
+    const uint8_t *data;
+    size_t length;
+    uint32_t type_count;
+    uint32_t target_count;
+    uint32_t slot_count;
+    const uint8_t *slots;
+    const uint8_t *types;
+    const uint8_t *targets;
+    const char *strings;
+    uint64_t strings_size;
+};
+
+struct rum_annotated_t
+{
+    int target;        // RUM_ANNOTATED_*
+    const char *class; // internal form, none of these are NUL-terminated
+    size_t class_length;
+    const char *name; // empty for the class
+    size_t name_length;
+    const char *descriptor;
+    size_t descriptor_length;
+};
+
+// calls `found` for every annotation on the class `pool` was parsed from and on its fields and
+// methods, until it returns non-zero. Only the annotation types are decoded, every other attribute
+// is stepped over by its length, and classes whose pool doesn't name RuntimeVisibleAnnotations
+// aren't looked at past it
+int rum_annotations_scan(const struct rum_pool_t *pool, int (*found)(void *user, const struct rum_annotation_t *annotation), void *user);
+// steps over one annotation structure, its type and its element-value pairs. RUM_ERR_TAG for an
+// unknown element tag or values nested too deep
+int rum_annotation_skip(struct cursor_t *cursor);
+// scans every class on `threads` workers and writes the index, keeping only the `types` (internal
+// form) when there are any
+int rum_annotations_build(const struct rum_classpath_t *classpath, int threads, const char *const *types, size_t types_count, const char *path, size_t *type_count, size_t *target_count);
+int rum_annotations_open(struct rum_annotations_t *annotations, const char *path);
+void rum_annotations_close(struct rum_annotations_t *annotations);
+// calls `found` for everything annotated with `type` in classpath order, until it returns non-zero.
+// returns how many were found
+size_t rum_annotations_find(const struct rum_annotations_t *annotations, const char *type, size_t length, int (*found)(void *user, const struct rum_annotated_t *annotated), void *user);
+
+
+// JIT size limits over every method of a classpath. HotSpot only inlines a method with more bytecode
+// than MaxInlineSize at hot call sites, never inlines one with more than FreqInlineSize, and doesn't
+// compile one with more than HugeMethodLimit at all. These are its defaults
+#define RUM_MAX_INLINE_SIZE 35
+#define RUM_FREQ_INLINE_SIZE 325
+#define RUM_HUGE_METHOD_LIMIT 8000
+
+#define RUM_SIZE_OVER_MAX_INLINE 1
+#define RUM_SIZE_OVER_FREQ_INLINE 2
+#define RUM_SIZE_HUGE 4
+
+struct rum_inline_limits_t
+{
+    uint32_t max_inline;
+    uint32_t freq_inline;
+    uint32_t huge_method;
+};
+
+// names point into the class file
+struct rum_method_size_t
+{
+    unsigned short access_flags;
+    struct rum_name_t name;
+    struct rum_name_t descriptor;
+    uint32_t code_length;
+};
+
+// a method over at least one limit, none of the names are NUL-terminated
+struct rum_inlined_t
+{
+    const char *class;
+    size_t class_length;
+    const char *name;
+    size_t name_length;
+    const char *descriptor;
+    size_t descriptor_length;
+    uint32_t code_length;
+    int flags; // RUM_SIZE_*
+};
+
+struct rum_inlining_t
+{
+    struct rum_inline_limits_t limits;
+    size_t count;
+    struct rum_inlined_t *methods; // largest first, then in classpath order
+    uint64_t method_count;         // with a Code attribute, over a limit or not
+    uint64_t over_max_inline;
+    uint64_t over_freq_inline;
+    uint64_t huge;
+    char *strings;
+};
+
+// calls `found` with the code_length of every method of the class `pool` was parsed from that has a
+// Code attribute, until it returns non-zero. Attributes are stepped over by their length
+int rum_method_sizes(const struct rum_pool_t *pool, int (*found)(void *user, const struct rum_method_size_t *method), void *user);
+// scans every class on `threads` workers and keeps the methods over any of the `limits`
+int rum_inlining_build(struct rum_inlining_t *inlining, const struct rum_classpath_t *classpath, int threads, const struct rum_inline_limits_t *limits);
+void rum_inlining_free(struct rum_inlining_t *inlining);
+
+// whole-program reachability, which classes, methods and fields can be reached from a set of entry
+// points through the code of a classpath. Calls through invokevirtual and invokeinterface land on
+// every class that is instantiated somewhere reachable, and reflection isn't followed
+#define RUM_REACH_KEPT 1         // reachable
+#define RUM_REACH_INSTANTIATED 2 // classes created with new or a constructor handle, or kept whole
+#define RUM_REACH_ENTRY 4        // an entry point
+
+#define RUM_KEEP_MAIN 1 // every public static void main(String[]) is an entry point
+
+struct rum_reach_options_t
+{
+    int flags; // RUM_KEEP_*
+    // "Class" keeps a class whole, "Class.member" every field and method of the class with that
+    // name, "@Type" everything annotated with Type. Classes are in internal form, and a trailing '*'
+    // matches any class starting with what comes before it
+    const char *const *keep;
+    size_t keep_count;
+};
+
+struct rum_reach_member_t
+{
+    uint32_t name; // ids in the reach's names
+    uint32_t descriptor;
+    unsigned short access_flags;
+    uint8_t flags; // RUM_REACH_*
+};
+
+struct rum_reach_class_t
+{
+    uint32_t name;
+    uint32_t superclass; // RUM_HIERARCHY_NONE for java/lang/Object
+    size_t entry;        // in the classpath
+    uint32_t length;     // of the class file
+    unsigned short access_flags;
+    uint8_t flags; // RUM_REACH_*
+    uint32_t first_field; // into the reach's fields
+    uint32_t field_count;
+    uint32_t first_method;
+    uint32_t method_count;
+};
+
+struct rum_reach_t
+{
+    struct rum_names_t names;
+    struct rum_reach_class_t *classes; // in classpath order, the first definition of a name wins
+    uint32_t class_count;
+    struct rum_reach_member_t *fields;
+    uint32_t field_count;
+    struct rum_reach_member_t *methods;
+    uint32_t method_count;
+    uint32_t entry_points;
+    uint32_t rounds; // of the worklist, each one expanding every method the last one reached
+    uint32_t kept_classes;
+    uint32_t kept_fields;
+    uint32_t kept_methods;
+    uint64_t removed_bytes; // class files of the classes nothing reaches
+};
+
+// parses every class on `threads` workers, then runs the worklist with the methods of every round
+// expanded on them
+int rum_reach_build(struct rum_reach_t *reach, const struct rum_classpath_t *classpath, int threads, const struct rum_reach_options_t *options);
+void rum_reach_free(struct rum_reach_t *reach);
+// "keep class A" or "remove class A" for every class by name, and "keep method A.m()V" or "remove
+// field A.f:I" for the members of the classes that are kept
+int rum_reach_write(const struct rum_reach_t *reach, FILE *out);
+
+#endif
@@ -0,0 +1,10 @@
+@Deprecated
+public class Annotated {
+  @Deprecated(since = "2", forRemoval = true)
+  public int old;
+
+  @SafeVarargs
+  public static <T> int count(T... values) {
+    return values.length;
+  }
+}
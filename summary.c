@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+
+#include "rum.h"
+
+// payload size of every constant pool tag, 0 for tags that don't exist. Utf8 entries add their
+// length on top, Long and Double take the next index as well
+static const uint8_t tag_sizes[256] = {
+    [CONSTANT_Utf8] = 2,
+    [CONSTANT_Integer] = 4,
+    [CONSTANT_Float] = 4,
+    [CONSTANT_Long] = 8,
+    [CONSTANT_Double] = 8,
+    [CONSTANT_Class] = 2,
+    [CONSTANT_String] = 2,
+    [CONSTANT_Fieldref] = 4,
+    [CONSTANT_Methodref] = 4,
+    [CONSTANT_InterfaceMethodref] = 4,
+    [CONSTANT_NameAndType] = 4,
+    [CONSTANT_MethodHandle] = 3,
+    [CONSTANT_MethodType] = 2,
+    [CONSTANT_InvokeDynamic] = 4,
+};
+
+// an index being resolved, and where its entry was found
+struct wanted_t
+{
+    unsigned short index;
+    size_t offset; // of the payload, 0 until found
+};
+
+// walks the pool from the cursor (at its first entry) and fills in the offset of every wanted index,
+// stopping after the highest one. With nothing wanted the cursor ends up just past the pool
+static int skip_pool(struct cursor_t *cursor, unsigned short count, struct wanted_t *wanted, size_t wanted_count)
+{
+    unsigned short last = 0;
+    for (size_t i = 0; i < wanted_count; i++)
+    {
+        last = wanted[i].index > last ? wanted[i].index : last;
+    }
+
+    for (unsigned short index = 1; index < count; index++)
+    {
+        if (wanted_count > 0 && index > last)
+        {
+            return RUM_OK;
+        }
+        uint8_t tag = read_u1(cursor);
+        if (tag_sizes[tag] == 0)
+        {
+            return cursor->overflow ? RUM_ERR_TRUNCATED : RUM_ERR_TAG;
+        }
+        for (size_t i = 0; i < wanted_count; i++)
+        {
+            if (wanted[i].index == index)
+            {
+                wanted[i].offset = cursor->offset;
+            }
+        }
+
+        // only Utf8 lengths are ever read, everything else is stepped over by size
+        size_t size = tag_sizes[tag];
+        if (tag == CONSTANT_Utf8)
+        {
+            size += read_u2(cursor);
+            size -= 2;
+        }
+        read_bytes(cursor, size);
+        if (cursor->overflow)
+        {
+            return RUM_ERR_TRUNCATED;
+        }
+        if (tag == CONSTANT_Long || tag == CONSTANT_Double)
+        {
+            index++;
+        }
+    }
+    return RUM_OK;
+}
+
+// reads the u2 at `offset`, which `skip_pool` checked to be in bounds
+static unsigned short read_u2_at(const uint8_t *data, size_t offset)
+{
+    return (unsigned short)(data[offset] << 8 | data[offset + 1]);
+}
+
+int rum_summarize(const uint8_t *data, size_t length, struct rum_summary_t *summary)
+{
+    struct cursor_t cursor = {
+        .data = data,
+        .length = length,
+        .offset = 0,
+        .overflow = 0};
+
+    memset(summary, 0, sizeof(struct rum_summary_t));
+    uint32_t magic = read_u4(&cursor);
+    summary->minor = read_u2(&cursor);
+    summary->major = read_u2(&cursor);
+    unsigned short count = read_u2(&cursor);
+    if (cursor.overflow)
+    {
+        return RUM_ERR_TRUNCATED;
+    }
+    if (magic != 0xcafebabe)
+    {
+        return RUM_ERR_MAGIC;
+    }
+
+    // first pass, over the whole pool, to find where it ends
+    size_t pool = cursor.offset;
+    int error = skip_pool(&cursor, count, NULL, 0);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+    summary->access_flags = read_u2(&cursor);
+    unsigned short this_class = read_u2(&cursor);
+    unsigned short super_class = read_u2(&cursor);
+    summary->interfaces_count = read_u2(&cursor);
+
+    // the Class entries to resolve, this and super first
+    struct wanted_t classes[RUM_SUMMARY_INTERFACES + 2] = {{this_class, 0}, {super_class, 0}};
+    size_t wanted = 2;
+    for (unsigned short i = 0; i < summary->interfaces_count; i++)
+    {
+        unsigned short interface = read_u2(&cursor);
+        if (wanted < RUM_SUMMARY_INTERFACES + 2)
+        {
+            classes[wanted++].index = interface;
+        }
+    }
+    if (cursor.overflow)
+    {
+        return RUM_ERR_TRUNCATED;
+    }
+
+    // second pass, up to the last of those Class entries, for their name indices
+    cursor.offset = pool;
+    if ((error = skip_pool(&cursor, count, classes, wanted)) != RUM_OK)
+    {
+        return error;
+    }
+    if (classes[0].offset == 0)
+    {
+        return RUM_ERR_TAG;
+    }
+    struct wanted_t names[RUM_SUMMARY_INTERFACES + 2];
+    for (size_t i = 0; i < wanted; i++)
+    {
+        // super_class is 0 for java/lang/Object, which has no superclass, any other index has to be in the pool
+        if (classes[i].offset == 0 && (i != 1 || classes[i].index != 0))
+        {
+            return RUM_ERR_FORMAT;
+        }
+        if (classes[i].offset != 0 && data[classes[i].offset - 1] != CONSTANT_Class)
+        {
+            return RUM_ERR_TAG;
+        }
+        names[i].index = classes[i].offset == 0 ? 0 : read_u2_at(data, classes[i].offset);
+        names[i].offset = 0;
+    }
+
+    // third pass for the names themselves, the only bytes looked at beyond tags and lengths
+    cursor.offset = pool;
+    if ((error = skip_pool(&cursor, count, names, wanted)) != RUM_OK)
+    {
+        return error;
+    }
+    struct rum_name_t *resolved[RUM_SUMMARY_INTERFACES + 2] = {&summary->this_class, &summary->super_class};
+    for (size_t i = 2; i < wanted; i++)
+    {
+        resolved[i] = &summary->interfaces[i - 2];
+    }
+    for (size_t i = 0; i < wanted; i++)
+    {
+        if (names[i].offset == 0 && classes[i].offset != 0)
+        {
+            return RUM_ERR_FORMAT; // a Class constant naming nothing in the pool
+        }
+        if (names[i].offset == 0)
+        {
+            continue;
+        }
+        if (data[names[i].offset - 1] != CONSTANT_Utf8)
+        {
+            return RUM_ERR_TAG;
+        }
+        resolved[i]->length = read_u2_at(data, names[i].offset);
+        resolved[i]->bytes = data + names[i].offset + 2;
+        if (!rum_mutf8_valid(resolved[i]->bytes, resolved[i]->length))
+        {
+            return RUM_ERR_UTF8;
+        }
+    }
+    return RUM_OK;
+}
@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rum.h"
+
+#define SYMBOLS_MAGIC 0x494d5552 // "RUMI", reads differently on a machine of the other byte order
+#define SYMBOLS_VERSION 1
+#define SYMBOLS_SEED 0x52554d49
+
+// the file is this header, the slots, the records and then the strings, each 8 byte aligned
+struct symbols_header_t
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t slot_count;
+    uint64_t strings_size;
+    uint64_t reserved;
+};
+
+struct symbol_record_t
+{
+    uint64_t hash;
+    uint32_t name; // offsets into the strings
+    uint32_t name_length;
+    uint32_t entry;
+    uint32_t entry_length;
+    uint32_t container_length;
+    uint32_t kind;
+    uint64_t offset;
+    uint64_t length;
+};
+
+static size_t slots_size(uint32_t slot_count)
+{
+    return ((size_t)slot_count * sizeof(uint32_t) + 7) & ~(size_t)7;
+}
+
+// what every worker found for its classes
+struct build_t
+{
+    const struct rum_classpath_t *classpath;
+    struct rum_loader_t *loaders;
+    char **names; // this_class of every entry, NULL when it couldn't be summarized
+    uint32_t *name_lengths;
+    uint64_t *lengths; // of the class file, only kept for plain files
+};
+
+static void build_job(void *user, size_t index, int worker)
+{
+    struct build_t *build = user;
+    const uint8_t *data;
+    size_t length;
+    struct rum_summary_t summary;
+    if (rum_classpath_load(build->classpath, index, &build->loaders[worker], &data, &length) != RUM_OK ||
+        rum_summarize(data, length, &summary) != RUM_OK)
+    {
+        return;
+    }
+    // the name points into bytes the next load will replace
+    build->names[index] = malloc(summary.this_class.length + 1u);
+    if (build->names[index] != NULL)
+    {
+        memcpy(build->names[index], summary.this_class.bytes, summary.this_class.length);
+        build->name_lengths[index] = summary.this_class.length;
+        build->lengths[index] = length;
+    }
+}
+
+// where the class's bytes are stored in its container
+static void locate(const struct rum_classpath_t *classpath, size_t index, uint64_t file_length, struct symbol_record_t *record)
+{
+    const struct rum_entry_t *entry = &classpath->entries[index];
+    const struct rum_source_t *source = &classpath->sources[entry->source];
+    record->kind = (uint32_t)source->kind;
+    record->offset = 0;
+    record->length = file_length;
+    if (source->kind == RUM_SOURCE_ZIP)
+    {
+        record->offset = source->zip.entries[entry->entry].local_header_offset;
+        record->length = source->zip.entries[entry->entry].compressed_size;
+    }
+    else if (source->kind == RUM_SOURCE_JIMAGE)
+    {
+        struct rum_jimage_location_t location;
+        rum_jimage_location(&source->jimage, entry->entry, &location);
+        record->offset = source->jimage.index_size + location.offset;
+        record->length = location.compressed != 0 ? location.compressed : location.uncompressed;
+    }
+}
+
+// slot of `name`, or of the empty slot it would go in
+static uint32_t probe(const uint32_t *slots, uint32_t slot_count, const uint8_t *records, const char *strings, uint64_t hash, const char *name, size_t name_length)
+{
+    for (uint32_t slot = (uint32_t)hash & (slot_count - 1);; slot = (slot + 1) & (slot_count - 1))
+    {
+        if (slots[slot] == 0)
+        {
+            return slot;
+        }
+        const struct symbol_record_t *record = (const struct symbol_record_t *)records + (slots[slot] - 1);
+        if (record->hash == hash && record->name_length == name_length && memcmp(strings + record->name, name, name_length) == 0)
+        {
+            return slot;
+        }
+    }
+}
+
+struct symbols_output_t
+{
+    const struct symbols_header_t *header;
+    const uint32_t *slots;
+    const struct symbol_record_t *records;
+    const char *strings;
+};
+
+static int write_symbols(void *user, FILE *file)
+{
+    const struct symbols_output_t *output = user;
+    const struct symbols_header_t *header = output->header;
+    static const uint8_t padding[8] = {0};
+    size_t slots_bytes = (size_t)header->slot_count * sizeof(uint32_t);
+    int written = fwrite(header, sizeof(*header), 1, file) == 1 &&
+                  fwrite(output->slots, sizeof(uint32_t), header->slot_count, file) == header->slot_count &&
+                  fwrite(padding, 1, slots_size(header->slot_count) - slots_bytes, file) == slots_size(header->slot_count) - slots_bytes &&
+                  fwrite(output->records, sizeof(struct symbol_record_t), header->count, file) == header->count &&
+                  fwrite(output->strings, 1, header->strings_size, file) == header->strings_size;
+    return written ? RUM_OK : RUM_ERR_IO;
+}
+
+int rum_symbols_build(const struct rum_classpath_t *classpath, int threads, const char *path, size_t *indexed)
+{
+    *indexed = 0;
+    size_t count = classpath->count;
+    if (count >= UINT32_MAX / 4)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    struct build_t build = {
+        .classpath = classpath,
+        .loaders = calloc((size_t)threads, sizeof(struct rum_loader_t)),
+        .names = calloc(count + 1, sizeof(char *)),
+        .name_lengths = calloc(count + 1, sizeof(uint32_t)),
+        .lengths = calloc(count + 1, sizeof(uint64_t))};
+    int error = build.loaders == NULL || build.names == NULL || build.name_lengths == NULL || build.lengths == NULL ? RUM_ERR_NOMEM : RUM_OK;
+    if (error == RUM_OK)
+    {
+        error = rum_parallel_for(count, threads, build_job, &build);
+    }
+
+    // a power of two at least twice the number of names keeps probe sequences short
+    uint32_t slot_count = 2;
+    while (slot_count < count * 2)
+    {
+        slot_count *= 2;
+    }
+    uint64_t strings_size = 0;
+    char entry[4096];
+    for (size_t i = 0; error == RUM_OK && i < count; i++)
+    {
+        int length = rum_classpath_name(classpath, i, entry, sizeof(entry));
+        strings_size += build.name_lengths[i] + (length > 0 ? (uint64_t)length : 0) + 2;
+    }
+    uint32_t *slots = calloc(slot_count, sizeof(uint32_t));
+    struct symbol_record_t *records = calloc(count + 1, sizeof(struct symbol_record_t));
+    char *strings = strings_size >= UINT32_MAX ? NULL : malloc(strings_size + 1);
+    if (error == RUM_OK && (slots == NULL || records == NULL || strings == NULL))
+    {
+        error = RUM_ERR_NOMEM;
+    }
+
+    // inserted in classpath order, so a name already in the table shadows the later ones
+    struct symbols_header_t header = {
+        .magic = SYMBOLS_MAGIC,
+        .version = SYMBOLS_VERSION,
+        .slot_count = slot_count};
+    for (size_t i = 0; error == RUM_OK && i < count; i++)
+    {
+        if (build.names[i] == NULL)
+        {
+            continue;
+        }
+        uint64_t hash = rum_hash_bytes((const uint8_t *)build.names[i], build.name_lengths[i], SYMBOLS_SEED);
+        uint32_t slot = probe(slots, slot_count, (const uint8_t *)records, strings, hash, build.names[i], build.name_lengths[i]);
+        if (slots[slot] != 0)
+        {
+            continue;
+        }
+        struct symbol_record_t *record = &records[header.count];
+        record->hash = hash;
+        record->name = (uint32_t)header.strings_size;
+        record->name_length = build.name_lengths[i];
+        memcpy(strings + header.strings_size, build.names[i], record->name_length);
+        strings[header.strings_size + record->name_length] = '\0';
+        header.strings_size += record->name_length + 1u;
+
+        int length = rum_classpath_name(classpath, i, strings + header.strings_size, (size_t)(strings_size + 1 - header.strings_size));
+        record->entry = (uint32_t)header.strings_size;
+        record->entry_length = length > 0 ? (uint32_t)length : 0;
+        record->container_length = (uint32_t)strlen(classpath->sources[classpath->entries[i].source].path);
+        header.strings_size += record->entry_length + 1u;
+        locate(classpath, i, build.lengths[i], record);
+        slots[slot] = ++header.count;
+    }
+
+    if (error == RUM_OK)
+    {
+        struct symbols_output_t output = {&header, slots, records, strings};
+        error = rum_write_atomic(path, write_symbols, &output);
+        *indexed = header.count;
+    }
+    for (size_t i = 0; build.names != NULL && i < count; i++)
+    {
+        free(build.names[i]);
+    }
+    for (int i = 0; build.loaders != NULL && i < threads; i++)
+    {
+        rum_loader_release(&build.loaders[i]);
+    }
+    free(build.loaders);
+    free(build.names);
+    free(build.name_lengths);
+    free(build.lengths);
+    free(slots);
+    free(records);
+    free(strings);
+    return error;
+}
+
+int rum_symbols_open(struct rum_symbols_t *symbols, const char *path)
+{
+    memset(symbols, 0, sizeof(struct rum_symbols_t));
+    int error = rum_map_file(path, &symbols->data, &symbols->length);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+
+    struct symbols_header_t header;
+    if (symbols->length >= sizeof(header))
+    {
+        memcpy(&header, symbols->data, sizeof(header));
+    }
+    // the sizes are checked against the file before any of them is added up
+    if (symbols->length < sizeof(header) || header.magic != SYMBOLS_MAGIC || header.version != SYMBOLS_VERSION ||
+        header.slot_count == 0 || (header.slot_count & (header.slot_count - 1)) != 0 || header.count >= header.slot_count ||
+        slots_size(header.slot_count) > symbols->length - sizeof(header) ||
+        (uint64_t)header.count * sizeof(struct symbol_record_t) > symbols->length - sizeof(header) - slots_size(header.slot_count) ||
+        header.strings_size != symbols->length - sizeof(header) - slots_size(header.slot_count) - (uint64_t)header.count * sizeof(struct symbol_record_t))
+    {
+        rum_symbols_close(symbols);
+        return RUM_ERR_ARCHIVE;
+    }
+    symbols->count = header.count;
+    symbols->slot_count = header.slot_count;
+    symbols->slots = (const uint32_t *)(symbols->data + sizeof(header));
+    symbols->records = symbols->data + sizeof(header) + slots_size(header.slot_count);
+    symbols->strings = (const char *)symbols->records + (size_t)header.count * sizeof(struct symbol_record_t);
+    symbols->strings_size = header.strings_size;
+    return RUM_OK;
+}
+
+void rum_symbols_close(struct rum_symbols_t *symbols)
+{
+    if (symbols->data != NULL)
+    {
+        rum_unmap_file(symbols->data, symbols->length);
+    }
+    memset(symbols, 0, sizeof(struct rum_symbols_t));
+}
+
+int rum_symbols_find(const struct rum_symbols_t *symbols, const char *name, size_t name_length, struct rum_symbol_t *symbol)
+{
+    uint64_t hash = rum_hash_bytes((const uint8_t *)name, name_length, SYMBOLS_SEED);
+    uint32_t mask = symbols->slot_count - 1;
+    // the table is never full, so every probe sequence ends at an empty slot
+    for (uint32_t slot = (uint32_t)hash & mask, probes = 0; probes < symbols->slot_count; slot = (slot + 1) & mask, probes++)
+    {
+        uint32_t index = symbols->slots[slot];
+        if (index == 0 || index > symbols->count)
+        {
+            return RUM_ERR_IO;
+        }
+        struct symbol_record_t record;
+        memcpy(&record, symbols->records + (size_t)(index - 1) * sizeof(record), sizeof(record));
+        if (record.hash != hash || record.name_length != name_length)
+        {
+            continue;
+        }
+        if ((uint64_t)record.name + record.name_length > symbols->strings_size ||
+            (uint64_t)record.entry + record.entry_length > symbols->strings_size || record.container_length > record.entry_length)
+        {
+            return RUM_ERR_ARCHIVE;
+        }
+        if (memcmp(symbols->strings + record.name, name, name_length) == 0)
+        {
+            symbol->name = symbols->strings + record.name;
+            symbol->name_length = record.name_length;
+            symbol->entry = symbols->strings + record.entry;
+            symbol->entry_length = record.entry_length;
+            symbol->container_length = record.container_length;
+            symbol->kind = (int)record.kind;
+            symbol->offset = record.offset;
+            symbol->length = record.length;
+            return RUM_OK;
+        }
+    }
+    return RUM_ERR_IO;
+}
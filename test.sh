@@ -11,4 +11,201 @@ for file in samples/*.class; do
 	fi
 done;
 
+./out/rum samples/Samples.jar > /dev/null
+if [ $? -eq 0 ]; then
+	echo ✅ samples/Samples.jar
+else
+	echo ❌ samples/Samples.jar
+	EXIT_CODE=1
+fi
+
+# a stored and a zip-compressed resource, looked up through the image's hash table
+./out/rum samples/Stack.class > /tmp/rum_stack.txt && ./out/rum samples/Queue.class > /tmp/rum_queue.txt &&
+	./out/rum 'samples/Samples.jimage!/demo.mod/sample/deep/Stack.class' | cmp -s - /tmp/rum_stack.txt &&
+	./out/rum 'samples/Samples.jimage!/java.base/sample/Queue.class' | cmp -s - /tmp/rum_queue.txt
+if [ $? -eq 0 ]; then
+	echo ✅ samples/Samples.jimage
+else
+	echo ❌ samples/Samples.jimage
+	EXIT_CODE=1
+fi
+
+./out/rum --summary samples/Samples.jar | grep -q "^samples/Samples.jar!/Stack.class : Stack extends java/lang/Object implements java/lang/Iterable$"
+if [ $? -eq 0 ]; then
+	echo ✅ --summary
+else
+	echo ❌ --summary
+	EXIT_CODE=1
+fi
+
+# a cold run fills the cache and a warm one loads every class from it, both print what a plain run does
+rm -rf /tmp/rum_cache
+./out/rum samples > /tmp/rum_plain.txt && ./out/rum --cache /tmp/rum_cache samples 2> /dev/null | cmp -s - /tmp/rum_plain.txt &&
+	./out/rum --cache /tmp/rum_cache samples 2>&1 > /tmp/rum_cached.txt | grep -q "^\[+\] \([0-9]*\) of \1 classes" &&
+	cmp -s /tmp/rum_cached.txt /tmp/rum_plain.txt
+if [ $? -eq 0 ]; then
+	echo ✅ --cache
+else
+	echo ❌ --cache
+	EXIT_CODE=1
+fi
+
+# classes are found through the index without the classpath, the jar listed first shadows the directory
+./out/rum --index /tmp/rum_symbols samples/Samples.jar samples > /dev/null &&
+	./out/rum --lookup /tmp/rum_symbols Queue | grep -q "^Queue : samples/Samples.jar!/Queue.class [0-9]* [0-9]*$" &&
+	./out/rum --lookup /tmp/rum_symbols 'QuadTree$Pt' | grep -q "^QuadTree\$Pt : samples/QuadTree\$Pt.class 0 [0-9]*$" &&
+	echo java/lang/Missing | ./out/rum --lookup /tmp/rum_symbols | grep -q "^\[-\] couldn't find class 'java/lang/Missing'$"
+if [ $? -eq 0 ]; then
+	echo ✅ --index
+else
+	echo ❌ --index
+	EXIT_CODE=1
+fi
+
+# interface queries walk the graph, class queries use the superclass intervals
+printf 'implementors java.lang.Iterable\nis-subtype Stack java/lang/Iterable\nis-subtype Stack Queue\n' | ./out/rum --hierarchy samples/*.class > /tmp/rum_hierarchy.txt &&
+	printf 'implementors java/lang/Iterable : DoublyLinkedList, HSet, Queue, Stack\nis-subtype Stack java/lang/Iterable : true\nis-subtype Stack Queue : false\n' | cmp -s - /tmp/rum_hierarchy.txt
+if [ $? -eq 0 ]; then
+	echo ✅ --hierarchy
+else
+	echo ❌ --hierarchy
+	EXIT_CODE=1
+fi
+
+# every class referencing a member, by name alone or with its descriptor
+./out/rum --xref /tmp/rum_xref samples/*.class > /dev/null &&
+	./out/rum --references /tmp/rum_xref 'DoublyLinkedList$Node.next:LDoublyLinkedList$Node;' | grep -q '^DoublyLinkedList\$Node.next:LDoublyLinkedList\$Node; : DoublyLinkedList\$1, DoublyLinkedList\$Node, DoublyLinkedList$' &&
+	./out/rum --references /tmp/rum_xref java.io.PrintStream.println | grep -q '^java/io/PrintStream.println(Ljava/lang/String;)V : Main$'
+if [ $? -eq 0 ]; then
+	echo ✅ --xref
+else
+	echo ❌ --xref
+	EXIT_CODE=1
+fi
+
+# the dependency graph, its cycles and its layers, and the binary form of an empty classpath
+./out/rum --deps layers samples/*.class | grep -q '^cycle [0-9]* : Trie\$Node, Trie$' &&
+	./out/rum --deps layers samples/*.class | grep -q '^layer 3 : DirectedGraph$' &&
+	./out/rum --deps csv samples/Edge.class | grep -qx '"Edge","java/lang/Object"' &&
+	mkdir -p /tmp/rum_empty && ./out/rum --deps binary /tmp/rum_empty > /tmp/rum_empty.bin &&
+	[ "$(wc -c < /tmp/rum_empty.bin)" -eq 32 ]
+if [ $? -eq 0 ]; then
+	echo ✅ --deps
+else
+	echo ❌ --deps
+	EXIT_CODE=1
+fi
+
+# annotations on the class and its members, and only the query set when there is one
+./out/rum --annotations /tmp/rum_annotations samples > /dev/null &&
+	./out/rum --annotated /tmp/rum_annotations java.lang.Deprecated java/lang/SafeVarargs > /tmp/rum_annotated.txt &&
+	printf 'java/lang/Deprecated : Annotated.old:I\njava/lang/Deprecated : Annotated\njava/lang/SafeVarargs : Annotated.count([Ljava/lang/Object;)I\n' | cmp -s - /tmp/rum_annotated.txt &&
+	./out/rum --annotation java.lang.SafeVarargs --annotations /tmp/rum_annotations samples > /dev/null &&
+	! ./out/rum --annotated /tmp/rum_annotations java/lang/Deprecated > /dev/null
+if [ $? -eq 0 ]; then
+	echo ✅ --annotations
+else
+	echo ❌ --annotations
+	EXIT_CODE=1
+fi
+
+# Code attributes are disassembled, the constructor of Annotated is aload_0, invokespecial, return
+./out/rum samples/Annotated.class | grep -m 1 -A 4 '^		code ' | tr -s ' \t' ' ' > /tmp/rum_code.txt &&
+	printf ' code -> \n 0 : aload_0\n 1 : invokespecial #1\n 4 : return\n exception_table -> []\n' | cmp -s - /tmp/rum_code.txt
+if [ $? -eq 0 ]; then
+	echo ✅ Code
+else
+	echo ❌ Code
+	EXIT_CODE=1
+fi
+
+# control-flow graphs, showGraph has a loop nested in another and the output doesn't depend on -j
+./out/rum --cfg loops samples/Graph.class | grep -A 2 '^Graph.showGraph' > /tmp/rum_cfg.txt &&
+	printf 'Graph.showGraph(LGraph;)V : 7 blocks, 2 loops, depth 2\n\tloop 0 : header pc 36, depth 2, 2 blocks, 48 bytes, 1 back edges, in loop 1\n\tloop 1 : header pc 12, depth 1, 5 blocks, 84 bytes, 1 back edges\n' | cmp -s - /tmp/rum_cfg.txt &&
+	./out/rum -j 4 --cfg dot samples > /tmp/rum_cfg.txt && ./out/rum -j 1 --cfg dot samples | cmp -s - /tmp/rum_cfg.txt
+if [ $? -eq 0 ]; then
+	echo ✅ --cfg
+else
+	echo ❌ --cfg
+	EXIT_CODE=1
+fi
+
+# methods over the JIT size limits, largest first, with a lowered HugeMethodLimit
+./out/rum --inlining --huge-method 1000 'samples/QuadTree$Node.class' > /tmp/rum_inlining.txt &&
+	grep -q '^QuadTree\$Node.knn(IJJLjava/util/PriorityQueue;)V : 1547 bytes, over HugeMethodLimit 1000$' /tmp/rum_inlining.txt &&
+	sed -n 2p /tmp/rum_inlining.txt | grep -q '^QuadTree\$Node.add(JJ)Z : 342 bytes, over FreqInlineSize 325$' &&
+	grep -q '^\[+\] 5 methods, 5 over MaxInlineSize 35, 2 over FreqInlineSize 325, 1 over HugeMethodLimit 1000$' /tmp/rum_inlining.txt
+if [ $? -eq 0 ]; then
+	echo ✅ --inlining
+else
+	echo ❌ --inlining
+	EXIT_CODE=1
+fi
+
+# writing a class back unchanged gives the same bytes, stripping debug attributes leaves the bytecode alone
+./out/rum --rewrite /tmp/rum_rewrite.class samples/Stack.class > /dev/null && cmp -s /tmp/rum_rewrite.class samples/Stack.class &&
+	./out/rum --rewrite /tmp/rum_rewrite.jar samples/Samples.jar > /dev/null && cmp -s /tmp/rum_rewrite.jar samples/Samples.jar &&
+	./out/rum --rewrite /tmp/rum_stripped.jar --strip-debug samples/Samples.jar | grep -q '^\[+\] wrote 5 classes of 6 entries' &&
+	./out/rum --cfg dot /tmp/rum_stripped.jar > /tmp/rum_stripped.txt && ./out/rum --cfg dot samples/Samples.jar | cmp -s - /tmp/rum_stripped.txt &&
+	./out/rum --rewrite /tmp/rum_stripped.class --strip-debug samples/Stack.class > /dev/null &&
+	./out/rum /tmp/rum_stripped.class | grep -q '^attribute_count       : 1$' &&
+	[ "$(wc -c < /tmp/rum_stripped.class)" -lt "$(wc -c < samples/Stack.class)" ]
+if [ $? -eq 0 ]; then
+	echo ✅ --rewrite
+else
+	echo ❌ --rewrite
+	EXIT_CODE=1
+fi
+
+# compacting the pool drops the debug attribute names, the classes have to read the same
+./out/rum --rewrite /tmp/rum_compact.class --strip-debug --compact-pool samples/Stack.class | grep -q 'constants 60 -> 57$' &&
+	./out/rum --rewrite /tmp/rum_compact.class --compact-pool samples/Stack.class | grep -q 'constants 60 -> 60$' &&
+	cmp -s /tmp/rum_compact.class samples/Stack.class &&
+	./out/rum --rewrite /tmp/rum_compact.jar --strip-debug --compact-pool samples/Samples.jar > /dev/null &&
+	./out/rum --deps csv /tmp/rum_compact.jar > /tmp/rum_compact.txt && ./out/rum --deps csv samples/Samples.jar | cmp -s - /tmp/rum_compact.txt &&
+	./out/rum --cfg dot /tmp/rum_compact.jar > /tmp/rum_compact.txt && ./out/rum --cfg dot samples/Samples.jar | cmp -s - /tmp/rum_compact.txt
+if [ $? -eq 0 ]; then
+	echo ✅ --compact-pool
+else
+	echo ❌ --compact-pool
+	EXIT_CODE=1
+fi
+
+# only what the main methods reach is kept, the same on any number of workers, and a class
+# implementing a type outside the classpath keeps the methods the library can call back into
+./out/rum -j 1 --reachable samples/ > /tmp/rum_reachable.txt &&
+	./out/rum -j 4 --reachable samples/ | cmp -s - /tmp/rum_reachable.txt &&
+	grep -q '^keep method Graph.showGraph(LGraph;)V$' /tmp/rum_reachable.txt &&
+	grep -q '^remove class Stack$' /tmp/rum_reachable.txt &&
+	grep -q '^\[+\] 4 of 24 classes, 5 of 145 methods and 3 of 76 fields reachable from 2 entry points in 2 rounds' /tmp/rum_reachable.txt &&
+	./out/rum --reachable --keep DoublyLinkedList.iterator samples/ | grep -q '^keep method DoublyLinkedList\$1.hasNext()Z$'
+if [ $? -eq 0 ]; then
+	echo ✅ --reachable
+else
+	echo ❌ --reachable
+	EXIT_CODE=1
+fi
+
+# a string constant holding U+0000, as the modified UTF-8 pair c0 80, is printed whole
+printf '\312\376\272\276\000\000\000\064\000\002\001\000\004a\300\200b\000\041\000\000\000\000\000\000\000\000\000\000\000\000' > /tmp/rum_nul.class &&
+	./out/rum /tmp/rum_nul.class | grep -a '^	bytes' > /tmp/rum_nul.txt &&
+	printf '\tbytes                 : "a\000b"\n' | cmp -s - /tmp/rum_nul.txt
+if [ $? -eq 0 ]; then
+	echo ✅ U+0000 in a string constant
+else
+	echo ❌ U+0000 in a string constant
+	EXIT_CODE=1
+fi
+
+# every sample at once on the worker pool, the output has to match the one-by-one order
+./out/rum -j 4 samples > /tmp/rum_batch.txt && ./out/rum -j 1 samples | cmp -s - /tmp/rum_batch.txt &&
+	./out/rum -j 4 --pipeline samples | cmp -s - /tmp/rum_batch.txt &&
+	./out/rum -j 4 --pipeline=threads samples | cmp -s - /tmp/rum_batch.txt
+if [ $? -eq 0 ]; then
+	echo ✅ samples/
+else
+	echo ❌ samples/
+	EXIT_CODE=1
+fi
+
 exit $EXIT_CODE
\ No newline at end of file
@@ -0,0 +1,446 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include "rum.h"
+
+#define ZIP_DESCRIPTOR 0x0008 // sizes follow the data, never set here as they go in the local header
+#define ZIP_UTF8 0x0800
+
+static void put_le16(uint8_t *p, uint16_t value)
+{
+    p[0] = value & 0xff;
+    p[1] = value >> 8;
+}
+
+static void put_le32(uint8_t *p, uint32_t value)
+{
+    put_le16(p, value & 0xffff);
+    put_le16(p + 2, value >> 16);
+}
+
+static void put_le64(uint8_t *p, uint64_t value)
+{
+    put_le32(p, (uint32_t)value);
+    put_le32(p + 4, (uint32_t)(value >> 32));
+}
+
+// what the central directory needs of an entry once it has been written
+struct written_t
+{
+    uint16_t version;  // made by, copied from the input
+    uint16_t flags;
+    uint16_t method;
+    uint16_t time;
+    uint16_t date;
+    uint16_t internal;
+    uint32_t external;
+    uint32_t crc32;
+    uint32_t compressed_size;
+    uint32_t uncompressed_size;
+    uint64_t size; // of the local header and the data
+};
+
+struct rewrite_worker_t
+{
+    struct rum_inflater_t *inflater;
+    struct class_t *class;
+    struct rum_buffer_t buffer;
+    z_stream stream;
+    int deflating; // `stream` has been through deflateInit2
+    size_t classes;
+    size_t unparsed;
+    uint64_t class_bytes;
+    uint64_t written_bytes;
+    uint64_t constants;
+    uint64_t written_constants;
+};
+
+struct rewrite_t
+{
+    const struct rum_zip_t *zip;
+    int flags;
+    struct written_t *written;
+    int *errors;
+    struct rewrite_worker_t *workers;
+    struct rum_ordered_t ordered;
+};
+
+// a raw deflate stream of `length` bytes at `data`, into `out` after the `reserved` bytes of the header
+static int deflate_into(struct rewrite_worker_t *worker, const uint8_t *data, size_t length, uint8_t **out, size_t reserved, uint32_t *compressed)
+{
+    int status = worker->deflating ? deflateReset(&worker->stream)
+                                   : deflateInit2(&worker->stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    if (status != Z_OK)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    worker->deflating = 1;
+    uLong bound = deflateBound(&worker->stream, (uLong)length);
+    *out = malloc(reserved + bound);
+    if (*out == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    worker->stream.next_in = (Bytef *)data;
+    worker->stream.avail_in = (uInt)length;
+    worker->stream.next_out = *out + reserved;
+    worker->stream.avail_out = (uInt)bound;
+    if (deflate(&worker->stream, Z_FINISH) != Z_STREAM_END)
+    {
+        free(*out);
+        *out = NULL;
+        return RUM_ERR_NOMEM;
+    }
+    *compressed = (uint32_t)worker->stream.total_out;
+    return RUM_OK;
+}
+
+static void put_local_header(uint8_t *p, const struct written_t *written, const struct rum_zip_entry_t *entry)
+{
+    put_le32(p, ZIP_LOCAL);
+    put_le16(p + 4, 20); // version needed
+    put_le16(p + 6, written->flags);
+    put_le16(p + 8, written->method);
+    put_le16(p + 10, written->time);
+    put_le16(p + 12, written->date);
+    put_le32(p + 14, written->crc32);
+    put_le32(p + 18, written->compressed_size);
+    put_le32(p + 22, written->uncompressed_size);
+    put_le16(p + 26, entry->name_length);
+    put_le16(p + 28, 0); // extra field
+    memcpy(p + 30, entry->name, entry->name_length);
+}
+
+// constant pool slots of a class written to `buffer`, its count follows the magic and the version
+static unsigned short written_constants(const struct rum_buffer_t *buffer)
+{
+    return (unsigned short)(((buffer->data[8] << 8) | buffer->data[9]) - 1);
+}
+
+// rewrites the class `data` into the worker's buffer, 0 when it can't be parsed and has to be copied
+static int rewrite_class(struct rewrite_t *rewrite, struct rewrite_worker_t *worker, const uint8_t *data, size_t length)
+{
+    worker->buffer.length = 0;
+    worker->buffer.failed = 0;
+    int error = rum_class_parse_buffer(worker->class, data, length);
+    if (error == RUM_OK)
+    {
+        error = rum_class_write(worker->class, rewrite->flags, &worker->buffer);
+    }
+    if (error != RUM_OK || worker->buffer.length > UINT32_MAX)
+    {
+        worker->unparsed++;
+        return 0;
+    }
+    worker->classes++;
+    worker->class_bytes += length;
+    worker->written_bytes += worker->buffer.length;
+    worker->constants += worker->class->constant_pool_count - 1;
+    worker->written_constants += written_constants(&worker->buffer);
+    return 1;
+}
+
+// the local header and data of one entry. Classes are parsed, written back and compressed again
+// the way they were, everything else and every class that can't be parsed is copied compressed
+static void rewrite_job(void *user, size_t index, int id)
+{
+    struct rewrite_t *rewrite = user;
+    struct rewrite_worker_t *worker = &rewrite->workers[id];
+    const struct rum_zip_t *zip = rewrite->zip;
+    const struct rum_zip_entry_t *entry = &zip->entries[index];
+    struct written_t *written = &rewrite->written[index];
+    uint8_t *out = NULL;
+    size_t header = 30 + (size_t)entry->name_length;
+
+    // the name points into the entry's central directory record, which has everything but the data
+    const uint8_t *central = (const uint8_t *)entry->name - 46;
+    uint64_t offset = entry->local_header_offset;
+    if (offset > zip->length || zip->length - offset < 30 || le32(zip->data + offset) != ZIP_LOCAL ||
+        entry->compressed_size > UINT32_MAX - header || entry->uncompressed_size > UINT32_MAX)
+    {
+        rewrite->errors[index] = RUM_ERR_ARCHIVE;
+        rum_ordered_submit(&rewrite->ordered, index, NULL, 0);
+        return;
+    }
+    offset += 30 + (uint64_t)le16(zip->data + offset + 26) + le16(zip->data + offset + 28);
+    if (offset > zip->length || entry->compressed_size > zip->length - offset)
+    {
+        rewrite->errors[index] = RUM_ERR_ARCHIVE;
+        rum_ordered_submit(&rewrite->ordered, index, NULL, 0);
+        return;
+    }
+    *written = (struct written_t){
+        .version = le16(central + 4),
+        .flags = le16(central + 8) & ~ZIP_DESCRIPTOR,
+        .method = entry->method,
+        .time = le16(central + 12),
+        .date = le16(central + 14),
+        .internal = le16(central + 36),
+        .external = le32(central + 38),
+        .crc32 = entry->crc32,
+        .compressed_size = (uint32_t)entry->compressed_size,
+        .uncompressed_size = (uint32_t)entry->uncompressed_size};
+
+    const uint8_t *data;
+    size_t length;
+    int error = RUM_OK;
+    if (rum_zip_entry_is(entry, ".class") && (entry->method == ZIP_STORED || entry->method == ZIP_DEFLATED) &&
+        rum_zip_read(zip, index, worker->inflater, &data, &length) == RUM_OK && rewrite_class(rewrite, worker, data, length))
+    {
+        const uint8_t *bytes = worker->buffer.data;
+        length = worker->buffer.length;
+        written->flags &= ZIP_UTF8;
+        written->crc32 = (uint32_t)crc32(crc32(0L, Z_NULL, 0), bytes, (uInt)length);
+        written->uncompressed_size = (uint32_t)length;
+        if (entry->method == ZIP_DEFLATED)
+        {
+            error = deflate_into(worker, bytes, length, &out, header, &written->compressed_size);
+        }
+        else if ((out = malloc(header + length)) != NULL)
+        {
+            memcpy(out + header, bytes, length);
+            written->compressed_size = (uint32_t)length;
+        }
+    }
+    else if ((out = malloc(header + (size_t)entry->compressed_size)) != NULL)
+    {
+        memcpy(out + header, zip->data + offset, (size_t)entry->compressed_size);
+    }
+
+    error = error == RUM_OK && out == NULL ? RUM_ERR_NOMEM : error;
+    if (error != RUM_OK)
+    {
+        rewrite->errors[index] = error;
+        rum_ordered_submit(&rewrite->ordered, index, NULL, 0);
+        return;
+    }
+    put_local_header(out, written, entry);
+    written->size = header + written->compressed_size;
+    rum_ordered_submit(&rewrite->ordered, index, (char *)out, (size_t)written->size);
+}
+
+// the central directory after the entries, in their order, and the end records. Zip64 records are
+// only added when the archive needs them
+static int write_directory(FILE *file, const struct rum_zip_t *zip, const struct written_t *written, uint64_t *size)
+{
+    uint64_t offset = 0, directory = 0;
+    for (size_t i = 0; i < zip->count; i++)
+    {
+        offset += written[i].size;
+    }
+    uint64_t start = offset;
+    offset = 0;
+    for (size_t i = 0; i < zip->count; i++)
+    {
+        const struct rum_zip_entry_t *entry = &zip->entries[i];
+        int zip64 = offset >= 0xffffffff;
+        uint8_t record[46 + 12];
+        put_le32(record, ZIP_CENTRAL);
+        put_le16(record + 4, written[i].version);
+        put_le16(record + 6, zip64 ? 45 : 20);
+        put_le16(record + 8, written[i].flags);
+        put_le16(record + 10, written[i].method);
+        put_le16(record + 12, written[i].time);
+        put_le16(record + 14, written[i].date);
+        put_le32(record + 16, written[i].crc32);
+        put_le32(record + 20, written[i].compressed_size);
+        put_le32(record + 24, written[i].uncompressed_size);
+        put_le16(record + 28, entry->name_length);
+        put_le16(record + 30, zip64 ? 12 : 0);
+        put_le16(record + 32, 0); // comment
+        put_le16(record + 34, 0); // disk
+        put_le16(record + 36, written[i].internal);
+        put_le32(record + 38, written[i].external);
+        put_le32(record + 42, zip64 ? 0xffffffff : (uint32_t)offset);
+        // the zip64 extra field, only the offset overflows
+        put_le16(record + 46, 1);
+        put_le16(record + 48, 8);
+        put_le64(record + 50, offset);
+        if (fwrite(record, 46, 1, file) != 1 || fwrite(entry->name, 1, entry->name_length, file) != entry->name_length ||
+            (zip64 && fwrite(record + 46, 12, 1, file) != 1))
+        {
+            return RUM_ERR_IO;
+        }
+        directory += 46 + (uint64_t)entry->name_length + (zip64 ? 12 : 0);
+        offset += written[i].size;
+    }
+
+    uint64_t end = start + directory;
+    int zip64 = zip->count >= 0xffff || start >= 0xffffffff || directory >= 0xffffffff;
+    uint8_t records[56 + 20 + 22];
+    uint8_t *eocd = records + (zip64 ? 76 : 0);
+    if (zip64)
+    {
+        put_le32(records, ZIP_EOCD64);
+        put_le64(records + 4, 44); // size of the rest of the record
+        put_le16(records + 12, 45);
+        put_le16(records + 14, 45);
+        put_le32(records + 16, 0);
+        put_le32(records + 20, 0);
+        put_le64(records + 24, zip->count);
+        put_le64(records + 32, zip->count);
+        put_le64(records + 40, directory);
+        put_le64(records + 48, start);
+        put_le32(records + 56, ZIP_EOCD64_LOCATOR);
+        put_le32(records + 60, 0);
+        put_le64(records + 64, end);
+        put_le32(records + 72, 1);
+    }
+    put_le32(eocd, ZIP_EOCD);
+    put_le16(eocd + 4, 0);
+    put_le16(eocd + 6, 0);
+    put_le16(eocd + 8, zip->count >= 0xffff ? 0xffff : (uint16_t)zip->count);
+    put_le16(eocd + 10, zip->count >= 0xffff ? 0xffff : (uint16_t)zip->count);
+    put_le32(eocd + 12, directory >= 0xffffffff ? 0xffffffff : (uint32_t)directory);
+    put_le32(eocd + 16, start >= 0xffffffff ? 0xffffffff : (uint32_t)start);
+    put_le16(eocd + 20, 0); // comment
+    size_t records_size = (size_t)(eocd - records) + 22;
+    *size = end + records_size;
+    return fwrite(records, 1, records_size, file) == records_size ? RUM_OK : RUM_ERR_IO;
+}
+
+// unlike the indices the rewritten files are artifacts, readable by everyone
+static int publish(FILE *file)
+{
+    return fchmod(fileno(file), 0644) == 0 ? RUM_OK : RUM_ERR_IO;
+}
+
+struct jar_output_t
+{
+    struct rum_zip_t *zip;
+    int threads;
+    int flags;
+    struct rum_rewrite_t *stats;
+};
+
+static int write_jar(void *user, FILE *file)
+{
+    const struct jar_output_t *output = user;
+    const struct rum_zip_t *zip = output->zip;
+    struct rum_rewrite_t *stats = output->stats;
+    int threads = output->threads;
+    int error = publish(file);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+
+    struct rewrite_t rewrite = {.zip = zip, .flags = output->flags};
+    rewrite.written = calloc(zip->count + 1, sizeof(struct written_t));
+    rewrite.errors = calloc(zip->count + 1, sizeof(int));
+    rewrite.workers = calloc((size_t)threads, sizeof(struct rewrite_worker_t));
+    error = rewrite.written == NULL || rewrite.errors == NULL || rewrite.workers == NULL ? RUM_ERR_NOMEM : RUM_OK;
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        rewrite.workers[w].inflater = rum_inflater_new();
+        rewrite.workers[w].class = rum_class_new();
+        error = rewrite.workers[w].inflater == NULL || rewrite.workers[w].class == NULL ? RUM_ERR_NOMEM : RUM_OK;
+    }
+
+    // entries go out in archive order as soon as the ones before them are done
+    if (error == RUM_OK && (error = rum_ordered_init(&rewrite.ordered, zip->count, file)) == RUM_OK)
+    {
+        error = rum_parallel_for(zip->count, threads, rewrite_job, &rewrite);
+        rum_ordered_free(&rewrite.ordered);
+    }
+    for (size_t i = 0; error == RUM_OK && i < zip->count; i++)
+    {
+        error = rewrite.errors[i];
+    }
+    if (error == RUM_OK)
+    {
+        error = ferror(file) ? RUM_ERR_IO : write_directory(file, zip, rewrite.written, &stats->output_bytes);
+    }
+
+    stats->entries = zip->count;
+    stats->input_bytes = zip->length;
+    for (int w = 0; rewrite.workers != NULL && w < threads; w++)
+    {
+        struct rewrite_worker_t *worker = &rewrite.workers[w];
+        stats->classes += worker->classes;
+        stats->unparsed += worker->unparsed;
+        stats->class_bytes += worker->class_bytes;
+        stats->written_bytes += worker->written_bytes;
+        stats->constants += worker->constants;
+        stats->written_constants += worker->written_constants;
+        rum_inflater_free(worker->inflater);
+        rum_class_free(worker->class);
+        rum_buffer_free(&worker->buffer);
+        if (worker->deflating)
+        {
+            deflateEnd(&worker->stream);
+        }
+    }
+    free(rewrite.written);
+    free(rewrite.errors);
+    free(rewrite.workers);
+    return error;
+}
+
+int rum_rewrite_jar(const char *input, const char *output, int threads, int flags, struct rum_rewrite_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    threads = threads < 1 ? 1 : threads;
+    struct rum_zip_t zip;
+    int error = rum_zip_open(&zip, input);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+    struct jar_output_t jar = {&zip, threads, flags, stats};
+    error = rum_write_atomic(output, write_jar, &jar);
+    rum_zip_close(&zip);
+    return error;
+}
+
+static int write_class(void *user, FILE *file)
+{
+    const struct rum_buffer_t *buffer = user;
+    int error = publish(file);
+    if (error == RUM_OK && buffer->length > 0 && fwrite(buffer->data, 1, buffer->length, file) != buffer->length)
+    {
+        error = RUM_ERR_IO;
+    }
+    return error;
+}
+
+int rum_rewrite_class(const char *input, const char *output, int flags, struct rum_rewrite_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    struct class_t *class = rum_class_new();
+    if (class == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    struct rum_buffer_t buffer = {0};
+    int error = rum_class_parse_path(class, input);
+    if (error == RUM_OK)
+    {
+        error = rum_class_write(class, flags, &buffer);
+    }
+    if (error == RUM_OK)
+    {
+        error = rum_write_atomic(output, write_class, &buffer);
+    }
+    if (error == RUM_OK)
+    {
+        stats->entries = 1;
+        stats->classes = 1;
+        stats->class_bytes = stats->input_bytes = class->length;
+        stats->written_bytes = stats->output_bytes = buffer.length;
+        stats->constants = class->constant_pool_count - 1;
+        stats->written_constants = written_constants(&buffer);
+    }
+    rum_buffer_free(&buffer);
+    rum_class_free(class);
+    return error;
+}
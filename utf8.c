@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+
+#include "rum.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && defined(__SSE2__)
+#include <immintrin.h>
+#define HAVE_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HAVE_NEON 1
+#endif
+
+// index of the first byte at or after `i` that isn't plain ASCII (0x01 to 0x7f), word at a time
+static size_t ascii_run_scalar(const uint8_t *bytes, size_t length, size_t i)
+{
+    for (; i + 8 <= length; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        // a set high bit, or a zero byte borrowing into one
+        if (((word | ((word - 0x0101010101010101ull) & ~word)) & 0x8080808080808080ull) != 0)
+        {
+            break;
+        }
+    }
+    while (i < length && bytes[i] != 0 && bytes[i] < 0x80)
+    {
+        i++;
+    }
+    return i;
+}
+
+#ifdef HAVE_SSE2
+static size_t ascii_run_sse2(const uint8_t *bytes, size_t length, size_t i)
+{
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(bytes + i));
+        unsigned stop = (unsigned)_mm_movemask_epi8(v) | (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+        if (stop != 0)
+        {
+            return i + (size_t)__builtin_ctz(stop);
+        }
+    }
+    return ascii_run_scalar(bytes, length, i);
+}
+
+__attribute__((target("avx2"))) static size_t ascii_run_avx2(const uint8_t *bytes, size_t length, size_t i)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    for (; i + 32 <= length; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(bytes + i));
+        unsigned stop = (unsigned)_mm256_movemask_epi8(v) | (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero));
+        if (stop != 0)
+        {
+            return i + (size_t)__builtin_ctz(stop);
+        }
+    }
+    return ascii_run_sse2(bytes, length, i);
+}
+#endif
+
+#ifdef HAVE_NEON
+static size_t ascii_run_neon(const uint8_t *bytes, size_t length, size_t i)
+{
+    // bytes 0x01 to 0x7f are the ones that stay below 0x7f once 1 is taken off
+    const uint8_t one = 1, limit = 0x7f;
+    for (; i + 16 <= length; i += 16)
+    {
+        uint8x16_t v = vsubq_u8(vld1q_u8(bytes + i), vdupq_n_u8(one));
+        if (vmaxvq_u8(vcgeq_u8(v, vdupq_n_u8(limit))) != 0)
+        {
+            break;
+        }
+    }
+    return ascii_run_scalar(bytes, length, i);
+}
+#endif
+
+static size_t ascii_run(const uint8_t *bytes, size_t length, size_t i)
+{
+    // most names are shorter than a vector, they aren't worth the dispatch
+    if (length - i < 16)
+    {
+        return ascii_run_scalar(bytes, length, i);
+    }
+#if defined(HAVE_SSE2)
+    return __builtin_cpu_supports("avx2") ? ascii_run_avx2(bytes, length, i) : ascii_run_sse2(bytes, length, i);
+#elif defined(HAVE_NEON)
+    return ascii_run_neon(bytes, length, i);
+#else
+    return ascii_run_scalar(bytes, length, i);
+#endif
+}
+
+static int is_continuation(uint8_t byte)
+{
+    return (byte & 0xc0) == 0x80;
+}
+
+// length of the multi-byte sequence at `p`, 0 when it isn't one Modified UTF-8 allows
+static size_t sequence_length(const uint8_t *p, size_t remaining)
+{
+    if (p[0] == 0xc0)
+    {
+        // NUL is the only overlong form, and it is always two bytes
+        return remaining >= 2 && p[1] == 0x80 ? 2 : 0;
+    }
+    if (p[0] >= 0xc2 && p[0] <= 0xdf)
+    {
+        return remaining >= 2 && is_continuation(p[1]) ? 2 : 0;
+    }
+    if (p[0] >= 0xe0 && p[0] <= 0xef)
+    {
+        // surrogates (ed a0..bf) are allowed, they are how characters past U+FFFF are written
+        if (remaining < 3 || !is_continuation(p[1]) || !is_continuation(p[2]) || (p[0] == 0xe0 && p[1] < 0xa0))
+        {
+            return 0;
+        }
+        return 3;
+    }
+    // zero, stray continuation bytes, and the four-byte leads standard UTF-8 would use
+    return 0;
+}
+
+int rum_mutf8_valid(const uint8_t *bytes, size_t length)
+{
+    int valid = RUM_MUTF8_STANDARD;
+    size_t i = 0;
+    while ((i = ascii_run(bytes, length, i)) < length)
+    {
+        size_t step = sequence_length(bytes + i, length - i);
+        if (step == 0)
+        {
+            return 0;
+        }
+        // c0 80 and surrogates are the only sequences standard UTF-8 doesn't share
+        if (bytes[i] == 0xc0 || (bytes[i] == 0xed && bytes[i + 1] >= 0xa0))
+        {
+            valid = RUM_MUTF8_MODIFIED;
+        }
+        i += step;
+    }
+    return valid;
+}
+
+size_t rum_mutf8_to_utf8(const uint8_t *bytes, size_t length, uint8_t *out)
+{
+    size_t i = 0, written = 0;
+    for (;;)
+    {
+        size_t run = ascii_run(bytes, length, i);
+        memcpy(out + written, bytes + i, run - i);
+        written += run - i;
+        if ((i = run) >= length)
+        {
+            return written;
+        }
+
+        const uint8_t *p = bytes + i;
+        size_t remaining = length - i;
+        if (p[0] == 0xc0 && remaining >= 2)
+        {
+            out[written++] = 0;
+            i += 2;
+        }
+        else if (p[0] == 0xed && remaining >= 3 && p[1] >= 0xa0)
+        {
+            // a high surrogate followed by a low one makes up a single four-byte character
+            if (p[1] <= 0xaf && remaining >= 6 && p[3] == 0xed && p[4] >= 0xb0)
+            {
+                uint32_t code = 0x10000 + ((((uint32_t)p[1] & 0x0f) << 6 | (p[2] & 0x3f)) << 10) + (((uint32_t)p[4] & 0x0f) << 6 | (p[5] & 0x3f));
+                out[written++] = (uint8_t)(0xf0 | code >> 18);
+                out[written++] = (uint8_t)(0x80 | ((code >> 12) & 0x3f));
+                out[written++] = (uint8_t)(0x80 | ((code >> 6) & 0x3f));
+                out[written++] = (uint8_t)(0x80 | (code & 0x3f));
+                i += 6;
+            }
+            else
+            {
+                // UTF-8 can't hold a lone surrogate, it becomes U+FFFD
+                out[written++] = 0xef;
+                out[written++] = 0xbf;
+                out[written++] = 0xbd;
+                i += 3;
+            }
+        }
+        else
+        {
+            size_t step = p[0] >= 0xe0 ? 3 : 2;
+            step = step > remaining ? remaining : step;
+            memcpy(out + written, p, step);
+            written += step;
+            i += step;
+        }
+    }
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "rum.h"
+
+// calls `callback` with the remaining arguments when it is set, turning a non-zero result into RUM_STOPPED
+#define VISIT(callback, ...)                                             \
+    if ((callback) != NULL && (callback)(visitor->user, __VA_ARGS__) != 0) \
+    {                                                                    \
+        return RUM_STOPPED;                                              \
+    }
+
+static int visit_attributes(struct cursor_t *cursor, const struct rum_visitor_t *visitor, int owner, unsigned short owner_index, unsigned short attributes_count)
+{
+    for (unsigned short k = 0; k < attributes_count; k++)
+    {
+        unsigned short name_index = read_u2(cursor);
+        uint32_t attribute_length = read_u4(cursor);
+
+        struct attribute_info_t attribute = {
+            .attribute_name_index = name_index,
+            .attribute_length = attribute_length,
+            .offset = (uint32_t)cursor->offset};
+        const uint8_t *info = read_bytes(cursor, attribute_length);
+        if (cursor->overflow)
+        {
+            return RUM_ERR_TRUNCATED;
+        }
+
+        VISIT(visitor->on_attribute, owner, owner_index, &attribute, info);
+    }
+    return cursor->overflow ? RUM_ERR_TRUNCATED : RUM_OK;
+}
+
+// fields and methods share the same layout, `owner` tells them apart
+static int visit_members(struct cursor_t *cursor, const struct rum_visitor_t *visitor, int owner)
+{
+    unsigned short count = read_u2(cursor);
+    for (unsigned short i = 0; i < count; i++)
+    {
+        unsigned short access_flags = read_u2(cursor);
+        unsigned short name_index = read_u2(cursor);
+        unsigned short descriptor_index = read_u2(cursor);
+        unsigned short attributes_count = read_u2(cursor);
+        if (cursor->overflow)
+        {
+            return RUM_ERR_TRUNCATED;
+        }
+
+        if (owner == RUM_OWNER_FIELD)
+        {
+            struct field_info_t field = {
+                .access_flags = access_flags,
+                .name_index = name_index,
+                .descriptor_index = descriptor_index,
+                .attributes_count = attributes_count,
+                .attributes = NULL};
+            VISIT(visitor->on_field, i, &field);
+        }
+        else
+        {
+            struct method_info_t method = {
+                .access_flags = access_flags,
+                .name_index = name_index,
+                .descriptor_index = descriptor_index,
+                .attributes_count = attributes_count,
+                .attributes = NULL};
+            VISIT(visitor->on_method, i, &method);
+        }
+
+        int error = visit_attributes(cursor, visitor, owner, i, attributes_count);
+        if (error != RUM_OK)
+        {
+            return error;
+        }
+    }
+    return cursor->overflow ? RUM_ERR_TRUNCATED : RUM_OK;
+}
+
+int rum_visit_buffer(const uint8_t *data, size_t length, const struct rum_visitor_t *visitor)
+{
+    struct cursor_t cursor = {
+        .data = data,
+        .length = length,
+        .offset = 0,
+        .overflow = 0};
+
+    uint32_t magic = read_u4(&cursor);
+    unsigned short minor = read_u2(&cursor);
+    unsigned short major = read_u2(&cursor);
+    unsigned short constant_pool_count = read_u2(&cursor);
+    if (cursor.overflow)
+    {
+        return RUM_ERR_TRUNCATED;
+    }
+    if (magic != 0xcafebabe)
+    {
+        return RUM_ERR_MAGIC;
+    }
+    VISIT(visitor->on_header, magic, minor, major, constant_pool_count);
+
+    // wider than the count, a Long or Double in the last slot steps the index past 65535
+    for (unsigned int index = 1; index < constant_pool_count; index++)
+    {
+        struct cp_info_t constant;
+        int error = read_constant(&cursor, &constant);
+        if (error == RUM_OK && cursor.overflow)
+        {
+            error = RUM_ERR_TRUNCATED; // the constant's operands were cut off and read as zeros
+        }
+        if (error != RUM_OK)
+        {
+            return error;
+        }
+        VISIT(visitor->on_constant, (unsigned short)index, &constant);
+        // Long and Double take up two slots of the pool
+        if (constant.tag == CONSTANT_Long || constant.tag == CONSTANT_Double)
+        {
+            index++;
+        }
+    }
+
+    unsigned short access_flags = read_u2(&cursor);
+    unsigned short this_class = read_u2(&cursor);
+    unsigned short super_class = read_u2(&cursor);
+    unsigned short interfaces_count = read_u2(&cursor);
+    if (cursor.overflow)
+    {
+        return RUM_ERR_TRUNCATED;
+    }
+    VISIT(visitor->on_class, access_flags, this_class, super_class, interfaces_count);
+
+    for (unsigned short i = 0; i < interfaces_count; i++)
+    {
+        unsigned short interface = read_u2(&cursor);
+        if (cursor.overflow)
+        {
+            return RUM_ERR_TRUNCATED;
+        }
+        VISIT(visitor->on_interface, i, interface);
+    }
+
+    int error = visit_members(&cursor, visitor, RUM_OWNER_FIELD);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+    error = visit_members(&cursor, visitor, RUM_OWNER_METHOD);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+    unsigned short attribute_count = read_u2(&cursor);
+    return visit_attributes(&cursor, visitor, RUM_OWNER_CLASS, 0, attribute_count);
+}
+
+int rum_visit_path(const char *path, const struct rum_visitor_t *visitor)
+{
+    const uint8_t *data;
+    size_t length;
+    int error = rum_map_file(path, &data, &length);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+    error = rum_visit_buffer(data, length, visitor);
+    rum_unmap_file(data, length);
+    return error;
+}
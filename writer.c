@@ -0,0 +1,368 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "rum.h"
+
+void rum_buffer_put(struct rum_buffer_t *buffer, const void *bytes, size_t length)
+{
+    if (buffer->failed)
+    {
+        return;
+    }
+    if (length > buffer->capacity - buffer->length)
+    {
+        size_t capacity = buffer->capacity == 0 ? 4096 : buffer->capacity;
+        while (capacity - buffer->length < length)
+        {
+            capacity *= 2;
+        }
+        uint8_t *grown = realloc(buffer->data, capacity);
+        if (grown == NULL)
+        {
+            buffer->failed = 1;
+            return;
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+    if (length > 0)
+    {
+        memcpy(buffer->data + buffer->length, bytes, length);
+        buffer->length += length;
+    }
+}
+
+void rum_buffer_u1(struct rum_buffer_t *buffer, uint8_t value)
+{
+    rum_buffer_put(buffer, &value, 1);
+}
+
+void rum_buffer_u2(struct rum_buffer_t *buffer, uint16_t value)
+{
+    uint8_t bytes[2] = {value >> 8, value & 0xff};
+    rum_buffer_put(buffer, bytes, 2);
+}
+
+void rum_buffer_u4(struct rum_buffer_t *buffer, uint32_t value)
+{
+    uint8_t bytes[4] = {value >> 24, (value >> 16) & 0xff, (value >> 8) & 0xff, value & 0xff};
+    rum_buffer_put(buffer, bytes, 4);
+}
+
+// overwrites a u4 written earlier, at `offset` into the buffer
+static void patch_u4(struct rum_buffer_t *buffer, size_t offset, uint32_t value)
+{
+    if (!buffer->failed)
+    {
+        uint8_t bytes[4] = {value >> 24, (value >> 16) & 0xff, (value >> 8) & 0xff, value & 0xff};
+        memcpy(buffer->data + offset, bytes, 4);
+    }
+}
+
+void rum_buffer_free(struct rum_buffer_t *buffer)
+{
+    free(buffer->data);
+    memset(buffer, 0, sizeof(*buffer));
+}
+
+int rum_write_drops(const struct class_t *class, int flags, unsigned short name_index)
+{
+    if (!(flags & RUM_WRITE_STRIP_DEBUG) || name_index == 0 || name_index >= class->constant_pool_count ||
+        class->constant_pool[name_index - 1].tag != CONSTANT_Utf8)
+    {
+        return 0;
+    }
+    // the debug attributes, told apart by length first
+    const struct constant_utf8_t *name = &class->constant_pool[name_index - 1].constant_utf8;
+    switch (name->length)
+    {
+    case 10:
+        return memcmp(name->bytes, "SourceFile", 10) == 0;
+    case 15:
+        return memcmp(name->bytes, "LineNumberTable", 15) == 0;
+    case 18:
+        return memcmp(name->bytes, "LocalVariableTable", 18) == 0;
+    case 22:
+        return memcmp(name->bytes, "LocalVariableTypeTable", 22) == 0;
+    default:
+        return 0;
+    }
+}
+
+// the indices an entry holds, renumbered
+static void remap_constant(struct cp_info_t *constant, const unsigned short *map)
+{
+    switch (constant->tag)
+    {
+    case CONSTANT_Class:
+        constant->constant_class.name_index = map[constant->constant_class.name_index];
+        break;
+    case CONSTANT_Fieldref:
+    case CONSTANT_Methodref:
+    case CONSTANT_InterfaceMethodref:
+        constant->constant_methodref.class_index = map[constant->constant_methodref.class_index];
+        constant->constant_methodref.name_and_type_index = map[constant->constant_methodref.name_and_type_index];
+        break;
+    case CONSTANT_String:
+        constant->constant_string.string_index = map[constant->constant_string.string_index];
+        break;
+    case CONSTANT_NameAndType:
+        constant->constant_name_and_type_info.name_index = map[constant->constant_name_and_type_info.name_index];
+        constant->constant_name_and_type_info.descriptor_index = map[constant->constant_name_and_type_info.descriptor_index];
+        break;
+    case CONSTANT_MethodHandle:
+        constant->constant_method_handle.reference_index = map[constant->constant_method_handle.reference_index];
+        break;
+    case CONSTANT_MethodType:
+        constant->constant_method_type.descriptor_index = map[constant->constant_method_type.descriptor_index];
+        break;
+    case CONSTANT_InvokeDynamic:
+        constant->constant_invoke_dynamic.name_and_type_index = map[constant->constant_invoke_dynamic.name_and_type_index];
+        break;
+    }
+}
+
+static void write_constant(struct rum_buffer_t *out, const struct cp_info_t *constant)
+{
+    rum_buffer_u1(out, constant->tag);
+    switch (constant->tag)
+    {
+    case CONSTANT_Class:
+        rum_buffer_u2(out, constant->constant_class.name_index);
+        break;
+    case CONSTANT_Fieldref:
+    case CONSTANT_Methodref:
+    case CONSTANT_InterfaceMethodref:
+        // the three share a layout
+        rum_buffer_u2(out, constant->constant_methodref.class_index);
+        rum_buffer_u2(out, constant->constant_methodref.name_and_type_index);
+        break;
+    case CONSTANT_String:
+        rum_buffer_u2(out, constant->constant_string.string_index);
+        break;
+    case CONSTANT_Integer:
+        rum_buffer_u4(out, constant->constant_integer.bytes);
+        break;
+    case CONSTANT_Float:
+        rum_buffer_u4(out, constant->constant_float.bytes);
+        break;
+    case CONSTANT_Long:
+        rum_buffer_u4(out, constant->constant_long.high_bytes);
+        rum_buffer_u4(out, constant->constant_long.low_bytes);
+        break;
+    case CONSTANT_Double:
+        rum_buffer_u4(out, constant->constant_double.high_bytes);
+        rum_buffer_u4(out, constant->constant_double.low_bytes);
+        break;
+    case CONSTANT_NameAndType:
+        rum_buffer_u2(out, constant->constant_name_and_type_info.name_index);
+        rum_buffer_u2(out, constant->constant_name_and_type_info.descriptor_index);
+        break;
+    case CONSTANT_Utf8:
+        rum_buffer_u2(out, constant->constant_utf8.length);
+        rum_buffer_put(out, constant->constant_utf8.bytes, constant->constant_utf8.length);
+        break;
+    case CONSTANT_MethodHandle:
+        rum_buffer_u1(out, constant->constant_method_handle.reference_kind);
+        rum_buffer_u2(out, constant->constant_method_handle.reference_index);
+        break;
+    case CONSTANT_MethodType:
+        rum_buffer_u2(out, constant->constant_method_type.descriptor_index);
+        break;
+    case CONSTANT_InvokeDynamic:
+        rum_buffer_u2(out, constant->constant_invoke_dynamic.bootstrap_method_attr_index);
+        rum_buffer_u2(out, constant->constant_invoke_dynamic.name_and_type_index);
+        break;
+    }
+}
+
+// what one class is written with, `map` renumbers the pool when it is compacted
+struct write_t
+{
+    const struct class_t *class;
+    int flags;
+    const unsigned short *map; // NULL to keep every index
+    struct rum_buffer_t *out;
+};
+
+static unsigned short remap(const struct write_t *write, unsigned short index)
+{
+    return write->map == NULL ? index : write->map[index];
+}
+
+// a Code attribute without the nested attributes the flags drop, the rest of the body is copied as it is
+static int write_code(struct write_t *write, const struct attribute_info_t *attribute)
+{
+    const struct class_t *class = write->class;
+    struct rum_buffer_t *out = write->out;
+    struct rum_code_t code;
+    int error = rum_code_decode(class->data, attribute, &code);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+    const uint8_t *body = class->data + attribute->offset;
+    rum_buffer_u2(out, attribute->attribute_name_index);
+    size_t length = out->length;
+    rum_buffer_u4(out, 0);
+    // max_stack, max_locals, the code and the exception table, up to attributes_count
+    rum_buffer_put(out, body, 8 + (size_t)code.code_length + 2 + (size_t)code.exception_table_length * 8);
+
+    size_t count = out->length;
+    unsigned short kept = 0;
+    rum_buffer_u2(out, 0);
+    uint32_t offset = 0;
+    for (unsigned short i = 0; i < code.attributes_count; i++)
+    {
+        struct attribute_info_t nested;
+        rum_code_attribute(class->data, &code, &offset, &nested);
+        if (!rum_write_drops(class, write->flags, nested.attribute_name_index))
+        {
+            rum_buffer_put(out, class->data + nested.offset - 6, 6 + (size_t)nested.attribute_length);
+            kept++;
+        }
+    }
+    if (!out->failed)
+    {
+        out->data[count] = kept >> 8;
+        out->data[count + 1] = kept & 0xff;
+    }
+    patch_u4(out, length, (uint32_t)(out->length - length - 4));
+    return RUM_OK;
+}
+
+static int write_attributes(struct write_t *write, const struct attribute_info_t *attributes, unsigned short count, int method)
+{
+    const struct class_t *class = write->class;
+    struct rum_buffer_t *out = write->out;
+    unsigned short kept = count;
+    for (unsigned short i = 0; i < count; i++)
+    {
+        kept -= rum_write_drops(class, write->flags, attributes[i].attribute_name_index);
+    }
+    rum_buffer_u2(out, kept);
+    for (unsigned short i = 0; i < count; i++)
+    {
+        const struct attribute_info_t *attribute = &attributes[i];
+        if (rum_write_drops(class, write->flags, attribute->attribute_name_index))
+        {
+            continue;
+        }
+        size_t start = out->length;
+        if (method && (write->flags & RUM_WRITE_STRIP_DEBUG) && rum_attribute_is(class, attribute, "Code"))
+        {
+            int error = write_code(write, attribute);
+            if (error != RUM_OK)
+            {
+                return error;
+            }
+        }
+        else
+        {
+            // the name and length come right before the body
+            rum_buffer_put(out, class->data + attribute->offset - 6, 6 + (size_t)attribute->attribute_length);
+        }
+        // renumbered once written, in the copy
+        if (write->map != NULL && !out->failed)
+        {
+            int error = rum_pool_remap(class, write->map, out->data + start, out->length - start);
+            if (error != RUM_OK)
+            {
+                return error;
+            }
+        }
+    }
+    return RUM_OK;
+}
+
+int rum_class_write(const struct class_t *class, int flags, struct rum_buffer_t *out)
+{
+    struct write_t write = {
+        .class = class,
+        .flags = flags,
+        .map = NULL,
+        .out = out};
+    unsigned short *map = NULL;
+    unsigned short count = class->constant_pool_count;
+    if (flags & RUM_WRITE_COMPACT_POOL)
+    {
+        map = malloc(((size_t)class->constant_pool_count + 1) * sizeof(unsigned short));
+        if (map == NULL)
+        {
+            return RUM_ERR_NOMEM;
+        }
+        int error = rum_pool_compact(class, flags, map, &count);
+        if (error == RUM_OK)
+        {
+            write.map = map;
+        }
+        else if (error != RUM_STOPPED) // RUM_STOPPED leaves the pool as it is
+        {
+            free(map);
+            return error;
+        }
+    }
+
+    rum_buffer_u4(out, class->magic);
+    rum_buffer_u2(out, class->minor);
+    rum_buffer_u2(out, class->major);
+    rum_buffer_u2(out, write.map == NULL ? class->constant_pool_count : count);
+    unsigned short next = 1;
+    for (unsigned short i = 0; i + 1 < class->constant_pool_count; i++)
+    {
+        const struct cp_info_t *constant = &class->constant_pool[i];
+        int wide = constant->tag == CONSTANT_Long || constant->tag == CONSTANT_Double;
+        // dropped entries map to 0 and merged ones to an entry written already
+        if (write.map == NULL || write.map[i + 1] == next)
+        {
+            struct cp_info_t renumbered = *constant;
+            if (write.map != NULL)
+            {
+                remap_constant(&renumbered, write.map);
+            }
+            write_constant(out, &renumbered);
+            next += wide ? 2 : 1;
+        }
+        i += wide; // the unusable slot after them isn't in the file
+    }
+    rum_buffer_u2(out, class->access_flags);
+    rum_buffer_u2(out, remap(&write, class->this_class));
+    rum_buffer_u2(out, remap(&write, class->super_class));
+    rum_buffer_u2(out, class->interfaces_count);
+    for (unsigned short i = 0; i < class->interfaces_count; i++)
+    {
+        rum_buffer_u2(out, remap(&write, class->interfaces[i]));
+    }
+
+    int error = RUM_OK;
+    rum_buffer_u2(out, class->fields_count);
+    for (unsigned short i = 0; error == RUM_OK && i < class->fields_count; i++)
+    {
+        const struct field_info_t *field = &class->fields[i];
+        rum_buffer_u2(out, field->access_flags);
+        rum_buffer_u2(out, remap(&write, field->name_index));
+        rum_buffer_u2(out, remap(&write, field->descriptor_index));
+        error = write_attributes(&write, field->attributes, field->attributes_count, 0);
+    }
+    rum_buffer_u2(out, class->methods_count);
+    for (unsigned short i = 0; error == RUM_OK && i < class->methods_count; i++)
+    {
+        const struct method_info_t *method = &class->methods[i];
+        rum_buffer_u2(out, method->access_flags);
+        rum_buffer_u2(out, remap(&write, method->name_index));
+        rum_buffer_u2(out, remap(&write, method->descriptor_index));
+        error = write_attributes(&write, method->attributes, method->attributes_count, 1);
+    }
+    if (error == RUM_OK)
+    {
+        error = write_attributes(&write, class->attributes, class->attribute_count, 0);
+    }
+    free(map);
+    return error == RUM_OK && out->failed ? RUM_ERR_NOMEM : error;
+}
@@ -0,0 +1,641 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rum.h"
+
+#define XREF_MAGIC 0x584d5552 // "RUMX", reads differently on a machine of the other byte order
+#define XREF_VERSION 1
+#define XREF_SEED 0x58524546
+
+// the file is this header, the slots, the members, the classes, the strings and then the postings
+struct xref_header_t
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t member_count;
+    uint32_t class_count;
+    uint32_t slot_count;
+    uint32_t reserved;
+    uint64_t strings_size;
+    uint64_t postings_size;
+};
+
+// a member's key is "owner.name" followed by its descriptor, hashed without the descriptor so every
+// overload of a name sits on the same probe sequence
+struct xref_member_t
+{
+    uint64_t hash;
+    uint32_t key;
+    uint16_t owner_length;
+    uint16_t name_length;
+    uint16_t descriptor_length;
+    uint16_t kinds; // RUM_XREF_*
+    uint32_t count; // classes in the posting list
+    uint64_t postings;
+};
+
+struct xref_class_t
+{
+    uint32_t name;
+    uint32_t length;
+};
+
+// interns members by their whole key, one per worker and one to merge them into
+struct interner_t
+{
+    uint32_t *slots; // member + 1, 0 when empty
+    uint32_t slot_count;
+    uint32_t count;
+    uint32_t capacity;
+    struct xref_member_t *members; // `postings` is unused until the index is written
+    char *strings;
+    size_t strings_size;
+    size_t strings_capacity;
+};
+
+static void interner_free(struct interner_t *interner)
+{
+    free(interner->slots);
+    free(interner->members);
+    free(interner->strings);
+    memset(interner, 0, sizeof(struct interner_t));
+}
+
+static uint64_t key_hash(const char *key, size_t length)
+{
+    return rum_hash_bytes((const uint8_t *)key, length, XREF_SEED);
+}
+
+// doubles the slots once they are half full, rehashing by the stored hashes
+static int interner_grow(struct interner_t *interner)
+{
+    uint32_t slot_count = interner->slot_count == 0 ? 1024 : interner->slot_count * 2;
+    uint32_t *slots = calloc(slot_count, sizeof(uint32_t));
+    struct xref_member_t *members = realloc(interner->members, sizeof(struct xref_member_t) * (slot_count / 2));
+    if (slots == NULL || members == NULL)
+    {
+        free(slots);
+        interner->members = members != NULL ? members : interner->members;
+        return RUM_ERR_NOMEM;
+    }
+    for (uint32_t i = 0; i < interner->count; i++)
+    {
+        uint32_t slot = (uint32_t)members[i].hash & (slot_count - 1);
+        while (slots[slot] != 0)
+        {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+        slots[slot] = i + 1;
+    }
+    free(interner->slots);
+    interner->slots = slots;
+    interner->slot_count = slot_count;
+    interner->members = members;
+    interner->capacity = slot_count / 2;
+    return RUM_OK;
+}
+
+// the member's index, added when it isn't there yet. RUM_HIERARCHY_NONE when out of memory
+static uint32_t interner_add(struct interner_t *interner, const uint8_t *owner, uint16_t owner_length, const uint8_t *name, uint16_t name_length, const uint8_t *descriptor, uint16_t descriptor_length, uint16_t kinds)
+{
+    size_t length = (size_t)owner_length + 1 + name_length + descriptor_length;
+    if (interner->count == interner->capacity && interner_grow(interner) != RUM_OK)
+    {
+        return RUM_HIERARCHY_NONE;
+    }
+    if (interner->strings_size + length + 1 > interner->strings_capacity)
+    {
+        size_t capacity = (interner->strings_capacity + length + 1) * 2;
+        char *strings = capacity >= UINT32_MAX ? NULL : realloc(interner->strings, capacity);
+        if (strings == NULL)
+        {
+            return RUM_HIERARCHY_NONE;
+        }
+        interner->strings = strings;
+        interner->strings_capacity = capacity;
+    }
+
+    // written at the end of the strings, and only kept there when it's new
+    char *key = interner->strings + interner->strings_size;
+    memcpy(key, owner, owner_length);
+    key[owner_length] = '.';
+    memcpy(key + owner_length + 1, name, name_length);
+    memcpy(key + owner_length + 1 + name_length, descriptor, descriptor_length);
+    key[length] = '\0';
+    uint64_t hash = key_hash(key, (size_t)owner_length + 1 + name_length);
+
+    uint32_t mask = interner->slot_count - 1;
+    uint32_t slot = (uint32_t)hash & mask;
+    for (; interner->slots[slot] != 0; slot = (slot + 1) & mask)
+    {
+        struct xref_member_t *member = &interner->members[interner->slots[slot] - 1];
+        if (member->hash == hash && member->owner_length == owner_length && member->name_length == name_length &&
+            member->descriptor_length == descriptor_length && memcmp(interner->strings + member->key, key, length) == 0)
+        {
+            member->kinds |= kinds;
+            return interner->slots[slot] - 1;
+        }
+    }
+    struct xref_member_t *member = &interner->members[interner->count];
+    memset(member, 0, sizeof(struct xref_member_t));
+    member->hash = hash;
+    member->key = (uint32_t)interner->strings_size;
+    member->owner_length = owner_length;
+    member->name_length = name_length;
+    member->descriptor_length = descriptor_length;
+    member->kinds = kinds;
+    interner->strings_size += length + 1;
+    interner->slots[slot] = ++interner->count;
+    return interner->count - 1;
+}
+
+// a reference from a class to one of its worker's members
+struct reference_t
+{
+    uint32_t member;
+    uint32_t entry;
+};
+
+struct xref_worker_t
+{
+    struct rum_pool_t pool;
+    struct rum_loader_t loader;
+    struct interner_t members;
+    struct reference_t *references;
+    size_t reference_count;
+    size_t reference_capacity;
+    int error;
+};
+
+struct xref_build_t
+{
+    const struct rum_classpath_t *classpath;
+    struct xref_worker_t *workers;
+    char **names; // this_class of every entry, NULL when it couldn't be read
+    uint16_t *name_lengths;
+};
+
+// the Utf8 name of the Class entry at `index`, NULL when it isn't one
+static const uint8_t *class_name(const struct rum_pool_t *pool, uint32_t index, uint16_t *length)
+{
+    if (index == 0 || index >= pool->count || pool->tags[index] != CONSTANT_Class)
+    {
+        return NULL;
+    }
+    return rum_pool_utf8(pool, (unsigned short)pool->values[index], length);
+}
+
+static int add_reference(struct xref_worker_t *worker, uint32_t member, uint32_t entry)
+{
+    if (worker->reference_count == worker->reference_capacity)
+    {
+        size_t capacity = worker->reference_capacity == 0 ? 4096 : worker->reference_capacity * 2;
+        struct reference_t *references = realloc(worker->references, sizeof(struct reference_t) * capacity);
+        if (references == NULL)
+        {
+            return RUM_ERR_NOMEM;
+        }
+        worker->references = references;
+        worker->reference_capacity = capacity;
+    }
+    worker->references[worker->reference_count++] = (struct reference_t){member, entry};
+    return RUM_OK;
+}
+
+// resolves every member reference of the class through its NameAndType, only the pool is parsed
+static void xref_job(void *user, size_t index, int id)
+{
+    struct xref_build_t *build = user;
+    struct xref_worker_t *worker = &build->workers[id];
+    const uint8_t *data;
+    size_t length;
+    struct rum_pool_t *pool = &worker->pool;
+    if (worker->error != RUM_OK || rum_classpath_load(build->classpath, index, &worker->loader, &data, &length) != RUM_OK ||
+        rum_pool_parse(pool, data, length) != RUM_OK || pool->end + 4 > length)
+    {
+        return;
+    }
+    uint16_t this_length;
+    const uint8_t *this_name = class_name(pool, (uint32_t)(data[pool->end + 2] << 8 | data[pool->end + 3]), &this_length);
+    if (this_name == NULL)
+    {
+        return;
+    }
+
+    static const uint8_t tags[] = {CONSTANT_Fieldref, CONSTANT_Methodref, CONSTANT_InterfaceMethodref};
+    static const uint16_t kinds[] = {RUM_XREF_FIELD, RUM_XREF_METHOD, RUM_XREF_INTERFACE_METHOD};
+    for (size_t t = 0; t < sizeof(tags); t++)
+    {
+        for (unsigned short i = rum_pool_next(pool, tags[t], 1); i != 0; i = rum_pool_next(pool, tags[t], (unsigned short)(i + 1)))
+        {
+            uint32_t nat = pool->values[i] & 0xffff;
+            uint16_t owner_length, name_length, descriptor_length;
+            const uint8_t *owner = class_name(pool, pool->values[i] >> 16, &owner_length);
+            if (owner == NULL || nat == 0 || nat >= pool->count || pool->tags[nat] != CONSTANT_NameAndType)
+            {
+                continue;
+            }
+            const uint8_t *name = rum_pool_utf8(pool, (unsigned short)(pool->values[nat] >> 16), &name_length);
+            const uint8_t *descriptor = rum_pool_utf8(pool, (unsigned short)pool->values[nat], &descriptor_length);
+            if (name == NULL || descriptor == NULL)
+            {
+                continue;
+            }
+            uint32_t member = interner_add(&worker->members, owner, owner_length, name, name_length, descriptor, descriptor_length, kinds[t]);
+            if (member == RUM_HIERARCHY_NONE || add_reference(worker, member, (uint32_t)index) != RUM_OK)
+            {
+                worker->error = RUM_ERR_NOMEM;
+                return;
+            }
+        }
+    }
+    if ((build->names[index] = malloc(this_length + 1u)) != NULL)
+    {
+        memcpy(build->names[index], this_name, this_length);
+        build->name_lengths[index] = this_length;
+    }
+    else
+    {
+        worker->error = RUM_ERR_NOMEM;
+    }
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static size_t put_varint(uint8_t *out, uint32_t value)
+{
+    size_t written = 0;
+    while (value >= 0x80)
+    {
+        out[written++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[written++] = (uint8_t)value;
+    return written;
+}
+
+struct xref_output_t
+{
+    const struct xref_header_t *header;
+    const uint32_t *slots;
+    const struct xref_member_t *members;
+    const struct xref_class_t *classes;
+    const char *strings;
+    const uint8_t *postings;
+};
+
+static int write_xref(void *user, FILE *file)
+{
+    const struct xref_output_t *output = user;
+    const struct xref_header_t *header = output->header;
+    int written = fwrite(header, sizeof(*header), 1, file) == 1 &&
+                  fwrite(output->slots, sizeof(uint32_t), header->slot_count, file) == header->slot_count &&
+                  fwrite(output->members, sizeof(struct xref_member_t), header->member_count, file) == header->member_count &&
+                  fwrite(output->classes, sizeof(struct xref_class_t), header->class_count, file) == header->class_count &&
+                  fwrite(output->strings, 1, header->strings_size, file) == header->strings_size &&
+                  fwrite(output->postings, 1, header->postings_size, file) == header->postings_size;
+    return written ? RUM_OK : RUM_ERR_IO;
+}
+
+// merges the workers' members, sorts every posting list and writes them delta and varint encoded
+static int merge(struct xref_build_t *build, int threads, const char *path, size_t *member_count, size_t *class_count)
+{
+    size_t count = build->classpath->count;
+    struct interner_t merged = {0};
+    uint32_t **maps = calloc((size_t)threads, sizeof(uint32_t *));
+    uint32_t *class_ids = malloc(sizeof(uint32_t) * (count + 1));
+    struct xref_class_t *classes = malloc(sizeof(struct xref_class_t) * (count + 1));
+    int error = maps == NULL || class_ids == NULL || classes == NULL ? RUM_ERR_NOMEM : interner_grow(&merged);
+
+    // classes are numbered in classpath order, so posting lists come out in that order too
+    uint32_t classes_count = 0;
+    for (size_t i = 0; error == RUM_OK && i < count; i++)
+    {
+        class_ids[i] = build->names[i] != NULL ? classes_count++ : RUM_HIERARCHY_NONE;
+    }
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        const struct interner_t *local = &build->workers[w].members;
+        maps[w] = malloc(sizeof(uint32_t) * ((size_t)local->count + 1));
+        error = maps[w] == NULL ? RUM_ERR_NOMEM : RUM_OK;
+        for (uint32_t m = 0; error == RUM_OK && m < local->count; m++)
+        {
+            const struct xref_member_t *member = &local->members[m];
+            const uint8_t *key = (const uint8_t *)local->strings + member->key;
+            const uint8_t *name = key + member->owner_length + 1;
+            maps[w][m] = interner_add(&merged, key, member->owner_length, name, member->name_length, name + member->name_length, member->descriptor_length, member->kinds);
+            error = maps[w][m] == RUM_HIERARCHY_NONE ? RUM_ERR_NOMEM : RUM_OK;
+        }
+    }
+
+    // counting sort of every reference by member
+    size_t references = 0;
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        references += build->workers[w].reference_count;
+    }
+    uint32_t *offsets = calloc((size_t)merged.count + 2, sizeof(uint32_t));
+    uint32_t *rows = malloc(sizeof(uint32_t) * (references + 1));
+    if (error == RUM_OK && (offsets == NULL || rows == NULL || references >= UINT32_MAX))
+    {
+        error = RUM_ERR_NOMEM;
+    }
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        for (size_t r = 0; r < build->workers[w].reference_count; r++)
+        {
+            offsets[maps[w][build->workers[w].references[r].member] + 1]++;
+        }
+    }
+    for (uint32_t m = 0; error == RUM_OK && m < merged.count; m++)
+    {
+        offsets[m + 1] += offsets[m];
+    }
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        for (size_t r = 0; r < build->workers[w].reference_count; r++)
+        {
+            const struct reference_t *reference = &build->workers[w].references[r];
+            rows[offsets[maps[w][reference->member]]++] = class_ids[reference->entry];
+        }
+    }
+
+    // every row is now at offsets[m - 1] to offsets[m], a varint never takes more than 5 bytes
+    uint8_t *postings = error == RUM_OK ? malloc(references * 5 + 1) : NULL;
+    if (error == RUM_OK && postings == NULL)
+    {
+        error = RUM_ERR_NOMEM;
+    }
+    uint64_t postings_size = 0;
+    for (uint32_t m = 0; error == RUM_OK && m < merged.count; m++)
+    {
+        uint32_t begin = m == 0 ? 0 : offsets[m - 1];
+        uint32_t end = offsets[m];
+        qsort(rows + begin, end - begin, sizeof(uint32_t), compare_u32);
+        merged.members[m].postings = postings_size;
+        merged.members[m].count = 0;
+        for (uint32_t r = begin, previous = 0; r < end; r++)
+        {
+            // a class can reference a member through more than one pool entry
+            if (r > begin && rows[r] == rows[r - 1])
+            {
+                continue;
+            }
+            postings_size += put_varint(postings + postings_size, rows[r] - previous);
+            previous = rows[r];
+            merged.members[m].count++;
+        }
+    }
+
+    // class names go after the member keys in the same strings
+    size_t names_size = 0;
+    for (size_t i = 0; error == RUM_OK && i < count; i++)
+    {
+        names_size += build->names[i] != NULL ? build->name_lengths[i] + 1u : 0;
+    }
+    if (error == RUM_OK && merged.strings_size + names_size + 1 > merged.strings_capacity)
+    {
+        char *strings = merged.strings_size + names_size >= UINT32_MAX ? NULL : realloc(merged.strings, merged.strings_size + names_size + 1);
+        error = strings == NULL ? RUM_ERR_NOMEM : RUM_OK;
+        merged.strings = strings != NULL ? strings : merged.strings;
+    }
+    for (size_t i = 0; error == RUM_OK && i < count; i++)
+    {
+        if (build->names[i] != NULL)
+        {
+            struct xref_class_t *class = &classes[class_ids[i]];
+            class->name = (uint32_t)merged.strings_size;
+            class->length = build->name_lengths[i];
+            memcpy(merged.strings + merged.strings_size, build->names[i], class->length);
+            merged.strings[merged.strings_size + class->length] = '\0';
+            merged.strings_size += class->length + 1u;
+        }
+    }
+
+    // the written slots are keyed by "owner.name" alone, which is what the members are hashed by
+    if (error == RUM_OK)
+    {
+        struct xref_header_t header = {
+            .magic = XREF_MAGIC,
+            .version = XREF_VERSION,
+            .member_count = merged.count,
+            .class_count = classes_count,
+            .slot_count = merged.slot_count,
+            .strings_size = merged.strings_size,
+            .postings_size = postings_size};
+        struct xref_output_t output = {&header, merged.slots, merged.members, classes, merged.strings, postings};
+        error = rum_write_atomic(path, write_xref, &output);
+        *member_count = merged.count;
+        *class_count = classes_count;
+    }
+    for (int w = 0; maps != NULL && w < threads; w++)
+    {
+        free(maps[w]);
+    }
+    free(maps);
+    free(class_ids);
+    free(classes);
+    free(offsets);
+    free(rows);
+    free(postings);
+    interner_free(&merged);
+    return error;
+}
+
+int rum_xref_build(const struct rum_classpath_t *classpath, int threads, const char *path, size_t *member_count, size_t *class_count)
+{
+    *member_count = 0;
+    *class_count = 0;
+    size_t count = classpath->count;
+    struct xref_build_t build = {
+        .classpath = classpath,
+        .workers = calloc((size_t)threads, sizeof(struct xref_worker_t)),
+        .names = calloc(count + 1, sizeof(char *)),
+        .name_lengths = calloc(count + 1, sizeof(uint16_t))};
+    int error = build.workers == NULL || build.names == NULL || build.name_lengths == NULL ? RUM_ERR_NOMEM : RUM_OK;
+    if (error == RUM_OK)
+    {
+        error = rum_parallel_for(count, threads, xref_job, &build);
+    }
+    for (int w = 0; error == RUM_OK && w < threads; w++)
+    {
+        error = build.workers[w].error;
+    }
+    if (error == RUM_OK)
+    {
+        error = merge(&build, threads, path, member_count, class_count);
+    }
+
+    for (size_t i = 0; build.names != NULL && i < count; i++)
+    {
+        free(build.names[i]);
+    }
+    for (int w = 0; build.workers != NULL && w < threads; w++)
+    {
+        rum_pool_release(&build.workers[w].pool);
+        rum_loader_release(&build.workers[w].loader);
+        interner_free(&build.workers[w].members);
+        free(build.workers[w].references);
+    }
+    free(build.workers);
+    free(build.names);
+    free(build.name_lengths);
+    return error;
+}
+
+int rum_xref_open(struct rum_xref_t *xref, const char *path)
+{
+    memset(xref, 0, sizeof(struct rum_xref_t));
+    int error = rum_map_file(path, &xref->data, &xref->length);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+
+    struct xref_header_t header;
+    uint64_t size = 0;
+    if (xref->length >= sizeof(header))
+    {
+        memcpy(&header, xref->data, sizeof(header));
+        size = sizeof(header) + (uint64_t)header.slot_count * sizeof(uint32_t) + (uint64_t)header.member_count * sizeof(struct xref_member_t) +
+               (uint64_t)header.class_count * sizeof(struct xref_class_t);
+    }
+    if (xref->length < sizeof(header) || header.magic != XREF_MAGIC || header.version != XREF_VERSION || header.slot_count == 0 ||
+        (header.slot_count & (header.slot_count - 1)) != 0 || header.member_count >= header.slot_count || size > xref->length ||
+        header.strings_size > xref->length - size || header.postings_size != xref->length - size - header.strings_size)
+    {
+        rum_xref_close(xref);
+        return RUM_ERR_ARCHIVE;
+    }
+    xref->member_count = header.member_count;
+    xref->class_count = header.class_count;
+    xref->slot_count = header.slot_count;
+    xref->slots = xref->data + sizeof(header);
+    xref->members = xref->slots + (size_t)header.slot_count * sizeof(uint32_t);
+    xref->classes = xref->members + (size_t)header.member_count * sizeof(struct xref_member_t);
+    xref->strings = (const char *)xref->classes + (size_t)header.class_count * sizeof(struct xref_class_t);
+    xref->strings_size = header.strings_size;
+    xref->postings = (const uint8_t *)xref->strings + header.strings_size;
+    xref->postings_size = header.postings_size;
+    return RUM_OK;
+}
+
+void rum_xref_close(struct rum_xref_t *xref)
+{
+    if (xref->data != NULL)
+    {
+        rum_unmap_file(xref->data, xref->length);
+    }
+    memset(xref, 0, sizeof(struct rum_xref_t));
+}
+
+size_t rum_xref_find(const struct rum_xref_t *xref, const char *owner, size_t owner_length, const char *name, size_t name_length, int (*found)(void *user, const struct rum_member_ref_t *member), void *user)
+{
+    // names hardly ever need more than the stack buffer
+    char buffer[1024];
+    if (owner_length > 65535 || name_length > 65535)
+    {
+        return 0;
+    }
+    char *key = owner_length + name_length + 1 <= sizeof(buffer) ? buffer : malloc(owner_length + name_length + 1);
+    if (key == NULL)
+    {
+        return 0;
+    }
+    memcpy(key, owner, owner_length);
+    key[owner_length] = '.';
+    memcpy(key + owner_length + 1, name, name_length);
+    uint64_t hash = key_hash(key, owner_length + 1 + name_length);
+
+    // every overload was inserted along this probe sequence, before its first empty slot
+    size_t matches = 0;
+    uint32_t mask = xref->slot_count - 1;
+    for (uint32_t slot = (uint32_t)hash & mask, probes = 0; probes < xref->slot_count; slot = (slot + 1) & mask, probes++)
+    {
+        uint32_t index;
+        memcpy(&index, xref->slots + (size_t)slot * sizeof(uint32_t), sizeof(index));
+        if (index == 0 || index > xref->member_count)
+        {
+            break;
+        }
+        struct xref_member_t member;
+        memcpy(&member, xref->members + (size_t)(index - 1) * sizeof(member), sizeof(member));
+        size_t length = (size_t)member.owner_length + 1 + member.name_length + member.descriptor_length;
+        if (member.hash != hash || member.owner_length != owner_length || member.name_length != name_length ||
+            (uint64_t)member.key + length > xref->strings_size || member.postings > xref->postings_size ||
+            memcmp(xref->strings + member.key, key, owner_length + 1 + name_length) != 0)
+        {
+            continue;
+        }
+        struct rum_member_ref_t ref = {
+            .owner = xref->strings + member.key,
+            .owner_length = member.owner_length,
+            .name = xref->strings + member.key + member.owner_length + 1,
+            .name_length = member.name_length,
+            .descriptor = xref->strings + member.key + member.owner_length + 1 + member.name_length,
+            .descriptor_length = member.descriptor_length,
+            .kinds = member.kinds,
+            .count = member.count,
+            .postings = xref->postings + member.postings,
+            .postings_length = (size_t)(xref->postings_size - member.postings)};
+        matches++;
+        if (found(user, &ref) != RUM_OK)
+        {
+            break;
+        }
+    }
+    if (key != buffer)
+    {
+        free(key);
+    }
+    return matches;
+}
+
+size_t rum_xref_classes(const struct rum_member_ref_t *member, uint32_t *classes)
+{
+    size_t decoded = 0, offset = 0;
+    uint32_t value = 0;
+    while (decoded < member->count && offset < member->postings_length)
+    {
+        uint32_t delta = 0;
+        for (unsigned shift = 0; offset < member->postings_length && shift < 35; shift += 7)
+        {
+            uint8_t byte = member->postings[offset++];
+            delta |= (uint32_t)(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+            {
+                break;
+            }
+        }
+        value += delta;
+        classes[decoded++] = value;
+    }
+    return decoded;
+}
+
+const char *rum_xref_class(const struct rum_xref_t *xref, uint32_t class, size_t *length)
+{
+    struct xref_class_t record;
+    if (class >= xref->class_count)
+    {
+        return NULL;
+    }
+    memcpy(&record, xref->classes + (size_t)class * sizeof(record), sizeof(record));
+    if ((uint64_t)record.name + record.length > xref->strings_size)
+    {
+        return NULL;
+    }
+    *length = record.length;
+    return xref->strings + record.name;
+}
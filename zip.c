@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2023-Present, Japroz Singh Saini <japrozsaini@outlook.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "rum.h"
+
+// the end of central directory record sits in the last 64k of the file, after an optional comment
+static const uint8_t *find_eocd(const uint8_t *data, size_t length)
+{
+    if (length < 22)
+    {
+        return NULL;
+    }
+    size_t lowest = length > 22 + 0xffff ? length - 22 - 0xffff : 0;
+    for (size_t offset = length - 22 + 1; offset-- > lowest;)
+    {
+        if (le32(data + offset) == ZIP_EOCD)
+        {
+            return data + offset;
+        }
+    }
+    return NULL;
+}
+
+// replaces the 0xffffffff placeholders of a central directory entry with its zip64 extra field
+static void read_zip64_extra(const uint8_t *extra, size_t length, struct rum_zip_entry_t *entry)
+{
+    while (length >= 4)
+    {
+        uint16_t id = le16(extra), size = le16(extra + 2);
+        if (size > length - 4)
+        {
+            return;
+        }
+        if (id == 0x0001)
+        {
+            const uint8_t *p = extra + 4, *end = p + size;
+            if (entry->uncompressed_size == 0xffffffff && end - p >= 8)
+            {
+                entry->uncompressed_size = le64(p);
+                p += 8;
+            }
+            if (entry->compressed_size == 0xffffffff && end - p >= 8)
+            {
+                entry->compressed_size = le64(p);
+                p += 8;
+            }
+            if (entry->local_header_offset == 0xffffffff && end - p >= 8)
+            {
+                entry->local_header_offset = le64(p);
+            }
+            return;
+        }
+        extra += 4 + size;
+        length -= 4 + size;
+    }
+}
+
+int rum_zip_open(struct rum_zip_t *zip, const char *path)
+{
+    memset(zip, 0, sizeof(struct rum_zip_t));
+    int error = rum_map_file(path, &zip->data, &zip->length);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+    error = rum_zip_open_buffer(zip, zip->data, zip->length);
+    if (error != RUM_OK)
+    {
+        rum_unmap_file(zip->data, zip->length);
+        memset(zip, 0, sizeof(struct rum_zip_t));
+        return error;
+    }
+    zip->mapped = 1;
+    return RUM_OK;
+}
+
+int rum_zip_open_buffer(struct rum_zip_t *zip, const uint8_t *data, size_t length)
+{
+    memset(zip, 0, sizeof(struct rum_zip_t));
+    zip->data = data;
+    zip->length = length;
+
+    const uint8_t *eocd = find_eocd(data, length);
+    if (eocd == NULL)
+    {
+        return RUM_ERR_ARCHIVE;
+    }
+    uint64_t count = le16(eocd + 10);
+    uint64_t directory_size = le32(eocd + 12);
+    uint64_t directory_offset = le32(eocd + 16);
+
+    // archives with more than 65535 entries or over 4GB keep the real values in the zip64 record
+    size_t eocd_offset = (size_t)(eocd - data);
+    if (eocd_offset >= 20 && le32(eocd - 20) == ZIP_EOCD64_LOCATOR)
+    {
+        uint64_t record = le64(eocd - 20 + 8);
+        if (length >= 56 && record <= length - 56 && le32(data + record) == ZIP_EOCD64)
+        {
+            count = le64(data + record + 32);
+            directory_size = le64(data + record + 40);
+            directory_offset = le64(data + record + 48);
+        }
+    }
+    if (directory_offset > length || directory_size > length - directory_offset || count > directory_size / 46)
+    {
+        return RUM_ERR_ARCHIVE;
+    }
+
+    zip->entries = malloc(sizeof(struct rum_zip_entry_t) * (count == 0 ? 1 : (size_t)count));
+    if (zip->entries == NULL)
+    {
+        return RUM_ERR_NOMEM;
+    }
+
+    const uint8_t *p = data + directory_offset, *end = p + directory_size;
+    for (uint64_t i = 0; i < count; i++)
+    {
+        if (end - p < 46 || le32(p) != ZIP_CENTRAL)
+        {
+            rum_zip_close(zip);
+            return RUM_ERR_ARCHIVE;
+        }
+        uint16_t name_length = le16(p + 28), extra_length = le16(p + 30), comment_length = le16(p + 32);
+        if ((size_t)(end - p) < 46u + name_length + extra_length + comment_length)
+        {
+            rum_zip_close(zip);
+            return RUM_ERR_ARCHIVE;
+        }
+
+        struct rum_zip_entry_t entry = {
+            .name = (const char *)p + 46,
+            .name_length = name_length,
+            .method = le16(p + 10),
+            .crc32 = le32(p + 16),
+            .compressed_size = le32(p + 20),
+            .uncompressed_size = le32(p + 24),
+            .local_header_offset = le32(p + 42)};
+        read_zip64_extra(p + 46 + name_length, extra_length, &entry);
+        zip->entries[zip->count++] = entry;
+
+        p += 46 + name_length + extra_length + comment_length;
+    }
+    return RUM_OK;
+}
+
+void rum_zip_close(struct rum_zip_t *zip)
+{
+    free(zip->entries);
+    if (zip->mapped)
+    {
+        rum_unmap_file(zip->data, zip->length);
+    }
+    memset(zip, 0, sizeof(struct rum_zip_t));
+}
+
+int rum_zip_entry_is(const struct rum_zip_entry_t *entry, const char *suffix)
+{
+    size_t length = strlen(suffix);
+    return entry->name_length >= length && memcmp(entry->name + entry->name_length - length, suffix, length) == 0;
+}
+
+struct rum_inflater_t
+{
+    z_stream stream;
+    int ready; // `stream` has been through inflateInit2
+    uint8_t *buffers[2];
+    size_t capacities[2];
+};
+
+struct rum_inflater_t *rum_inflater_new(void)
+{
+    return calloc(1, sizeof(struct rum_inflater_t));
+}
+
+void rum_inflater_free(struct rum_inflater_t *inflater)
+{
+    if (inflater == NULL)
+    {
+        return;
+    }
+    if (inflater->ready)
+    {
+        inflateEnd(&inflater->stream);
+    }
+    free(inflater->buffers[0]);
+    free(inflater->buffers[1]);
+    free(inflater);
+}
+
+// inflates a raw deflate (or zlib) stream into one of the inflater's buffers, which only ever grow.
+// output goes to whichever buffer `input` is not in, so layered streams can be undone in turn
+int rum_inflate(struct rum_inflater_t *inflater, const uint8_t *input, size_t input_length, size_t output_length, int raw, const uint8_t **output)
+{
+    int target = input == inflater->buffers[0] && input != NULL ? 1 : 0;
+    if (inflater->capacities[target] < output_length || inflater->buffers[target] == NULL)
+    {
+        size_t capacity = output_length < 4096 ? 4096 : output_length;
+        uint8_t *grown = realloc(inflater->buffers[target], capacity);
+        if (grown == NULL)
+        {
+            return RUM_ERR_NOMEM;
+        }
+        inflater->buffers[target] = grown;
+        inflater->capacities[target] = capacity;
+    }
+
+    int window = raw ? -MAX_WBITS : MAX_WBITS;
+    int status = inflater->ready ? inflateReset2(&inflater->stream, window) : inflateInit2(&inflater->stream, window);
+    if (status != Z_OK)
+    {
+        return RUM_ERR_NOMEM;
+    }
+    inflater->ready = 1;
+
+    // zlib counts in uInt, which is plenty for class files
+    inflater->stream.next_in = (Bytef *)input;
+    inflater->stream.avail_in = (uInt)input_length;
+    inflater->stream.next_out = inflater->buffers[target];
+    inflater->stream.avail_out = (uInt)output_length;
+    status = inflate(&inflater->stream, Z_FINISH);
+    if (status != Z_STREAM_END || inflater->stream.total_out != output_length)
+    {
+        return RUM_ERR_ARCHIVE;
+    }
+    *output = inflater->buffers[target];
+    return RUM_OK;
+}
+
+int rum_zip_read(const struct rum_zip_t *zip, size_t index, struct rum_inflater_t *inflater, const uint8_t **data, size_t *length)
+{
+    const struct rum_zip_entry_t *entry = &zip->entries[index];
+    uint64_t offset = entry->local_header_offset;
+    if (offset > zip->length || zip->length - offset < 30 || le32(zip->data + offset) != ZIP_LOCAL)
+    {
+        return RUM_ERR_ARCHIVE;
+    }
+    // the local header repeats the name, its extra field may differ from the central one
+    offset += 30 + (uint64_t)le16(zip->data + offset + 26) + le16(zip->data + offset + 28);
+    if (offset > zip->length || entry->compressed_size > zip->length - offset)
+    {
+        return RUM_ERR_ARCHIVE;
+    }
+    const uint8_t *body = zip->data + offset;
+
+    if (entry->method == ZIP_STORED)
+    {
+        // used in place, straight out of the mapping
+        if (entry->compressed_size != entry->uncompressed_size)
+        {
+            return RUM_ERR_ARCHIVE;
+        }
+        *data = body;
+        *length = (size_t)entry->uncompressed_size;
+        return RUM_OK;
+    }
+    if (entry->method != ZIP_DEFLATED || entry->uncompressed_size > UINT32_MAX || entry->compressed_size > UINT32_MAX)
+    {
+        return RUM_ERR_ARCHIVE;
+    }
+
+    int error = rum_inflate(inflater, body, (size_t)entry->compressed_size, (size_t)entry->uncompressed_size, 1, data);
+    if (error != RUM_OK)
+    {
+        return error;
+    }
+    if (crc32(crc32(0L, Z_NULL, 0), *data, (uInt)entry->uncompressed_size) != entry->crc32)
+    {
+        return RUM_ERR_ARCHIVE;
+    }
+    *length = (size_t)entry->uncompressed_size;
+    return RUM_OK;
+}